@@ -1,7 +1,10 @@
 TEMPLATE = subdirs
 
 SUBDIRS += $$PWD/dde-network-utils/dde-network-utils.pro \
-           $$PWD/tests/dde-network-utils/tst_dde-network-utils.pro
+           $$PWD/tests/dde-network-utils/tst_dde-network-utils.pro \
+           $$PWD/tests/benchmarks/bench_dde-network-utils.pro \
+           $$PWD/tests/e2e/e2e_dde-network-utils.pro \
+           $$PWD/tools/dde-network-replay/dde-network-replay.pro
 
 # Automating generation .qm files from .ts files
 CONFIG(release, debug|release) {
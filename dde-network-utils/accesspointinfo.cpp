@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "accesspointinfo.h"
+
+#include <QtMath>
+
+using namespace dde::network;
+
+AccessPointInfo::AccessPointInfo(int window, double alpha)
+    : m_samples(qMax(window, 2))
+    , m_head(0)
+    , m_count(0)
+    , m_alpha(qBound(0.0, alpha, 1.0))
+    , m_smoothed(0)
+{
+}
+
+const QString AccessPointInfo::key(const QJsonObject &apInfo)
+{
+    const QString &bssid = apInfo.value("Bssid").toString();
+    if (!bssid.isEmpty())
+        return bssid;
+
+    return apInfo.value("Path").toString();
+}
+
+void AccessPointInfo::addSample(int strength, qint64 timestamp)
+{
+    m_samples[m_head] = { timestamp, strength };
+    m_head = (m_head + 1) % m_samples.size();
+
+    if (m_count == 0)
+        m_smoothed = strength;
+    else
+        m_smoothed = m_alpha * strength + (1 - m_alpha) * m_smoothed;
+
+    if (m_count < m_samples.size())
+        ++m_count;
+}
+
+int AccessPointInfo::strength() const
+{
+    return isEmpty() ? 0 : sampleAt(m_count - 1).strength;
+}
+
+qint64 AccessPointInfo::lastUpdate() const
+{
+    return isEmpty() ? 0 : sampleAt(m_count - 1).timestamp;
+}
+
+double AccessPointInfo::trend() const
+{
+    if (m_count < 2)
+        return 0;
+
+    // 以最早的采样为时间原点, 避免时间戳过大时的精度损失
+    const qint64 origin = sampleAt(0).timestamp;
+    double sumT = 0, sumS = 0, sumTT = 0, sumTS = 0;
+    for (int i = 0; i < m_count; ++i) {
+        const Sample &s = sampleAt(i);
+        const double t = (s.timestamp - origin) / 1000.0;
+        sumT += t;
+        sumS += s.strength;
+        sumTT += t * t;
+        sumTS += t * s.strength;
+    }
+
+    const double denominator = m_count * sumTT - sumT * sumT;
+    if (qFuzzyIsNull(denominator))
+        return 0;
+
+    return (m_count * sumTS - sumT * sumS) / denominator;
+}
+
+const QVector<QPair<qint64, int>> AccessPointInfo::samples() const
+{
+    QVector<QPair<qint64, int>> result;
+    result.reserve(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        const Sample &s = sampleAt(i);
+        result.append(qMakePair(s.timestamp, s.strength));
+    }
+
+    return result;
+}
+
+// index 为 0 表示最早的采样
+const AccessPointInfo::Sample &AccessPointInfo::sampleAt(int index) const
+{
+    const int size = m_samples.size();
+    return m_samples.at((m_head - m_count + index + size) % size);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACCESSPOINTINFO_H
+#define ACCESSPOINTINFO_H
+
+#include <QVector>
+#include <QPair>
+#include <QString>
+#include <QJsonObject>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief AccessPointInfo 保存单个 AP 的信号强度时间序列
+ *
+ * 采样保存在固定大小的环形缓冲区中, 每次更新的开销为常数,
+ * 同时维护一个 EWMA 平滑后的信号强度, trend() 返回窗口内信号强度的变化速率.
+ */
+class AccessPointInfo
+{
+public:
+    enum {
+        DefaultWindow = 16
+    };
+
+    explicit AccessPointInfo(int window = DefaultWindow, double alpha = 0.3);
+
+    // AP 的唯一标识, 优先使用 BSSID, 后端未提供时退回到 AP 的 DBus 路径
+    static const QString key(const QJsonObject &apInfo);
+
+    void addSample(int strength, qint64 timestamp);
+
+    bool isEmpty() const { return m_count == 0; }
+    int sampleCount() const { return m_count; }
+    int window() const { return m_samples.size(); }
+    int strength() const;
+    qint64 lastUpdate() const;
+    double smoothedStrength() const { return m_smoothed; }
+    // 信号强度每秒的变化量(最小二乘斜率), 负数表示信号在变弱
+    double trend() const;
+    // 按时间顺序(旧 -> 新)返回所有采样, 每项为 (timestamp, strength)
+    const QVector<QPair<qint64, int>> samples() const;
+
+private:
+    struct Sample
+    {
+        qint64 timestamp;
+        int strength;
+    };
+
+    const Sample &sampleAt(int index) const;
+
+private:
+    QVector<Sample> m_samples;
+    int m_head;
+    int m_count;
+    double m_alpha;
+    double m_smoothed;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // ACCESSPOINTINFO_H
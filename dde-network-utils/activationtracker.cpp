@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "activationtracker.h"
+#include "devicestatushistory.h"
+#include "eventtracer.h"
+#include "networkdevice.h"
+#include "networkmodel.h"
+
+#include <QTimer>
+
+// 包括等待用户输入密码的时间
+#define ACTIVATION_TIMEOUT (3 * 60 * 1000)
+
+using namespace dde::network;
+
+ActivationTracker::ActivationTracker(NetworkModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_timeout(ACTIVATION_TIMEOUT)
+    , m_nextId(0)
+    , m_activated(0)
+    , m_failed(0)
+{
+    qRegisterMetaType<ActivationResult>();
+}
+
+quint64 ActivationTracker::start(const QString &method, const QString &devPath, const QString &uuid, const QString &apPath)
+{
+    if (m_pending.contains(devPath))
+        finish(devPath, false, "superseded", DeviceStatusHistory::now());
+
+    Pending pending;
+    pending.result.id = ++m_nextId;
+    pending.result.method = method;
+    pending.result.devPath = devPath;
+    pending.result.uuid = uuid;
+    pending.result.apPath = apPath;
+    pending.startUsec = DeviceStatusHistory::now();
+
+    NetworkDevice *dev = findDevice(devPath);
+    if (dev) {
+        pending.device = dev;
+        pending.statusConnection = connect(dev, static_cast<void (NetworkDevice::*)(NetworkDevice::DeviceStatus) const>(&NetworkDevice::statusChanged),
+                                           this, [this, devPath] { onStatusChanged(devPath); });
+        pending.removedConnection = connect(dev, &NetworkDevice::removed, this, [this, devPath] {
+            auto it = m_pending.find(devPath);
+            if (it == m_pending.end())
+                return;
+            // 设备正在析构, 不再读取它的状态
+            it.value().device = nullptr;
+            finish(devPath, false, "removed", DeviceStatusHistory::now());
+        });
+    }
+
+    const quint64 id = pending.result.id;
+    m_pending.insert(devPath, pending);
+
+    if (m_timeout > 0)
+        QTimer::singleShot(m_timeout, this, [this, devPath, id] { onTimeout(devPath, id); });
+
+    if (EventTracer::isEnabled())
+        EventTracer::asyncBegin("activation", method.toUtf8(), id, uuid.toUtf8());
+
+    return id;
+}
+
+void ActivationTracker::callFinished(quint64 id, const QString &error)
+{
+    for (auto it(m_pending.begin()); it != m_pending.end(); ++it) {
+        Pending &pending = it.value();
+        if (pending.result.id != id)
+            continue;
+
+        const qint64 now = DeviceStatusHistory::now();
+        pending.result.requestUsec = now - pending.startUsec;
+        m_request.record(pending.result.requestUsec);
+
+        if (!error.isEmpty())
+            finish(it.key(), false, error, now);
+        else if (!pending.device)
+            finish(it.key(), true, QString(), now);
+
+        return;
+    }
+}
+
+NetworkDevice *ActivationTracker::findDevice(const QString &devPath) const
+{
+    for (NetworkDevice *dev : m_model->devices()) {
+        if (dev->path() == devPath)
+            return dev;
+    }
+
+    return nullptr;
+}
+
+void ActivationTracker::onStatusChanged(const QString &devPath)
+{
+    auto it = m_pending.find(devPath);
+    if (it == m_pending.end() || !it.value().device)
+        return;
+
+    // 只关心请求之后开始且已经结束的那次连接, 之前未完成的连接被中断不算失败
+    const DeviceStatusHistory &history = it.value().device->statusHistory();
+    const DeviceStatusHistory::ConnectAttempt attempt = history.lastAttempt();
+    if (history.isConnecting() || attempt.startUsec < it.value().startUsec)
+        return;
+
+    const bool activated = attempt.result == NetworkDevice::Activated;
+    it.value().result.phaseUsec = attempt.phaseUsec;
+    finish(devPath, activated, activated ? QString() : QString("failed"), attempt.endUsec);
+}
+
+void ActivationTracker::onTimeout(const QString &devPath, quint64 id)
+{
+    auto it = m_pending.find(devPath);
+    if (it == m_pending.end() || it.value().result.id != id)
+        return;
+
+    finish(devPath, false, "timeout", DeviceStatusHistory::now());
+}
+
+void ActivationTracker::finish(const QString &devPath, bool activated, const QString &error, qint64 endUsec)
+{
+    Pending pending = m_pending.take(devPath);
+    disconnect(pending.statusConnection);
+    disconnect(pending.removedConnection);
+
+    ActivationResult &result = pending.result;
+    result.activated = activated;
+    result.error = error;
+    result.totalUsec = endUsec - pending.startUsec;
+    if (pending.device)
+        result.status = pending.device->status();
+
+    for (auto it(result.phaseUsec.constBegin()); it != result.phaseUsec.constEnd(); ++it)
+        m_phases[it.key()].record(it.value());
+
+    if (activated) {
+        ++m_activated;
+        m_timeToActivate.record(result.totalUsec);
+    } else {
+        ++m_failed;
+    }
+
+    if (EventTracer::isEnabled())
+        EventTracer::asyncEnd("activation", result.method.toUtf8(), result.id, error.toUtf8());
+
+    Q_EMIT activationFinished(result);
+}
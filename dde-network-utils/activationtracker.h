@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ACTIVATIONTRACKER_H
+#define ACTIVATIONTRACKER_H
+
+#include "latencyhistogram.h"
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QPointer>
+
+namespace dde {
+
+namespace network {
+
+class NetworkModel;
+class NetworkDevice;
+
+// 一次激活请求的结果, 时间单位为微秒
+struct ActivationResult
+{
+    ActivationResult() : id(0), activated(false), requestUsec(-1), totalUsec(0), status(0) {}
+
+    quint64 id;
+    // 发起请求的 DBus 方法
+    QString method;
+    QString devPath;
+    QString uuid;
+    QString apPath;
+    bool activated;
+    // 从调用到 DBus 返回的耗时, 没有返回时为 -1
+    qint64 requestUsec;
+    // 从调用到设备激活或失败的耗时
+    qint64 totalUsec;
+    // 设备在各连接阶段的耗时, key 为 NetworkDevice::DeviceStatus
+    QMap<int, qint64> phaseUsec;
+    // 结束时的设备状态, 没有对应设备时为 0
+    int status;
+    // 失败原因: DBus 错误名, 或 failed / timeout / superseded / removed
+    QString error;
+};
+
+/**
+ * @brief ActivationTracker 跟踪 NetworkWorker 发起的激活请求, 直到对应的设备激活或失败
+ *
+ * 以设备路径区分请求, 同一设备上新的请求会使之前未结束的请求以 superseded 结束.
+ * 设备状态的耗时取自 NetworkDevice::statusHistory() 中在请求之后开始的那次连接.
+ * model 中找不到对应设备时 (如 VPN), 以 DBus 调用的返回作为结束.
+ */
+class ActivationTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ActivationTracker(NetworkModel *model, QObject *parent = nullptr);
+
+    int timeout() const { return m_timeout; }
+    void setTimeout(int msec) { m_timeout = msec; }
+
+    // 返回请求的 id, DBus 调用返回时以该 id 调用 callFinished
+    quint64 start(const QString &method, const QString &devPath, const QString &uuid, const QString &apPath = QString());
+    // error 为空表示调用成功, 调用超时时为 QDBusError::Timeout 的错误名
+    void callFinished(quint64 id, const QString &error);
+
+    int pendingCount() const { return m_pending.size(); }
+    quint64 activatedCount() const { return m_activated; }
+    quint64 failedCount() const { return m_failed; }
+
+    // 成功激活的总耗时
+    const LatencyHistogram timeToActivate() const { return m_timeToActivate; }
+    const LatencyHistogram requestHistogram() const { return m_request; }
+    const LatencyHistogram phaseHistogram(int status) const { return m_phases.value(status); }
+
+Q_SIGNALS:
+    void activationFinished(const ActivationResult &result) const;
+
+private:
+    struct Pending
+    {
+        ActivationResult result;
+        qint64 startUsec;
+        QPointer<NetworkDevice> device;
+        QMetaObject::Connection statusConnection;
+        QMetaObject::Connection removedConnection;
+    };
+
+    NetworkDevice *findDevice(const QString &devPath) const;
+    void onStatusChanged(const QString &devPath);
+    void onTimeout(const QString &devPath, quint64 id);
+    void finish(const QString &devPath, bool activated, const QString &error, qint64 endUsec);
+
+private:
+    NetworkModel *m_model;
+    int m_timeout;
+    quint64 m_nextId;
+    QHash<QString, Pending> m_pending;
+
+    quint64 m_activated;
+    quint64 m_failed;
+    LatencyHistogram m_timeToActivate;
+    LatencyHistogram m_request;
+    QHash<int, LatencyHistogram> m_phases;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+Q_DECLARE_METATYPE(dde::network::ActivationResult)
+
+#endif // ACTIVATIONTRACKER_H
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "connectionrecord.h"
+#include "networkdevice.h"
+
+#include <QLatin1String>
+
+using namespace dde::network;
+
+struct ConnectionRecord::Data : public QSharedData
+{
+    explicit Data(const QJsonObject &connection) : object(connection), hash(0) {}
+
+    // 与解析得到的 Json 对象共享数据, 记录本身不复制任何字段
+    const QJsonObject object;
+    quint64 hash;
+};
+
+ConnectionRecord::ConnectionRecord()
+{
+}
+
+ConnectionRecord::ConnectionRecord(const QJsonObject &connection)
+    : d(new Data(connection))
+{
+    // 逐项访问 Json 值计算哈希, 不序列化为文本
+    d->hash = NetworkDevice::contentHash(QList<QJsonObject>() << connection);
+}
+
+ConnectionRecord::ConnectionRecord(const ConnectionRecord &other)
+    : d(other.d)
+{
+}
+
+ConnectionRecord::~ConnectionRecord()
+{
+}
+
+ConnectionRecord &ConnectionRecord::operator=(const ConnectionRecord &other)
+{
+    d = other.d;
+    return *this;
+}
+
+QString ConnectionRecord::field(const char *key) const
+{
+    // 不是字符串的值返回空字符串
+    return d ? d->object.value(QLatin1String(key)).toString() : QString();
+}
+
+QString ConnectionRecord::id() const
+{
+    return field("Id");
+}
+
+QString ConnectionRecord::uuid() const
+{
+    return field("Uuid");
+}
+
+QString ConnectionRecord::ssid() const
+{
+    return field("Ssid");
+}
+
+QString ConnectionRecord::hwAddress() const
+{
+    return field("HwAddress");
+}
+
+QString ConnectionRecord::ifcName() const
+{
+    return field("IfcName");
+}
+
+QString ConnectionRecord::path() const
+{
+    return field("Path");
+}
+
+quint64 ConnectionRecord::hash() const
+{
+    return d ? d->hash : 0;
+}
+
+QJsonObject ConnectionRecord::object() const
+{
+    return d ? d->object : QJsonObject();
+}
+
+bool ConnectionRecord::operator==(const ConnectionRecord &other) const
+{
+    if (d == other.d)
+        return true;
+    if (!d || !other.d)
+        return false;
+    if (d->hash != other.d->hash)
+        return false;
+
+    // 哈希相同时比较完整的内容, 排除碰撞
+    return d->object == other.d->object;
+}
+
+QList<ConnectionRecord> ConnectionRecord::fromObjects(const QList<QJsonObject> &objects)
+{
+    QList<ConnectionRecord> records;
+    records.reserve(objects.size());
+    for (const QJsonObject &object : objects)
+        records << ConnectionRecord(object);
+
+    return records;
+}
+
+QList<QJsonObject> ConnectionRecord::toObjects(const QList<ConnectionRecord> &records)
+{
+    QList<QJsonObject> objects;
+    objects.reserve(records.size());
+    for (const ConnectionRecord &record : records)
+        objects << record.object();
+
+    return objects;
+}
+
+ConnectionSnapshot ConnectionRecord::snapshot(const QList<ConnectionRecord> &records)
+{
+    return ConnectionSnapshot::lazy([records] {
+        return toObjects(records);
+    });
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONNECTIONRECORD_H
+#define CONNECTIONRECORD_H
+
+#include "sharedsnapshot.h"
+
+#include <QExplicitlySharedDataPointer>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief ConnectionRecord 一个连接配置的共享记录
+ *
+ * 记录只持有解析得到的 Json 对象, 与解析结果共享同一份数据, 不复制也不重新序列化;
+ * Id, Uuid, Ssid, HwAddress, IfcName 和 Path 等常用字段在访问时才从中读取.
+ * 记录创建后不可修改, 复制只增加引用计数, 所有接口都可以在任意线程中调用.
+ * hash() 在创建时计算, 哈希不同时直接判定不相等, 相同时再比较完整的内容确认.
+ */
+class ConnectionRecord
+{
+public:
+    ConnectionRecord();
+    explicit ConnectionRecord(const QJsonObject &connection);
+    ConnectionRecord(const ConnectionRecord &other);
+    ~ConnectionRecord();
+
+    ConnectionRecord &operator=(const ConnectionRecord &other);
+
+    bool isNull() const { return !d; }
+
+    QString id() const;
+    QString uuid() const;
+    QString ssid() const;
+    QString hwAddress() const;
+    QString ifcName() const;
+    QString path() const;
+
+    quint64 hash() const;
+
+    // 完整的连接配置, 与创建记录时的 Json 对象相同
+    QJsonObject object() const;
+
+    bool operator==(const ConnectionRecord &other) const;
+    bool operator!=(const ConnectionRecord &other) const { return !(*this == other); }
+
+    static QList<ConnectionRecord> fromObjects(const QList<QJsonObject> &objects);
+    static QList<QJsonObject> toObjects(const QList<ConnectionRecord> &records);
+    // 返回的快照在第一次访问内容时才生成列表
+    static ConnectionSnapshot snapshot(const QList<ConnectionRecord> &records);
+
+private:
+    QString field(const char *key) const;
+
+private:
+    struct Data;
+
+    QExplicitlySharedDataPointer<Data> d;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+Q_DECLARE_METATYPE(dde::network::ConnectionRecord)
+
+#endif // CONNECTIONRECORD_H
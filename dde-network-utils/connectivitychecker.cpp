@@ -20,6 +20,7 @@
  */
 
 #include "connectivitychecker.h"
+#include "eventtracer.h"
 
 #include <QEventLoop>
 #include <QNetworkAccessManager>
@@ -59,11 +60,16 @@ ConnectivityChecker::ConnectivityChecker(QObject *parent) : QObject(parent)
 
 void ConnectivityChecker::startCheck()
 {
+    TraceScope trace("connectivity", "startCheck");
     QNetworkAccessManager nam;
     if (m_checkUrls.isEmpty()) {
         m_checkUrls = CheckUrls;
     }
     for (auto url : m_checkUrls) {
+        TraceScope probe("connectivity", "probe");
+        if (EventTracer::isEnabled())
+            probe.setDetail(url.toUtf8());
+
         QScopedPointer<QNetworkReply> reply(nam.head(QNetworkRequest(QUrl(url))));
         qDebug() << "Check connectivity using url:" << url;
 
@@ -89,6 +95,7 @@ void ConnectivityChecker::startCheck()
                     (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 200 &&
                     reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() <= 206)) {
                 qDebug() << "Connected to url:" << url;
+                trace.setDetail("connected");
                 Q_EMIT checkFinished(true);
                 return;
             }
@@ -97,5 +104,6 @@ void ConnectivityChecker::startCheck()
         }
     }
 
+    trace.setDetail("disconnected");
     Q_EMIT checkFinished(false);
 }
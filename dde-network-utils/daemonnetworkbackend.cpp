@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemonnetworkbackend.h"
+
+#include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusServiceWatcher>
+#include <QDBusConnectionInterface>
+
+using namespace dde::network;
+
+const QString networkService = "com.deepin.daemon.Network";
+const QString networkPath = "/com/deepin/daemon/Network";
+
+DaemonNetworkBackend::DaemonNetworkBackend(QObject *parent)
+    : NetworkBackend(parent)
+    , m_networkInter(new NetworkInter(networkService, networkPath, QDBusConnection::sessionBus(), this))
+    , m_chainsInter(new ProxyChains(networkService, "/com/deepin/daemon/Network/ProxyChains", QDBusConnection::sessionBus(), this))
+    , m_payloadEncoding(PayloadCodec::Json)
+{
+    // 网络服务加载很慢时，需监听 服务启动后，刷新网络设备信息
+    auto req = QDBusConnection::sessionBus().interface()->isServiceRegistered(networkService);
+    if (!req.value()) {
+        qInfo() << networkService << "is not registered, waiting for registration";
+        QDBusServiceWatcher *serviceWatcher = new QDBusServiceWatcher(this);
+        serviceWatcher->setConnection(QDBusConnection::sessionBus());
+        serviceWatcher->addWatchedService(networkService);
+        connect(serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, [this] {
+            qInfo() << networkService <<  "is registered";
+            negotiatePayloadEncoding();
+            Q_EMIT serviceRegistered();
+        });
+    } else {
+        negotiatePayloadEncoding();
+    }
+
+    connect(m_networkInter, &NetworkInter::DevicesChanged, this, &DaemonNetworkBackend::devicesChanged);
+    // 协商为 CBOR 后, 服务仍然广播 Json 的变化 (NetworkInter 缓存的属性值因此保持最新),
+    // 同一变化随后还会以 CBOR 单独发给本客户端, 只解析 CBOR 的版本
+    connect(m_networkInter, &NetworkInter::ConnectionsChanged, this, [this](const QString &value) {
+        m_connectionsCbor.clear();
+        if (m_payloadEncoding != PayloadCodec::Cbor)
+            Q_EMIT connectionsChanged(value);
+    });
+    connect(m_networkInter, &NetworkInter::ActiveConnectionsChanged, this, &DaemonNetworkBackend::activeConnectionsChanged);
+    connect(m_networkInter, &NetworkInter::WirelessAccessPointsChanged, this, [this](const QString &value) {
+        m_accessPointsCbor.clear();
+        if (m_payloadEncoding != PayloadCodec::Cbor)
+            Q_EMIT wirelessAccessPointsChanged(value);
+    });
+    connect(m_networkInter, &NetworkInter::DeviceEnabled, this, &DaemonNetworkBackend::deviceEnabled);
+    connect(m_networkInter, &NetworkInter::ConnectivityChanged, this, &DaemonNetworkBackend::connectivityChanged);
+    connect(m_networkInter, &NetworkInter::VpnEnabledChanged, this, &DaemonNetworkBackend::vpnEnabledChanged);
+    connect(m_networkInter, &NetworkInter::NeedSecrets, this, &DaemonNetworkBackend::needSecrets);
+    connect(m_networkInter, &NetworkInter::NeedSecretsFinished, this, &DaemonNetworkBackend::needSecretsFinished);
+
+    connect(m_chainsInter, &ProxyChains::TypeChanged, this, &DaemonNetworkBackend::chainsTypeChanged);
+    connect(m_chainsInter, &ProxyChains::IPChanged, this, &DaemonNetworkBackend::chainsIPChanged);
+    connect(m_chainsInter, &ProxyChains::PortChanged, this, &DaemonNetworkBackend::chainsPortChanged);
+    connect(m_chainsInter, &ProxyChains::UserChanged, this, &DaemonNetworkBackend::chainsUserChanged);
+    connect(m_chainsInter, &ProxyChains::PasswordChanged, this, &DaemonNetworkBackend::chainsPasswordChanged);
+
+    m_networkInter->setSync(false);
+    m_chainsInter->setSync(false);
+}
+
+void DaemonNetworkBackend::onPropertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> args = message.arguments();
+    if (args.size() < 2 || args.at(0).toString() != networkService)
+        return;
+
+    // Json 格式的属性仍由 NetworkInter 处理, 这里只处理单独发给本客户端的 CBOR 编码的属性
+    const QVariantMap changed = qdbus_cast<QVariantMap>(args.at(1));
+    auto it = changed.constFind("ConnectionsCbor");
+    if (it != changed.constEnd()) {
+        m_connectionsCbor = it.value().toByteArray();
+        Q_EMIT connectionsCborChanged(m_connectionsCbor);
+    }
+    it = changed.constFind("WirelessAccessPointsCbor");
+    if (it != changed.constEnd()) {
+        m_accessPointsCbor = it.value().toByteArray();
+        Q_EMIT wirelessAccessPointsCborChanged(m_accessPointsCbor);
+    }
+}
+
+void DaemonNetworkBackend::negotiatePayloadEncoding()
+{
+    if (!PayloadCodec::isCborSupported() || qgetenv("DDE_NETWORK_UTILS_PAYLOAD") == "json")
+        return;
+
+    // QDBusInterface 创建时会同步 introspect, 这里直接发送消息
+    const QDBusMessage msg = QDBusMessage::createMethodCall(networkService, networkPath, networkService, "GetPayloadEncodings");
+    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(msg), this);
+    connect(w, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *w) {
+        w->deleteLater();
+        // 旧版本的服务没有这个方法, 继续使用 Json
+        if (w->isError())
+            return;
+
+        const QStringList encodings = qdbus_cast<QStringList>(w->reply().arguments().value(0));
+        if (!encodings.contains(PayloadCodec::encodingName(PayloadCodec::Cbor)))
+            return;
+
+        // 切换之前先监听, 以免错过切换后立即发出的变化
+        QDBusConnection bus = QDBusConnection::sessionBus();
+        if (m_payloadEncoding != PayloadCodec::Cbor)
+            bus.connect(networkService, networkPath, "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                        this, SLOT(onPropertiesChanged(QDBusMessage)));
+
+        QDBusMessage msg = QDBusMessage::createMethodCall(networkService, networkPath, networkService, "SetPayloadEncoding");
+        msg << PayloadCodec::encodingName(PayloadCodec::Cbor);
+        QDBusPendingCallWatcher *set = new QDBusPendingCallWatcher(bus.asyncCall(msg), this);
+        connect(set, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *set) {
+            set->deleteLater();
+            if (set->isError()) {
+                if (m_payloadEncoding != PayloadCodec::Cbor)
+                    QDBusConnection::sessionBus().disconnect(networkService, networkPath, "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                                                             this, SLOT(onPropertiesChanged(QDBusMessage)));
+                return;
+            }
+
+            m_payloadEncoding = PayloadCodec::Cbor;
+            qInfo() << networkService << "sends large properties as cbor";
+        });
+    });
+}
+
+QString DaemonNetworkBackend::devices() const
+{
+    return m_networkInter->devices();
+}
+
+QString DaemonNetworkBackend::connections() const
+{
+    return m_networkInter->connections();
+}
+
+QString DaemonNetworkBackend::activeConnections() const
+{
+    return m_networkInter->activeConnections();
+}
+
+QString DaemonNetworkBackend::wirelessAccessPoints() const
+{
+    return m_networkInter->wirelessAccessPoints();
+}
+
+bool DaemonNetworkBackend::vpnEnabled() const
+{
+    return m_networkInter->vpnEnabled();
+}
+
+int DaemonNetworkBackend::connectivity() const
+{
+    return static_cast<int>(m_networkInter->connectivity());
+}
+
+void DaemonNetworkBackend::setVpnEnabled(bool enabled)
+{
+    m_networkInter->setVpnEnabled(enabled);
+}
+
+QString DaemonNetworkBackend::fetchDevices()
+{
+    QDBusInterface inter(networkService,
+                         networkPath,
+                         networkService,
+                         QDBusConnection::sessionBus());
+
+    return inter.property("Devices").toString();
+}
+
+QDBusPendingCall DaemonNetworkBackend::activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath)
+{
+    return m_networkInter->ActivateAccessPoint(uuid, QDBusObjectPath(apPath), QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::activateConnection(const QString &uuid, const QString &devPath)
+{
+    return m_networkInter->ActivateConnection(uuid, QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::cancelSecret(const QString &connectionPath, const QString &settingName)
+{
+    return m_networkInter->CancelSecret(connectionPath, settingName);
+}
+
+QDBusPendingCall DaemonNetworkBackend::createConnection(const QString &type, const QString &devPath)
+{
+    return m_networkInter->CreateConnection(type, QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::createConnectionForAccessPoint(const QString &apPath, const QString &devPath)
+{
+    return m_networkInter->CreateConnectionForAccessPoint(QDBusObjectPath(apPath), QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::deactivateConnection(const QString &uuid)
+{
+    return m_networkInter->DeactivateConnection(uuid);
+}
+
+QDBusPendingCall DaemonNetworkBackend::deleteConnection(const QString &uuid)
+{
+    return m_networkInter->DeleteConnection(uuid);
+}
+
+QDBusPendingCall DaemonNetworkBackend::disconnectDevice(const QString &devPath)
+{
+    return m_networkInter->DisconnectDevice(QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::editConnection(const QString &uuid, const QString &devPath)
+{
+    return m_networkInter->EditConnection(uuid, QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::enableDevice(const QString &devPath, bool enabled)
+{
+    return m_networkInter->EnableDevice(QDBusObjectPath(devPath), enabled);
+}
+
+QDBusPendingCall DaemonNetworkBackend::enableWirelessHotspotMode(const QString &devPath)
+{
+    return m_networkInter->EnableWirelessHotspotMode(QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect)
+{
+    return m_networkInter->FeedSecret(connectionPath, settingName, password, autoConnect);
+}
+
+QDBusPendingCall DaemonNetworkBackend::getActiveConnectionInfo()
+{
+    return m_networkInter->GetActiveConnectionInfo();
+}
+
+QDBusPendingCall DaemonNetworkBackend::getAutoProxy()
+{
+    return m_networkInter->GetAutoProxy();
+}
+
+QDBusPendingCall DaemonNetworkBackend::getConnectivity()
+{
+    QDBusMessage msg = QDBusMessage::createMethodCall(networkService, networkPath,
+                                                      QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                      QStringLiteral("Get"));
+    msg << networkService << QStringLiteral("Connectivity");
+
+    return m_networkInter->connection().asyncCall(msg);
+}
+
+QDBusPendingCall DaemonNetworkBackend::getProxy(const QString &type)
+{
+    return m_networkInter->asyncCall(QStringLiteral("GetProxy"), type);
+}
+
+QDBusPendingCall DaemonNetworkBackend::getProxyIgnoreHosts()
+{
+    return m_networkInter->GetProxyIgnoreHosts();
+}
+
+QDBusPendingCall DaemonNetworkBackend::getProxyMethod()
+{
+    return m_networkInter->GetProxyMethod();
+}
+
+QDBusPendingCall DaemonNetworkBackend::isDeviceEnabled(const QString &devPath)
+{
+    return m_networkInter->IsDeviceEnabled(QDBusObjectPath(devPath));
+}
+
+QDBusPendingCall DaemonNetworkBackend::requestWirelessScan()
+{
+    return m_networkInter->RequestWirelessScan();
+}
+
+QDBusPendingCall DaemonNetworkBackend::setAutoProxy(const QString &proxy)
+{
+    return m_networkInter->SetAutoProxy(proxy);
+}
+
+QDBusPendingCall DaemonNetworkBackend::setDeviceManaged(const QString &devPath, bool managed)
+{
+    return m_networkInter->SetDeviceManaged(devPath, managed);
+}
+
+QDBusPendingCall DaemonNetworkBackend::setProxy(const QString &type, const QString &addr, const QString &port)
+{
+    return m_networkInter->SetProxy(type, addr, port);
+}
+
+QDBusPendingCall DaemonNetworkBackend::setProxyIgnoreHosts(const QString &hosts)
+{
+    return m_networkInter->SetProxyIgnoreHosts(hosts);
+}
+
+QDBusPendingCall DaemonNetworkBackend::setProxyMethod(const QString &proxyMethod)
+{
+    return m_networkInter->SetProxyMethod(proxyMethod);
+}
+
+QDBusPendingCall DaemonNetworkBackend::getChainsProperties()
+{
+    QDBusMessage msg = QDBusMessage::createMethodCall(m_chainsInter->service(), m_chainsInter->path(),
+                                                      QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                      QStringLiteral("GetAll"));
+    msg << m_chainsInter->interface();
+
+    return m_chainsInter->connection().asyncCall(msg);
+}
+
+QDBusPendingCall DaemonNetworkBackend::setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password)
+{
+    return m_chainsInter->Set(type, ip, port, user, password);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DAEMONNETWORKBACKEND_H
+#define DAEMONNETWORKBACKEND_H
+
+#include "networkbackend.h"
+#include "payloadcodec.h"
+
+#include <QDBusMessage>
+
+#include <com_deepin_daemon_network.h>
+#include <com_deepin_daemon_network_proxychains.h>
+
+namespace dde {
+
+namespace network {
+
+using NetworkInter = com::deepin::daemon::Network;
+using ProxyChains = com::deepin::daemon::network::ProxyChains;
+
+/**
+ * @brief DaemonNetworkBackend 通过会话总线访问 com.deepin.daemon.Network
+ *
+ * 服务提供 GetPayloadEncodings 且支持 "cbor" 时, 通过 SetPayloadEncoding 切换到 CBOR,
+ * 之后 Connections 和 WirelessAccessPoints 的变化以 ConnectionsCbor 和 WirelessAccessPointsCbor
+ * 属性发出; 不支持的服务 (调用返回 UnknownMethod) 继续使用 Json.
+ * 环境变量 DDE_NETWORK_UTILS_PAYLOAD=json 时不协商.
+ */
+class DaemonNetworkBackend : public NetworkBackend
+{
+    Q_OBJECT
+
+public:
+    explicit DaemonNetworkBackend(QObject *parent = nullptr);
+
+    QString devices() const override;
+    QString connections() const override;
+    QString activeConnections() const override;
+    QString wirelessAccessPoints() const override;
+    bool vpnEnabled() const override;
+    int connectivity() const override;
+    void setVpnEnabled(bool enabled) override;
+    QString fetchDevices() override;
+    QByteArray connectionsCbor() const override { return m_connectionsCbor; }
+    QByteArray wirelessAccessPointsCbor() const override { return m_accessPointsCbor; }
+
+    QDBusPendingCall activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath) override;
+    QDBusPendingCall activateConnection(const QString &uuid, const QString &devPath) override;
+    QDBusPendingCall cancelSecret(const QString &connectionPath, const QString &settingName) override;
+    QDBusPendingCall createConnection(const QString &type, const QString &devPath) override;
+    QDBusPendingCall createConnectionForAccessPoint(const QString &apPath, const QString &devPath) override;
+    QDBusPendingCall deactivateConnection(const QString &uuid) override;
+    QDBusPendingCall deleteConnection(const QString &uuid) override;
+    QDBusPendingCall disconnectDevice(const QString &devPath) override;
+    QDBusPendingCall editConnection(const QString &uuid, const QString &devPath) override;
+    QDBusPendingCall enableDevice(const QString &devPath, bool enabled) override;
+    QDBusPendingCall enableWirelessHotspotMode(const QString &devPath) override;
+    QDBusPendingCall feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect) override;
+    QDBusPendingCall getActiveConnectionInfo() override;
+    QDBusPendingCall getAutoProxy() override;
+    QDBusPendingCall getConnectivity() override;
+    QDBusPendingCall getProxy(const QString &type) override;
+    QDBusPendingCall getProxyIgnoreHosts() override;
+    QDBusPendingCall getProxyMethod() override;
+    QDBusPendingCall isDeviceEnabled(const QString &devPath) override;
+    QDBusPendingCall requestWirelessScan() override;
+    QDBusPendingCall setAutoProxy(const QString &proxy) override;
+    QDBusPendingCall setDeviceManaged(const QString &devPath, bool managed) override;
+    QDBusPendingCall setProxy(const QString &type, const QString &addr, const QString &port) override;
+    QDBusPendingCall setProxyIgnoreHosts(const QString &hosts) override;
+    QDBusPendingCall setProxyMethod(const QString &proxyMethod) override;
+
+    QDBusPendingCall getChainsProperties() override;
+    QDBusPendingCall setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password) override;
+
+    PayloadCodec::Encoding payloadEncoding() const { return m_payloadEncoding; }
+
+private Q_SLOTS:
+    void onPropertiesChanged(const QDBusMessage &message);
+
+private:
+    void negotiatePayloadEncoding();
+
+private:
+    NetworkInter *m_networkInter;
+    ProxyChains *m_chainsInter;
+    PayloadCodec::Encoding m_payloadEncoding;
+    // 最近收到的 CBOR 属性, 比 NetworkInter 缓存的 Json 新; 收到 Json 的变化后清空
+    QByteArray m_connectionsCbor;
+    QByteArray m_accessPointsCbor;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // DAEMONNETWORKBACKEND_H
@@ -13,7 +13,25 @@ SOURCES += \
     $$PWD/networkdevice.cpp \
     $$PWD/wirelessdevice.cpp \
     $$PWD/wireddevice.cpp \
-    $$PWD/connectivitychecker.cpp
+    $$PWD/connectivitychecker.cpp \
+    $$PWD/accesspointinfo.cpp \
+    $$PWD/wirelessscanscheduler.cpp \
+    $$PWD/latencyhistogram.cpp \
+    $$PWD/pendingcallmanager.cpp \
+    $$PWD/proxybypassmatcher.cpp \
+    $$PWD/sharedsnapshot.cpp \
+    $$PWD/payloadparser.cpp \
+    $$PWD/ingestpipeline.cpp \
+    $$PWD/daemonnetworkbackend.cpp \
+    $$PWD/signalrecorder.cpp \
+    $$PWD/networkstats.cpp \
+    $$PWD/eventtracer.cpp \
+    $$PWD/devicestatushistory.cpp \
+    $$PWD/activationtracker.cpp \
+    $$PWD/nmnetworkbackend.cpp \
+    $$PWD/payloadcodec.cpp \
+    $$PWD/connectionrecord.cpp \
+    $$PWD/emitcounter.cpp
 
 HEADERS += \
     $$PWD/networkmodel.h \
@@ -21,9 +39,38 @@ HEADERS += \
     $$PWD/networkdevice.h \
     $$PWD/wirelessdevice.h \
     $$PWD/wireddevice.h \
-    $$PWD/connectivitychecker.h
+    $$PWD/connectivitychecker.h \
+    $$PWD/accesspointinfo.h \
+    $$PWD/wirelessscanscheduler.h \
+    $$PWD/latencyhistogram.h \
+    $$PWD/pendingcallmanager.h \
+    $$PWD/proxybypassmatcher.h \
+    $$PWD/sharedsnapshot.h \
+    $$PWD/payloadparser.h \
+    $$PWD/ingestpipeline.h \
+    $$PWD/networkbackend.h \
+    $$PWD/daemonnetworkbackend.h \
+    $$PWD/signalrecorder.h \
+    $$PWD/networkstats.h \
+    $$PWD/eventtracer.h \
+    $$PWD/devicestatushistory.h \
+    $$PWD/activationtracker.h \
+    $$PWD/nmnetworkbackend.h \
+    $$PWD/payloadcodec.h \
+    $$PWD/connectionrecord.h \
+    $$PWD/emitcounter.h
 
-includes.files += *.h
+# 本地 PAC 解析依赖 QtQml, 没有该模块时不编译
+qtHaveModule(qml) {
+    QT += qml
+    DEFINES += DDENETWORKUTILS_PAC
+    SOURCES += $$PWD/pacproxyresolver.cpp
+    HEADERS += $$PWD/pacproxyresolver.h
+}
+
+includes.files += $$files(*.h)
+# 没有 QtQml 时不编译 PAC 解析器, 也不安装它的头文件
+!qtHaveModule(qml): includes.files -= pacproxyresolver.h
 includes.files += \
     $$PWD/NetworkModel \
     $$PWD/NetworkWorker \
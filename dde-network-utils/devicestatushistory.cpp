@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "devicestatushistory.h"
+
+#include <time.h>
+
+// 与 NetworkDevice::DeviceStatus 的取值相同
+#define STATUS_PREPARE      40
+#define STATUS_SECONDARIES  90
+#define STATUS_ACTIVATED    100
+
+using namespace dde::network;
+
+DeviceStatusHistory::DeviceStatusHistory()
+    : m_next(0)
+    , m_connecting(false)
+    , m_current(0)
+    , m_phaseStart(0)
+    , m_activated(0)
+    , m_failed(0)
+{
+    m_ring.reserve(Capacity);
+}
+
+qint64 DeviceStatusHistory::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool DeviceStatusHistory::isConnectingPhase(int status)
+{
+    return status >= STATUS_PREPARE && status <= STATUS_SECONDARIES;
+}
+
+void DeviceStatusHistory::record(int status, qint64 usec)
+{
+    if (m_ring.size() < Capacity)
+        m_ring.append({ status, usec });
+    else
+        m_ring[m_next] = { status, usec };
+    m_next = (m_next + 1) % Capacity;
+
+    if (m_connecting && isConnectingPhase(m_current))
+        m_attempt.phaseUsec[m_current] += usec - m_phaseStart;
+
+    if (isConnectingPhase(status)) {
+        if (!m_connecting) {
+            m_connecting = true;
+            m_attempt = ConnectAttempt();
+            m_attempt.startUsec = usec;
+        }
+    } else if (m_connecting) {
+        finishAttempt(status, usec);
+    }
+
+    m_current = status;
+    m_phaseStart = usec;
+}
+
+void DeviceStatusHistory::clear()
+{
+    *this = DeviceStatusHistory();
+}
+
+const QList<DeviceStatusHistory::Transition> DeviceStatusHistory::transitions() const
+{
+    QList<Transition> list;
+    if (m_ring.size() < Capacity) {
+        list = m_ring.toList();
+        return list;
+    }
+
+    for (int i = 0; i < Capacity; ++i)
+        list << m_ring.at((m_next + i) % Capacity);
+
+    return list;
+}
+
+void DeviceStatusHistory::finishAttempt(int status, qint64 usec)
+{
+    m_connecting = false;
+    m_attempt.endUsec = usec;
+    m_attempt.result = status;
+
+    // 失败的连接也统计各阶段耗时, 认证或获取地址超时往往以失败结束
+    for (auto it(m_attempt.phaseUsec.constBegin()); it != m_attempt.phaseUsec.constEnd(); ++it)
+        m_phases[it.key()].record(it.value());
+
+    if (status == STATUS_ACTIVATED) {
+        ++m_activated;
+        m_timeToConnect.record(m_attempt.totalUsec());
+    } else {
+        ++m_failed;
+    }
+
+    m_lastAttempt = m_attempt;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DEVICESTATUSHISTORY_H
+#define DEVICESTATUSHISTORY_H
+
+#include "latencyhistogram.h"
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QVector>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief DeviceStatusHistory 设备状态变化的历史和连接耗时统计
+ *
+ * 状态取值与 NetworkDevice::DeviceStatus 相同. 最近的 Capacity 次变化保存在环形缓冲区中, 时间戳为单调时钟的微秒数.
+ * 从非连接中的状态进入 Prepare ~ Secondaries 视为开始一次连接, 到达 Activated 为成功, 进入其他状态为失败.
+ * 每次连接结束后, 各阶段的耗时计入对应阶段的直方图, 成功的连接总耗时计入 timeToConnect().
+ */
+class DeviceStatusHistory
+{
+public:
+    enum {
+        Capacity = 64
+    };
+
+    struct Transition
+    {
+        int status;
+        qint64 usec;
+    };
+
+    struct ConnectAttempt
+    {
+        ConnectAttempt() : startUsec(0), endUsec(0), result(0) {}
+
+        qint64 totalUsec() const { return endUsec - startUsec; }
+
+        qint64 startUsec;
+        qint64 endUsec;
+        // 结束时的状态, Activated 表示成功
+        int result;
+        // 各阶段的累计耗时, 同一阶段可能进入多次
+        QMap<int, qint64> phaseUsec;
+    };
+
+    DeviceStatusHistory();
+
+    static qint64 now();
+    static bool isConnectingPhase(int status);
+
+    void record(int status, qint64 usec);
+    void clear();
+
+    // 按时间先后排列
+    const QList<Transition> transitions() const;
+    bool isConnecting() const { return m_connecting; }
+    const ConnectAttempt lastAttempt() const { return m_lastAttempt; }
+
+    quint64 activatedCount() const { return m_activated; }
+    quint64 failedCount() const { return m_failed; }
+    const LatencyHistogram timeToConnect() const { return m_timeToConnect; }
+    const LatencyHistogram phaseHistogram(int status) const { return m_phases.value(status); }
+
+private:
+    void finishAttempt(int status, qint64 usec);
+
+private:
+    QVector<Transition> m_ring;
+    int m_next;
+
+    bool m_connecting;
+    int m_current;
+    qint64 m_phaseStart;
+    ConnectAttempt m_attempt;
+    ConnectAttempt m_lastAttempt;
+
+    quint64 m_activated;
+    quint64 m_failed;
+    LatencyHistogram m_timeToConnect;
+    QHash<int, LatencyHistogram> m_phases;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // DEVICESTATUSHISTORY_H
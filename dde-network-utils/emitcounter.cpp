@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "emitcounter.h"
+
+#include <QMetaMethod>
+
+using namespace dde::network;
+
+EmitCounter::EmitCounter(QObject *source)
+    : QObject(source)
+    , m_source(source)
+    , m_enabled(false)
+    , m_count(0)
+{
+}
+
+void EmitCounter::watch(const QMetaObject *metaObject)
+{
+    m_metaObjects << metaObject;
+
+    if (m_enabled)
+        connectSignals(metaObject);
+}
+
+void EmitCounter::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    if (!enabled) {
+        disconnect(m_source, nullptr, this, nullptr);
+        return;
+    }
+
+    for (const QMetaObject *metaObject : m_metaObjects)
+        connectSignals(metaObject);
+}
+
+void EmitCounter::connectSignals(const QMetaObject *metaObject)
+{
+    const QMetaMethod slot = staticMetaObject.method(staticMetaObject.indexOfSlot("onSignal()"));
+
+    // 只连接 metaObject 自己声明的信号, 父类的信号由父类负责;
+    // 带默认参数的信号生成的克隆与原信号共用一个信号索引, 跳过以免重复计数
+    for (int i = metaObject->methodOffset(); i < metaObject->methodCount(); ++i) {
+        const QMetaMethod method = metaObject->method(i);
+        if (method.methodType() == QMetaMethod::Signal && !(method.attributes() & QMetaMethod::Cloned))
+            connect(m_source, method, this, slot, Qt::DirectConnection);
+    }
+}
+
+void EmitCounter::onSignal()
+{
+    ++m_count;
+}
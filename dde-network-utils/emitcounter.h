@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMITCOUNTER_H
+#define EMITCOUNTER_H
+
+#include <QObject>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief EmitCounter 统计一个对象实际发出的信号数
+ *
+ * 启用时把对象的信号直接连接到计数槽上, 所有发出的信号都经过这一处, 不需要在每个 emit 旁边手动计数.
+ * 被 blockSignals 屏蔽的信号不计入, 与 QSignalSpy 看到的一致.
+ * 默认不启用, 此时不建立任何连接, 发出信号没有额外开销, isSignalConnected() 也不受影响.
+ *
+ * 构造基类时 metaObject() 还不是子类的, 因此每一层类在自己的构造函数中
+ * 调用 watch(&staticMetaObject), 只统计该类自己声明的信号.
+ * 计数不是原子的, 信号只能在对象所在的线程中发出.
+ */
+class EmitCounter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EmitCounter(QObject *source);
+
+    void watch(const QMetaObject *metaObject);
+    quint64 count() const { return m_count; }
+
+    bool isEnabled() const { return m_enabled; }
+    // 关闭后断开所有连接, 已有的计数保留
+    void setEnabled(bool enabled);
+
+private Q_SLOTS:
+    void onSignal();
+
+private:
+    void connectSignals(const QMetaObject *metaObject);
+
+private:
+    QObject *m_source;
+    QList<const QMetaObject *> m_metaObjects;
+    bool m_enabled;
+    quint64 m_count;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // EMITCOUNTER_H
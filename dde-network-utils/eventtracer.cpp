@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "eventtracer.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+
+// 缓冲区按块分配, 只有实际用到的块才占用内存
+#define CHUNK_SIZE 4096
+#define CHUNK_COUNT (EventTracer::TraceBufferCapacity / CHUNK_SIZE)
+
+using namespace dde::network;
+
+namespace {
+
+struct TraceEvent
+{
+    char phase;
+    const char *category;
+    QByteArray name;
+    QByteArray detail;
+    qint64 ts;
+    qint64 dur;
+    quint64 id;
+};
+
+// 只由所属线程追加; count 以 release 语义发布, 读取方只访问 count 之前的事件
+struct ThreadBuffer
+{
+    ThreadBuffer(int tid, const QByteArray &threadName)
+        : tid(tid)
+        , threadName(threadName)
+        , base(0)
+    {
+        for (int i = 0; i < CHUNK_COUNT; ++i)
+            chunks[i] = nullptr;
+    }
+
+    const int tid;
+    const QByteArray threadName;
+    QAtomicInt count;
+    QAtomicInt dropped;
+    // 已写入文件的事件数, 由 registry 的锁保护; start() 时与 count 一起清零
+    int base;
+    TraceEvent *chunks[CHUNK_COUNT];
+};
+
+struct TraceRegistry
+{
+    TraceRegistry() : nextTid(0), postRoutineAdded(false) {}
+
+    QMutex mutex;
+    // 线程退出后缓冲区仍然保留, 其中的事件还需要写入文件
+    QList<ThreadBuffer *> buffers;
+    QString fileName;
+    int nextTid;
+    bool postRoutineAdded;
+};
+
+}
+
+Q_GLOBAL_STATIC(TraceRegistry, registry)
+
+static thread_local ThreadBuffer *t_buffer = nullptr;
+
+QAtomicInt EventTracer::s_enabled;
+
+static QElapsedTimer startedTimer()
+{
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
+}
+
+static ThreadBuffer *threadBuffer()
+{
+    if (t_buffer)
+        return t_buffer;
+
+    TraceRegistry *reg = registry();
+    QMutexLocker locker(&reg->mutex);
+
+    const int tid = ++reg->nextTid;
+    QThread *thread = QThread::currentThread();
+    QByteArray name = thread->objectName().toUtf8();
+    if (name.isEmpty())
+        name = QCoreApplication::instance() && QCoreApplication::instance()->thread() == thread
+                ? QByteArray("main") : QByteArray("thread-") + QByteArray::number(tid);
+
+    t_buffer = new ThreadBuffer(tid, name);
+    reg->buffers << t_buffer;
+
+    return t_buffer;
+}
+
+static QJsonObject toJson(const TraceEvent &event, int pid, int tid)
+{
+    QJsonObject obj;
+    obj.insert("name", QString::fromUtf8(event.name));
+    obj.insert("cat", QString::fromLatin1(event.category));
+    obj.insert("ph", QString(QLatin1Char(event.phase)));
+    obj.insert("ts", event.ts / 1000.0);
+    obj.insert("pid", pid);
+    obj.insert("tid", tid);
+
+    switch (event.phase) {
+    case 'X':
+        obj.insert("dur", event.dur / 1000.0);
+        break;
+    case 'i':
+        obj.insert("s", QString("t"));
+        break;
+    case 'b':
+    case 'e':
+        obj.insert("id", QString("0x") + QString::number(event.id, 16));
+        break;
+    default:
+        break;
+    }
+
+    if (!event.detail.isEmpty())
+        obj.insert("args", QJsonObject { { "detail", QString::fromUtf8(event.detail) } });
+
+    return obj;
+}
+
+static QJsonObject metadata(const char *name, int pid, int tid, const QString &value)
+{
+    QJsonObject obj;
+    obj.insert("name", QString::fromLatin1(name));
+    obj.insert("ph", QString("M"));
+    obj.insert("pid", pid);
+    obj.insert("tid", tid);
+    obj.insert("args", QJsonObject { { "name", value } });
+    return obj;
+}
+
+static void flushAtExit()
+{
+    if (EventTracer::isEnabled())
+        EventTracer::stop();
+}
+
+bool EventTracer::start(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return false;
+
+    // 先初始化时间起点, 避免第一个事件的时间戳早于起点
+    now();
+
+    TraceRegistry *reg = registry();
+    QMutexLocker locker(&reg->mutex);
+
+    // 开启之前清空缓冲区, 每次记录都有完整的容量; 已分配的块留给之后的记录复用.
+    // 未开启时各线程不会追加, 可以在这里直接修改 count
+    s_enabled.store(0);
+    for (ThreadBuffer *buffer : reg->buffers) {
+        buffer->count.storeRelease(0);
+        buffer->dropped.store(0);
+        buffer->base = 0;
+    }
+    reg->fileName = fileName;
+
+    if (!reg->postRoutineAdded && QCoreApplication::instance()) {
+        qAddPostRoutine(flushAtExit);
+        reg->postRoutineAdded = true;
+    }
+
+    s_enabled.store(1);
+    return true;
+}
+
+bool EventTracer::stop()
+{
+    if (!s_enabled.testAndSetOrdered(1, 0))
+        return false;
+
+    TraceRegistry *reg = registry();
+    QMutexLocker locker(&reg->mutex);
+
+    QFile file(reg->fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to write trace file" << reg->fileName << ":" << file.errorString();
+        return false;
+    }
+
+    const int pid = static_cast<int>(QCoreApplication::applicationPid());
+    const QString process = QCoreApplication::applicationName();
+    int dropped = 0;
+
+    file.write("{\"traceEvents\":[\n");
+    file.write(QJsonDocument(metadata("process_name", pid, 0, process.isEmpty() ? QString("dde-network-utils") : process))
+               .toJson(QJsonDocument::Compact));
+
+    for (ThreadBuffer *buffer : reg->buffers) {
+        file.write(",\n");
+        file.write(QJsonDocument(metadata("thread_name", pid, buffer->tid, QString::fromUtf8(buffer->threadName)))
+                   .toJson(QJsonDocument::Compact));
+
+        const int count = buffer->count.loadAcquire();
+        for (int i = buffer->base; i < count; ++i) {
+            const TraceEvent &event = buffer->chunks[i / CHUNK_SIZE][i % CHUNK_SIZE];
+            file.write(",\n");
+            file.write(QJsonDocument(toJson(event, pid, buffer->tid)).toJson(QJsonDocument::Compact));
+        }
+
+        dropped += buffer->dropped.fetchAndStoreRelaxed(0);
+        buffer->base = count;
+    }
+
+    file.write(QString("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%1}}\n").arg(dropped).toUtf8());
+    file.close();
+
+    return true;
+}
+
+void EventTracer::startFromEnvironment()
+{
+    if (isEnabled())
+        return;
+
+    const QString file = QString::fromLocal8Bit(qgetenv("DDE_NETWORK_UTILS_TRACE"));
+    if (!file.isEmpty())
+        start(file);
+}
+
+QString EventTracer::fileName()
+{
+    TraceRegistry *reg = registry();
+    QMutexLocker locker(&reg->mutex);
+
+    return reg->fileName;
+}
+
+quint64 EventTracer::eventCount()
+{
+    TraceRegistry *reg = registry();
+    QMutexLocker locker(&reg->mutex);
+
+    quint64 count = 0;
+    for (ThreadBuffer *buffer : reg->buffers)
+        count += buffer->count.loadAcquire() - buffer->base;
+
+    return count;
+}
+
+quint64 EventTracer::droppedCount()
+{
+    TraceRegistry *reg = registry();
+    QMutexLocker locker(&reg->mutex);
+
+    quint64 count = 0;
+    for (ThreadBuffer *buffer : reg->buffers)
+        count += buffer->dropped.load();
+
+    return count;
+}
+
+qint64 EventTracer::now()
+{
+    static const QElapsedTimer timer = startedTimer();
+
+    return timer.nsecsElapsed();
+}
+
+void EventTracer::complete(const char *category, const QByteArray &name, qint64 startNsec, qint64 durNsec,
+                           const QByteArray &detail)
+{
+    if (isEnabled())
+        append('X', category, name, startNsec, durNsec, 0, detail);
+}
+
+void EventTracer::begin(const char *category, const QByteArray &name, const QByteArray &detail)
+{
+    if (isEnabled())
+        append('B', category, name, now(), 0, 0, detail);
+}
+
+void EventTracer::end(const char *category, const QByteArray &name, const QByteArray &detail)
+{
+    if (isEnabled())
+        append('E', category, name, now(), 0, 0, detail);
+}
+
+void EventTracer::instant(const char *category, const QByteArray &name, const QByteArray &detail)
+{
+    if (isEnabled())
+        append('i', category, name, now(), 0, 0, detail);
+}
+
+void EventTracer::asyncBegin(const char *category, const QByteArray &name, quint64 id, const QByteArray &detail)
+{
+    if (isEnabled())
+        append('b', category, name, now(), 0, id, detail);
+}
+
+void EventTracer::asyncEnd(const char *category, const QByteArray &name, quint64 id, const QByteArray &detail)
+{
+    if (isEnabled())
+        append('e', category, name, now(), 0, id, detail);
+}
+
+void EventTracer::append(char phase, const char *category, const QByteArray &name, qint64 ts, qint64 dur,
+                         quint64 id, const QByteArray &detail)
+{
+    ThreadBuffer *buffer = threadBuffer();
+
+    const int index = buffer->count.load();
+    if (index >= TraceBufferCapacity) {
+        buffer->dropped.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    TraceEvent *&chunk = buffer->chunks[index / CHUNK_SIZE];
+    if (!chunk)
+        chunk = new TraceEvent[CHUNK_SIZE];
+
+    TraceEvent &event = chunk[index % CHUNK_SIZE];
+    event.phase = phase;
+    event.category = category;
+    event.name = name;
+    event.detail = detail;
+    event.ts = ts;
+    event.dur = dur;
+    event.id = id;
+
+    buffer->count.storeRelease(index + 1);
+}
+
+TraceScope::TraceScope(const char *category, const char *name)
+    : m_category(category)
+    , m_name(name)
+    , m_start(EventTracer::isEnabled() ? EventTracer::now() : -1)
+{
+}
+
+TraceScope::~TraceScope()
+{
+    if (m_start < 0 || !EventTracer::isEnabled())
+        return;
+
+    EventTracer::complete(m_category, QByteArray(m_name), m_start, EventTracer::now() - m_start, m_detail);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EVENTTRACER_H
+#define EVENTTRACER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief EventTracer 记录 Chrome trace-event 格式的时间线, 可直接在 chrome://tracing 或 Perfetto 中打开
+ *
+ * 设置环境变量 DDE_NETWORK_UTILS_TRACE=<文件> 后由 NetworkWorker 开始记录, 程序退出时写入文件;
+ * 也可以调用 start()/stop() 手动控制.
+ * 每个线程第一次记录时分配自己的缓冲区, 之后的记录只由本线程追加, 不加锁.
+ * 每次记录中每个线程最多记录 TraceBufferCapacity 个事件, 超出的事件被丢弃并计数.
+ * 未开启时各处记录只有一次原子读取的开销; 参数需要构造时, 调用方应先检查 isEnabled().
+ */
+class EventTracer
+{
+public:
+    enum {
+        TraceBufferCapacity = 1 << 20
+    };
+
+    static bool isEnabled() { return s_enabled.load() != 0; }
+
+    // 开始记录, 之前记录的事件不再写入文件
+    static bool start(const QString &fileName);
+    // 停止记录并写入文件
+    static bool stop();
+    static void startFromEnvironment();
+    static QString fileName();
+
+    static quint64 eventCount();
+    static quint64 droppedCount();
+
+    // 时间单位为纳秒, 起点为进程中第一次调用的时刻
+    static qint64 now();
+
+    // 同一线程中的一段耗时
+    static void complete(const char *category, const QByteArray &name, qint64 startNsec, qint64 durNsec,
+                         const QByteArray &detail = QByteArray());
+    static void begin(const char *category, const QByteArray &name, const QByteArray &detail = QByteArray());
+    static void end(const char *category, const QByteArray &name, const QByteArray &detail = QByteArray());
+    static void instant(const char *category, const QByteArray &name, const QByteArray &detail = QByteArray());
+    // 可以跨越多次事件循环的异步操作, 以 id 配对
+    static void asyncBegin(const char *category, const QByteArray &name, quint64 id,
+                           const QByteArray &detail = QByteArray());
+    static void asyncEnd(const char *category, const QByteArray &name, quint64 id,
+                         const QByteArray &detail = QByteArray());
+
+private:
+    static void append(char phase, const char *category, const QByteArray &name, qint64 ts, qint64 dur,
+                       quint64 id, const QByteArray &detail);
+
+private:
+    static QAtomicInt s_enabled;
+};
+
+/**
+ * @brief TraceScope 在析构时把作用域的耗时记录为一个事件
+ *
+ * name 必须是字符串常量; 未开启记录时不做任何分配.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name);
+    ~TraceScope();
+
+    void setDetail(const QByteArray &detail) { m_detail = detail; }
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start;
+    QByteArray m_detail;
+
+    Q_DISABLE_COPY(TraceScope)
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // EVENTTRACER_H
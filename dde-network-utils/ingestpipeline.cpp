@@ -0,0 +1,442 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ingestpipeline.h"
+#include "networkmodel.h"
+#include "payloadparser.h"
+#include "networkstats.h"
+#include "eventtracer.h"
+#include "payloadcodec.h"
+
+#include <QThread>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+using namespace dde::network;
+
+static int statsEntryPoint(int kind)
+{
+    switch (kind) {
+    case IngestPipeline::Devices:           return NetworkStats::DevicesChanged;
+    case IngestPipeline::Connections:       return NetworkStats::ConnectionListChanged;
+    case IngestPipeline::ActiveConnections: return NetworkStats::ActiveConnectionsChanged;
+    case IngestPipeline::AccessPoints:      return NetworkStats::WirelessAccessPointsChanged;
+    case IngestPipeline::ActiveConnInfo:    return NetworkStats::ActiveConnInfoChanged;
+    default:                                return -1;
+    }
+}
+
+IngestParser::IngestParser(const IngestPipeline *pipeline, NetworkStatsCollector *stats, QObject *parent)
+    : QObject(parent)
+    , m_pipeline(pipeline)
+    , m_stats(stats)
+{
+}
+
+QVariant IngestParser::parse(int kind, const QString &payload)
+{
+    switch (kind) {
+    case IngestPipeline::Devices:
+        return QVariant::fromValue(PayloadParser::parseDevices(payload));
+    case IngestPipeline::Connections:
+        return QVariant::fromValue(PayloadParser::parseConnections(payload));
+    case IngestPipeline::ActiveConnections:
+        return QVariant::fromValue(PayloadParser::parseActiveConnections(payload));
+    case IngestPipeline::AccessPoints:
+        return QVariant::fromValue(PayloadParser::parseAccessPoints(payload));
+    case IngestPipeline::ActiveConnInfo:
+        return QVariant::fromValue(PayloadParser::parseActiveConnInfo(payload));
+    default:
+        return QVariant();
+    }
+}
+
+QVariant IngestParser::parse(int kind, const QJsonObject &payload)
+{
+    switch (kind) {
+    case IngestPipeline::Devices:
+        return QVariant::fromValue(PayloadParser::parseDevices(payload));
+    case IngestPipeline::Connections:
+        return QVariant::fromValue(PayloadParser::parseConnections(payload));
+    case IngestPipeline::ActiveConnections:
+        return QVariant::fromValue(PayloadParser::parseActiveConnections(payload));
+    case IngestPipeline::AccessPoints:
+        return QVariant::fromValue(PayloadParser::parseAccessPoints(payload));
+    default:
+        return QVariant();
+    }
+}
+
+QVariant IngestParser::parseCbor(int kind, const QByteArray &payload)
+{
+    return parse(kind, PayloadCodec::decode(payload, PayloadCodec::Cbor));
+}
+
+void IngestParser::process(int kind, quint64 seq, const QString &payload)
+{
+    // 已经有更新的同类数据排在后面, 不必再解析
+    if (m_pipeline->isSuperseded(kind, seq)) {
+        Q_EMIT dropped(kind, seq);
+        return;
+    }
+
+    TraceScope trace("ingest", "parse");
+    if (EventTracer::isEnabled())
+        trace.setDetail(NetworkStats::entryPointName(statsEntryPoint(kind)).toUtf8());
+
+    if (!m_stats->isEnabled()) {
+        Q_EMIT parsed(kind, seq, parse(kind, payload));
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVariant result = parse(kind, payload);
+    m_stats->recordParse(statsEntryPoint(kind), payload.size(), timer.nsecsElapsed());
+
+    Q_EMIT parsed(kind, seq, result);
+}
+
+void IngestParser::processCbor(int kind, quint64 seq, const QByteArray &payload)
+{
+    if (m_pipeline->isSuperseded(kind, seq)) {
+        Q_EMIT dropped(kind, seq);
+        return;
+    }
+
+    TraceScope trace("ingest", "parseCbor");
+    if (EventTracer::isEnabled())
+        trace.setDetail(NetworkStats::entryPointName(statsEntryPoint(kind)).toUtf8());
+
+    if (!m_stats->isEnabled()) {
+        Q_EMIT parsed(kind, seq, parseCbor(kind, payload));
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVariant result = parseCbor(kind, payload);
+    m_stats->recordParse(statsEntryPoint(kind), payload.size(), timer.nsecsElapsed());
+
+    Q_EMIT parsed(kind, seq, result);
+}
+
+void IngestParser::processObject(int kind, quint64 seq, const QJsonObject &payload)
+{
+    if (m_pipeline->isSuperseded(kind, seq)) {
+        Q_EMIT dropped(kind, seq);
+        return;
+    }
+
+    TraceScope trace("ingest", "parseObject");
+    if (EventTracer::isEnabled())
+        trace.setDetail(NetworkStats::entryPointName(statsEntryPoint(kind)).toUtf8());
+
+    if (!m_stats->isEnabled()) {
+        Q_EMIT parsed(kind, seq, parse(kind, payload));
+        return;
+    }
+
+    // 没有序列化的数据, 字节数记为 0
+    QElapsedTimer timer;
+    timer.start();
+    const QVariant result = parse(kind, payload);
+    m_stats->recordParse(statsEntryPoint(kind), 0, timer.nsecsElapsed());
+
+    Q_EMIT parsed(kind, seq, result);
+}
+
+IngestPipeline::IngestPipeline(NetworkModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_parser(new IngestParser(this, &model->m_stats))
+    , m_thread(new QThread(this))
+    , m_enabled(true)
+    , m_sequence(0)
+    , m_lastKind(KindCount)
+    , m_nextApply(1)
+    , m_submitted(0)
+    , m_applied(0)
+    , m_dropped(0)
+    , m_pending(0)
+{
+    for (int i = 0; i < KindCount; ++i) {
+        m_latest[i] = 0;
+        m_runStart[i] = 0;
+    }
+
+    connect(this, &IngestPipeline::requestParse, m_parser, &IngestParser::process);
+    connect(this, &IngestPipeline::requestParseCbor, m_parser, &IngestParser::processCbor);
+    connect(this, &IngestPipeline::requestParseObject, m_parser, &IngestParser::processObject);
+    // 结果由解析线程直接放入 m_results, 不经过事件队列, waitFor() 才能在 model 所在线程中等待
+    connect(m_parser, &IngestParser::parsed, this, &IngestPipeline::onParsed, Qt::DirectConnection);
+    connect(m_parser, &IngestParser::dropped, this, &IngestPipeline::onDropped, Qt::DirectConnection);
+    connect(m_thread, &QThread::finished, m_parser, &IngestParser::deleteLater);
+
+    m_thread->setObjectName("IngestParser");
+    m_parser->moveToThread(m_thread);
+    m_thread->start();
+}
+
+IngestPipeline::~IngestPipeline()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void IngestPipeline::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+void IngestPipeline::apply(PayloadKind kind, const QString &payload)
+{
+    // 与 submit 一样排队, 之前提交的数据先应用, 不会在之后覆盖这一份
+    waitFor(submit(kind, payload));
+}
+
+void IngestPipeline::applyCbor(PayloadKind kind, const QByteArray &payload)
+{
+    waitFor(submitCbor(kind, payload));
+}
+
+void IngestPipeline::submitParsed(PayloadKind kind, const QVariant &parsed)
+{
+    const quint64 seq = enqueue(kind);
+    deliver(seq, Result { kind, false, parsed });
+    waitFor(seq);
+}
+
+bool IngestPipeline::isSuperseded(int kind, quint64 seq) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return seq < m_latest[kind] && seq >= m_runStart[kind];
+}
+
+void IngestPipeline::submitDevices(const QString &devices)
+{
+    submit(Devices, devices);
+}
+
+void IngestPipeline::submitConnections(const QString &conns)
+{
+    submit(Connections, conns);
+}
+
+void IngestPipeline::submitActiveConnections(const QString &conns)
+{
+    submit(ActiveConnections, conns);
+}
+
+void IngestPipeline::submitAccessPoints(const QString &wirelessList)
+{
+    submit(AccessPoints, wirelessList);
+}
+
+void IngestPipeline::submitActiveConnInfo(const QString &activeConnInfo)
+{
+    submit(ActiveConnInfo, activeConnInfo);
+}
+
+void IngestPipeline::submitConnectionsCbor(const QByteArray &conns)
+{
+    submitCbor(Connections, conns);
+}
+
+void IngestPipeline::submitAccessPointsCbor(const QByteArray &wirelessList)
+{
+    submitCbor(AccessPoints, wirelessList);
+}
+
+void IngestPipeline::submitDevicesObject(const QJsonObject &devices)
+{
+    submitObject(Devices, devices);
+}
+
+void IngestPipeline::submitConnectionsObject(const QJsonObject &conns)
+{
+    submitObject(Connections, conns);
+}
+
+void IngestPipeline::submitActiveConnectionsObject(const QJsonObject &conns)
+{
+    submitObject(ActiveConnections, conns);
+}
+
+void IngestPipeline::submitAccessPointsObject(const QJsonObject &wirelessData)
+{
+    submitObject(AccessPoints, wirelessData);
+}
+
+void IngestPipeline::onParsed(int kind, quint64 seq, const QVariant &payload)
+{
+    deliver(seq, Result { kind, false, payload });
+}
+
+void IngestPipeline::onDropped(int kind, quint64 seq)
+{
+    deliver(seq, Result { kind, true, QVariant() });
+}
+
+void IngestPipeline::applyReady()
+{
+    while (true) {
+        QMutexLocker locker(&m_mutex);
+
+        auto it = m_results.find(m_nextApply);
+        if (it == m_results.end())
+            return;
+
+        const quint64 seq = it.key();
+        const Result result = it.value();
+        m_results.erase(it);
+        ++m_nextApply;
+        locker.unlock();
+
+        --m_pending;
+        // 解析期间又提交了更新的同类数据
+        if (result.dropped || isSuperseded(result.kind, seq)) {
+            ++m_dropped;
+            continue;
+        }
+
+        // 解析已在 IngestParser 中统计
+        NetworkStatsScope stats(&m_model->m_stats, statsEntryPoint(result.kind), 0);
+        applyParsed(result.kind, result.payload);
+    }
+}
+
+quint64 IngestPipeline::submit(PayloadKind kind, const QString &payload)
+{
+    const quint64 seq = enqueue(kind);
+
+    if (m_enabled) {
+        Q_EMIT requestParse(kind, seq, payload);
+    } else {
+        // 关闭时在当前线程中解析, 结果仍按序号应用
+        m_parser->process(kind, seq, payload);
+        applyReady();
+    }
+
+    return seq;
+}
+
+quint64 IngestPipeline::submitCbor(PayloadKind kind, const QByteArray &payload)
+{
+    const quint64 seq = enqueue(kind);
+
+    if (m_enabled) {
+        Q_EMIT requestParseCbor(kind, seq, payload);
+    } else {
+        m_parser->processCbor(kind, seq, payload);
+        applyReady();
+    }
+
+    return seq;
+}
+
+quint64 IngestPipeline::submitObject(PayloadKind kind, const QJsonObject &payload)
+{
+    const quint64 seq = enqueue(kind);
+
+    if (m_enabled) {
+        Q_EMIT requestParseObject(kind, seq, payload);
+    } else {
+        m_parser->processObject(kind, seq, payload);
+        applyReady();
+    }
+
+    return seq;
+}
+
+quint64 IngestPipeline::enqueue(PayloadKind kind)
+{
+    ++m_submitted;
+    ++m_pending;
+
+    QMutexLocker locker(&m_mutex);
+
+    const quint64 seq = ++m_sequence;
+    if (m_lastKind != kind)
+        m_runStart[kind] = seq;
+    m_latest[kind] = seq;
+    m_lastKind = kind;
+
+    return seq;
+}
+
+void IngestPipeline::deliver(quint64 seq, const Result &result)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_results.insert(seq, result);
+        m_resultReady.wakeAll();
+    }
+
+    // 在解析线程中调用时交回 model 所在线程; 在 model 所在线程中调用时由调用者随后应用
+    if (QThread::currentThread() != thread())
+        QMetaObject::invokeMethod(this, "applyReady", Qt::QueuedConnection);
+}
+
+void IngestPipeline::waitFor(quint64 seq)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // 解析线程按提交的顺序处理, 序号不大于 seq 的结果都到齐后才能按序应用到 seq
+        while (true) {
+            bool ready = true;
+            for (quint64 s = m_nextApply; s <= seq && ready; ++s)
+                ready = m_results.contains(s);
+            if (ready)
+                break;
+            m_resultReady.wait(&m_mutex);
+        }
+    }
+
+    applyReady();
+}
+
+void IngestPipeline::applyParsed(int kind, const QVariant &payload)
+{
+    TraceScope trace("ingest", "apply");
+    if (EventTracer::isEnabled())
+        trace.setDetail(NetworkStats::entryPointName(statsEntryPoint(kind)).toUtf8());
+
+    ++m_applied;
+
+    switch (kind) {
+    case Devices:
+        m_model->applyDevices(payload.value<DevicesPayload>());
+        break;
+    case Connections:
+        m_model->applyConnections(payload.value<ConnectionsPayload>());
+        break;
+    case ActiveConnections:
+        m_model->applyActiveConnections(payload.value<ActiveConnectionsPayload>());
+        break;
+    case AccessPoints:
+        m_model->applyAccessPoints(payload.value<AccessPointsPayload>());
+        break;
+    case ActiveConnInfo:
+        m_model->applyActiveConnInfo(payload.value<ActiveConnInfoPayload>());
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QVariant>
+#include <QWaitCondition>
+#include <QJsonObject>
+
+class QThread;
+
+namespace dde {
+
+namespace network {
+
+class NetworkModel;
+class IngestPipeline;
+class NetworkStatsCollector;
+
+/**
+ * @brief IngestParser 在独立线程中解析后端数据, 由 IngestPipeline 内部使用
+ */
+class IngestParser : public QObject
+{
+    Q_OBJECT
+
+public:
+    IngestParser(const IngestPipeline *pipeline, NetworkStatsCollector *stats, QObject *parent = nullptr);
+
+    static QVariant parse(int kind, const QString &payload);
+    static QVariant parse(int kind, const QJsonObject &payload);
+    static QVariant parseCbor(int kind, const QByteArray &payload);
+
+Q_SIGNALS:
+    void parsed(int kind, quint64 seq, const QVariant &payload) const;
+    void dropped(int kind, quint64 seq) const;
+
+public Q_SLOTS:
+    void process(int kind, quint64 seq, const QString &payload);
+    void processCbor(int kind, quint64 seq, const QByteArray &payload);
+    void processObject(int kind, quint64 seq, const QJsonObject &payload);
+
+private:
+    const IngestPipeline *m_pipeline;
+    NetworkStatsCollector *m_stats;
+};
+
+/**
+ * @brief IngestPipeline 在后台线程解析后端数据, 再交回 model 所在线程应用
+ *
+ * 所有数据按提交的顺序依次应用. 同一类数据连续提交多次时, 队列中尚未解析的旧数据会被直接丢弃,
+ * 只解析和应用最新的一份; 中间夹着其他类型的数据时不丢弃, 以免打乱不同类型之间的先后关系.
+ * 解析线程只保存结果, 由 model 所在线程按序号依次取出应用.
+ * apply() 和 submitParsed() 同样经过队列, 等到之前提交的数据和它自己都应用或丢弃后才返回.
+ */
+class IngestPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum PayloadKind {
+        Devices,
+        Connections,
+        ActiveConnections,
+        AccessPoints,
+        ActiveConnInfo,
+        KindCount
+    };
+
+    explicit IngestPipeline(NetworkModel *model, QObject *parent = nullptr);
+    ~IngestPipeline();
+
+    // 关闭后 submit 系列接口退化为同步解析和应用, 默认开启
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    void apply(PayloadKind kind, const QString &payload);
+    // CBOR 编码的数据, 在解析线程中解码后直接解析 Json 对象
+    void applyCbor(PayloadKind kind, const QByteArray &payload);
+    // 应用后端已经解析好的数据 (DevicesPayload 等), 不经过解析线程, 但仍按序号排队
+    void submitParsed(PayloadKind kind, const QVariant &parsed);
+
+    // 队列中的数据是否已被之后提交的同类数据取代, 可以在任意线程中调用
+    bool isSuperseded(int kind, quint64 seq) const;
+
+    quint64 submittedCount() const { return m_submitted; }
+    quint64 appliedCount() const { return m_applied; }
+    quint64 droppedCount() const { return m_dropped; }
+    // 已提交但尚未应用或丢弃的数据个数
+    int pendingCount() const { return m_pending; }
+
+Q_SIGNALS:
+    void requestParse(int kind, quint64 seq, const QString &payload) const;
+    void requestParseCbor(int kind, quint64 seq, const QByteArray &payload) const;
+    void requestParseObject(int kind, quint64 seq, const QJsonObject &payload) const;
+
+public Q_SLOTS:
+    void submitDevices(const QString &devices);
+    void submitConnections(const QString &conns);
+    void submitActiveConnections(const QString &conns);
+    void submitAccessPoints(const QString &wirelessList);
+    // GetActiveConnectionInfo 的返回值
+    void submitActiveConnInfo(const QString &activeConnInfo);
+    // 与服务协商后以 CBOR 编码发送的数据
+    void submitConnectionsCbor(const QByteArray &conns);
+    void submitAccessPointsCbor(const QByteArray &wirelessList);
+    // 后端直接提供的 Json 对象
+    void submitDevicesObject(const QJsonObject &devices);
+    void submitConnectionsObject(const QJsonObject &conns);
+    void submitActiveConnectionsObject(const QJsonObject &conns);
+    void submitAccessPointsObject(const QJsonObject &wirelessData);
+
+private Q_SLOTS:
+    // 由解析线程直接调用
+    void onParsed(int kind, quint64 seq, const QVariant &payload);
+    void onDropped(int kind, quint64 seq);
+    void applyReady();
+
+private:
+    struct Result
+    {
+        int kind;
+        bool dropped;
+        QVariant payload;
+    };
+
+    quint64 submit(PayloadKind kind, const QString &payload);
+    quint64 submitCbor(PayloadKind kind, const QByteArray &payload);
+    quint64 submitObject(PayloadKind kind, const QJsonObject &payload);
+    quint64 enqueue(PayloadKind kind);
+    void deliver(quint64 seq, const Result &result);
+    void waitFor(quint64 seq);
+    void applyParsed(int kind, const QVariant &payload);
+
+private:
+    NetworkModel *m_model;
+    IngestParser *m_parser;
+    QThread *m_thread;
+    bool m_enabled;
+
+    // 以下各项也由解析线程读取, 需要加锁
+    mutable QMutex m_mutex;
+    quint64 m_sequence;
+    int m_lastKind;
+    // 每种数据最后一次提交的序号, 以及它所在的连续同类提交的起始序号
+    quint64 m_latest[KindCount];
+    quint64 m_runStart[KindCount];
+    // 已解析或丢弃, 等待按序号应用的数据, 以及下一个应用的序号
+    QMap<quint64, Result> m_results;
+    quint64 m_nextApply;
+    QWaitCondition m_resultReady;
+
+    quint64 m_submitted;
+    quint64 m_applied;
+    quint64 m_dropped;
+    int m_pending;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // INGESTPIPELINE_H
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latencyhistogram.h"
+
+using namespace dde::network;
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(BucketCount, 0)
+    , m_count(0)
+    , m_min(0)
+    , m_max(0)
+    , m_total(0)
+{
+}
+
+void LatencyHistogram::record(qint64 usec)
+{
+    usec = qMax<qint64>(usec, 0);
+
+    qint64 msec = usec / 1000;
+    int bucket = 0;
+    while (msec > 0 && bucket < BucketCount - 1) {
+        msec >>= 1;
+        ++bucket;
+    }
+    ++m_buckets[bucket];
+
+    m_min = m_count ? qMin(m_min, usec) : usec;
+    m_max = qMax(m_max, usec);
+    m_total += usec;
+    ++m_count;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (!other.m_count)
+        return;
+
+    for (int i = 0; i < BucketCount; ++i)
+        m_buckets[i] += other.m_buckets.at(i);
+
+    m_min = m_count ? qMin(m_min, other.m_min) : other.m_min;
+    m_max = qMax(m_max, other.m_max);
+    m_total += other.m_total;
+    m_count += other.m_count;
+}
+
+void LatencyHistogram::clear()
+{
+    *this = LatencyHistogram();
+}
+
+qint64 LatencyHistogram::percentileMsec(double percentile) const
+{
+    if (!m_count)
+        return 0;
+
+    const quint64 target = qMax<quint64>(1, static_cast<quint64>(m_count * qBound(0.0, percentile, 100.0) / 100.0 + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets.at(i);
+        if (seen >= target) {
+            const qint64 upper = bucketUpperBoundMsec(i);
+            return upper < 0 ? m_max / 1000 + 1 : qMin(upper, m_max / 1000 + 1);
+        }
+    }
+
+    return m_max / 1000 + 1;
+}
+
+qint64 LatencyHistogram::bucketUpperBoundMsec(int bucket)
+{
+    if (bucket >= BucketCount - 1)
+        return -1;
+
+    return qint64(1) << bucket;
+}
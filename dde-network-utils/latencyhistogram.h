@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QVector>
+#include <QtGlobal>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief LatencyHistogram 以 2 的幂次划分区间的耗时直方图
+ *
+ * 第 0 个区间为 [0, 1ms), 第 i 个区间为 [2^(i-1)ms, 2^i ms), 最后一个区间不设上限.
+ * 记录一次耗时的开销为常数, 占用空间固定.
+ */
+class LatencyHistogram
+{
+public:
+    enum {
+        BucketCount = 18
+    };
+
+    LatencyHistogram();
+
+    void record(qint64 usec);
+    void merge(const LatencyHistogram &other);
+    void clear();
+
+    quint64 count() const { return m_count; }
+    qint64 minUsec() const { return m_count ? m_min : 0; }
+    qint64 maxUsec() const { return m_max; }
+    qint64 totalUsec() const { return m_total; }
+    qint64 meanUsec() const { return m_count ? m_total / static_cast<qint64>(m_count) : 0; }
+    // 返回百分位 (0 ~ 100) 所在区间的上限, 单位毫秒
+    qint64 percentileMsec(double percentile) const;
+
+    const QVector<quint64> buckets() const { return m_buckets; }
+    static qint64 bucketUpperBoundMsec(int bucket);
+
+private:
+    QVector<quint64> m_buckets;
+    quint64 m_count;
+    qint64 m_min;
+    qint64 m_max;
+    qint64 m_total;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // LATENCYHISTOGRAM_H
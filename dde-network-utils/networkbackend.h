@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKBACKEND_H
+#define NETWORKBACKEND_H
+
+#include <QObject>
+#include <QDBusPendingCall>
+#include <QJsonObject>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief NetworkBackend NetworkWorker 与网络服务之间的接口
+ *
+ * 属性读取返回本地缓存的值, 方法调用都是异步的, 返回的 QDBusPendingCall 交给 PendingCallManager 管理.
+ * 返回值按 DBus 方法的输出参数依次放在 reply().arguments() 中.
+ * 默认实现是 DaemonNetworkBackend, 测试中可以替换为不依赖 DBus 的实现.
+ */
+class NetworkBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkBackend(QObject *parent = nullptr) : QObject(parent) {}
+
+    // 属性
+    virtual QString devices() const = 0;
+    virtual QString connections() const = 0;
+    virtual QString activeConnections() const = 0;
+    virtual QString wirelessAccessPoints() const = 0;
+    virtual bool vpnEnabled() const = 0;
+    virtual int connectivity() const = 0;
+    virtual void setVpnEnabled(bool enabled) = 0;
+
+    // 不经过缓存, 直接从服务读取设备列表
+    virtual QString fetchDevices() { return devices(); }
+    // 协商为 CBOR 后最近收到的 Connections 和 WirelessAccessPoints, 没有时为空;
+    // 不为空时由调用者直接解码, 不必先转换为 Json 字符串
+    virtual QByteArray connectionsCbor() const { return QByteArray(); }
+    virtual QByteArray wirelessAccessPointsCbor() const { return QByteArray(); }
+
+    // 方法
+    virtual QDBusPendingCall activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath) = 0;
+    virtual QDBusPendingCall activateConnection(const QString &uuid, const QString &devPath) = 0;
+    virtual QDBusPendingCall cancelSecret(const QString &connectionPath, const QString &settingName) = 0;
+    virtual QDBusPendingCall createConnection(const QString &type, const QString &devPath) = 0;
+    virtual QDBusPendingCall createConnectionForAccessPoint(const QString &apPath, const QString &devPath) = 0;
+    virtual QDBusPendingCall deactivateConnection(const QString &uuid) = 0;
+    virtual QDBusPendingCall deleteConnection(const QString &uuid) = 0;
+    virtual QDBusPendingCall disconnectDevice(const QString &devPath) = 0;
+    virtual QDBusPendingCall editConnection(const QString &uuid, const QString &devPath) = 0;
+    virtual QDBusPendingCall enableDevice(const QString &devPath, bool enabled) = 0;
+    virtual QDBusPendingCall enableWirelessHotspotMode(const QString &devPath) = 0;
+    virtual QDBusPendingCall feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect) = 0;
+    virtual QDBusPendingCall getActiveConnectionInfo() = 0;
+    virtual QDBusPendingCall getAutoProxy() = 0;
+    virtual QDBusPendingCall getConnectivity() = 0;
+    virtual QDBusPendingCall getProxy(const QString &type) = 0;
+    virtual QDBusPendingCall getProxyIgnoreHosts() = 0;
+    virtual QDBusPendingCall getProxyMethod() = 0;
+    virtual QDBusPendingCall isDeviceEnabled(const QString &devPath) = 0;
+    virtual QDBusPendingCall requestWirelessScan() = 0;
+    virtual QDBusPendingCall setAutoProxy(const QString &proxy) = 0;
+    virtual QDBusPendingCall setDeviceManaged(const QString &devPath, bool managed) = 0;
+    virtual QDBusPendingCall setProxy(const QString &type, const QString &addr, const QString &port) = 0;
+    virtual QDBusPendingCall setProxyIgnoreHosts(const QString &hosts) = 0;
+    virtual QDBusPendingCall setProxyMethod(const QString &proxyMethod) = 0;
+
+    // ProxyChains
+    virtual QDBusPendingCall getChainsProperties() = 0;
+    virtual QDBusPendingCall setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password) = 0;
+
+Q_SIGNALS:
+    // 服务启动较晚时, 注册到总线后发出
+    void serviceRegistered() const;
+
+    void devicesChanged(const QString &devices) const;
+    void connectionsChanged(const QString &connections) const;
+    void activeConnectionsChanged(const QString &activeConnections) const;
+    void wirelessAccessPointsChanged(const QString &accessPoints) const;
+    // 后端自己维护结构化数据时, 直接发出 Json 对象代替上面的 Json 字符串, 省去序列化和反序列化;
+    // 与字符串一样在解析线程中解析
+    void devicesObjectChanged(const QJsonObject &devices) const;
+    void connectionsObjectChanged(const QJsonObject &connections) const;
+    void activeConnectionsObjectChanged(const QJsonObject &activeConnections) const;
+    void wirelessAccessPointsObjectChanged(const QJsonObject &accessPoints) const;
+    // 与服务协商使用 CBOR 后, 代替 connectionsChanged 和 wirelessAccessPointsChanged 发出;
+    // 最新的值由 connectionsCbor() 和 wirelessAccessPointsCbor() 返回
+    void connectionsCborChanged(const QByteArray &connections) const;
+    void wirelessAccessPointsCborChanged(const QByteArray &accessPoints) const;
+    void deviceEnabled(const QString &devPath, bool enabled) const;
+    void connectivityChanged(int connectivity) const;
+    void vpnEnabledChanged(bool enabled) const;
+    void needSecrets(const QString &info) const;
+    void needSecretsFinished(const QString &info0, const QString &info1) const;
+
+    void chainsTypeChanged(const QString &type) const;
+    void chainsIPChanged(const QString &ip) const;
+    void chainsPortChanged(uint port) const;
+    void chainsUserChanged(const QString &user) const;
+    void chainsPasswordChanged(const QString &password) const;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // NETWORKBACKEND_H
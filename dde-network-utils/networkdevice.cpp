@@ -25,6 +25,7 @@
 
 #include "networkdevice.h"
 #include "networkmodel.h"
+#include "eventtracer.h"
 
 #include <QDebug>
 #include <QJsonArray>
@@ -35,18 +36,95 @@
 
 using namespace dde::network;
 
+namespace {
+
+// 64 位 FNV-1a, 直接在解析后的 Json 结构上计算, 不需要重新序列化
+const quint64 FnvOffsetBasis = 14695981039346656037ULL;
+const quint64 FnvPrime = 1099511628211ULL;
+
+inline void hashBytes(quint64 &hash, const void *data, int size)
+{
+    const uchar *bytes = static_cast<const uchar *>(data);
+    for (int i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FnvPrime;
+    }
+}
+
+inline void hashString(quint64 &hash, const QString &str)
+{
+    const int size = str.size();
+    hashBytes(hash, &size, sizeof(size));
+    hashBytes(hash, str.constData(), size * static_cast<int>(sizeof(QChar)));
+}
+
+void hashValue(quint64 &hash, const QJsonValue &value)
+{
+    const uchar type = static_cast<uchar>(value.type());
+    hashBytes(hash, &type, sizeof(type));
+
+    switch (value.type()) {
+    case QJsonValue::Bool: {
+        const uchar b = value.toBool();
+        hashBytes(hash, &b, sizeof(b));
+        break;
+    }
+    case QJsonValue::Double: {
+        const double d = value.toDouble();
+        hashBytes(hash, &d, sizeof(d));
+        break;
+    }
+    case QJsonValue::String:
+        hashString(hash, value.toString());
+        break;
+    // 混入元素个数, 避免嵌套的容器与展开后的元素序列得到相同的哈希
+    case QJsonValue::Array: {
+        const QJsonArray &array = value.toArray();
+        const int size = array.size();
+        hashBytes(hash, &size, sizeof(size));
+        for (const QJsonValue &v : array)
+            hashValue(hash, v);
+        break;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject &object = value.toObject();
+        const int size = object.size();
+        hashBytes(hash, &size, sizeof(size));
+        for (auto it(object.constBegin()); it != object.constEnd(); ++it) {
+            hashString(hash, it.key());
+            hashValue(hash, it.value());
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+}
+
 NetworkDevice::NetworkDevice(const DeviceType type, const QJsonObject &info, QObject *parent)
     : QObject(parent),
 
       m_type(type),
       m_status(Unknown),
       m_deviceInfo(info),
-      m_enabled(true)
+      m_enabled(true),
+      m_emitCounter(new EmitCounter(this)),
+      m_revision(0),
+      m_suppressedSignals(0)
 {
+    countSignalsOf(&staticMetaObject);
+
     updateDeviceInfo(info);
 }
 
 void NetworkDevice::setDeviceStatus(const int status)
+{
+    setDeviceStatusAt(status, DeviceStatusHistory::now());
+}
+
+void NetworkDevice::setDeviceStatusAt(const int status, qint64 usec)
 {
     DeviceStatus stat = Unknown;
 
@@ -68,9 +146,15 @@ void NetworkDevice::setDeviceStatus(const int status)
 
     if (m_status != stat)
     {
+        if (EventTracer::isEnabled())
+            EventTracer::instant("device", "statusChanged",
+                                 QString("%1: %2 -> %3").arg(path()).arg(m_status).arg(stat).toUtf8());
+
         m_status = stat;
 
         enqueueStatus(m_status);
+        m_statusHistory.record(m_status, usec);
+        markStateChanged();
 
         Q_EMIT statusChanged(m_status);
         Q_EMIT statusChanged(statusString());
@@ -179,6 +263,7 @@ void NetworkDevice::setEnabled(const bool enabled)
     if (m_enabled != enabled) {
         m_enabled = enabled;
         m_statusQueue.clear();
+        markStateChanged();
         Q_EMIT enableChanged(m_enabled);
     }
 }
@@ -206,8 +291,65 @@ const QString NetworkDevice::interfaceName() const
     return m_deviceInfo.value("Interface").toString();
 }
 
+quint64 NetworkDevice::contentHash(const QList<QJsonObject> &list)
+{
+    quint64 hash = FnvOffsetBasis;
+    const int size = list.size();
+    hashBytes(hash, &size, sizeof(size));
+
+    for (const QJsonObject &object : list)
+        hashValue(hash, object);
+
+    return hash;
+}
+
+quint64 NetworkDevice::contentHash(const QList<ConnectionRecord> &list)
+{
+    quint64 hash = FnvOffsetBasis;
+    const int size = list.size();
+    hashBytes(hash, &size, sizeof(size));
+
+    for (const ConnectionRecord &record : list) {
+        const quint64 recordHash = record.hash();
+        hashBytes(hash, &recordHash, sizeof(recordHash));
+    }
+
+    return hash;
+}
+
+bool NetworkDevice::contentChanged(quint64 &storedHash, const QList<QJsonObject> &stored, const QList<QJsonObject> &list)
+{
+    return contentChanged(storedHash, stored, list, contentHash(list));
+}
+
+bool NetworkDevice::contentChanged(quint64 &storedHash, const QList<QJsonObject> &stored, const QList<QJsonObject> &list, quint64 hash)
+{
+    // 哈希不同时内容一定不同; 哈希相同时再逐项比较, 排除碰撞
+    return updateContentHash(storedHash, hash, hash == storedHash && list == stored);
+}
+
+bool NetworkDevice::contentChanged(quint64 &storedHash, const QList<ConnectionRecord> &stored, const QList<ConnectionRecord> &list)
+{
+    const quint64 hash = contentHash(list);
+
+    return updateContentHash(storedHash, hash, hash == storedHash && list == stored);
+}
+
+bool NetworkDevice::updateContentHash(quint64 &storedHash, quint64 hash, bool unchanged)
+{
+    if (unchanged)
+        return false;
+
+    storedHash = hash;
+    markStateChanged();
+    return true;
+}
+
 void NetworkDevice::updateDeviceInfo(const QJsonObject &devInfo)
 {
+    if (m_deviceInfo != devInfo)
+        markStateChanged();
+
     m_deviceInfo = devInfo;
 
     setDeviceStatus(m_deviceInfo.value("State").toInt());
@@ -26,6 +26,10 @@
 #ifndef NETWORKDEVICE_H
 #define NETWORKDEVICE_H
 
+#include "devicestatushistory.h"
+#include "connectionrecord.h"
+#include "emitcounter.h"
+
 #include <QObject>
 #include <QJsonObject>
 #include <QSet>
@@ -74,6 +78,8 @@ public:
     DeviceType type() const { return m_type; }
     DeviceStatus status() const { return m_status; }
     QQueue<DeviceStatus> statusQueue() const { return m_statusQueue; }
+    // 带时间戳的状态变化历史, 以及各阶段和连接总耗时的直方图
+    const DeviceStatusHistory &statusHistory() const { return m_statusHistory; }
     const QString statusString() const;
     const QString statusStringDetail() const;
     const QJsonObject info() const { return m_deviceInfo; }
@@ -82,6 +88,15 @@ public:
     const QString usingHwAdr() const;
     const QString interfaceName() const;
 
+    // 开启统计期间设备实际发出的信号数, 以及列表类 setter 因内容未变化而被抑制的信号数
+    quint64 emittedSignalCount() const { return m_emitCounter->count(); }
+    quint64 suppressedSignalCount() const { return m_suppressedSignals; }
+
+    // 列表内容的哈希, 用于判断 setter 收到的列表是否变化; 不访问设备, 可以在解析线程中预先计算
+    static quint64 contentHash(const QList<QJsonObject> &list);
+    // 只组合每条记录创建时算好的哈希
+    static quint64 contentHash(const QList<ConnectionRecord> &list);
+
 Q_SIGNALS:
     void removed() const;
     void statusChanged(DeviceStatus stat) const;
@@ -97,17 +112,42 @@ private Q_SLOTS:
 protected:
     explicit NetworkDevice(const DeviceType type, const QJsonObject &info, QObject *parent = nullptr);
 
+    // 比较 list 与当前保存的 stored 及其哈希 storedHash, 有变化时更新 storedHash 并返回 true;
+    // 哈希相同时还会用 == 确认内容相同
+    bool contentChanged(quint64 &storedHash, const QList<QJsonObject> &stored, const QList<QJsonObject> &list);
+    // hash 为 contentHash(list), 已由解析线程算好
+    bool contentChanged(quint64 &storedHash, const QList<QJsonObject> &stored, const QList<QJsonObject> &list, quint64 hash);
+    bool contentChanged(quint64 &storedHash, const QList<ConnectionRecord> &stored, const QList<ConnectionRecord> &list);
+    // setter 因内容未变化而返回时, 记录本来会发出的信号数
+    void countSuppressedSignals(int signalCount) { m_suppressedSignals += signalCount; }
+    // 子类在构造函数中传入自己的 staticMetaObject, 其声明的信号才会计入 emittedSignalCount
+    void countSignalsOf(const QMetaObject *metaObject) { m_emitCounter->watch(metaObject); }
+    // 由 NetworkModel::setStatsEnabled 控制, 关闭时不连接任何计数槽
+    void setEmitCountingEnabled(bool enabled) { m_emitCounter->setEnabled(enabled); }
+    // 设备状态发生变化时调用, model 据此找出事务中变化的设备
+    void markStateChanged() { ++m_revision; }
+    quint64 revision() const { return m_revision; }
+
 private Q_SLOTS:
     void setDeviceStatus(const int status);
+
+private:
+    bool updateContentHash(quint64 &storedHash, quint64 hash, bool unchanged);
+    void setDeviceStatusAt(const int status, qint64 usec);
     void enqueueStatus(DeviceStatus status);
 
 private:
     const DeviceType m_type;
     DeviceStatus m_status;
     QQueue<DeviceStatus> m_statusQueue;
+    DeviceStatusHistory m_statusHistory;
     QJsonObject m_deviceInfo;
 
     bool m_enabled;
+
+    EmitCounter *m_emitCounter;
+    quint64 m_revision;
+    quint64 m_suppressedSignals;
 };
 
 }   // namespace network
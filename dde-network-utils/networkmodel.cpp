@@ -27,43 +27,56 @@
 #include "networkdevice.h"
 #include "wirelessdevice.h"
 #include "wireddevice.h"
+#include "eventtracer.h"
 
 #include <QDebug>
+#include <QSet>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 
 using namespace dde::network;
 
-#define CONNECTED  2
+QAtomicInt NetworkModel::m_Connectivity(Connectivity::Full);
 
-Connectivity NetworkModel::m_Connectivity(Connectivity::Full);
-QStringList NetworkModel::m_deviceInterface;
-
-NetworkDevice::DeviceType parseDeviceType(const QString &type)
+// 在作用域内开启一个事务, 保证每个出口都会调用 endUpdate
+class UpdateScope
 {
-    if (type == "wireless") {
-        return NetworkDevice::Wireless;
-    }
-    if (type == "wired") {
-        return NetworkDevice::Wired;
-    }
+public:
+    explicit UpdateScope(NetworkModel *model) : m_model(model) { m_model->beginUpdate(); }
+    ~UpdateScope() { m_model->endUpdate(); }
 
-    return NetworkDevice::None;
-}
+private:
+    NetworkModel *m_model;
+};
 
 NetworkModel::NetworkModel(QObject *parent)
     : QObject(parent)
     , m_lastSecretDevice(nullptr)
     , m_connectivityChecker(new ConnectivityChecker)
     , m_connectivityCheckThread(new QThread(this))
+    , m_vpnEnabled(false)
+    , m_appProxyExist(false)
+    , m_updateDepth(0)
+    , m_emitCounter(new EmitCounter(this))
+    , m_removedDeviceSignals(0)
 {
+    m_emitCounter->watch(&staticMetaObject);
+    m_stats.setSignalCounter([this] { return emittedSignalCount(); });
+
+    qRegisterMetaType<ChangeSet>();
+    qRegisterMetaType<ConnectionSnapshot>();
+    qRegisterMetaType<DeviceSnapshot>();
+
     connect(this, &NetworkModel::needCheckConnectivitySecondary,
             m_connectivityChecker, &ConnectivityChecker::startCheck);
     connect(m_connectivityChecker, &ConnectivityChecker::checkFinished,
             this, &NetworkModel::onConnectivitySecondaryCheckFinished);
 
+    m_connectivityCheckThread->setObjectName("ConnectivityChecker");
     m_connectivityChecker->moveToThread(m_connectivityCheckThread);
+
+    publishSnapshot(ChangeSet());
 }
 
 NetworkModel::~NetworkModel()
@@ -74,28 +87,196 @@ NetworkModel::~NetworkModel()
     m_connectivityCheckThread->wait();
 }
 
+void NetworkModel::setStatsEnabled(bool enabled)
+{
+    m_stats.setEnabled(enabled);
+
+    m_emitCounter->setEnabled(enabled);
+    for (NetworkDevice *dev : m_devices)
+        dev->setEmitCountingEnabled(enabled);
+}
+
+quint64 NetworkModel::emittedSignalCount() const
+{
+    quint64 count = m_emitCounter->count() + m_removedDeviceSignals;
+    for (const NetworkDevice *dev : m_devices)
+        count += dev->emittedSignalCount();
+
+    return count;
+}
+
+void NetworkModel::beginUpdate()
+{
+    if (m_updateDepth++ > 0)
+        return;
+
+    if (EventTracer::isEnabled())
+        EventTracer::begin("model", "update");
+
+    m_deviceRevisions.clear();
+    for (const NetworkDevice *dev : m_devices)
+        m_deviceRevisions.insert(dev->path(), dev->revision());
+}
+
+void NetworkModel::endUpdate()
+{
+    Q_ASSERT(m_updateDepth > 0);
+    if (m_updateDepth <= 0 || --m_updateDepth > 0)
+        return;
+
+    for (const NetworkDevice *dev : m_devices) {
+        auto it = m_deviceRevisions.find(dev->path());
+        if (it == m_deviceRevisions.end()) {
+            m_changes.devices << dev->path();
+            continue;
+        }
+
+        if (it.value() != dev->revision()) {
+            m_changes.entities |= ChangeSet::DeviceStateChanged;
+            m_changes.devices << dev->path();
+        }
+        m_deviceRevisions.erase(it);
+    }
+    // 剩下的是事务中被移除的设备
+    m_changes.devices << m_deviceRevisions.keys();
+    m_deviceRevisions.clear();
+
+    if (m_changes.isEmpty()) {
+        if (EventTracer::isEnabled())
+            EventTracer::end("model", "update");
+        return;
+    }
+
+    const ChangeSet changes = m_changes;
+    m_changes = ChangeSet();
+
+    // 先发布快照, 响应 modelChanged 的其他线程可以直接读取到最新数据
+    publishSnapshot(changes);
+
+    Q_EMIT modelChanged(changes);
+
+    if (EventTracer::isEnabled())
+        EventTracer::end("model", "update", "entities=0x" + QByteArray::number(changes.entities, 16));
+}
+
+void NetworkModel::publishSnapshot(const ChangeSet &changes)
+{
+    std::shared_ptr<NetworkModelSnapshot> snapshot = std::make_shared<NetworkModelSnapshot>();
+
+    const std::shared_ptr<const NetworkModelSnapshot> current = std::atomic_load(&m_snapshot);
+    snapshot->version = current ? current->version + 1 : 1;
+    snapshot->connectivity = connectivity();
+    snapshot->deviceInterface = m_deviceInterface;
+    if (!current || changes.contains(ChangeSet::DevicesChanged) || changes.contains(ChangeSet::DeviceStateChanged)) {
+        snapshot->devices = current ? deviceStates(current->devices, changes.devices) : deviceStates();
+        // 设备的状态变化不会经过 onDevicesChanged, 在这里一并更新设备列表快照
+        m_devicesSnapshot.update(snapshot->devices);
+    } else {
+        // 设备没有变化时直接共享上一份快照中的列表
+        snapshot->devices = current->devices;
+    }
+
+    snapshot->vpns = m_vpns;
+    snapshot->wireds = m_wireds;
+    snapshot->wireless = m_wireless;
+    snapshot->pppoes = m_pppoes;
+    snapshot->hotspots = m_hotspots;
+    snapshot->activeConns = m_activeConnsSnapshot;
+    snapshot->activeConnInfos = m_activeConnInfosSnapshot;
+
+    snapshot->vpnEnabled = m_vpnEnabled;
+    snapshot->appProxyExist = m_appProxyExist;
+    snapshot->proxyMethod = m_proxyMethod;
+    snapshot->autoProxy = m_autoProxy;
+    snapshot->ignoreHosts = m_proxyIgnoreHosts;
+    snapshot->proxies = m_proxies;
+    snapshot->chainsProxy = m_chainsProxy;
+    snapshot->proxyBypassMatcher = m_proxyBypassMatcher;
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const NetworkModelSnapshot>(snapshot));
+}
+
+QList<DeviceState> NetworkModel::deviceStates() const
+{
+    QList<DeviceState> states;
+    states.reserve(m_devices.size());
+    for (const NetworkDevice *dev : m_devices)
+        states << deviceState(dev);
+
+    return states;
+}
+
+QList<DeviceState> NetworkModel::deviceStates(const QList<DeviceState> &previous, const QStringList &changedDevices) const
+{
+    // 未变化的设备沿用上一份快照中的状态, 只为变化(包括新增)的设备重新读取
+    QSet<QString> changed;
+    for (const QString &path : changedDevices)
+        changed.insert(path);
+
+    QHash<QString, const DeviceState *> unchanged;
+    for (const DeviceState &state : previous) {
+        if (!changed.contains(state.path))
+            unchanged.insert(state.path, &state);
+    }
+
+    QList<DeviceState> states;
+    states.reserve(m_devices.size());
+    for (const NetworkDevice *dev : m_devices) {
+        const DeviceState *state = unchanged.value(dev->path());
+        states << (state ? *state : deviceState(dev));
+    }
+
+    return states;
+}
+
+DeviceState NetworkModel::deviceState(const NetworkDevice *dev)
+{
+    DeviceState state;
+    state.path = dev->path();
+    state.type = dev->type();
+    state.status = dev->status();
+    state.enabled = dev->enabled();
+    state.interfaceName = dev->interfaceName();
+    state.hwAddress = dev->usingHwAdr();
+    state.info = dev->info();
+
+    return state;
+}
+
+void NetworkModel::markChanged(int entities)
+{
+    beginUpdate();
+    m_changes.entities |= entities;
+    endUpdate();
+}
+
 const QString NetworkModel::connectionUuidByPath(const QString &connPath) const
 {
-    return connectionByPath(connPath).value("Uuid").toString();
+    return connectionRecordByPath(connPath).uuid();
 }
 
 const QString NetworkModel::connectionNameByPath(const QString &connPath) const
 {
-    return connectionByPath(connPath).value("Id").toString();
+    return connectionRecordByPath(connPath).id();
 }
 
 const QJsonObject NetworkModel::connectionByPath(const QString &connPath) const
+{
+    return connectionRecordByPath(connPath).object();
+}
+
+const ConnectionRecord NetworkModel::connectionRecordByPath(const QString &connPath) const
 {
     for (const auto &list : m_connections)
     {
         for (const auto &cfg : list)
         {
-            if (cfg.value("Path").toString() == connPath)
+            if (cfg.path() == connPath)
                 return cfg;
         }
     }
 
-    return QJsonObject();
+    return ConnectionRecord();
 }
 
 const QJsonObject NetworkModel::activeConnObjectByUuid(const QString &uuid) const
@@ -111,12 +292,13 @@ const QJsonObject NetworkModel::activeConnObjectByUuid(const QString &uuid) cons
 
 const QString NetworkModel::connectionUuidByApInfo(const QJsonObject &apInfo) const
 {
+    const QString &ssid = apInfo.value("Ssid").toString();
     for (const auto &list : m_connections)
     {
         for (const auto &cfg : list)
         {
-            if (cfg.value("Ssid").toString() == apInfo.value("Ssid").toString())
-                return cfg.value("Uuid").toString();
+            if (cfg.ssid() == ssid)
+                return cfg.uuid();
         }
     }
 
@@ -143,8 +325,8 @@ const QJsonObject NetworkModel::connectionByUuid(const QString &uuid) const
     {
         for (const auto &cfg : list)
         {
-            if (cfg.value("Uuid").toString() == uuid)
-                return cfg;
+            if (cfg.uuid() == uuid)
+                return cfg.object();
         }
     }
 
@@ -172,6 +354,7 @@ void NetworkModel::onVPNEnabledChanged(const bool enabled)
         m_vpnEnabled = enabled;
 
         Q_EMIT vpnEnabledChanged(m_vpnEnabled);
+        markChanged(ChangeSet::VpnChanged);
     }
 }
 
@@ -186,6 +369,7 @@ void NetworkModel::onProxiesChanged(const QString &type, const QString &url, con
         m_proxies[type] = config;
 
         Q_EMIT proxyChanged(type, config);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -196,6 +380,7 @@ void NetworkModel::onAutoProxyChanged(const QString &proxy)
         m_autoProxy = proxy;
 
         Q_EMIT autoProxyChanged(m_autoProxy);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -206,6 +391,7 @@ void NetworkModel::onProxyMethodChanged(const QString &proxyMethod)
         m_proxyMethod = proxyMethod;
 
         Q_EMIT proxyMethodChanged(m_proxyMethod);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -214,78 +400,141 @@ void NetworkModel::onProxyIgnoreHostsChanged(const QString &hosts)
     if (hosts != m_proxyIgnoreHosts)
     {
         m_proxyIgnoreHosts = hosts;
+        m_proxyBypassMatcher = ProxyBypassMatcher(m_proxyIgnoreHosts);
 
         Q_EMIT proxyIgnoreHostsChanged(m_proxyIgnoreHosts);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
-void NetworkModel::onDevicesChanged(const QString &devices)
+void NetworkModel::onProxySettingsChanged(const ProxySettings &settings)
 {
-    const QJsonObject data = QJsonDocument::fromJson(devices.toUtf8()).object();
+    // 先更新所有字段再发出信号, 响应任何一个信号时读取到的都是完整的新配置
+    QStringList changedProxies;
+    for (auto it(settings.proxies.constBegin()); it != settings.proxies.constEnd(); ++it) {
+        const ProxyConfig &old = m_proxies.value(it.key());
+        if (old.url == it.value().url && old.port == it.value().port)
+            continue;
 
-    QSet<QString> devSet;
+        m_proxies[it.key()] = { it.value().port, it.key(), it.value().url, "", "" };
+        changedProxies << it.key();
+    }
 
-    bool changed = false;
+    const bool autoProxyUpdated = (settings.fields & ProxySettings::AutoProxy) && m_autoProxy != settings.autoProxy;
+    if (autoProxyUpdated)
+        m_autoProxy = settings.autoProxy;
 
-    m_deviceInterface.clear();
+    const bool methodUpdated = (settings.fields & ProxySettings::Method) && m_proxyMethod != settings.method;
+    if (methodUpdated)
+        m_proxyMethod = settings.method;
 
-    for (auto it(data.constBegin()); it != data.constEnd(); ++it) {
-        const auto type = parseDeviceType(it.key());
-        const auto list = it.value().toArray();
+    const bool ignoreHostsUpdated = (settings.fields & ProxySettings::IgnoreHosts) && m_proxyIgnoreHosts != settings.ignoreHosts;
+    if (ignoreHostsUpdated) {
+        m_proxyIgnoreHosts = settings.ignoreHosts;
+        m_proxyBypassMatcher = ProxyBypassMatcher(m_proxyIgnoreHosts);
+    }
 
-        if (type == NetworkDevice::None)
-            continue;
+    const ProxyConfig oldChains = m_chainsProxy;
+    if (settings.fields & ProxySettings::Chains)
+        m_chainsProxy = settings.chains;
+    const bool chainsTypeUpdated = oldChains.type != m_chainsProxy.type;
+    const bool chainsAddrUpdated = oldChains.url != m_chainsProxy.url;
+    const bool chainsPortUpdated = oldChains.port != m_chainsProxy.port;
+    const bool chainsUserUpdated = oldChains.username != m_chainsProxy.username;
+    const bool chainsPasswdUpdated = oldChains.password != m_chainsProxy.password;
+    const bool chainsUpdated = chainsTypeUpdated || chainsAddrUpdated || chainsPortUpdated
+            || chainsUserUpdated || chainsPasswdUpdated;
 
-        for (auto const &l : list)
-        {
-            const auto info = l.toObject();
-            const QString path = info.value("Path").toString();
-            bool managed = info.value("Managed").toBool();
-            QString interface = info.value("Interface").toString();
+    if (changedProxies.isEmpty() && !autoProxyUpdated && !methodUpdated && !ignoreHostsUpdated && !chainsUpdated)
+        return;
 
-            if (!m_deviceInterface.contains(interface))
-                m_deviceInterface << interface;
+    UpdateScope scope(this);
 
-            if (!managed) {
-                qDebug() << "device: " << path << "ignored due to unmanged";
-                continue;
-            }
+    for (const QString &type : changedProxies) {
+        Q_EMIT proxyChanged(type, m_proxies.value(type));
+    }
+    if (autoProxyUpdated) {
+        Q_EMIT autoProxyChanged(m_autoProxy);
+    }
+    if (methodUpdated) {
+        Q_EMIT proxyMethodChanged(m_proxyMethod);
+    }
+    if (ignoreHostsUpdated) {
+        Q_EMIT proxyIgnoreHostsChanged(m_proxyIgnoreHosts);
+    }
+    if (chainsTypeUpdated) {
+        Q_EMIT chainsTypeChanged(m_chainsProxy.type);
+    }
+    if (chainsAddrUpdated) {
+        Q_EMIT chainsAddrChanged(m_chainsProxy.url);
+    }
+    if (chainsPortUpdated) {
+        Q_EMIT chainsPortChanged(m_chainsProxy.port);
+    }
+    if (chainsUserUpdated) {
+        Q_EMIT chainsUsernameChanged(m_chainsProxy.username);
+    }
+    if (chainsPasswdUpdated) {
+        Q_EMIT chainsPasswdChanged(m_chainsProxy.password);
+    }
 
-            // 根据标志位InterfaceFlags判断网络连接是否有效
-            if (type != NetworkDevice::Wireless) {
-                if (!info.value("InterfaceFlags").isUndefined()) {
-                    int flag = info.value("InterfaceFlags").toInt();
-                    if (!(flag & NM_DEVICE_INTERFACE_FLAG_UP)) {
-                        continue;
-                    }
-                }
-            }
+    Q_EMIT proxyConfigChanged();
+    markChanged(ChangeSet::ProxyChanged);
+}
 
-            if (!devSet.contains(path)) {
-                devSet << path;
-            }
+void NetworkModel::onDevicesChanged(const QString &devices)
+{
+    NetworkStatsScope stats(&m_stats, NetworkStats::DevicesChanged, devices.size());
+    const DevicesPayload payload = PayloadParser::parseDevices(devices);
+    stats.parsed();
+    applyDevices(payload);
+}
 
-            NetworkDevice *d = device(path);
-            if (d == nullptr)
-            {
-                changed = true;
+void NetworkModel::applyDevices(const DevicesPayload &payload)
+{
+    UpdateScope scope(this);
 
-                switch (type)
-                {
-                    case NetworkDevice::Wireless: d = new WirelessDevice(info, this); break;
-                    case NetworkDevice::Wired:    d = new WiredDevice(info, this);    break;
-                    default:;
-                }
+    QSet<QString> devSet;
+
+    bool changed = false;
 
-                m_devices.append(d);
+    m_deviceInterface = payload.interfaces;
 
-                if (d != nullptr) {
-                    // init device enabled status
-                    Q_EMIT requestDeviceStatus(d->path());
+    for (const auto &entry : payload.devices) {
+        const auto type = entry.type;
+        const QString &path = entry.path;
+        const QJsonObject &info = entry.info;
+
+        devSet << path;
+
+        NetworkDevice *d = device(path);
+        if (d == nullptr)
+        {
+            changed = true;
+
+            switch (type)
+            {
+                case NetworkDevice::Wireless: {
+                    WirelessDevice *wd = new WirelessDevice(info, this);
+                    connect(wd, &WirelessDevice::scanRequested, this, [=] {
+                        Q_EMIT requestWirelessScan(wd->path());
+                    });
+                    d = wd;
+                    break;
                 }
-            } else {
-                d->updateDeviceInfo(info);
+                case NetworkDevice::Wired:    d = new WiredDevice(info, this);    break;
+                default:;
             }
+
+            m_devices.append(d);
+
+            if (d != nullptr) {
+                d->setEmitCountingEnabled(m_emitCounter->isEnabled());
+                // init device enabled status
+                Q_EMIT requestDeviceStatus(d->path());
+            }
+        } else {
+            d->updateDeviceInfo(info);
         }
     }
 
@@ -298,6 +547,7 @@ void NetworkModel::onDevicesChanged(const QString &devices)
     }
 
     for (auto const r : removeList) {
+        m_removedDeviceSignals += r->emittedSignalCount();
         m_devices.removeOne(r);
         r->deleteLater();
     }
@@ -309,12 +559,24 @@ void NetworkModel::onDevicesChanged(const QString &devices)
 //    qDeleteAll(removeList);
 
     if (changed) {
+        m_devicesSnapshot.update(deviceStates());
         Q_EMIT deviceListChanged(m_devices);
+        markChanged(ChangeSet::DevicesChanged);
     }
 }
 
 void NetworkModel::onConnectionListChanged(const QString &conns)
 {
+    NetworkStatsScope stats(&m_stats, NetworkStats::ConnectionListChanged, conns.size());
+    const ConnectionsPayload payload = PayloadParser::parseConnections(conns);
+    stats.parsed();
+    applyConnections(payload);
+}
+
+void NetworkModel::applyConnections(const ConnectionsPayload &payload)
+{
+    UpdateScope scope(this);
+
     // m_connections 保存了所有从 NetworkManager 获取到的 connection
     // m_connections 是一个以连接的类型为键(wired,wireless,vpn,pppoe,etc.), 以此类型的所有连接组成的 list 为值的 map
 
@@ -326,50 +588,29 @@ void NetworkModel::onConnectionListChanged(const QString &conns)
     // 其子 map 的结构也与 m_connection 相同
     // 这表示 deviceConnections 中的一个键值对代表了一个设备, 及其独有的各种类型的连接
 
-    QMap<QString, QList<QJsonObject>> commonConnections;
-    QMap<QString, QMap<QString, QList<QJsonObject>>> deviceConnections;
-
-    QMap<QString, QList<QJsonObject>> wiredCommonConnections;
-    QMap<QString, QMap<QString, QList<QJsonObject>>> wiredDeviceConnections;
-
-    // 解析所有的 connection
-    const QJsonObject connsObject = QJsonDocument::fromJson(conns.toUtf8()).object();
-    for (auto it(connsObject.constBegin()); it != connsObject.constEnd(); ++it) {
-        const auto &connList = it.value().toArray();
-        const auto &connType = it.key();
-        if (connType.isEmpty())
+    // 只替换本次数据中出现的连接类型, 比较记录先比较创建时算好的哈希
+    QSet<QString> changedTypes;
+    for (auto it(payload.connections.constBegin()); it != payload.connections.constEnd(); ++it) {
+        QList<ConnectionRecord> &records = m_connections[it.key()];
+        if (records == it.value())
             continue;
 
-        m_connections[connType].clear();
-
-        for (const auto &connObject : connList) {
-            const QJsonObject &connection = connObject.toObject();
-
-            m_connections[connType].append(connection);
-
-            const auto &hwAddr = connection.value("HwAddress").toString();
-            if (hwAddr.isEmpty()) {
-                commonConnections[connType].append(connection);
-            } else {
-                deviceConnections[hwAddr][connType].append(connection);
-            }
-
-            const auto &interface = connection.value("IfcName").toString();
-            if (interface.isEmpty()) {
-                wiredCommonConnections[connType].append(connection);
-            } else {
-                wiredDeviceConnections[interface][connType].append(connection);
-            }
-        }
+        records = it.value();
+        changedTypes << it.key();
     }
 
+    const auto &commonConnections = payload.commonConnections;
+    const auto &deviceConnections = payload.deviceConnections;
+    const auto &wiredCommonConnections = payload.wiredCommonConnections;
+    const auto &wiredDeviceConnections = payload.wiredDeviceConnections;
+
     // 将 connections 分配给具体的设备
     for (NetworkDevice *dev : m_devices) {
         const QString &hwAddr = dev->realHwAdr();
-        const QMap<QString, QList<QJsonObject>> &connsByType = deviceConnections.value(hwAddr);
+        const QMap<QString, QList<ConnectionRecord>> &connsByType = deviceConnections.value(hwAddr);
         const QString &inter = dev->interfaceName();
-        const QMap<QString, QList<QJsonObject>> &connsByInter = wiredDeviceConnections.value(inter);
-        QList<QJsonObject> destConns;
+        const QMap<QString, QList<ConnectionRecord>> &connsByInter = wiredDeviceConnections.value(inter);
+        QList<ConnectionRecord> destConns;
 
         switch (dev->type()) {
         case NetworkDevice::Wired: {
@@ -396,108 +637,114 @@ void NetworkModel::onConnectionListChanged(const QString &conns)
         }
     }
 
+    // 快照在第一次访问内容时才生成 Json 对象, 内容没有变化的类型保留原来的快照
+    if (changedTypes.contains("vpn"))
+        m_vpns = ConnectionRecord::snapshot(m_connections.value("vpn"));
+    if (changedTypes.contains("wired"))
+        m_wireds = ConnectionRecord::snapshot(m_connections.value("wired"));
+    if (changedTypes.contains("wireless"))
+        m_wireless = ConnectionRecord::snapshot(m_connections.value("wireless"));
+    if (changedTypes.contains("pppoe"))
+        m_pppoes = ConnectionRecord::snapshot(m_connections.value("pppoe"));
+    if (changedTypes.contains("wireless-hotspot"))
+        m_hotspots = ConnectionRecord::snapshot(m_connections.value("wireless-hotspot"));
+
     Q_EMIT connectionListChanged();
+    markChanged(ChangeSet::ConnectionsChanged);
 }
 
 void NetworkModel::onActiveConnInfoChanged(const QString &conns)
 {
-    m_activeConnInfos.clear();
+    NetworkStatsScope stats(&m_stats, NetworkStats::ActiveConnInfoChanged, conns.size());
+    const ActiveConnInfoPayload payload = PayloadParser::parseActiveConnInfo(conns);
+    stats.parsed();
+    applyActiveConnInfo(payload);
+}
 
-    QMap<QString, QJsonObject> activeConnInfo;
-    QMap<QString, QJsonObject> activeHotspotInfo;
+void NetworkModel::applyActiveConnInfo(const ActiveConnInfoPayload &payload)
+{
+    UpdateScope scope(this);
 
-    // parse active connections info and save it by DevicePath
-    QJsonArray activeConns = QJsonDocument::fromJson(conns.toUtf8()).array();
-    for (const auto &info : activeConns)
-    {
-        const auto &connInfo = info.toObject();
-        const auto &type = connInfo.value("ConnectionType").toString();
-        const auto &devPath = connInfo.value("Device").toString();
+    m_activeConnInfos = payload.activeConnInfos;
 
-        activeConnInfo.insertMulti(devPath, connInfo);
-        m_activeConnInfos << connInfo;
-
-        if (type == "wireless-hotspot") {
-            activeHotspotInfo.insert(devPath, connInfo);
-        }
-    }
+    // 列表的哈希已在解析线程中算好, 没有活动连接的设备都使用空列表的哈希
+    const quint64 emptyHash = NetworkDevice::contentHash(QList<QJsonObject>());
 
     // update device active connection
     for (auto *dev : m_devices)
     {
         const auto &devPath = dev->path();
+        const QList<QJsonObject> &infos = payload.deviceActiveConnInfos.value(devPath);
+        const quint64 hash = payload.deviceActiveConnInfosHash.value(devPath, emptyHash);
 
         switch (dev->type())
         {
         case NetworkDevice::Wired:
         {
             WiredDevice *d = static_cast<WiredDevice *>(dev);
-            d->setActiveConnectionsInfo(activeConnInfo.values(devPath));
+            d->setActiveConnectionsInfo(infos, hash);
             break;
         }
         case NetworkDevice::Wireless:
         {
+            // 热点信息也由设备在 setActiveConnectionsInfo 中一并分类
             WirelessDevice *d = static_cast<WirelessDevice *>(dev);
-            d->setActiveConnectionsInfo(activeConnInfo.values(devPath));
-            d->setActiveHotspotInfo(activeHotspotInfo.value(devPath));
+            d->setActiveConnectionsInfo(infos, hash);
             break;
         }
         default:;
         }
     }
 
+    m_activeConnInfosSnapshot.update(m_activeConnInfos);
+
     Q_EMIT activeConnInfoChanged(m_activeConnInfos);
+    markChanged(ChangeSet::ActiveConnInfoChanged);
 }
 
 void NetworkModel::onActiveConnectionsChanged(const QString &conns)
 {
-    m_activeConns.clear();
-
-    // 按照设备分类所有 active 连接
-    QMap<QString, QList<QJsonObject>> deviceActiveConnsMap;
+    NetworkStatsScope stats(&m_stats, NetworkStats::ActiveConnectionsChanged, conns.size());
+    const ActiveConnectionsPayload payload = PayloadParser::parseActiveConnections(conns);
+    stats.parsed();
+    applyActiveConnections(payload);
+}
 
-    const QJsonObject activeConns = QJsonDocument::fromJson(conns.toUtf8()).object();
-    for (auto it(activeConns.constBegin()); it != activeConns.constEnd(); ++it)
-    {
-        const QJsonObject &info = it.value().toObject();
-        if (info.isEmpty())
-            continue;
+void NetworkModel::applyActiveConnections(const ActiveConnectionsPayload &payload)
+{
+    UpdateScope scope(this);
 
-        m_activeConns << info;
-        int connectionState = info.value("State").toInt();
+    m_activeConns = payload.activeConns;
 
-        for (const auto &item : info.value("Devices").toArray()) {
-            const QString &devicePath = item.toString();
-            if (devicePath.isEmpty()) {
-                continue;
-            }
-            deviceActiveConnsMap[devicePath] << info;
+    // 按照设备分类所有 active 连接
+    const QMap<QString, QList<QJsonObject>> &deviceActiveConnsMap = payload.deviceActiveConns;
 
-            NetworkDevice *dev = device(devicePath);
-            if (dev != nullptr) {
-                if (dev->status() != NetworkDevice::DeviceStatus::Activated && connectionState == CONNECTED) {
-                    qDebug() << devicePath << "The active connection status does not match the device connection status. It has been changed";
-                    dev->setDeviceStatus(NetworkDevice::DeviceStatus::Activated);
-                }
-            }
+    for (const QString &devicePath : payload.connectedDevices) {
+        NetworkDevice *dev = device(devicePath);
+        if (dev != nullptr && dev->status() != NetworkDevice::DeviceStatus::Activated) {
+            qDebug() << devicePath << "The active connection status does not match the device connection status. It has been changed";
+            dev->setDeviceStatus(NetworkDevice::DeviceStatus::Activated);
         }
     }
 
-    // 将 active 连接分配给具体的设备
+    // 将 active 连接分配给具体的设备, 列表的哈希已在解析线程中算好
     for (auto it(deviceActiveConnsMap.constBegin()); it != deviceActiveConnsMap.constEnd(); ++it) {
         NetworkDevice *dev = device(it.key());
         if (dev == nullptr) {
             continue;
         }
+        auto hash = payload.deviceActiveConnsHash.constFind(it.key());
+        const quint64 contentHash = hash != payload.deviceActiveConnsHash.constEnd() ? hash.value()
+                                                                                      : NetworkDevice::contentHash(it.value());
         switch (dev->type()) {
             case NetworkDevice::Wired: {
                 WiredDevice *wdDevice = static_cast<WiredDevice *>(dev);
-                wdDevice->setActiveConnections(it.value());
+                wdDevice->setActiveConnections(it.value(), contentHash);
                 break;
             }
             case NetworkDevice::Wireless: {
                 WirelessDevice *wsDevice = static_cast<WirelessDevice *>(dev);
-                wsDevice->setActiveConnections(it.value());
+                wsDevice->setActiveConnections(it.value(), contentHash);
                 break;
             }
             default:
@@ -505,7 +752,10 @@ void NetworkModel::onActiveConnectionsChanged(const QString &conns)
         }
     }
 
+    m_activeConnsSnapshot.update(m_activeConns);
+
     Q_EMIT activeConnectionsChanged(m_activeConns);
+    markChanged(ChangeSet::ActiveConnectionsChanged);
 }
 
 void NetworkModel::onConnectionSessionCreated(const QString &device, const QString &sessionPath)
@@ -523,6 +773,8 @@ void NetworkModel::onConnectionSessionCreated(const QString &device, const QStri
 
 void NetworkModel::onDeviceEnableChanged(const QString &device, const bool enabled)
 {
+    UpdateScope scope(this);
+
     NetworkDevice *dev = nullptr;
     for (auto const d : m_devices)
     {
@@ -546,6 +798,7 @@ void NetworkModel::onChainsTypeChanged(const QString &type)
     if (type != m_chainsProxy.type) {
         m_chainsProxy.type = type;
         Q_EMIT chainsTypeChanged(type);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -554,6 +807,7 @@ void NetworkModel::onChainsAddrChanged(const QString &addr)
     if (addr != m_chainsProxy.url) {
         m_chainsProxy.url = addr;
         Q_EMIT chainsAddrChanged(addr);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -562,6 +816,7 @@ void NetworkModel::onChainsPortChanged(const uint port)
     if (port != m_chainsProxy.port) {
         m_chainsProxy.port = port;
         Q_EMIT chainsPortChanged(port);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -570,6 +825,7 @@ void NetworkModel::onChainsUserChanged(const QString &user)
     if (user != m_chainsProxy.username) {
         m_chainsProxy.username = user;
         Q_EMIT chainsUsernameChanged(user);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 
@@ -578,6 +834,7 @@ void NetworkModel::onChainsPasswdChanged(const QString &passwd)
     if (passwd != m_chainsProxy.password) {
         m_chainsProxy.password = passwd;
         Q_EMIT chainsPasswdChanged(passwd);
+        markChanged(ChangeSet::ProxyChanged);
     }
 }
 void NetworkModel::onNeedSecrets(const QString &info)
@@ -614,28 +871,31 @@ void NetworkModel::onNeedSecretsFinished(const QString &info0, const QString &in
 void NetworkModel::onConnectivityChanged(int connectivity)
 {
     Connectivity conn = static_cast<Connectivity>(connectivity);
-    if (m_Connectivity == conn) {
+    if (connectivity() == conn) {
         return;
     }
 
-    m_Connectivity = conn;
+    m_Connectivity.storeRelease(conn);
 
     // if the new connectivity state from NetworkManager is not Full,
     // check it again use our urls
-    if (m_Connectivity != Full) {
+    if (conn != Full) {
         if (!m_connectivityCheckThread->isRunning()) {
             m_connectivityCheckThread->start();
         }
         Q_EMIT needCheckConnectivitySecondary();
     }
 
-    Q_EMIT connectivityChanged(m_Connectivity);
+    Q_EMIT connectivityChanged(conn);
+    markChanged(ChangeSet::ConnectivityChanged);
 }
 
 void NetworkModel::onConnectivitySecondaryCheckFinished(bool connectivity)
 {
-    m_Connectivity = connectivity ? Full : NoConnectivity;
-    Q_EMIT connectivityChanged(m_Connectivity);
+    const Connectivity conn = connectivity ? Full : NoConnectivity;
+    m_Connectivity.storeRelease(conn);
+    Q_EMIT connectivityChanged(conn);
+    markChanged(ChangeSet::ConnectivityChanged);
 }
 
 bool NetworkModel::containsDevice(const QString &devPath) const
@@ -661,18 +921,28 @@ void NetworkModel::onAppProxyExistChanged(bool appProxyExist)
     m_appProxyExist = appProxyExist;
 
     Q_EMIT appProxyExistChanged(appProxyExist);
+    markChanged(ChangeSet::AppProxyChanged);
 }
 
 void NetworkModel::onWirelessAccessPointsChanged(const QString &WirelessList)
 {
+    NetworkStatsScope stats(&m_stats, NetworkStats::WirelessAccessPointsChanged, WirelessList.size());
+    const AccessPointsPayload payload = PayloadParser::parseAccessPoints(WirelessList);
+    stats.parsed();
+    applyAccessPoints(payload);
+}
+
+void NetworkModel::applyAccessPoints(const AccessPointsPayload &payload)
+{
+    UpdateScope scope(this);
+
     //当数据非json的时候,则这个里面的项为0,则下面的for不会被执行
-    QJsonObject WirelessData = QJsonDocument::fromJson(WirelessList.toUtf8()).object();
-    for (QString Device : WirelessData.keys()) {
+    for (auto it(payload.deviceAccessPoints.constBegin()); it != payload.deviceAccessPoints.constEnd(); ++it) {
         for (auto const dev : m_devices) {
             //当类型不为无线网,path不为当前需要的device则进入下一个循环
-            if (dev->type() != NetworkDevice::Wireless || dev->path() != Device) continue;
-            dynamic_cast<WirelessDevice *>(dev)->setAPList(WirelessData.value(Device));
+            if (dev->type() != NetworkDevice::Wireless || dev->path() != it.key()) continue;
+            NetworkStatsScope stats(&m_stats, NetworkStats::SetAPList, 0);
+            static_cast<WirelessDevice *>(dev)->setAPList(it.value());
         }
     }
-    return;
 }
@@ -27,12 +27,21 @@
 #define NETWORKMODEL_H
 
 #include "networkdevice.h"
+#include "emitcounter.h"
 #include "connectivitychecker.h"
+#include "proxybypassmatcher.h"
+#include "sharedsnapshot.h"
+#include "payloadparser.h"
+#include "networkstats.h"
 
 #include <QMap>
+#include <QHash>
 #include <QTimer>
 #include <QDBusObjectPath>
 #include <QThread>
+#include <QAtomicInt>
+
+#include <memory>
 
 namespace dde {
 
@@ -47,6 +56,53 @@ struct ProxyConfig
     QString password;
 };
 
+// 一次批量获取到的代理配置, fields 标记了其中哪些部分是有效的
+struct ProxySettings
+{
+    enum Field
+    {
+        AutoProxy   = 0x1,
+        Method      = 0x2,
+        IgnoreHosts = 0x4,
+        Chains      = 0x8,
+    };
+
+    ProxySettings() : fields(0) {}
+
+    int fields;
+    QMap<QString, ProxyConfig> proxies;
+    QString autoProxy;
+    QString method;
+    QString ignoreHosts;
+    ProxyConfig chains;
+};
+
+// 一次事务中发生变化的数据, 由 NetworkModel::modelChanged 发出
+struct ChangeSet
+{
+    enum Entity
+    {
+        DevicesChanged           = 0x1,
+        DeviceStateChanged       = 0x2,
+        ConnectionsChanged       = 0x4,
+        ActiveConnectionsChanged = 0x8,
+        ActiveConnInfoChanged    = 0x10,
+        ProxyChanged             = 0x20,
+        VpnChanged               = 0x40,
+        AppProxyChanged          = 0x80,
+        ConnectivityChanged      = 0x100,
+    };
+
+    ChangeSet() : entities(0) {}
+
+    bool isEmpty() const { return entities == 0; }
+    bool contains(Entity entity) const { return entities & entity; }
+
+    int entities;
+    // 发生变化(包括新增和移除)的设备路径
+    QStringList devices;
+};
+
 enum Connectivity
 {
     UnknownConnectivity = 0,
@@ -64,37 +120,132 @@ enum InterfaceFlags
     NM_DEVICE_INTERFACE_FLAG_CARRIER  = 0x10000, //the interface has carrier. In most cases this is equal to the value of @NM_DEVICE_INTERFACE_FLAG_LOWER_UP
 };
 
-class NetworkDevice;
+// 发布快照时设备的状态, 不持有 NetworkDevice 指针, 可以在任意线程中读取
+struct DeviceState
+{
+    QString path;
+    NetworkDevice::DeviceType type;
+    NetworkDevice::DeviceStatus status;
+    bool enabled;
+    QString interfaceName;
+    QString hwAddress;
+    QJsonObject info;
+};
+
+inline bool operator==(const DeviceState &s1, const DeviceState &s2)
+{
+    return s1.path == s2.path && s1.type == s2.type && s1.status == s2.status && s1.enabled == s2.enabled
+            && s1.interfaceName == s2.interfaceName && s1.hwAddress == s2.hwAddress && s1.info == s2.info;
+}
+
+inline bool operator!=(const DeviceState &s1, const DeviceState &s2)
+{
+    return !(s1 == s2);
+}
+
+// 设备列表的快照保存的是设备状态的副本, 设备被移除释放后仍然可以安全地读取
+typedef SharedSnapshot<DeviceState> DeviceSnapshot;
+
+/**
+ * @brief NetworkModelSnapshot NetworkModel 在某次更新完成后的只读快照
+ *
+ * 每个事务结束后由 NetworkModel 生成新的快照并原子地替换旧快照, 已经取到的快照不会再被修改,
+ * 因此任意线程都可以不加锁地读取其中的内容 (包括 ProxyBypassMatcher::matches).
+ * 取快照本身使用 std::atomic_load, libstdc++ 中它由全局的互斥锁池实现, 并非无锁,
+ * 但锁只覆盖复制指针和增加引用计数, 持有时间很短.
+ */
+struct NetworkModelSnapshot
+{
+    NetworkModelSnapshot() : version(0), connectivity(Full), vpnEnabled(false), appProxyExist(false) {}
+
+    quint64 version;
+    Connectivity connectivity;
+    QStringList deviceInterface;
+    QList<DeviceState> devices;
+
+    ConnectionSnapshot vpns;
+    ConnectionSnapshot wireds;
+    ConnectionSnapshot wireless;
+    ConnectionSnapshot pppoes;
+    ConnectionSnapshot hotspots;
+    ConnectionSnapshot activeConns;
+    ConnectionSnapshot activeConnInfos;
+
+    bool vpnEnabled;
+    bool appProxyExist;
+    QString proxyMethod;
+    QString autoProxy;
+    QString ignoreHosts;
+    QMap<QString, ProxyConfig> proxies;
+    ProxyConfig chainsProxy;
+    ProxyBypassMatcher proxyBypassMatcher;
+};
+
 class NetworkWorker;
+class IngestPipeline;
 class WirelessDevice;
 class NetworkModel : public QObject
 {
     Q_OBJECT
 
     friend class NetworkWorker;
+    friend class IngestPipeline;
 
 public:
     explicit NetworkModel(QObject *parent = nullptr);
     ~NetworkModel();
+
+    // 事务可以嵌套, 最外层的 endUpdate 将事务中的所有变化合并为一次 modelChanged
+    // 各个具体的信号仍然照常发出, 只需要整体刷新的界面响应 modelChanged 即可
+    void beginUpdate();
+    void endUpdate();
+    bool isUpdating() const { return m_updateDepth > 0; }
+
+    // 各数据入口和 DBus 回调的统计, 默认关闭; 可以在任意线程中调用
+    NetworkStats stats() const { return m_stats.snapshot(); }
+    bool isStatsEnabled() const { return m_stats.isEnabled(); }
+    // 开启后才统计 model 及其设备发出的信号, 关闭时不连接任何计数槽
+    void setStatsEnabled(bool enabled);
+    void resetStats() { m_stats.reset(); }
+    // 开启统计期间 model 及其设备累计发出的信号数
+    quint64 emittedSignalCount() const;
+
+    // 可以在任意线程中调用, 返回最近一次发布的快照
+    std::shared_ptr<const NetworkModelSnapshot> snapshot() const { return std::atomic_load(&m_snapshot); }
     ProxyConfig getChainsProxy() { return m_chainsProxy;}
 
     bool vpnEnabled() const { return m_vpnEnabled; }
     bool appProxyExist() const { return m_appProxyExist; }
 
-    static Connectivity connectivity() { return m_Connectivity; }
+    // 可以在任意线程中调用
+    static Connectivity connectivity() { return static_cast<Connectivity>(m_Connectivity.loadAcquire()); }
 
     const ProxyConfig proxy(const QString &type) const { return m_proxies[type]; }
     const QString autoProxy() const { return m_autoProxy; }
     const QString proxyMethod() const { return m_proxyMethod; }
     const QString ignoreHosts() const { return m_proxyIgnoreHosts; }
+    // 由 ignoreHosts 编译得到, 仅在 ignoreHosts 变化时重建
+    const ProxyBypassMatcher &proxyBypassMatcher() const { return m_proxyBypassMatcher; }
     const QList<NetworkDevice *> devices() const { return m_devices; }
-    const QList<QJsonObject> vpns() const { return m_connections.value("vpn"); }
-    const QList<QJsonObject> wireds() const { return m_connections.value("wired"); }
-    const QList<QJsonObject> wireless() const { return m_connections.value("wireless"); }
-    const QList<QJsonObject> pppoes() const { return m_connections.value("pppoe"); }
-    const QList<QJsonObject> hotspots() const { return m_connections.value("wireless-hotspot"); }
+    const QList<QJsonObject> vpns() const { return m_vpns.items(); }
+    const QList<QJsonObject> wireds() const { return m_wireds.items(); }
+    const QList<QJsonObject> wireless() const { return m_wireless.items(); }
+    const QList<QJsonObject> pppoes() const { return m_pppoes.items(); }
+    const QList<QJsonObject> hotspots() const { return m_hotspots.items(); }
     const QList<QJsonObject> activeConnInfos() const { return m_activeConnInfos; }
     const QList<QJsonObject> activeConns() const { return m_activeConns; }
+
+    // 快照只在内容变化时替换, 持有方可以通过 version() 判断数据是否更新
+    const DeviceSnapshot devicesSnapshot() const { return m_devicesSnapshot; }
+    const ConnectionSnapshot vpnsSnapshot() const { return m_vpns; }
+    const ConnectionSnapshot wiredsSnapshot() const { return m_wireds; }
+    const ConnectionSnapshot wirelessSnapshot() const { return m_wireless; }
+    const ConnectionSnapshot pppoesSnapshot() const { return m_pppoes; }
+    const ConnectionSnapshot hotspotsSnapshot() const { return m_hotspots; }
+    const ConnectionSnapshot activeConnInfosSnapshot() const { return m_activeConnInfosSnapshot; }
+    const ConnectionSnapshot activeConnsSnapshot() const { return m_activeConnsSnapshot; }
+    // 只需要 Id, Uuid, Ssid 等常用字段时使用, 不会生成 Json 对象列表
+    const QList<ConnectionRecord> connectionRecords(const QString &type) const { return m_connections.value(type); }
     const QString connectionUuidByPath(const QString &connPath) const;
     const QString connectionNameByPath(const QString &connPath) const;
     const QString connectionUuidByApInfo(const QJsonObject &apInfo) const;
@@ -111,7 +262,10 @@ Q_SIGNALS:
     void proxyChanged(const QString &type, const ProxyConfig &config) const;
     void proxyMethodChanged(const QString &proxyMethod) const;
     void proxyIgnoreHostsChanged(const QString &hosts) const;
+    // 批量更新代理配置后只发送一次, 代理页面只需要响应这一个信号
+    void proxyConfigChanged() const;
     void requestDeviceStatus(const QString &devPath) const;
+    void requestWirelessScan(const QString &devPath) const;
     void activeConnectionsChanged(const QList<QJsonObject> &conns) const;
     void activeConnInfoChanged(const QList<QJsonObject> &infos) const;
     void vpnEnabledChanged(const bool enabled) const;
@@ -126,6 +280,8 @@ Q_SIGNALS:
     void needSecrets(const QString &info);
     void needSecretsFinished(const QString &info0, const QString &info1);
     void connectivityChanged(const Connectivity connectivity) const;
+    // 事务外的每次变化以及每个事务结束时发出一次
+    void modelChanged(const ChangeSet &changes) const;
 
     // Private Signals
     // Need ensure the checker thread is running
@@ -140,6 +296,7 @@ private Q_SLOTS:
     void onAutoProxyChanged(const QString &proxy);
     void onProxyMethodChanged(const QString &proxyMethod);
     void onProxyIgnoreHostsChanged(const QString &hosts);
+    void onProxySettingsChanged(const ProxySettings &settings);
     void onDevicesChanged(const QString &devices);
     void onConnectionListChanged(const QString &conns);
     void onActiveConnInfoChanged(const QString &conns);
@@ -165,6 +322,19 @@ private:
     bool containsDevice(const QString &devPath) const;
     NetworkDevice *device(const QString &devPath) const;
     void updateWiredConnInfo();
+    const ConnectionRecord connectionRecordByPath(const QString &connPath) const;
+    void markChanged(int entities);
+    void publishSnapshot(const ChangeSet &changes);
+    QList<DeviceState> deviceStates() const;
+    QList<DeviceState> deviceStates(const QList<DeviceState> &previous, const QStringList &changedDevices) const;
+    static DeviceState deviceState(const NetworkDevice *dev);
+
+    // 应用已经解析好的数据, 必须在 model 所在线程中调用
+    void applyDevices(const DevicesPayload &payload);
+    void applyConnections(const ConnectionsPayload &payload);
+    void applyActiveConnections(const ActiveConnectionsPayload &payload);
+    void applyActiveConnInfo(const ActiveConnInfoPayload &payload);
+    void applyAccessPoints(const AccessPointsPayload &payload);
 
 private:
     NetworkDevice *m_lastSecretDevice;
@@ -176,20 +346,45 @@ private:
 
     QString m_proxyMethod;
     QString m_proxyIgnoreHosts;
+    ProxyBypassMatcher m_proxyBypassMatcher;
     QString m_autoProxy;
     ProxyConfig m_chainsProxy;
     QList<NetworkDevice *> m_devices;
     QList<QJsonObject> m_activeConnInfos;
     QList<QJsonObject> m_activeConns;
     QMap<QString, ProxyConfig> m_proxies;
-    QMap<QString, QList<QJsonObject>> m_connections;
+    QMap<QString, QList<ConnectionRecord>> m_connections;
+
+    DeviceSnapshot m_devicesSnapshot;
+    ConnectionSnapshot m_vpns;
+    ConnectionSnapshot m_wireds;
+    ConnectionSnapshot m_wireless;
+    ConnectionSnapshot m_pppoes;
+    ConnectionSnapshot m_hotspots;
+    ConnectionSnapshot m_activeConnInfosSnapshot;
+    ConnectionSnapshot m_activeConnsSnapshot;
 
-    static QStringList m_deviceInterface;
-    static Connectivity m_Connectivity;
+    int m_updateDepth;
+    ChangeSet m_changes;
+    // 事务开始时各设备的 revision, 用于找出事务中发生变化的设备
+    QHash<QString, quint64> m_deviceRevisions;
+
+    QStringList m_deviceInterface;
+    std::shared_ptr<const NetworkModelSnapshot> m_snapshot;
+
+    EmitCounter *m_emitCounter;
+    // 已移除的设备发出的信号数
+    quint64 m_removedDeviceSignals;
+    NetworkStatsCollector m_stats;
+
+    static QAtomicInt m_Connectivity;
 };
 
 }   // namespace network
 
 }   // namespace dde
 
+Q_DECLARE_METATYPE(dde::network::ChangeSet)
+Q_DECLARE_METATYPE(dde::network::DeviceSnapshot)
+
 #endif // NETWORKMODEL_H
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkstats.h"
+
+#include <QMutexLocker>
+
+using namespace dde::network;
+
+QString NetworkStats::entryPointName(int entryPoint)
+{
+    switch (entryPoint) {
+    case DevicesChanged:                return "onDevicesChanged";
+    case ConnectionListChanged:         return "onConnectionListChanged";
+    case ActiveConnInfoChanged:         return "onActiveConnInfoChanged";
+    case ActiveConnectionsChanged:      return "onActiveConnectionsChanged";
+    case WirelessAccessPointsChanged:   return "onWirelessAccessPointsChanged";
+    case SetAPList:                     return "setAPList";
+    default:                            return QString();
+    }
+}
+
+NetworkStatsCollector::NetworkStatsCollector()
+    : m_enabled(0)
+{
+}
+
+void NetworkStatsCollector::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled ? 1 : 0);
+}
+
+void NetworkStatsCollector::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = NetworkStats();
+}
+
+NetworkStats NetworkStatsCollector::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    NetworkStats stats = m_stats;
+    stats.enabled = isEnabled();
+    return stats;
+}
+
+void NetworkStatsCollector::recordParse(int entryPoint, qint64 bytes, qint64 nsec)
+{
+    if (!isEnabled() || entryPoint < 0 || entryPoint >= NetworkStats::EntryPointCount)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    HandlerStats &stats = m_stats.entryPoints[entryPoint];
+    stats.bytes += bytes;
+    stats.parseNsec += nsec;
+}
+
+void NetworkStatsCollector::recordApply(int entryPoint, qint64 bytes, qint64 parseNsec, qint64 applyNsec, quint64 signalCount)
+{
+    if (!isEnabled() || entryPoint < 0 || entryPoint >= NetworkStats::EntryPointCount)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    HandlerStats &stats = m_stats.entryPoints[entryPoint];
+    ++stats.calls;
+    stats.bytes += bytes;
+    stats.parseNsec += parseNsec;
+    stats.applyNsec += applyNsec;
+    stats.signalCount += signalCount;
+}
+
+void NetworkStatsCollector::recordCallback(const QString &method, qint64 bytes, qint64 nsec, quint64 signalCount)
+{
+    if (!isEnabled())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    HandlerStats &stats = m_stats.callbacks[method];
+    ++stats.calls;
+    stats.bytes += bytes;
+    stats.applyNsec += nsec;
+    stats.signalCount += signalCount;
+}
+
+NetworkStatsScope::NetworkStatsScope(NetworkStatsCollector *collector, int entryPoint, qint64 bytes)
+    : m_collector(collector && collector->isEnabled() ? collector : nullptr)
+    , m_entryPoint(entryPoint)
+    , m_bytes(bytes)
+    , m_parseNsec(0)
+    , m_signalCount(0)
+{
+    if (!m_collector)
+        return;
+
+    m_signalCount = m_collector->signalCount();
+    m_timer.start();
+}
+
+NetworkStatsScope::NetworkStatsScope(NetworkStatsCollector *collector, const QString &method, qint64 bytes)
+    : NetworkStatsScope(collector, -1, bytes)
+{
+    if (m_collector)
+        m_method = method;
+}
+
+NetworkStatsScope::~NetworkStatsScope()
+{
+    if (!m_collector)
+        return;
+
+    const qint64 elapsed = m_timer.nsecsElapsed();
+    const quint64 signalCount = m_collector->signalCount() - m_signalCount;
+
+    if (m_entryPoint >= 0)
+        m_collector->recordApply(m_entryPoint, m_bytes, m_parseNsec, elapsed - m_parseNsec, signalCount);
+    else if (!m_method.isEmpty())
+        m_collector->recordCallback(m_method, m_bytes, elapsed, signalCount);
+}
+
+void NetworkStatsScope::parsed()
+{
+    if (m_collector)
+        m_parseNsec = m_timer.nsecsElapsed();
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKSTATS_H
+#define NETWORKSTATS_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+
+namespace dde {
+
+namespace network {
+
+// 一个入口或回调的累计统计, 时间单位为纳秒, 数据量按字符数计
+struct HandlerStats
+{
+    HandlerStats() : calls(0), bytes(0), parseNsec(0), applyNsec(0), signalCount(0) {}
+
+    quint64 calls;
+    quint64 bytes;
+    qint64 parseNsec;
+    qint64 applyNsec;
+    quint64 signalCount;
+};
+
+/**
+ * @brief NetworkStats NetworkModel::stats() 返回的统计快照
+ *
+ * entryPoints 为 model 的各数据入口, callbacks 按 DBus 方法名统计 NetworkWorker 中的回调.
+ * IngestPipeline 在后台线程解析的数据, 解析时间计入对应入口的 parseNsec.
+ * setAPList 收到的是已经解析好的数据, 不统计数据量和解析时间.
+ */
+struct NetworkStats
+{
+    enum EntryPoint {
+        DevicesChanged,
+        ConnectionListChanged,
+        ActiveConnInfoChanged,
+        ActiveConnectionsChanged,
+        WirelessAccessPointsChanged,
+        SetAPList,
+        EntryPointCount
+    };
+
+    NetworkStats() : enabled(false) {}
+
+    static QString entryPointName(int entryPoint);
+
+    bool enabled;
+    HandlerStats entryPoints[EntryPointCount];
+    QMap<QString, HandlerStats> callbacks;
+};
+
+/**
+ * @brief NetworkStatsCollector 收集 NetworkStats, 可以在任意线程中调用
+ *
+ * 默认关闭, 关闭时各处统计只有一次原子读取的开销.
+ */
+class NetworkStatsCollector
+{
+public:
+    typedef std::function<quint64()> SignalCounter;
+
+    NetworkStatsCollector();
+
+    bool isEnabled() const { return m_enabled.load() != 0; }
+    void setEnabled(bool enabled);
+    void reset();
+    NetworkStats snapshot() const;
+
+    // 返回累计发出的信号数, 只在 model 所在线程中调用
+    void setSignalCounter(const SignalCounter &counter) { m_signalCounter = counter; }
+    quint64 signalCount() const { return m_signalCounter ? m_signalCounter() : 0; }
+
+    void recordParse(int entryPoint, qint64 bytes, qint64 nsec);
+    void recordApply(int entryPoint, qint64 bytes, qint64 parseNsec, qint64 applyNsec, quint64 signalCount);
+    void recordCallback(const QString &method, qint64 bytes, qint64 nsec, quint64 signalCount);
+
+private:
+    QAtomicInt m_enabled;
+    SignalCounter m_signalCounter;
+
+    mutable QMutex m_mutex;
+    NetworkStats m_stats;
+};
+
+/**
+ * @brief NetworkStatsScope 统计一次入口或回调的调用, 析构时记录
+ *
+ * 需要区分解析和应用时间的入口在解析结束后调用 parsed().
+ */
+class NetworkStatsScope
+{
+public:
+    NetworkStatsScope(NetworkStatsCollector *collector, int entryPoint, qint64 bytes);
+    NetworkStatsScope(NetworkStatsCollector *collector, const QString &method, qint64 bytes);
+    ~NetworkStatsScope();
+
+    void parsed();
+
+private:
+    NetworkStatsCollector *m_collector;
+    int m_entryPoint;
+    QString m_method;
+    qint64 m_bytes;
+    qint64 m_parseNsec;
+    quint64 m_signalCount;
+    QElapsedTimer m_timer;
+
+    Q_DISABLE_COPY(NetworkStatsScope)
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // NETWORKSTATS_H
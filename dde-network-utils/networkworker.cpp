@@ -24,148 +24,256 @@
  */
 
 #include "networkworker.h"
+#include "eventtracer.h"
+#include "nmnetworkbackend.h"
 
+#include <QDBusArgument>
 #include <QMetaProperty>
+#include <QTimer>
 
 using namespace dde::network;
 
-const QString networkService = "com.deepin.daemon.Network";
-const QString networkPath = "/com/deepin/daemon/Network";
+// 用于合并重复请求的 query key, 带参数的请求会在后面追加参数
+const QString ActiveConnInfoQuery = "GetActiveConnectionInfo";
+const QString ConnectivityQuery = "Get:Connectivity";
+const QString AutoProxyQuery = "GetAutoProxy";
+const QString ProxyMethodQuery = "GetProxyMethod";
+const QString ProxyIgnoreHostsQuery = "GetProxyIgnoreHosts";
+const QString ProxyQuery = "GetProxy:%1";
+const QString DeviceStatusQuery = "IsDeviceEnabled:%1";
+const QString ChainsQuery = "GetAll:ProxyChains";
+
+const QStringList ProxyTypes = { "http", "https", "ftp", "socks" };
+
+// 超过这个时间仍未返回的批量请求, 只应用已经返回的部分
+#define PROXY_BATCH_TIMEOUT (12 * 1000)
+
+// queryProxyData 中的一次批量请求, 所有调用返回后一次性更新到 model
+struct NetworkWorker::ProxyBatch
+{
+    ProxySettings settings;
+    int pending;
+};
+
+// 直接从返回消息中取值, 出错时返回默认值
+// 与 QDBusPendingReply 不同, 这里不校验签名, backend 可以返回本地构造的结果
+template <typename T>
+static T replyValue(QDBusPendingCallWatcher *w, int index = 0)
+{
+    if (w->isError())
+        return T();
+
+    return qdbus_cast<T>(w->reply().arguments().value(index));
+}
+
+static ProxyConfig parseChainsProperties(const QVariantMap &properties)
+{
+    ProxyConfig config;
+    config.type = properties.value("Type").toString();
+    config.url = properties.value("IP").toString();
+    config.port = properties.value("Port").toUInt();
+    config.username = properties.value("User").toString();
+    config.password = properties.value("Password").toString();
+
+    return config;
+}
+
+// DDE_NETWORK_UTILS_BACKEND=nm 时直接访问 NetworkManager, 默认使用 deepin 网络服务
+static NetworkBackend *createDefaultBackend()
+{
+    if (qgetenv("DDE_NETWORK_UTILS_BACKEND") == "nm")
+        return new NmNetworkBackend;
+
+    return new DaemonNetworkBackend;
+}
 
 NetworkWorker::NetworkWorker(NetworkModel *model, QObject *parent, bool sync)
-    : QObject(parent),
-      m_networkInter(networkService, networkPath, QDBusConnection::sessionBus(), this),
-      m_chainsInter(new ProxyChains(networkService, "/com/deepin/daemon/Network/ProxyChains", QDBusConnection::sessionBus(), this)),
-      m_networkModel(model)
+    : NetworkWorker(createDefaultBackend(), model, parent, sync)
 {
+}
+
+NetworkWorker::NetworkWorker(NetworkBackend *backend, NetworkModel *model, QObject *parent, bool sync)
+    : QObject(parent),
+      m_backend(backend),
+      m_networkModel(model),
+      m_scanScheduler(new WirelessScanScheduler(model, this)),
+      m_callManager(new PendingCallManager(this)),
+      m_ingestPipeline(new IngestPipeline(model, this)),
+      m_recorder(new SignalRecorder(this)),
+      m_activationTracker(new ActivationTracker(model, this))
+{
+    // 没有 parent 的 backend 由 worker 负责释放
+    if (!m_backend->parent())
+        m_backend->setParent(this);
+
+    m_callManager->setStatsCollector(&m_networkModel->m_stats);
+
+    // 激活连接可能需要等待用户认证, 给更长的超时时间
+    m_callManager->setTimeout("ActivateAccessPoint", 25 * 1000);
+    m_callManager->setTimeout("ActivateConnection", 25 * 1000);
+
+    // 先于其他连接录制, 保证录制的顺序与收到信号的顺序一致
+    m_recorder->attach(m_backend);
+    const QString recordFile = QString::fromLocal8Bit(qgetenv("DDE_NETWORK_UTILS_RECORD"));
+    if (!recordFile.isEmpty())
+        m_recorder->start(recordFile);
+    EventTracer::startFromEnvironment();
+
     // 网络服务加载很慢时，需监听 服务启动后，刷新网络设备信息
-    auto req = QDBusConnection::sessionBus().interface()->isServiceRegistered(networkService);
-    if (!req.value()) {
-        qInfo() << networkService << "is not registered, waiting for registration";
-        QDBusServiceWatcher *serviceWatcher = new QDBusServiceWatcher(this);
-        serviceWatcher->setConnection(QDBusConnection::sessionBus());
-        serviceWatcher->addWatchedService(networkService);
-        connect(serviceWatcher, &QDBusServiceWatcher::serviceRegistered, [this] {
-            NetworkInter netInter(networkService, networkPath, QDBusConnection::sessionBus(), this);
-            QString devices = netInter.devices();
-            qInfo() << networkService <<  "is registered";
-            if (!devices.isEmpty()){
-                m_networkModel->onDevicesChanged(netInter.devices());
-            } else {
-                qInfo() << "network devices is empty";
-            }
-        });
-    }
+    connect(m_backend, &NetworkBackend::serviceRegistered, this, [this] {
+        const QString devices = m_backend->fetchDevices();
+        if (!devices.isEmpty()){
+            applyPayload(IngestPipeline::Devices, devices);
+        } else {
+            qInfo() << "network devices is empty";
+        }
+    });
 
     //对网络适配器的监听，当适配器消失及时响应
-    connect(&m_networkInter, &NetworkInter::ActiveConnectionsChanged, this, &NetworkWorker::queryActiveConnInfo, Qt::QueuedConnection);
-    connect(&m_networkInter, &NetworkInter::ActiveConnectionsChanged, m_networkModel, &NetworkModel::onActiveConnectionsChanged);
-    connect(&m_networkInter, &NetworkInter::DevicesChanged, m_networkModel, &NetworkModel::onDevicesChanged);
-
-    connect(&m_networkInter, &NetworkInter::ConnectionsChanged, m_networkModel, &NetworkModel::onConnectionListChanged);
-    connect(&m_networkInter, &NetworkInter::DeviceEnabled, m_networkModel, &NetworkModel::onDeviceEnableChanged);
-    connect(&m_networkInter, &NetworkInter::ConnectivityChanged, m_networkModel, &NetworkModel::onConnectivityChanged);
-    connect(&m_networkInter, &NetworkInter::WirelessAccessPointsChanged, m_networkModel, &NetworkModel::onWirelessAccessPointsChanged);
-    connect(&m_networkInter, &NetworkInter::VpnEnabledChanged, m_networkModel, &NetworkModel::onVPNEnabledChanged);
-    connect(&m_networkInter, &NetworkInter::NeedSecrets, m_networkModel, &NetworkModel::onNeedSecrets);
-    connect(&m_networkInter, &NetworkInter::NeedSecretsFinished, m_networkModel, &NetworkModel::onNeedSecretsFinished);
+    // 活动连接变化后, 正在进行中的 GetActiveConnectionInfo 结果已经过期, 需要重新获取
+    connect(m_backend, &NetworkBackend::activeConnectionsChanged, this, [this] {
+        m_callManager->invalidate(ActiveConnInfoQuery);
+        queryActiveConnInfo();
+    }, Qt::QueuedConnection);
+    connect(m_backend, &NetworkBackend::activeConnectionsObjectChanged, this, [this] {
+        m_callManager->invalidate(ActiveConnInfoQuery);
+        queryActiveConnInfo();
+    }, Qt::QueuedConnection);
+    // 较大的 Json 属性在后台线程中解析
+    connect(m_backend, &NetworkBackend::activeConnectionsChanged, m_ingestPipeline, &IngestPipeline::submitActiveConnections);
+    connect(m_backend, &NetworkBackend::devicesChanged, m_ingestPipeline, &IngestPipeline::submitDevices);
+
+    connect(m_backend, &NetworkBackend::connectionsChanged, m_ingestPipeline, &IngestPipeline::submitConnections);
+    connect(m_backend, &NetworkBackend::deviceEnabled, m_networkModel, &NetworkModel::onDeviceEnableChanged);
+    connect(m_backend, &NetworkBackend::connectivityChanged, m_networkModel, &NetworkModel::onConnectivityChanged);
+    connect(m_backend, &NetworkBackend::wirelessAccessPointsChanged, m_ingestPipeline, &IngestPipeline::submitAccessPoints);
+    connect(m_backend, &NetworkBackend::connectionsCborChanged, m_ingestPipeline, &IngestPipeline::submitConnectionsCbor);
+    connect(m_backend, &NetworkBackend::wirelessAccessPointsCborChanged, m_ingestPipeline, &IngestPipeline::submitAccessPointsCbor);
+    connect(m_backend, &NetworkBackend::devicesObjectChanged, m_ingestPipeline, &IngestPipeline::submitDevicesObject);
+    connect(m_backend, &NetworkBackend::connectionsObjectChanged, m_ingestPipeline, &IngestPipeline::submitConnectionsObject);
+    connect(m_backend, &NetworkBackend::activeConnectionsObjectChanged, m_ingestPipeline, &IngestPipeline::submitActiveConnectionsObject);
+    connect(m_backend, &NetworkBackend::wirelessAccessPointsObjectChanged, m_ingestPipeline, &IngestPipeline::submitAccessPointsObject);
+    connect(m_backend, &NetworkBackend::vpnEnabledChanged, m_networkModel, &NetworkModel::onVPNEnabledChanged);
+    connect(m_backend, &NetworkBackend::needSecrets, m_networkModel, &NetworkModel::onNeedSecrets);
+    connect(m_backend, &NetworkBackend::needSecretsFinished, m_networkModel, &NetworkModel::onNeedSecretsFinished);
     connect(m_networkModel, &NetworkModel::requestDeviceStatus, this, &NetworkWorker::queryDeviceStatus, Qt::QueuedConnection);
+    connect(m_networkModel, &NetworkModel::requestWirelessScan, m_scanScheduler, &WirelessScanScheduler::requestScan);
+    connect(m_scanScheduler, &WirelessScanScheduler::scanRequired, this, [this] {
+        m_callManager->call("RequestWirelessScan", [this] {
+            return m_backend->requestWirelessScan();
+        });
+    });
+    // 设备列表变化后重新应用连接并查询活动连接信息; 事务只包含同步应用的连接列表,
+    // 不等待查询返回, 查询的结果各自作为一次 modelChanged 通知
     connect(m_networkModel, &NetworkModel::deviceListChanged, this, [=]() {
-        m_networkModel->onConnectionListChanged(m_networkInter.connections());
+        m_networkModel->beginUpdate();
+        applyPayload(IngestPipeline::Connections, m_backend->connections(), m_backend->connectionsCbor());
+        m_networkModel->endUpdate();
         queryActiveConnInfo();
     }, Qt::QueuedConnection);
 
-    connect(m_chainsInter, &ProxyChains::IPChanged, model, &NetworkModel::onChainsAddrChanged);
-    connect(m_chainsInter, &ProxyChains::PasswordChanged, model, &NetworkModel::onChainsPasswdChanged);
-    connect(m_chainsInter, &ProxyChains::TypeChanged, model, &NetworkModel::onChainsTypeChanged);
-    connect(m_chainsInter, &ProxyChains::UserChanged, model, &NetworkModel::onChainsUserChanged);
-    connect(m_chainsInter, &ProxyChains::PortChanged, model, &NetworkModel::onChainsPortChanged);
-
-    m_networkInter.setSync(false);
-    m_chainsInter->setSync(false);
+    connect(m_backend, &NetworkBackend::chainsIPChanged, model, &NetworkModel::onChainsAddrChanged);
+    connect(m_backend, &NetworkBackend::chainsPasswordChanged, model, &NetworkModel::onChainsPasswdChanged);
+    connect(m_backend, &NetworkBackend::chainsTypeChanged, model, &NetworkModel::onChainsTypeChanged);
+    connect(m_backend, &NetworkBackend::chainsUserChanged, model, &NetworkModel::onChainsUserChanged);
+    connect(m_backend, &NetworkBackend::chainsPortChanged, model, &NetworkModel::onChainsPortChanged);
 
     active(sync);
-    m_networkModel->onWirelessAccessPointsChanged(m_networkInter.wirelessAccessPoints());
+    applyPayload(IngestPipeline::AccessPoints, m_backend->wirelessAccessPoints(), m_backend->wirelessAccessPointsCbor());
 }
 
 void NetworkWorker::active(bool bSync)
 {
-    m_networkInter.blockSignals(false);
+    m_backend->blockSignals(false);
+
+    // 初始化时的全部数据作为一次变化通知界面
+    m_networkModel->beginUpdate();
 
     //如果需要立即显示网络模块，则需要在active中使用同步方式获取网络设备数据
     if (bSync) {
-        QDBusInterface inter(networkService,
-                             networkPath,
-                             networkService,
-                             QDBusConnection::sessionBus());
-        QVariant req = inter.property("Devices");
-        m_networkModel->onDevicesChanged(req.toString());
+        applyPayload(IngestPipeline::Devices, m_backend->fetchDevices());
         qDebug() << Q_FUNC_INFO << "network active ,get devices size :" << m_networkModel->devices().size();
     } else {
-        m_networkModel->onDevicesChanged(m_networkInter.devices());
+        applyPayload(IngestPipeline::Devices, m_backend->devices());
     }
-    m_networkModel->onConnectionListChanged(m_networkInter.connections());
-    m_networkModel->onVPNEnabledChanged(m_networkInter.vpnEnabled());
-    m_networkModel->onActiveConnectionsChanged(m_networkInter.activeConnections());
-    m_networkModel->onConnectivityChanged(static_cast<int>(m_networkInter.connectivity()));
+    applyPayload(IngestPipeline::Connections, m_backend->connections(), m_backend->connectionsCbor());
+    m_recorder->recordVpnEnabled(m_backend->vpnEnabled());
+    m_networkModel->onVPNEnabledChanged(m_backend->vpnEnabled());
+    applyPayload(IngestPipeline::ActiveConnections, m_backend->activeConnections());
+    m_recorder->recordConnectivity(m_backend->connectivity());
+    m_networkModel->onConnectivityChanged(m_backend->connectivity());
 
     queryActiveConnInfo();
 
     const bool isAppProxyVaild = QProcess::execute("which", QStringList() << "/usr/bin/proxychains4") == 0;
     m_networkModel->onAppProxyExistChanged(isAppProxyVaild);
+
+    m_networkModel->endUpdate();
 }
 
 void NetworkWorker::deactive()
 {
-    m_networkInter.blockSignals(true);
+    m_backend->blockSignals(true);
 }
 
 void NetworkWorker::setVpnEnable(const bool enable)
 {
-    m_networkInter.setVpnEnabled(enable);
+    m_backend->setVpnEnabled(enable);
 }
 
 void NetworkWorker::setDeviceEnable(const QString &devPath, const bool enable)
 {
-    m_networkInter.EnableDevice(QDBusObjectPath(devPath), enable);
+    m_callManager->call("EnableDevice", [=] {
+        return m_backend->enableDevice(devPath, enable);
+    });
 }
 
 void NetworkWorker::setProxyMethod(const QString &proxyMethod)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.SetProxyMethod(proxyMethod), this);
-
     // requery result
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryProxyMethod);
-    connect(w, &QDBusPendingCallWatcher::finished, w, &QDBusPendingCallWatcher::deleteLater);
+    m_callManager->call("SetProxyMethod", [=] {
+        return m_backend->setProxyMethod(proxyMethod);
+    }, [this](QDBusPendingCallWatcher *) {
+        m_callManager->invalidate(ProxyMethodQuery);
+        queryProxyMethod();
+    });
 }
 
 void NetworkWorker::setProxyIgnoreHosts(const QString &hosts)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.SetProxyIgnoreHosts(hosts), this);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryProxyIgnoreHosts);
-    connect(w, &QDBusPendingCallWatcher::finished, w, &QDBusPendingCallWatcher::deleteLater);
+    m_callManager->call("SetProxyIgnoreHosts", [=] {
+        return m_backend->setProxyIgnoreHosts(hosts);
+    }, [this](QDBusPendingCallWatcher *) {
+        m_callManager->invalidate(ProxyIgnoreHostsQuery);
+        queryProxyIgnoreHosts();
+    });
 }
 
 void NetworkWorker::setAutoProxy(const QString &proxy)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.SetAutoProxy(proxy), this);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryAutoProxy);
-    connect(w, &QDBusPendingCallWatcher::finished, w, &QDBusPendingCallWatcher::deleteLater);
+    m_callManager->call("SetAutoProxy", [=] {
+        return m_backend->setAutoProxy(proxy);
+    }, [this](QDBusPendingCallWatcher *) {
+        m_callManager->invalidate(AutoProxyQuery);
+        queryAutoProxy();
+    });
 }
 
 void NetworkWorker::setProxy(const QString &type, const QString &addr, const QString &port)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.SetProxy(type, addr, port), this);
-
-    connect(w, &QDBusPendingCallWatcher::finished, [=] { queryProxy(type); });
-    connect(w, &QDBusPendingCallWatcher::finished, w, &QDBusPendingCallWatcher::deleteLater);
+    m_callManager->call("SetProxy", [=] {
+        return m_backend->setProxy(type, addr, port);
+    }, [=](QDBusPendingCallWatcher *) {
+        m_callManager->invalidate(ProxyQuery.arg(type));
+        queryProxy(type);
+    });
 }
 
 void NetworkWorker::setChainsProxy(const ProxyConfig &config)
 {
-    m_chainsInter->Set(config.type, config.url, config.port, config.username, config.password);
+    m_callManager->call("ProxyChains.Set", [=] {
+        return m_backend->setChainsProxy(config.type, config.url, config.port, config.username, config.password);
+    });
 }
 
 void NetworkWorker::onChainsTypeChanged(const QString &type)
@@ -175,81 +283,192 @@ void NetworkWorker::onChainsTypeChanged(const QString &type)
 
 void NetworkWorker::feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, const bool autoConnect)
 {
-    m_networkInter.FeedSecret(connectionPath, settingName, password, autoConnect);
+    m_callManager->call("FeedSecret", [=] {
+        return m_backend->feedSecret(connectionPath, settingName, password, autoConnect);
+    });
 }
 void NetworkWorker::cancelSecret(const QString &connectionPath, const QString &settingName)
 {
-    m_networkInter.CancelSecret(connectionPath, settingName);
+    m_callManager->call("CancelSecret", [=] {
+        return m_backend->cancelSecret(connectionPath, settingName);
+    });
 }
 
 void NetworkWorker::initWirelessHotspot(const QString &devPath)
 {
-    m_networkInter.EnableWirelessHotspotMode(QDBusObjectPath(devPath));
+    m_callManager->call("EnableWirelessHotspotMode", [=] {
+        return m_backend->enableWirelessHotspotMode(devPath);
+    });
 }
 
 void NetworkWorker::queryProxy(const QString &type)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.asyncCall(QStringLiteral("GetProxy"), type), this);
-
-    w->setProperty("proxyType", type);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryProxyCB);
+    m_callManager->call("GetProxy", [=] {
+        return m_backend->getProxy(type);
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryProxyCB(w);
+    }, ProxyQuery.arg(type), { { "proxyType", type } });
 }
 
 void NetworkWorker::requestWirelessScan()
 {
-    m_networkInter.RequestWirelessScan();
+    // 主动刷新不受空闲扫描间隔的限制
+    m_scanScheduler->requestScanNow();
+}
+
+void NetworkWorker::setWirelessListVisible(const bool visible)
+{
+    m_scanScheduler->setListVisible(visible);
 }
 
 void NetworkWorker::queryChains()
 {
-    m_networkModel->onChainsTypeChanged(m_chainsInter->type());
-    m_networkModel->onChainsAddrChanged(m_chainsInter->iP());
-    m_networkModel->onChainsPortChanged(m_chainsInter->port());
-    m_networkModel->onChainsUserChanged(m_chainsInter->user());
-    m_networkModel->onChainsPasswdChanged(m_chainsInter->password());
+    // 一次 GetAll 代替五次同步的属性读取
+    m_callManager->call("Properties.GetAll", [this] {
+        return m_backend->getChainsProperties();
+    }, [this](QDBusPendingCallWatcher *w) {
+        if (w->isError()) {
+            qWarning() << "get proxychains properties failed:" << w->error().message();
+            return;
+        }
+
+        ProxySettings settings;
+        settings.fields = ProxySettings::Chains;
+        settings.chains = parseChainsProperties(replyValue<QVariantMap>(w));
+        m_networkModel->onProxySettingsChanged(settings);
+    }, ChainsQuery);
 }
 
 void NetworkWorker::queryAutoProxy()
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.GetAutoProxy(), this);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryAutoProxyCB);
+    m_callManager->call("GetAutoProxy", [this] {
+        return m_backend->getAutoProxy();
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryAutoProxyCB(w);
+    }, AutoProxyQuery);
 }
 
 void NetworkWorker::queryProxyData()
 {
-    queryProxy("http");
-    queryProxy("https");
-    queryProxy("ftp");
-    queryProxy("socks");
-    queryAutoProxy();
-    queryProxyMethod();
-    queryProxyIgnoreHosts();
+    // 已有批量请求在进行中, 直接复用其结果
+    if (m_proxyBatch)
+        return;
+
+    // 所有请求同时发出, 全部返回后作为一次更新应用到 model
+    QSharedPointer<ProxyBatch> batch(new ProxyBatch);
+    batch->pending = ProxyTypes.size() + 4;
+    m_proxyBatch = batch;
+
+    for (const QString &type : ProxyTypes) {
+        m_callManager->call("GetProxy", [=] {
+            return m_backend->getProxy(type);
+        }, [=](QDBusPendingCallWatcher *w) {
+            const QDBusMessage &reply = w->reply();
+            if (reply.type() == QDBusMessage::ReplyMessage && reply.arguments().size() >= 2) {
+                const ProxyConfig config = { reply.arguments()[1].toUInt(), type, reply.arguments()[0].toString(), "", "" };
+                batch->settings.proxies.insert(type, config);
+            }
+            finishProxyBatch(batch);
+        });
+    }
+
+    m_callManager->call("GetAutoProxy", [this] {
+        return m_backend->getAutoProxy();
+    }, [=](QDBusPendingCallWatcher *w) {
+        if (!w->isError()) {
+            batch->settings.autoProxy = replyValue<QString>(w);
+            batch->settings.fields |= ProxySettings::AutoProxy;
+        }
+        finishProxyBatch(batch);
+    });
+
+    m_callManager->call("GetProxyMethod", [this] {
+        return m_backend->getProxyMethod();
+    }, [=](QDBusPendingCallWatcher *w) {
+        if (!w->isError()) {
+            batch->settings.method = replyValue<QString>(w);
+            batch->settings.fields |= ProxySettings::Method;
+        }
+        finishProxyBatch(batch);
+    });
+
+    m_callManager->call("GetProxyIgnoreHosts", [this] {
+        return m_backend->getProxyIgnoreHosts();
+    }, [=](QDBusPendingCallWatcher *w) {
+        if (!w->isError()) {
+            batch->settings.ignoreHosts = replyValue<QString>(w);
+            batch->settings.fields |= ProxySettings::IgnoreHosts;
+        }
+        finishProxyBatch(batch);
+    });
+
+    m_callManager->call("Properties.GetAll", [this] {
+        return m_backend->getChainsProperties();
+    }, [=](QDBusPendingCallWatcher *w) {
+        if (!w->isError()) {
+            batch->settings.chains = parseChainsProperties(replyValue<QVariantMap>(w));
+            batch->settings.fields |= ProxySettings::Chains;
+        }
+        finishProxyBatch(batch);
+    });
+
+    // 超时的调用也会以错误回调, 这里只是兜底, 避免批量请求一直无法完成
+    QTimer::singleShot(PROXY_BATCH_TIMEOUT, this, [=] { applyProxyBatch(batch); });
 }
 
 void NetworkWorker::queryProxyMethod()
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.GetProxyMethod(), this);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryProxyMethodCB);
+    m_callManager->call("GetProxyMethod", [this] {
+        return m_backend->getProxyMethod();
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryProxyMethodCB(w);
+    }, ProxyMethodQuery);
 }
 
 void NetworkWorker::queryProxyIgnoreHosts()
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.GetProxyIgnoreHosts(), this);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryProxyIgnoreHostsCB);
+    m_callManager->call("GetProxyIgnoreHosts", [this] {
+        return m_backend->getProxyIgnoreHosts();
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryProxyIgnoreHostsCB(w);
+    }, ProxyIgnoreHostsQuery);
 }
 
 void NetworkWorker::queryActiveConnInfo()
 {
-    //需要及时更新网络连接状态
-    m_networkModel->onConnectivityChanged(static_cast<int>(m_networkInter.connectivity()));
+    //需要及时更新网络连接状态, 与活动连接信息一起异步获取, 避免在此处同步读取属性阻塞界面
+    queryConnectivity();
+
+    m_callManager->call("GetActiveConnectionInfo", [this] {
+        return m_backend->getActiveConnectionInfo();
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryActiveConnInfoCB(w);
+    }, ActiveConnInfoQuery);
+}
+
+void NetworkWorker::queryConnectivity()
+{
+    m_callManager->call("Properties.Get", [this] {
+        return m_backend->getConnectivity();
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryConnectivityCB(w);
+    }, ConnectivityQuery);
+}
+
+void NetworkWorker::finishProxyBatch(const QSharedPointer<ProxyBatch> &batch)
+{
+    if (--batch->pending == 0)
+        applyProxyBatch(batch);
+}
 
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.GetActiveConnectionInfo(), this);
+void NetworkWorker::applyProxyBatch(const QSharedPointer<ProxyBatch> &batch)
+{
+    // 已经应用过(全部返回或超时)的批量请求不再处理
+    if (m_proxyBatch != batch)
+        return;
 
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryActiveConnInfoCB);
+    m_proxyBatch.clear();
+    m_networkModel->onProxySettingsChanged(batch->settings);
 }
 
 void NetworkWorker::queryAccessPoints(const QString &devPath)
@@ -262,152 +481,196 @@ void NetworkWorker::queryConnectionSession(const QString &devPath, const QString
 {
     Q_ASSERT_X(!uuid.isEmpty(), Q_FUNC_INFO, "uuid is empty");
 
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.EditConnection(uuid, QDBusObjectPath(devPath)), this);
-
-    w->setProperty("devPath", devPath);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryConnectionSessionCB);
+    m_callManager->call("EditConnection", [=] {
+        return m_backend->editConnection(uuid, devPath);
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryConnectionSessionCB(w);
+    }, QString(), { { "devPath", devPath } });
 }
 
 void NetworkWorker::queryDeviceStatus(const QString &devPath)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.IsDeviceEnabled(QDBusObjectPath(devPath)), this);
-
-    w->setProperty("devPath", devPath);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryDeviceStatusCB);
+    m_callManager->call("IsDeviceEnabled", [=] {
+        return m_backend->isDeviceEnabled(devPath);
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryDeviceStatusCB(w);
+    }, DeviceStatusQuery.arg(devPath), { { "devPath", devPath } });
 }
 
 void NetworkWorker::remanageDevice(const QString &devPath)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.SetDeviceManaged(devPath, false));
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, [=] { m_networkInter.SetDeviceManaged(devPath, true); });
-    connect(w, &QDBusPendingCallWatcher::finished, w, &QDBusPendingCallWatcher::deleteLater);
+    m_callManager->call("SetDeviceManaged", [=] {
+        return m_backend->setDeviceManaged(devPath, false);
+    }, [=](QDBusPendingCallWatcher *) {
+        m_callManager->call("SetDeviceManaged", [=] {
+            return m_backend->setDeviceManaged(devPath, true);
+        });
+    });
 }
 
 void NetworkWorker::deleteConnection(const QString &uuid)
 {
-    m_networkInter.DeleteConnection(uuid);
+    m_callManager->call("DeleteConnection", [=] {
+        return m_backend->deleteConnection(uuid);
+    });
 }
 
 void NetworkWorker::deactiveConnection(const QString &uuid)
 {
-    m_networkInter.DeactivateConnection(uuid);
+    m_callManager->call("DeactivateConnection", [=] {
+        return m_backend->deactivateConnection(uuid);
+    });
 }
 
 void NetworkWorker::disconnectDevice(const QString &devPath)
 {
-    m_networkInter.DisconnectDevice(QDBusObjectPath(devPath));
+    m_callManager->call("DisconnectDevice", [=] {
+        return m_backend->disconnectDevice(devPath);
+    });
 }
 
 void NetworkWorker::createApConfig(const QString &devPath, const QString &apPath)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.CreateConnectionForAccessPoint(QDBusObjectPath(apPath), QDBusObjectPath(devPath)));
-
-    w->setProperty("devPath", devPath);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryConnectionSessionCB);
+    m_callManager->call("CreateConnectionForAccessPoint", [=] {
+        return m_backend->createConnectionForAccessPoint(apPath, devPath);
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryConnectionSessionCB(w);
+    }, QString(), { { "devPath", devPath } });
 }
 
 void NetworkWorker::createConnection(const QString &type, const QString &devPath)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.CreateConnection(type, QDBusObjectPath(devPath)));
-
-    w->setProperty("devPath", devPath);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::queryConnectionSessionCB);
+    m_callManager->call("CreateConnection", [=] {
+        return m_backend->createConnection(type, devPath);
+    }, [this](QDBusPendingCallWatcher *w) {
+        queryConnectionSessionCB(w);
+    }, QString(), { { "devPath", devPath } });
 }
 
 void NetworkWorker::activateConnection(const QString &devPath, const QString &uuid)
 {
-    m_networkInter.ActivateConnection(uuid, QDBusObjectPath(devPath));
+    const quint64 id = m_activationTracker->start("ActivateConnection", devPath, uuid);
+
+    m_callManager->call("ActivateConnection", [=] {
+        return m_backend->activateConnection(uuid, devPath);
+    }, [this, id](QDBusPendingCallWatcher *w) {
+        m_activationTracker->callFinished(id, w->isError() ? w->error().name() : QString());
+    });
 }
 
 void NetworkWorker::activateAccessPoint(const QString &devPath, const QString &apPath, const QString &uuid)
 {
-    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_networkInter.ActivateAccessPoint(uuid, QDBusObjectPath(apPath), QDBusObjectPath(devPath)));
+    const quint64 id = m_activationTracker->start("ActivateAccessPoint", devPath, uuid, apPath);
 
-    w->setProperty("devPath", devPath);
-    w->setProperty("apPath", apPath);
-    w->setProperty("uuid", uuid);
-
-    connect(w, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::activateAccessPointCB);
+    m_callManager->call("ActivateAccessPoint", [=] {
+        return m_backend->activateAccessPoint(uuid, apPath, devPath);
+    }, [this, id](QDBusPendingCallWatcher *w) {
+        m_activationTracker->callFinished(id, w->isError() ? w->error().name() : QString());
+        activateAccessPointCB(w);
+    }, QString(), { { "devPath", devPath }, { "apPath", apPath }, { "uuid", uuid } });
 }
 
+// 以下回调中的 watcher 由 PendingCallManager 负责释放
+// 调用出错或超时时 watcher 带有错误, 查询类的回调保留 model 中现有的值
+
 void NetworkWorker::activateAccessPointCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QDBusObjectPath> reply = *w;
-
     m_networkModel->onActivateAccessPointDone(w->property("devPath").toString(),
-            w->property("apPath").toString(), w->property("uuid").toString(), reply.value());
-
-    w->deleteLater();
+            w->property("apPath").toString(), w->property("uuid").toString(), replyValue<QDBusObjectPath>(w));
 }
 
 void NetworkWorker::queryAutoProxyCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QString> reply = *w;
-
-    m_networkModel->onAutoProxyChanged(reply.value());
+    if (w->isError())
+        return;
 
-    w->deleteLater();
+    m_networkModel->onAutoProxyChanged(replyValue<QString>(w));
 }
 
 void NetworkWorker::queryProxyCB(QDBusPendingCallWatcher *w)
 {
-    QDBusMessage reply = w->reply();
+    if (w->isError())
+        return;
 
     const QString &type = w->property("proxyType").toString();
-    const QString &addr = reply.arguments()[0].toString();
-    const uint port = reply.arguments()[1].toUInt();
+    const QString &addr = replyValue<QString>(w, 0);
+    const uint port = replyValue<uint>(w, 1);
 
     m_networkModel->onProxiesChanged(type, addr, port);
-
-    w->deleteLater();
 }
 
 void NetworkWorker::queryProxyMethodCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QString> reply = *w;
+    if (w->isError())
+        return;
 
-    m_networkModel->onProxyMethodChanged(reply.value());
-
-    w->deleteLater();
+    m_networkModel->onProxyMethodChanged(replyValue<QString>(w));
 }
 
 void NetworkWorker::queryProxyIgnoreHostsCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QString> reply = *w;
-
-    m_networkModel->onProxyIgnoreHostsChanged(reply.value());
+    if (w->isError())
+        return;
 
-    w->deleteLater();
+    m_networkModel->onProxyIgnoreHostsChanged(replyValue<QString>(w));
 }
 
 void NetworkWorker::queryConnectionSessionCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QDBusObjectPath> reply = *w;
-
-    m_networkModel->onConnectionSessionCreated(w->property("devPath").toString(), reply.value().path());
-
-    w->deleteLater();
+    m_networkModel->onConnectionSessionCreated(w->property("devPath").toString(), replyValue<QDBusObjectPath>(w).path());
 }
 
 void NetworkWorker::queryDeviceStatusCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<bool> reply = *w;
+    if (w->isError())
+        return;
 
-    m_networkModel->onDeviceEnableChanged(w->property("devPath").toString(), reply.value());
+    m_networkModel->onDeviceEnableChanged(w->property("devPath").toString(), replyValue<bool>(w));
+}
 
-    w->deleteLater();
+void NetworkWorker::queryConnectivityCB(QDBusPendingCallWatcher *w)
+{
+    if (w->isError()) {
+        qWarning() << "get connectivity failed:" << w->error().message();
+        return;
+    }
+
+    const int connectivity = replyValue<QDBusVariant>(w).variant().toInt();
+    m_recorder->recordConnectivity(connectivity);
+    m_networkModel->onConnectivityChanged(connectivity);
 }
 
 void NetworkWorker::queryActiveConnInfoCB(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QString> reply = *w;
+    if (w->isError()) {
+        qWarning() << "get active connection info failed:" << w->error().message();
+        return;
+    }
 
-    m_networkModel->onActiveConnInfoChanged(reply.value());
+    const QString info = replyValue<QString>(w);
+    m_recorder->record(SignalRecorder::ActiveConnInfo, info);
+    // 与属性数据一起排队, 在解析线程中解析并计算每个设备列表的哈希
+    m_ingestPipeline->submitActiveConnInfo(info);
+}
+
+void NetworkWorker::applyPayload(IngestPipeline::PayloadKind kind, const QString &payload)
+{
+    static_assert(int(IngestPipeline::Devices) == int(SignalRecorder::Devices)
+                  && int(IngestPipeline::ActiveConnInfo) == int(SignalRecorder::ActiveConnInfo),
+                  "payload kinds of IngestPipeline and SignalRecorder must match");
+
+    m_recorder->record(static_cast<SignalRecorder::Kind>(kind), payload);
+    m_ingestPipeline->apply(kind, payload);
+}
+
+void NetworkWorker::applyPayload(IngestPipeline::PayloadKind kind, const QString &payload, const QByteArray &cbor)
+{
+    if (cbor.isEmpty()) {
+        applyPayload(kind, payload);
+        return;
+    }
 
-    w->deleteLater();
+    // 在解析线程中解码后直接解析, 不转换为 Json 字符串
+    m_recorder->recordCbor(static_cast<SignalRecorder::Kind>(kind), cbor);
+    m_ingestPipeline->applyCbor(kind, cbor);
 }
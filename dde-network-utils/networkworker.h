@@ -27,29 +27,41 @@
 #define NETWORKWORKER_H
 
 #include "networkmodel.h"
+#include "wirelessscanscheduler.h"
+#include "pendingcallmanager.h"
+#include "ingestpipeline.h"
+#include "signalrecorder.h"
+#include "daemonnetworkbackend.h"
+#include "activationtracker.h"
 
 #include <QObject>
-
-#include <com_deepin_daemon_network.h>
-#include <com_deepin_daemon_network_proxychains.h>
+#include <QSharedPointer>
 
 namespace dde {
 
 namespace network {
 
-using NetworkInter = com::deepin::daemon::Network;
-using ProxyChains = com::deepin::daemon::network::ProxyChains;
-
 class NetworkWorker : public QObject
 {
     Q_OBJECT
 
 public:
     explicit NetworkWorker(NetworkModel *model, QObject *parent = nullptr, bool sync = false);
+    // backend 没有 parent 时由 worker 负责释放
+    NetworkWorker(NetworkBackend *backend, NetworkModel *model, QObject *parent = nullptr, bool sync = false);
 
     void active(bool bSync = false);
     void deactive();
 
+    WirelessScanScheduler *scanScheduler() const { return m_scanScheduler; }
+    NetworkBackend *backend() const { return m_backend; }
+    PendingCallManager *callManager() const { return m_callManager; }
+    IngestPipeline *ingestPipeline() const { return m_ingestPipeline; }
+    SignalRecorder *recorder() const { return m_recorder; }
+    ActivationTracker *activationTracker() const { return m_activationTracker; }
+    // 因已有相同的请求正在进行而被合并掉的 query 调用次数
+    quint64 dedupedQueryCount() const { return m_callManager->dedupedCount(); }
+
 public Q_SLOTS:
     void activateConnection(const QString &devPath, const QString &uuid);
     void activateAccessPoint(const QString &devPath, const QString &apPath, const QString &uuid);
@@ -60,6 +72,8 @@ public Q_SLOTS:
     void disconnectDevice(const QString &devPath);
     void initWirelessHotspot(const QString &devPath);
     void requestWirelessScan();
+    // 无线列表显示/隐藏时调用, 显示期间自动扫描使用更短的间隔; 显示与隐藏需要成对调用
+    void setWirelessListVisible(const bool visible);
     void queryChains();
     void queryAutoProxy();
     void queryProxyData();
@@ -91,11 +105,28 @@ private Q_SLOTS:
     void queryConnectionSessionCB(QDBusPendingCallWatcher *w);
     void queryDeviceStatusCB(QDBusPendingCallWatcher *w);
     void queryActiveConnInfoCB(QDBusPendingCallWatcher *w);
+    void queryConnectivityCB(QDBusPendingCallWatcher *w);
+
+private:
+    struct ProxyBatch;
+
+    void queryConnectivity();
+    // 同步应用从 backend 读取的数据, 并在录制时记录下来
+    void applyPayload(IngestPipeline::PayloadKind kind, const QString &payload);
+    // cbor 不为空时它比 payload 新, 改为应用 cbor
+    void applyPayload(IngestPipeline::PayloadKind kind, const QString &payload, const QByteArray &cbor);
+    void finishProxyBatch(const QSharedPointer<ProxyBatch> &batch);
+    void applyProxyBatch(const QSharedPointer<ProxyBatch> &batch);
 
 private:
-    NetworkInter m_networkInter;
-    ProxyChains *m_chainsInter;
+    NetworkBackend *m_backend;
     NetworkModel *m_networkModel;
+    WirelessScanScheduler *m_scanScheduler;
+    PendingCallManager *m_callManager;
+    IngestPipeline *m_ingestPipeline;
+    SignalRecorder *m_recorder;
+    ActivationTracker *m_activationTracker;
+    QSharedPointer<ProxyBatch> m_proxyBatch;
 };
 
 }   // namespace network
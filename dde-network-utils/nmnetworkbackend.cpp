@@ -0,0 +1,906 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "nmnetworkbackend.h"
+
+#include <QDBusArgument>
+#include <QDBusMetaType>
+#include <QDBusObjectPath>
+#include <QDBusPendingCallWatcher>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QDebug>
+
+// NMDeviceType
+#define NM_DEVICE_TYPE_ETHERNET     1
+#define NM_DEVICE_TYPE_WIFI         2
+// NMActiveConnectionState
+#define NM_ACTIVE_CONNECTION_STATE_ACTIVATED    2
+// NM80211ApFlags / NM80211ApSecurityFlags
+#define NM_802_11_AP_FLAGS_PRIVACY              0x1
+#define NM_802_11_AP_SEC_KEY_MGMT_802_1X        0x200
+
+using namespace dde::network;
+
+// 只有这些属性的变化需要通知 model, 其余属性 (如统计信息) 的变化只更新缓存
+static const QSet<QString> DeviceKeys { "Interface", "HwAddress", "PermHwAddress", "Managed", "InterfaceFlags",
+                                        "State", "Driver", "DeviceType" };
+static const QSet<QString> AccessPointKeys { "Ssid", "HwAddress", "Strength", "Flags", "WpaFlags", "RsnFlags", "Frequency" };
+static const QSet<QString> ActiveKeys { "Id", "Uuid", "Type", "State", "Devices", "Vpn", "Connection", "SpecificObject" };
+
+// 把 DBus 类型转换为便于缓存和比较的 Qt 类型: o -> QString, ao -> QStringList
+static QVariant normalized(const QVariant &value)
+{
+    if (value.userType() == qMetaTypeId<QDBusObjectPath>())
+        return value.value<QDBusObjectPath>().path();
+
+    QList<QDBusObjectPath> paths;
+    if (value.userType() == qMetaTypeId<QDBusArgument>()) {
+        const QDBusArgument arg = value.value<QDBusArgument>();
+        if (arg.currentSignature() != "ao")
+            return value;
+        paths = qdbus_cast<QList<QDBusObjectPath>>(arg);
+    } else if (value.userType() == qMetaTypeId<QList<QDBusObjectPath>>()) {
+        paths = value.value<QList<QDBusObjectPath>>();
+    } else {
+        return value;
+    }
+
+    QStringList list;
+    for (const QDBusObjectPath &path : paths)
+        list << path.path();
+    return list;
+}
+
+static QVariantMap normalized(const QVariantMap &map)
+{
+    QVariantMap result;
+    for (auto it(map.constBegin()); it != map.constEnd(); ++it)
+        result.insert(it.key(), normalized(it.value()));
+
+    return result;
+}
+
+// QMap::unite 会保留同名的旧值, 这里用新值覆盖
+static void merge(QVariantMap &props, const QVariantMap &changed)
+{
+    for (auto it(changed.constBegin()); it != changed.constEnd(); ++it)
+        props.insert(it.key(), it.value());
+}
+
+static bool containsAny(const QVariantMap &changed, const QSet<QString> &keys)
+{
+    for (auto it(changed.constBegin()); it != changed.constEnd(); ++it) {
+        if (keys.contains(it.key()))
+            return true;
+    }
+
+    return false;
+}
+
+static QString macAddress(const QVariant &value)
+{
+    const QByteArray bytes = value.toByteArray();
+    QStringList parts;
+    for (const char b : bytes)
+        parts << QString("%1").arg(static_cast<uchar>(b), 2, 16, QChar('0')).toUpper();
+
+    return parts.join(':');
+}
+
+static QString connectionType(const QString &nmType)
+{
+    if (nmType == "802-3-ethernet")
+        return "wired";
+    if (nmType == "802-11-wireless")
+        return "wireless";
+    if (nmType == "vpn" || nmType == "pppoe")
+        return nmType;
+
+    return QString();
+}
+
+static QString toJson(const QJsonObject &object)
+{
+    return QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact));
+}
+
+NmNetworkBackend::NmNetworkBackend(const QDBusConnection &bus, const QString &service, QObject *parent)
+    : NetworkBackend(parent)
+    , m_bus(bus)
+    , m_service(service)
+    , m_vpnEnabled(true)
+    , m_dirty(0)
+{
+    qDBusRegisterMetaType<NMVariantMapMap>();
+
+    // 路径为空时匹配服务的所有对象
+    m_bus.connect(m_service, QString(), DBUS_PROPERTIES_IFACE, "PropertiesChanged",
+                  this, SLOT(onPropertiesChanged(QDBusMessage)));
+    m_bus.connect(m_service, NM_SETTINGS_PATH, NM_SETTINGS_IFACE, "NewConnection",
+                  this, SLOT(onConnectionAdded(QDBusObjectPath)));
+    m_bus.connect(m_service, NM_SETTINGS_PATH, NM_SETTINGS_IFACE, "ConnectionRemoved",
+                  this, SLOT(onConnectionRemoved(QDBusObjectPath)));
+    m_bus.connect(m_service, QString(), NM_CONNECTION_IFACE, "Updated",
+                  this, SLOT(onConnectionUpdated(QDBusMessage)));
+
+    // NetworkManager 启动较晚或重启后重新读取全部数据.
+    // 读取完成后通过 *ObjectChanged 通知, 不发出 serviceRegistered, 以免 NetworkWorker 再同步读取一次设备
+    QDBusServiceWatcher *serviceWatcher = new QDBusServiceWatcher(m_service, m_bus, QDBusServiceWatcher::WatchForRegistration, this);
+    connect(serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, [this] {
+        qInfo() << m_service << "is registered";
+        loadAll();
+    });
+
+    loadAll();
+}
+
+QString NmNetworkBackend::devices() const
+{
+    return toJson(devicesObject());
+}
+
+QString NmNetworkBackend::connections() const
+{
+    return toJson(connectionsObject());
+}
+
+QString NmNetworkBackend::activeConnections() const
+{
+    return toJson(activeConnectionsObject());
+}
+
+QString NmNetworkBackend::wirelessAccessPoints() const
+{
+    return toJson(accessPointsObject());
+}
+
+int NmNetworkBackend::connectivity() const
+{
+    return static_cast<int>(m_manager.value("Connectivity").toUInt());
+}
+
+void NmNetworkBackend::setVpnEnabled(bool enabled)
+{
+    // VPN 总开关由 deepin 网络服务实现, 这里只保存状态
+    if (m_vpnEnabled == enabled)
+        return;
+
+    m_vpnEnabled = enabled;
+    Q_EMIT vpnEnabledChanged(enabled);
+}
+
+QString NmNetworkBackend::fetchDevices()
+{
+    const QVariantMap manager = getAll(NM_PATH, NM_IFACE);
+    if (!manager.isEmpty()) {
+        m_manager = manager;
+        updateDeviceList(m_manager.value("Devices").toStringList(), true);
+    }
+
+    return devices();
+}
+
+QDBusPendingCall NmNetworkBackend::activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath)
+{
+    const QString connPath = connectionPathByUuid(uuid);
+
+    // 没有保存的连接时由 NetworkManager 根据热点创建
+    if (connPath.isEmpty()) {
+        return call(NM_PATH, NM_IFACE, "AddAndActivateConnection",
+                    { QVariant::fromValue(NMVariantMapMap()), QVariant::fromValue(QDBusObjectPath(devPath)),
+                      QVariant::fromValue(QDBusObjectPath(apPath)) });
+    }
+
+    return call(NM_PATH, NM_IFACE, "ActivateConnection",
+                { QVariant::fromValue(QDBusObjectPath(connPath)), QVariant::fromValue(QDBusObjectPath(devPath)),
+                  QVariant::fromValue(QDBusObjectPath(apPath)) });
+}
+
+QDBusPendingCall NmNetworkBackend::activateConnection(const QString &uuid, const QString &devPath)
+{
+    const QString connPath = connectionPathByUuid(uuid);
+    if (connPath.isEmpty()) {
+        const QDBusMessage msg = QDBusMessage::createMethodCall(m_service, NM_PATH, NM_IFACE, "ActivateConnection");
+        return QDBusPendingCall::fromCompletedCall(msg.createErrorReply("org.freedesktop.NetworkManager.UnknownConnection",
+                                                                        QString("no connection with uuid %1").arg(uuid)));
+    }
+
+    return call(NM_PATH, NM_IFACE, "ActivateConnection",
+                { QVariant::fromValue(QDBusObjectPath(connPath)),
+                  QVariant::fromValue(QDBusObjectPath(devPath.isEmpty() ? QString("/") : devPath)),
+                  QVariant::fromValue(QDBusObjectPath("/")) });
+}
+
+QDBusPendingCall NmNetworkBackend::cancelSecret(const QString &connectionPath, const QString &settingName)
+{
+    Q_UNUSED(connectionPath);
+    Q_UNUSED(settingName);
+
+    return notSupported("CancelSecret");
+}
+
+QDBusPendingCall NmNetworkBackend::createConnection(const QString &type, const QString &devPath)
+{
+    Q_UNUSED(type);
+    Q_UNUSED(devPath);
+
+    return notSupported("CreateConnection");
+}
+
+QDBusPendingCall NmNetworkBackend::createConnectionForAccessPoint(const QString &apPath, const QString &devPath)
+{
+    Q_UNUSED(apPath);
+    Q_UNUSED(devPath);
+
+    return notSupported("CreateConnectionForAccessPoint");
+}
+
+QDBusPendingCall NmNetworkBackend::deactivateConnection(const QString &uuid)
+{
+    for (auto it(m_activeConns.constBegin()); it != m_activeConns.constEnd(); ++it) {
+        if (it.value().value("Uuid").toString() == uuid)
+            return call(NM_PATH, NM_IFACE, "DeactivateConnection", { QVariant::fromValue(QDBusObjectPath(it.key())) });
+    }
+
+    return localReply("DeactivateConnection");
+}
+
+QDBusPendingCall NmNetworkBackend::deleteConnection(const QString &uuid)
+{
+    const QString connPath = connectionPathByUuid(uuid);
+    if (connPath.isEmpty())
+        return localReply("Delete");
+
+    return call(connPath, NM_CONNECTION_IFACE, "Delete");
+}
+
+QDBusPendingCall NmNetworkBackend::disconnectDevice(const QString &devPath)
+{
+    return call(devPath, NM_DEVICE_IFACE, "Disconnect");
+}
+
+QDBusPendingCall NmNetworkBackend::editConnection(const QString &uuid, const QString &devPath)
+{
+    Q_UNUSED(uuid);
+    Q_UNUSED(devPath);
+
+    return notSupported("EditConnection");
+}
+
+QDBusPendingCall NmNetworkBackend::enableDevice(const QString &devPath, bool enabled)
+{
+    // 以关闭自动连接并断开来模拟 deepin 网络服务中的禁用设备
+    if (enabled) {
+        m_disabledDevices.remove(devPath);
+    } else {
+        m_disabledDevices.insert(devPath);
+        call(devPath, NM_DEVICE_IFACE, "Disconnect");
+    }
+
+    Q_EMIT deviceEnabled(devPath, enabled);
+
+    return call(devPath, DBUS_PROPERTIES_IFACE, "Set",
+                { QString(NM_DEVICE_IFACE), QString("Autoconnect"), QVariant::fromValue(QDBusVariant(enabled)) });
+}
+
+QDBusPendingCall NmNetworkBackend::enableWirelessHotspotMode(const QString &devPath)
+{
+    Q_UNUSED(devPath);
+
+    return notSupported("EnableWirelessHotspotMode");
+}
+
+QDBusPendingCall NmNetworkBackend::feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect)
+{
+    Q_UNUSED(connectionPath);
+    Q_UNUSED(settingName);
+    Q_UNUSED(password);
+    Q_UNUSED(autoConnect);
+
+    return notSupported("FeedSecret");
+}
+
+QDBusPendingCall NmNetworkBackend::getActiveConnectionInfo()
+{
+    const QString primary = m_manager.value("PrimaryConnection").toString();
+
+    QJsonArray infos;
+    for (auto it(m_activeConns.constBegin()); it != m_activeConns.constEnd(); ++it) {
+        const QVariantMap &conn = it.value();
+        if (conn.value("State").toUInt() != NM_ACTIVE_CONNECTION_STATE_ACTIVATED)
+            continue;
+
+        for (const QString &devPath : conn.value("Devices").toStringList()) {
+            infos.append(QJsonObject {
+                { "Device", devPath },
+                { "HwAddress", m_devices.value(devPath).value("HwAddress").toString() },
+                { "ConnectionUuid", conn.value("Uuid").toString() },
+                { "ConnectionName", conn.value("Id").toString() },
+                { "ConnectionType", connectionType(conn.value("Type").toString()) },
+                { "SettingPath", conn.value("Connection").toString() },
+                { "SpecificObject", conn.value("SpecificObject").toString() },
+                { "IsPrimaryConnection", it.key() == primary },
+            });
+        }
+    }
+
+    return localReply("GetActiveConnectionInfo", { QString::fromUtf8(QJsonDocument(infos).toJson(QJsonDocument::Compact)) });
+}
+
+QDBusPendingCall NmNetworkBackend::getAutoProxy()
+{
+    return localReply("GetAutoProxy", { QString() });
+}
+
+QDBusPendingCall NmNetworkBackend::getConnectivity()
+{
+    // 与 deepin 网络服务一样返回 Properties.Get 的 v; CheckConnectivity 返回的是 u, 而且会触发一次检测
+    return localReply("Get", { QVariant::fromValue(QDBusVariant(m_manager.value("Connectivity").toUInt())) });
+}
+
+QDBusPendingCall NmNetworkBackend::getProxy(const QString &type)
+{
+    Q_UNUSED(type);
+
+    return localReply("GetProxy", { QString(), QString("0") });
+}
+
+QDBusPendingCall NmNetworkBackend::getProxyIgnoreHosts()
+{
+    return localReply("GetProxyIgnoreHosts", { QString() });
+}
+
+QDBusPendingCall NmNetworkBackend::getProxyMethod()
+{
+    return localReply("GetProxyMethod", { QString("none") });
+}
+
+QDBusPendingCall NmNetworkBackend::isDeviceEnabled(const QString &devPath)
+{
+    return localReply("IsDeviceEnabled", { !m_disabledDevices.contains(devPath) });
+}
+
+QDBusPendingCall NmNetworkBackend::requestWirelessScan()
+{
+    QDBusPendingCall last = localReply("RequestScan");
+    for (auto it(m_devices.constBegin()); it != m_devices.constEnd(); ++it) {
+        if (it.value().value("DeviceType").toUInt() == NM_DEVICE_TYPE_WIFI)
+            last = call(it.key(), NM_WIRELESS_IFACE, "RequestScan", { QVariantMap() });
+    }
+
+    return last;
+}
+
+QDBusPendingCall NmNetworkBackend::setAutoProxy(const QString &proxy)
+{
+    Q_UNUSED(proxy);
+
+    return notSupported("SetAutoProxy");
+}
+
+QDBusPendingCall NmNetworkBackend::setDeviceManaged(const QString &devPath, bool managed)
+{
+    return call(devPath, DBUS_PROPERTIES_IFACE, "Set",
+                { QString(NM_DEVICE_IFACE), QString("Managed"), QVariant::fromValue(QDBusVariant(managed)) });
+}
+
+QDBusPendingCall NmNetworkBackend::setProxy(const QString &type, const QString &addr, const QString &port)
+{
+    Q_UNUSED(type);
+    Q_UNUSED(addr);
+    Q_UNUSED(port);
+
+    return notSupported("SetProxy");
+}
+
+QDBusPendingCall NmNetworkBackend::setProxyIgnoreHosts(const QString &hosts)
+{
+    Q_UNUSED(hosts);
+
+    return notSupported("SetProxyIgnoreHosts");
+}
+
+QDBusPendingCall NmNetworkBackend::setProxyMethod(const QString &proxyMethod)
+{
+    Q_UNUSED(proxyMethod);
+
+    return notSupported("SetProxyMethod");
+}
+
+QDBusPendingCall NmNetworkBackend::getChainsProperties()
+{
+    return localReply("GetAll", { QVariantMap() });
+}
+
+QDBusPendingCall NmNetworkBackend::setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password)
+{
+    Q_UNUSED(type);
+    Q_UNUSED(ip);
+    Q_UNUSED(port);
+    Q_UNUSED(user);
+    Q_UNUSED(password);
+
+    return notSupported("Set");
+}
+
+QJsonObject NmNetworkBackend::devicesObject() const
+{
+    QJsonArray wired;
+    QJsonArray wireless;
+
+    for (const QString &path : m_manager.value("Devices").toStringList()) {
+        const QVariantMap &props = m_devices.value(path);
+        const uint type = props.value("DeviceType").toUInt();
+        if (type != NM_DEVICE_TYPE_ETHERNET && type != NM_DEVICE_TYPE_WIFI)
+            continue;
+
+        // deepin 网络服务中 HwAddress 为真实地址, ClonedAddress 为当前使用的地址
+        const QString hwAddress = props.value("HwAddress").toString();
+        const QString permHwAddress = props.value("PermHwAddress").toString();
+
+        QJsonObject info {
+            { "Path", path },
+            { "Interface", props.value("Interface").toString() },
+            { "HwAddress", permHwAddress.isEmpty() ? hwAddress : permHwAddress },
+            { "Managed", props.value("Managed").toBool() },
+            { "State", static_cast<int>(props.value("State").toUInt()) },
+            { "Driver", props.value("Driver").toString() },
+        };
+        if (!permHwAddress.isEmpty() && permHwAddress.compare(hwAddress, Qt::CaseInsensitive) != 0)
+            info.insert("ClonedAddress", hwAddress);
+        if (props.contains("InterfaceFlags"))
+            info.insert("InterfaceFlags", static_cast<int>(props.value("InterfaceFlags").toUInt()));
+
+        if (type == NM_DEVICE_TYPE_ETHERNET)
+            wired.append(info);
+        else
+            wireless.append(info);
+    }
+
+    QJsonObject data;
+    if (!wired.isEmpty())
+        data.insert("wired", wired);
+    if (!wireless.isEmpty())
+        data.insert("wireless", wireless);
+
+    return data;
+}
+
+QJsonObject NmNetworkBackend::connectionsObject() const
+{
+    QMap<QString, QJsonArray> lists;
+
+    for (auto it(m_settings.constBegin()); it != m_settings.constEnd(); ++it) {
+        const NMVariantMapMap &settings = it.value();
+        const QVariantMap &conn = settings.value("connection");
+        const QString nmType = conn.value("type").toString();
+
+        QString type = connectionType(nmType);
+        if (type.isEmpty())
+            continue;
+
+        QJsonObject info {
+            { "Path", it.key() },
+            { "Uuid", conn.value("uuid").toString() },
+            { "Id", conn.value("id").toString() },
+            { "IfcName", conn.value("interface-name").toString() },
+            { "HwAddress", macAddress(settings.value(nmType).value("mac-address")) },
+        };
+
+        if (type == "wireless") {
+            const QVariantMap &wireless = settings.value(nmType);
+            info.insert("Ssid", QString::fromUtf8(wireless.value("ssid").toByteArray()));
+            if (wireless.value("mode").toString() == "ap")
+                type = "wireless-hotspot";
+        }
+
+        lists[type].append(info);
+    }
+
+    QJsonObject data;
+    for (auto it(lists.constBegin()); it != lists.constEnd(); ++it)
+        data.insert(it.key(), it.value());
+
+    return data;
+}
+
+QJsonObject NmNetworkBackend::activeConnectionsObject() const
+{
+    QJsonObject data;
+
+    for (auto it(m_activeConns.constBegin()); it != m_activeConns.constEnd(); ++it) {
+        const QVariantMap &props = it.value();
+        if (props.isEmpty())
+            continue;
+
+        data.insert(it.key(), QJsonObject {
+            { "Devices", QJsonArray::fromStringList(props.value("Devices").toStringList()) },
+            { "Uuid", props.value("Uuid").toString() },
+            { "Id", props.value("Id").toString() },
+            { "Type", props.value("Type").toString() },
+            { "State", static_cast<int>(props.value("State").toUInt()) },
+            { "Vpn", props.value("Vpn").toBool() },
+            { "SettingPath", props.value("Connection").toString() },
+            { "SpecificObject", props.value("SpecificObject").toString() },
+        });
+    }
+
+    return data;
+}
+
+QJsonObject NmNetworkBackend::accessPointsObject() const
+{
+    QJsonObject data;
+
+    for (auto dev(m_devices.constBegin()); dev != m_devices.constEnd(); ++dev) {
+        if (dev.value().value("DeviceType").toUInt() != NM_DEVICE_TYPE_WIFI)
+            continue;
+
+        QJsonArray list;
+        for (const QString &path : dev.value().value("AccessPoints").toStringList()) {
+            const QVariantMap &ap = m_accessPoints.value(path);
+            if (ap.isEmpty())
+                continue;
+
+            const uint security = ap.value("WpaFlags").toUInt() | ap.value("RsnFlags").toUInt();
+            list.append(QJsonObject {
+                { "Path", path },
+                { "Ssid", QString::fromUtf8(ap.value("Ssid").toByteArray()) },
+                { "Bssid", ap.value("HwAddress").toString() },
+                { "Strength", ap.value("Strength").toInt() },
+                { "Secured", (ap.value("Flags").toUInt() & NM_802_11_AP_FLAGS_PRIVACY) || security },
+                { "SecuredInEap", (security & NM_802_11_AP_SEC_KEY_MGMT_802_1X) != 0 },
+                { "Frequency", static_cast<int>(ap.value("Frequency").toUInt()) },
+            });
+        }
+        data.insert(dev.key(), list);
+    }
+
+    return data;
+}
+
+void NmNetworkBackend::onPropertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> args = message.arguments();
+    if (args.size() < 2)
+        return;
+
+    const QString path = message.path();
+    const QString interface = args.at(0).toString();
+    const QVariantMap changed = normalized(qdbus_cast<QVariantMap>(args.at(1)));
+
+    if (path == NM_PATH) {
+        if (interface == NM_IFACE)
+            updateManager(changed);
+    } else if (path.startsWith(NM_DEVICE_PREFIX)) {
+        if (m_devices.contains(path) && interface.startsWith(NM_DEVICE_IFACE))
+            updateDevice(path, changed);
+    } else if (path.startsWith(NM_AP_PREFIX)) {
+        auto it = m_accessPoints.find(path);
+        if (it == m_accessPoints.end() || it.value().isEmpty())
+            return;
+        merge(it.value(), changed);
+        if (containsAny(changed, AccessPointKeys))
+            markDirty(AccessPointsDirty);
+    } else if (path.startsWith(NM_ACTIVE_PREFIX)) {
+        auto it = m_activeConns.find(path);
+        if (it == m_activeConns.end() || it.value().isEmpty())
+            return;
+        merge(it.value(), changed);
+        if (containsAny(changed, ActiveKeys))
+            markDirty(ActiveConnectionsDirty);
+    }
+}
+
+void NmNetworkBackend::onConnectionAdded(const QDBusObjectPath &path)
+{
+    m_settings.insert(path.path(), NMVariantMapMap());
+    requestSettings(path.path());
+}
+
+void NmNetworkBackend::onConnectionRemoved(const QDBusObjectPath &path)
+{
+    if (m_settings.remove(path.path()))
+        markDirty(ConnectionsDirty);
+}
+
+void NmNetworkBackend::onConnectionUpdated(const QDBusMessage &message)
+{
+    if (m_settings.contains(message.path()))
+        requestSettings(message.path());
+}
+
+void NmNetworkBackend::loadAll()
+{
+    m_manager.clear();
+    m_devices.clear();
+    m_accessPoints.clear();
+    m_activeConns.clear();
+    m_settings.clear();
+    markDirty(DevicesDirty | ConnectionsDirty | ActiveConnectionsDirty | AccessPointsDirty);
+
+    // 全部异步读取, 各对象的属性读到后再合并通知, 服务未启动时请求直接失败
+    QDBusMessage msg = QDBusMessage::createMethodCall(m_service, NM_PATH, DBUS_PROPERTIES_IFACE, "GetAll");
+    msg << QString(NM_IFACE);
+
+    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_bus.asyncCall(msg), this);
+    connect(w, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *w) {
+        w->deleteLater();
+        if (w->isError()) {
+            qInfo() << "failed to load" << m_service << ":" << w->error().message();
+            return;
+        }
+
+        merge(m_manager, normalized(qdbus_cast<QVariantMap>(w->reply().arguments().value(0))));
+        updateDeviceList(m_manager.value("Devices").toStringList(), false);
+        updateActiveList(m_manager.value("ActiveConnections").toStringList(), false);
+        Q_EMIT connectivityChanged(connectivity());
+    });
+
+    const QDBusMessage listMsg = QDBusMessage::createMethodCall(m_service, NM_SETTINGS_PATH, NM_SETTINGS_IFACE, "ListConnections");
+    QDBusPendingCallWatcher *listWatcher = new QDBusPendingCallWatcher(m_bus.asyncCall(listMsg), this);
+    connect(listWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *w) {
+        w->deleteLater();
+        if (w->isError())
+            return;
+
+        for (const QString &path : normalized(w->reply().arguments().value(0)).toStringList()) {
+            if (m_settings.contains(path))
+                continue;
+            m_settings.insert(path, NMVariantMapMap());
+            requestSettings(path);
+        }
+    });
+}
+
+QVariantMap NmNetworkBackend::getAll(const QString &path, const QString &interface) const
+{
+    QDBusMessage msg = QDBusMessage::createMethodCall(m_service, path, DBUS_PROPERTIES_IFACE, "GetAll");
+    msg << interface;
+
+    const QDBusMessage reply = m_bus.call(msg);
+    if (reply.type() != QDBusMessage::ReplyMessage) {
+        qWarning() << "failed to get properties of" << path << interface << ":" << reply.errorMessage();
+        return QVariantMap();
+    }
+
+    return normalized(qdbus_cast<QVariantMap>(reply.arguments().value(0)));
+}
+
+void NmNetworkBackend::requestObject(const QString &path, const QString &interface)
+{
+    QDBusMessage msg = QDBusMessage::createMethodCall(m_service, path, DBUS_PROPERTIES_IFACE, "GetAll");
+    msg << interface;
+
+    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_bus.asyncCall(msg), this);
+    connect(w, &QDBusPendingCallWatcher::finished, this, [this, path, interface](QDBusPendingCallWatcher *w) {
+        w->deleteLater();
+        if (w->isError())
+            return;
+
+        const QVariantMap props = normalized(qdbus_cast<QVariantMap>(w->reply().arguments().value(0)));
+
+        // 请求期间对象已被移除时丢弃结果
+        if (path.startsWith(NM_DEVICE_PREFIX)) {
+            if (!m_devices.contains(path))
+                return;
+            updateDevice(path, props);
+            if (interface == NM_DEVICE_IFACE && props.value("DeviceType").toUInt() == NM_DEVICE_TYPE_WIFI)
+                requestObject(path, NM_WIRELESS_IFACE);
+        } else if (path.startsWith(NM_AP_PREFIX)) {
+            if (!m_accessPoints.contains(path))
+                return;
+            m_accessPoints[path] = props;
+            markDirty(AccessPointsDirty);
+        } else if (path.startsWith(NM_ACTIVE_PREFIX)) {
+            if (!m_activeConns.contains(path))
+                return;
+            m_activeConns[path] = props;
+            markDirty(ActiveConnectionsDirty);
+        }
+    });
+}
+
+void NmNetworkBackend::requestSettings(const QString &path)
+{
+    const QDBusMessage msg = QDBusMessage::createMethodCall(m_service, path, NM_CONNECTION_IFACE, "GetSettings");
+
+    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(m_bus.asyncCall(msg), this);
+    connect(w, &QDBusPendingCallWatcher::finished, this, [this, path](QDBusPendingCallWatcher *w) {
+        w->deleteLater();
+        if (w->isError() || !m_settings.contains(path))
+            return;
+
+        m_settings[path] = qdbus_cast<NMVariantMapMap>(w->reply().arguments().value(0));
+        markDirty(ConnectionsDirty);
+    });
+}
+
+void NmNetworkBackend::updateManager(const QVariantMap &changed)
+{
+    merge(m_manager, changed);
+
+    if (changed.contains("Devices"))
+        updateDeviceList(changed.value("Devices").toStringList(), false);
+    if (changed.contains("ActiveConnections"))
+        updateActiveList(changed.value("ActiveConnections").toStringList(), false);
+    if (changed.contains("Connectivity"))
+        Q_EMIT connectivityChanged(static_cast<int>(changed.value("Connectivity").toUInt()));
+}
+
+void NmNetworkBackend::updateDevice(const QString &path, const QVariantMap &changed)
+{
+    merge(m_devices[path], changed);
+
+    if (changed.contains("AccessPoints"))
+        updateAccessPointList(changed.value("AccessPoints").toStringList(), false);
+    if (containsAny(changed, DeviceKeys))
+        markDirty(DevicesDirty | AccessPointsDirty);
+}
+
+void NmNetworkBackend::updateDeviceList(const QStringList &paths, bool sync)
+{
+    for (auto it(m_devices.begin()); it != m_devices.end();) {
+        if (paths.contains(it.key()))
+            ++it;
+        else
+            it = m_devices.erase(it);
+    }
+
+    for (const QString &path : paths) {
+        if (m_devices.contains(path))
+            continue;
+
+        // 先占位, 异步读取的结果只在设备仍然存在时才保存
+        m_devices.insert(path, QVariantMap());
+        if (!sync) {
+            requestObject(path, NM_DEVICE_IFACE);
+            continue;
+        }
+
+        QVariantMap props = getAll(path, NM_DEVICE_IFACE);
+        if (props.value("DeviceType").toUInt() == NM_DEVICE_TYPE_WIFI)
+            merge(props, getAll(path, NM_WIRELESS_IFACE));
+        m_devices[path] = props;
+        updateAccessPointList(props.value("AccessPoints").toStringList(), true);
+    }
+
+    // 清理已移除设备的热点
+    updateAccessPointList(QStringList(), sync);
+    markDirty(DevicesDirty | AccessPointsDirty);
+}
+
+void NmNetworkBackend::updateActiveList(const QStringList &paths, bool sync)
+{
+    for (auto it(m_activeConns.begin()); it != m_activeConns.end();) {
+        if (paths.contains(it.key()))
+            ++it;
+        else
+            it = m_activeConns.erase(it);
+    }
+
+    for (const QString &path : paths) {
+        if (m_activeConns.contains(path))
+            continue;
+
+        if (sync) {
+            m_activeConns.insert(path, getAll(path, NM_ACTIVE_IFACE));
+        } else {
+            m_activeConns.insert(path, QVariantMap());
+            requestObject(path, NM_ACTIVE_IFACE);
+        }
+    }
+
+    markDirty(ActiveConnectionsDirty);
+}
+
+void NmNetworkBackend::updateAccessPointList(const QStringList &paths, bool sync)
+{
+    // 移除不再属于任何设备的热点
+    QSet<QString> referenced;
+    for (const QVariantMap &props : m_devices) {
+        for (const QString &path : props.value("AccessPoints").toStringList())
+            referenced << path;
+    }
+    for (auto it(m_accessPoints.begin()); it != m_accessPoints.end();) {
+        if (referenced.contains(it.key()))
+            ++it;
+        else
+            it = m_accessPoints.erase(it);
+    }
+
+    for (const QString &path : paths) {
+        if (m_accessPoints.contains(path))
+            continue;
+
+        if (sync) {
+            m_accessPoints.insert(path, getAll(path, NM_AP_IFACE));
+        } else {
+            m_accessPoints.insert(path, QVariantMap());
+            requestObject(path, NM_AP_IFACE);
+        }
+    }
+
+    markDirty(AccessPointsDirty);
+}
+
+void NmNetworkBackend::markDirty(int dirty)
+{
+    // 同一轮事件循环中的变化合并为一次通知
+    if (!m_dirty)
+        QTimer::singleShot(0, this, &NmNetworkBackend::flush);
+
+    m_dirty |= dirty;
+}
+
+void NmNetworkBackend::flush()
+{
+    const int dirty = m_dirty;
+    m_dirty = 0;
+
+    // 与 deepin 网络服务一样, 设备先于连接和热点更新; 这里只组装 Json 对象, 解析在解析线程中进行
+    if (dirty & DevicesDirty)
+        Q_EMIT devicesObjectChanged(devicesObject());
+    if (dirty & ConnectionsDirty)
+        Q_EMIT connectionsObjectChanged(connectionsObject());
+    if (dirty & ActiveConnectionsDirty)
+        Q_EMIT activeConnectionsObjectChanged(activeConnectionsObject());
+    if (dirty & AccessPointsDirty)
+        Q_EMIT wirelessAccessPointsObjectChanged(accessPointsObject());
+}
+
+QString NmNetworkBackend::connectionPathByUuid(const QString &uuid) const
+{
+    if (uuid.isEmpty())
+        return QString();
+
+    for (auto it(m_settings.constBegin()); it != m_settings.constEnd(); ++it) {
+        if (it.value().value("connection").value("uuid").toString() == uuid)
+            return it.key();
+    }
+
+    return QString();
+}
+
+QDBusPendingCall NmNetworkBackend::call(const QString &path, const QString &interface, const QString &method,
+                                        const QVariantList &arguments) const
+{
+    QDBusMessage msg = QDBusMessage::createMethodCall(m_service, path, interface, method);
+    msg.setArguments(arguments);
+
+    return m_bus.asyncCall(msg);
+}
+
+QDBusPendingCall NmNetworkBackend::localReply(const QString &method, const QVariantList &arguments) const
+{
+    const QDBusMessage msg = QDBusMessage::createMethodCall(m_service, NM_PATH, NM_IFACE, method);
+
+    return QDBusPendingCall::fromCompletedCall(msg.createReply(arguments));
+}
+
+QDBusPendingCall NmNetworkBackend::notSupported(const QString &method) const
+{
+    const QDBusMessage msg = QDBusMessage::createMethodCall(m_service, NM_PATH, NM_IFACE, method);
+
+    return QDBusPendingCall::fromCompletedCall(msg.createErrorReply(QDBusError::NotSupported,
+                                                                    method + " is provided by com.deepin.daemon.Network"));
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NMNETWORKBACKEND_H
+#define NMNETWORKBACKEND_H
+
+#include "networkbackend.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QJsonObject>
+#include <QMap>
+#include <QSet>
+#include <QVariantMap>
+
+#define NM_SERVICE              "org.freedesktop.NetworkManager"
+#define NM_PATH                 "/org/freedesktop/NetworkManager"
+#define NM_SETTINGS_PATH        "/org/freedesktop/NetworkManager/Settings"
+#define NM_DEVICE_PREFIX        "/org/freedesktop/NetworkManager/Devices/"
+#define NM_AP_PREFIX            "/org/freedesktop/NetworkManager/AccessPoint/"
+#define NM_ACTIVE_PREFIX        "/org/freedesktop/NetworkManager/ActiveConnection/"
+#define NM_SETTINGS_PREFIX      "/org/freedesktop/NetworkManager/Settings/"
+
+#define NM_IFACE                "org.freedesktop.NetworkManager"
+#define NM_SETTINGS_IFACE       "org.freedesktop.NetworkManager.Settings"
+#define NM_CONNECTION_IFACE     "org.freedesktop.NetworkManager.Settings.Connection"
+#define NM_DEVICE_IFACE         "org.freedesktop.NetworkManager.Device"
+#define NM_WIRELESS_IFACE       "org.freedesktop.NetworkManager.Device.Wireless"
+#define NM_AP_IFACE             "org.freedesktop.NetworkManager.AccessPoint"
+#define NM_ACTIVE_IFACE         "org.freedesktop.NetworkManager.Connection.Active"
+#define DBUS_PROPERTIES_IFACE   "org.freedesktop.DBus.Properties"
+
+// Settings.Connection.GetSettings 返回的 a{sa{sv}}
+typedef QMap<QString, QVariantMap> NMVariantMapMap;
+Q_DECLARE_METATYPE(NMVariantMapMap)
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief NmNetworkBackend 直接访问 NetworkManager, 不经过 com.deepin.daemon.Network
+ *
+ * 启动和服务重启时异步读取各对象的属性, 之后只根据 PropertiesChanged 中变化的属性更新本地缓存;
+ * 只有 fetchDevices() 同步读取. 异步读取完成前 devices() 等接口返回空的数据.
+ * 同一轮事件循环中的变化合并后, 直接构造 Json 对象通过 *ObjectChanged 信号发出, 不生成 Json 字符串;
+ * 只有 devices() 等属性读取接口 (初始化时使用) 返回与 deepin 网络服务相同格式的 Json.
+ *
+ * 代理, 密码代理以及创建和编辑连接的会话由 deepin 网络服务提供, 本后端不支持,
+ * 代理的查询返回空值, 其他调用返回 NotSupported 错误.
+ */
+class NmNetworkBackend : public NetworkBackend
+{
+    Q_OBJECT
+
+public:
+    explicit NmNetworkBackend(const QDBusConnection &bus = QDBusConnection::systemBus(),
+                              const QString &service = NM_SERVICE, QObject *parent = nullptr);
+
+    QString devices() const override;
+    QString connections() const override;
+    QString activeConnections() const override;
+    QString wirelessAccessPoints() const override;
+    bool vpnEnabled() const override { return m_vpnEnabled; }
+    int connectivity() const override;
+    void setVpnEnabled(bool enabled) override;
+    QString fetchDevices() override;
+
+    QDBusPendingCall activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath) override;
+    QDBusPendingCall activateConnection(const QString &uuid, const QString &devPath) override;
+    QDBusPendingCall cancelSecret(const QString &connectionPath, const QString &settingName) override;
+    QDBusPendingCall createConnection(const QString &type, const QString &devPath) override;
+    QDBusPendingCall createConnectionForAccessPoint(const QString &apPath, const QString &devPath) override;
+    QDBusPendingCall deactivateConnection(const QString &uuid) override;
+    QDBusPendingCall deleteConnection(const QString &uuid) override;
+    QDBusPendingCall disconnectDevice(const QString &devPath) override;
+    QDBusPendingCall editConnection(const QString &uuid, const QString &devPath) override;
+    QDBusPendingCall enableDevice(const QString &devPath, bool enabled) override;
+    QDBusPendingCall enableWirelessHotspotMode(const QString &devPath) override;
+    QDBusPendingCall feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect) override;
+    QDBusPendingCall getActiveConnectionInfo() override;
+    QDBusPendingCall getAutoProxy() override;
+    QDBusPendingCall getConnectivity() override;
+    QDBusPendingCall getProxy(const QString &type) override;
+    QDBusPendingCall getProxyIgnoreHosts() override;
+    QDBusPendingCall getProxyMethod() override;
+    QDBusPendingCall isDeviceEnabled(const QString &devPath) override;
+    QDBusPendingCall requestWirelessScan() override;
+    QDBusPendingCall setAutoProxy(const QString &proxy) override;
+    QDBusPendingCall setDeviceManaged(const QString &devPath, bool managed) override;
+    QDBusPendingCall setProxy(const QString &type, const QString &addr, const QString &port) override;
+    QDBusPendingCall setProxyIgnoreHosts(const QString &hosts) override;
+    QDBusPendingCall setProxyMethod(const QString &proxyMethod) override;
+
+    QDBusPendingCall getChainsProperties() override;
+    QDBusPendingCall setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password) override;
+
+    // 以下为本地缓存对应的 Json, 格式与 deepin 网络服务的属性相同
+    QJsonObject devicesObject() const;
+    QJsonObject connectionsObject() const;
+    QJsonObject activeConnectionsObject() const;
+    QJsonObject accessPointsObject() const;
+
+private Q_SLOTS:
+    void onPropertiesChanged(const QDBusMessage &message);
+    void onConnectionAdded(const QDBusObjectPath &path);
+    void onConnectionRemoved(const QDBusObjectPath &path);
+    void onConnectionUpdated(const QDBusMessage &message);
+
+private:
+    enum Dirty {
+        DevicesDirty = 0x1,
+        ConnectionsDirty = 0x2,
+        ActiveConnectionsDirty = 0x4,
+        AccessPointsDirty = 0x8
+    };
+
+    void loadAll();
+    QVariantMap getAll(const QString &path, const QString &interface) const;
+    void requestObject(const QString &path, const QString &interface);
+    void requestSettings(const QString &path);
+
+    void updateManager(const QVariantMap &changed);
+    void updateDevice(const QString &path, const QVariantMap &changed);
+    void updateDeviceList(const QStringList &paths, bool sync);
+    void updateActiveList(const QStringList &paths, bool sync);
+    void updateAccessPointList(const QStringList &paths, bool sync);
+
+    void markDirty(int dirty);
+    void flush();
+
+    QString connectionPathByUuid(const QString &uuid) const;
+    QDBusPendingCall call(const QString &path, const QString &interface, const QString &method,
+                          const QVariantList &arguments = QVariantList()) const;
+    QDBusPendingCall localReply(const QString &method, const QVariantList &arguments = QVariantList()) const;
+    QDBusPendingCall notSupported(const QString &method) const;
+
+private:
+    QDBusConnection m_bus;
+    const QString m_service;
+
+    QVariantMap m_manager;
+    // 以对象路径为键的属性缓存, 设备的属性包括 Device 和 Device.Wireless 接口
+    QMap<QString, QVariantMap> m_devices;
+    QMap<QString, QVariantMap> m_accessPoints;
+    QMap<QString, QVariantMap> m_activeConns;
+    QMap<QString, NMVariantMapMap> m_settings;
+
+    QSet<QString> m_disabledDevices;
+    bool m_vpnEnabled;
+    int m_dirty;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // NMNETWORKBACKEND_H
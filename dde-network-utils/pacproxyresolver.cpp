@@ -0,0 +1,495 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pacproxyresolver.h"
+#include "networkmodel.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QHostInfo>
+#include <QNetworkInterface>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QJSEngine>
+#include <QQmlEngine>
+
+#include <algorithm>
+
+#define DEFAULT_CACHE_TTL (5 * 60 * 1000) // 5分钟
+#define LOAD_TIMEOUT (30 * 1000) // 30s超时
+#define MAX_CACHE_SIZE 1024
+#define DNS_CACHE_TTL (60 * 1000) // 1分钟
+
+using namespace dde::network;
+
+// 缓存已满时先删除过期的条目, 仍然是满的时按写入顺序淘汰最早的四分之一, 而不是整个清空
+template <typename Entry>
+static void evictCache(QHash<QString, Entry> &cache, qint64 now)
+{
+    if (cache.size() < MAX_CACHE_SIZE)
+        return;
+
+    for (auto it = cache.begin(); it != cache.end();)
+        it = it->expiry <= now ? cache.erase(it) : ++it;
+    if (cache.size() < MAX_CACHE_SIZE)
+        return;
+
+    QVector<quint64> sequences;
+    sequences.reserve(cache.size());
+    for (const Entry &entry : cache)
+        sequences << entry.sequence;
+
+    // 写入序号互不相同, 小于第 count 小的序号的条目正好有 count 个
+    const int count = cache.size() / 4;
+    std::nth_element(sequences.begin(), sequences.begin() + count, sequences.end());
+    const quint64 threshold = sequences.at(count);
+
+    for (auto it = cache.begin(); it != cache.end();)
+        it = it->sequence < threshold ? cache.erase(it) : ++it;
+}
+
+// PAC 规范中定义的辅助函数, dnsResolve 和 myIpAddress 由 PacEvaluator 实现
+static const char *PacHelpers = R"PAC(
+function isPlainHostName(host) {
+    return host.indexOf('.') < 0;
+}
+function dnsDomainIs(host, domain) {
+    return host.length >= domain.length && host.substring(host.length - domain.length) == domain;
+}
+function localHostOrDomainIs(host, hostdom) {
+    return host == hostdom || hostdom.lastIndexOf(host + '.', 0) == 0;
+}
+function dnsResolve(host) {
+    var ip = __pac.dnsResolve(host);
+    return ip ? ip : null;
+}
+function isResolvable(host) {
+    return !!__pac.dnsResolve(host);
+}
+function myIpAddress() {
+    return __pac.myIpAddress();
+}
+function dnsDomainLevels(host) {
+    return host.split('.').length - 1;
+}
+function convert_addr(ipchars) {
+    var b = ipchars.split('.');
+    return ((b[0] & 0xff) << 24 | (b[1] & 0xff) << 16 | (b[2] & 0xff) << 8 | (b[3] & 0xff)) >>> 0;
+}
+function isInNet(ipaddr, pattern, maskstr) {
+    if (!/^\d+\.\d+\.\d+\.\d+$/.test(ipaddr)) {
+        ipaddr = dnsResolve(ipaddr);
+        if (!ipaddr)
+            return false;
+    }
+    var mask = convert_addr(maskstr);
+    return ((convert_addr(ipaddr) & mask) >>> 0) == ((convert_addr(pattern) & mask) >>> 0);
+}
+function shExpMatch(str, shexp) {
+    var re = shexp.replace(/[.+^${}()|[\]\\]/g, '\\$&').replace(/\*/g, '.*').replace(/\?/g, '.');
+    return new RegExp('^' + re + '$').test(str);
+}
+
+var __days = ['SUN', 'MON', 'TUE', 'WED', 'THU', 'FRI', 'SAT'];
+var __months = ['JAN', 'FEB', 'MAR', 'APR', 'MAY', 'JUN', 'JUL', 'AUG', 'SEP', 'OCT', 'NOV', 'DEC'];
+
+function __now(gmt) {
+    var d = new Date();
+    if (gmt)
+        return { day: d.getUTCDay(), date: d.getUTCDate(), month: d.getUTCMonth(), year: d.getUTCFullYear(),
+                 hour: d.getUTCHours(), min: d.getUTCMinutes(), sec: d.getUTCSeconds() };
+    return { day: d.getDay(), date: d.getDate(), month: d.getMonth(), year: d.getFullYear(),
+             hour: d.getHours(), min: d.getMinutes(), sec: d.getSeconds() };
+}
+function __inRange(v, lo, hi) {
+    return lo <= hi ? (v >= lo && v <= hi) : (v >= lo || v <= hi);
+}
+function __args(args) {
+    var list = Array.prototype.slice.call(args);
+    var gmt = list.length > 0 && list[list.length - 1] == 'GMT';
+    if (gmt)
+        list.pop();
+    return { list: list, gmt: gmt };
+}
+function weekdayRange() {
+    var a = __args(arguments);
+    var lo = __days.indexOf(a.list[0]);
+    var hi = a.list.length > 1 ? __days.indexOf(a.list[1]) : lo;
+    return lo >= 0 && hi >= 0 && __inRange(__now(a.gmt).day, lo, hi);
+}
+function timeRange() {
+    var a = __args(arguments), t = __now(a.gmt), l = a.list;
+    var now = t.hour * 3600 + t.min * 60 + t.sec;
+    switch (l.length) {
+    case 1: return t.hour == l[0];
+    case 2: return __inRange(t.hour, l[0], l[1] - 1);
+    case 4: return __inRange(now, l[0] * 3600 + l[1] * 60, l[2] * 3600 + l[3] * 60 + 59);
+    case 6: return __inRange(now, l[0] * 3600 + l[1] * 60 + l[2], l[3] * 3600 + l[4] * 60 + l[5]);
+    }
+    return false;
+}
+function __dateKey(parts) {
+    var k = { y: -1, m: -1, d: -1 };
+    for (var i = 0; i < parts.length; ++i) {
+        if (typeof parts[i] == 'string')
+            k.m = __months.indexOf(parts[i]);
+        else if (parts[i] > 31)
+            k.y = parts[i];
+        else
+            k.d = parts[i];
+    }
+    return k;
+}
+function __dateValue(k) {
+    return Math.max(k.y, 0) * 10000 + Math.max(k.m, 0) * 100 + Math.max(k.d, 0);
+}
+function dateRange() {
+    var a = __args(arguments), t = __now(a.gmt), l = a.list;
+    if (l.length == 0)
+        return false;
+    var half = (l.length == 1 || l.length == 3) ? l.length : l.length / 2;
+    var lo = __dateKey(l.slice(0, half));
+    var hi = half == l.length ? lo : __dateKey(l.slice(half));
+    var now = { y: lo.y >= 0 ? t.year : -1, m: lo.m >= 0 ? t.month : -1, d: lo.d >= 0 ? t.date : -1 };
+    return __inRange(__dateValue(now), __dateValue(lo), __dateValue(hi));
+}
+)PAC";
+
+PacEvaluator::PacEvaluator(QObject *parent)
+    : QObject(parent)
+    , m_engine(nullptr)
+    , m_ready(false)
+    , m_nam(nullptr)
+    , m_download(nullptr)
+    , m_downloadGeneration(0)
+    , m_dnsSequence(0)
+{
+    m_clock.start();
+}
+
+QString PacEvaluator::dnsResolve(const QString &host)
+{
+    // 同步查询会阻塞 PAC 线程, 这里只读取缓存, 未命中时发起异步查询
+    auto it = m_dnsCache.constFind(host);
+    if (it != m_dnsCache.constEnd() && it->expiry > m_clock.elapsed())
+        return it->address;
+
+    m_missedHosts.insert(host);
+    if (!m_lookups.contains(host)) {
+        m_lookups.insert(host);
+        QHostInfo::lookupHost(host, this, [this, host](const QHostInfo &info) {
+            onHostLookedUp(host, info);
+        });
+    }
+
+    return QString();
+}
+
+QString PacEvaluator::myIpAddress() const
+{
+    for (const QHostAddress &address : QNetworkInterface::allAddresses()) {
+        if (address.protocol() == QAbstractSocket::IPv4Protocol && !address.isLoopback())
+            return address.toString();
+    }
+
+    return QStringLiteral("127.0.0.1");
+}
+
+void PacEvaluator::loadScript(quint64 generation, const QUrl &url)
+{
+    if (url.isLocalFile() || url.scheme().isEmpty()) {
+        QByteArray script;
+        QFile file(url.isLocalFile() ? url.toLocalFile() : url.path());
+        if (file.open(QIODevice::ReadOnly))
+            script = file.readAll();
+        else
+            qWarning() << "failed to open pac file:" << file.fileName() << file.errorString();
+
+        loadScriptContent(generation, QString::fromUtf8(script));
+        return;
+    }
+
+    abortDownload();
+
+    if (!m_nam)
+        m_nam = new QNetworkAccessManager(this);
+
+    m_download = m_nam->get(QNetworkRequest(url));
+    m_downloadGeneration = generation;
+    connect(m_download, &QNetworkReply::finished, this, &PacEvaluator::onScriptDownloaded);
+    QTimer::singleShot(LOAD_TIMEOUT, m_download, &QNetworkReply::abort);
+}
+
+void PacEvaluator::onScriptDownloaded()
+{
+    QNetworkReply *reply = m_download;
+    m_download = nullptr;
+    reply->deleteLater();
+
+    QByteArray script;
+    if (reply->error() == QNetworkReply::NoError)
+        script = reply->readAll();
+    else
+        qWarning() << "failed to download pac file:" << reply->url() << reply->errorString();
+
+    loadScriptContent(m_downloadGeneration, QString::fromUtf8(script));
+}
+
+void PacEvaluator::abortDownload()
+{
+    if (!m_download)
+        return;
+
+    // 已被新的脚本取代, 不再处理它的结果
+    m_download->disconnect(this);
+    m_download->abort();
+    m_download->deleteLater();
+    m_download = nullptr;
+}
+
+void PacEvaluator::loadScriptContent(quint64 generation, const QString &script)
+{
+    abortDownload();
+
+    // 每个脚本使用新的引擎, 避免上一个脚本定义的全局变量残留
+    delete m_engine;
+    m_engine = nullptr;
+    m_ready = false;
+
+    // 等待下载的请求在脚本加载后执行, 此时 m_download 已经为空
+    const QList<Evaluation> deferred = m_deferred;
+    m_deferred.clear();
+    auto runDeferred = [this, deferred] {
+        for (const Evaluation &evaluation : deferred)
+            evaluate(evaluation.generation, evaluation.url);
+    };
+
+    if (script.isEmpty()) {
+        Q_EMIT scriptLoaded(generation, false);
+        runDeferred();
+        return;
+    }
+
+    m_engine = new QJSEngine(this);
+
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+    m_engine->globalObject().setProperty("__pac", m_engine->newQObject(this));
+    m_engine->evaluate(PacHelpers);
+
+    const QJSValue result = m_engine->evaluate(script);
+    m_ready = !result.isError() && m_engine->globalObject().property("FindProxyForURL").isCallable();
+    if (!m_ready)
+        qWarning() << "invalid pac script:" << result.toString();
+
+    Q_EMIT scriptLoaded(generation, m_ready);
+    runDeferred();
+}
+
+void PacEvaluator::evaluate(quint64 generation, const QUrl &url)
+{
+    if (m_download) {
+        m_deferred << Evaluation { generation, url, QSet<QString>() };
+        return;
+    }
+
+    const QString host = url.host().toLower();
+    if (!m_ready) {
+        Q_EMIT evaluated(generation, host, QStringLiteral("DIRECT"));
+        return;
+    }
+
+    m_missedHosts.clear();
+    QJSValue findProxy = m_engine->globalObject().property("FindProxyForURL");
+    const QJSValue result = findProxy.call(QJSValueList() << url.toString() << host);
+
+    // 这次的结果基于不完整的查询结果, 丢弃后等查询返回再重新执行
+    if (!m_missedHosts.isEmpty()) {
+        m_waitingForDns << Evaluation { generation, url, m_missedHosts };
+        m_missedHosts.clear();
+        return;
+    }
+
+    if (result.isError()) {
+        qWarning() << "FindProxyForURL failed:" << url << result.toString();
+        Q_EMIT evaluated(generation, host, QStringLiteral("DIRECT"));
+        return;
+    }
+
+    Q_EMIT evaluated(generation, host, result.toString());
+}
+
+void PacEvaluator::onHostLookedUp(const QString &host, const QHostInfo &info)
+{
+    QString address;
+    for (const QHostAddress &candidate : info.addresses()) {
+        if (candidate.protocol() == QAbstractSocket::IPv4Protocol) {
+            address = candidate.toString();
+            break;
+        }
+    }
+
+    // 查询失败也缓存, 以免重新执行时再次未命中
+    const qint64 now = m_clock.elapsed();
+    evictCache(m_dnsCache, now);
+    m_dnsCache.insert(host, { address, ++m_dnsSequence, now + DNS_CACHE_TTL });
+    m_lookups.remove(host);
+
+    QList<Evaluation> ready;
+    for (auto it = m_waitingForDns.begin(); it != m_waitingForDns.end();) {
+        it->hosts.remove(host);
+        if (it->hosts.isEmpty()) {
+            ready << *it;
+            it = m_waitingForDns.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const Evaluation &evaluation : ready)
+        evaluate(evaluation.generation, evaluation.url);
+}
+
+PacProxyResolver::PacProxyResolver(NetworkModel *model, QObject *parent)
+    : QObject(parent)
+    , m_evaluator(new PacEvaluator)
+    , m_thread(new QThread(this))
+    , m_ready(false)
+    , m_generation(0)
+    , m_cacheTtl(DEFAULT_CACHE_TTL)
+    , m_cacheSequence(0)
+{
+    m_evaluator->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_evaluator, &PacEvaluator::deleteLater);
+
+    connect(this, &PacProxyResolver::requestLoadScript, m_evaluator, &PacEvaluator::loadScript);
+    connect(this, &PacProxyResolver::requestLoadScriptContent, m_evaluator, &PacEvaluator::loadScriptContent);
+    connect(this, &PacProxyResolver::requestEvaluate, m_evaluator, &PacEvaluator::evaluate);
+    connect(m_evaluator, &PacEvaluator::scriptLoaded, this, &PacProxyResolver::onScriptLoaded);
+    connect(m_evaluator, &PacEvaluator::evaluated, this, &PacProxyResolver::onEvaluated);
+
+    m_clock.start();
+    m_thread->start();
+
+    if (model) {
+        connect(model, &NetworkModel::autoProxyChanged, this, &PacProxyResolver::setScriptUrl);
+        if (!model->autoProxy().isEmpty())
+            setScriptUrl(model->autoProxy());
+    }
+}
+
+PacProxyResolver::~PacProxyResolver()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void PacProxyResolver::setCacheTtl(int msec)
+{
+    m_cacheTtl = qMax(0, msec);
+}
+
+const QString PacProxyResolver::cachedProxy(const QUrl &url) const
+{
+    auto it = m_cache.constFind(url.host().toLower());
+    if (it == m_cache.constEnd() || it->expiry <= m_clock.elapsed())
+        return QString();
+
+    return it->proxy;
+}
+
+void PacProxyResolver::resolve(const QUrl &url)
+{
+    const QString proxy = cachedProxy(url);
+    if (!proxy.isEmpty()) {
+        Q_EMIT proxyResolved(url, proxy);
+        return;
+    }
+
+    // 同一主机已经在执行中, 等待其结果即可
+    const QString host = url.host().toLower();
+    QList<QUrl> &waiting = m_pending[host];
+    waiting << url;
+    if (waiting.size() == 1)
+        Q_EMIT requestEvaluate(m_generation, url);
+}
+
+void PacProxyResolver::setScriptUrl(const QString &url)
+{
+    reset();
+
+    m_scriptUrl = url.isEmpty() ? QUrl() : QUrl::fromUserInput(url);
+    if (!m_scriptUrl.isEmpty())
+        Q_EMIT requestLoadScript(m_generation, m_scriptUrl);
+    else
+        Q_EMIT requestLoadScriptContent(m_generation, QString());
+
+    // 脚本加载请求在前, 重新发出的执行请求会使用新的脚本
+    for (const QList<QUrl> &waiting : m_pending)
+        Q_EMIT requestEvaluate(m_generation, waiting.first());
+}
+
+void PacProxyResolver::setScriptContent(const QString &script)
+{
+    reset();
+
+    m_scriptUrl.clear();
+    Q_EMIT requestLoadScriptContent(m_generation, script);
+
+    for (const QList<QUrl> &waiting : m_pending)
+        Q_EMIT requestEvaluate(m_generation, waiting.first());
+}
+
+void PacProxyResolver::clearCache()
+{
+    m_cache.clear();
+}
+
+void PacProxyResolver::onScriptLoaded(quint64 generation, bool success)
+{
+    if (generation != m_generation)
+        return;
+
+    m_ready = success;
+
+    Q_EMIT scriptLoaded(success);
+}
+
+void PacProxyResolver::onEvaluated(quint64 generation, const QString &host, const QString &proxy)
+{
+    // 脚本已经变化, 丢弃旧脚本的结果
+    if (generation != m_generation)
+        return;
+
+    if (m_cacheTtl > 0) {
+        const qint64 now = m_clock.elapsed();
+        evictCache(m_cache, now);
+        m_cache.insert(host, { proxy, ++m_cacheSequence, now + m_cacheTtl });
+    }
+
+    for (const QUrl &url : m_pending.take(host))
+        Q_EMIT proxyResolved(url, proxy);
+}
+
+void PacProxyResolver::reset()
+{
+    ++m_generation;
+    m_ready = false;
+    m_cache.clear();
+}
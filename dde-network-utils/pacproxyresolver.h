@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PACPROXYRESOLVER_H
+#define PACPROXYRESOLVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QUrl>
+#include <QElapsedTimer>
+
+class QJSEngine;
+class QThread;
+class QHostInfo;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace dde {
+
+namespace network {
+
+class NetworkModel;
+
+/**
+ * @brief PacEvaluator 在独立线程中加载并执行 PAC 脚本, 由 PacProxyResolver 内部使用
+ *
+ * 脚本的下载和 dnsResolve 的查询都是异步的, 不会阻塞线程. 下载期间收到的执行请求等加载后再执行;
+ * 脚本用到的主机名还没有查询结果时, dnsResolve 先返回空并发起查询, 查询返回后重新执行该请求.
+ */
+class PacEvaluator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PacEvaluator(QObject *parent = nullptr);
+
+    // 以下接口供 PAC 脚本中的辅助函数调用
+    Q_INVOKABLE QString dnsResolve(const QString &host);
+    Q_INVOKABLE QString myIpAddress() const;
+
+Q_SIGNALS:
+    void scriptLoaded(quint64 generation, bool success) const;
+    void evaluated(quint64 generation, const QString &host, const QString &proxy) const;
+
+public Q_SLOTS:
+    void loadScript(quint64 generation, const QUrl &url);
+    void loadScriptContent(quint64 generation, const QString &script);
+    void evaluate(quint64 generation, const QUrl &url);
+
+private Q_SLOTS:
+    void onScriptDownloaded();
+
+private:
+    struct Evaluation
+    {
+        quint64 generation;
+        QUrl url;
+        // 等待查询结果的主机名
+        QSet<QString> hosts;
+    };
+
+    struct DnsEntry
+    {
+        QString address;
+        // 写入顺序, 缓存满时先淘汰序号小的
+        quint64 sequence;
+        qint64 expiry;
+    };
+
+    void abortDownload();
+    void onHostLookedUp(const QString &host, const QHostInfo &info);
+
+private:
+    QJSEngine *m_engine;
+    bool m_ready;
+
+    QNetworkAccessManager *m_nam;
+    QNetworkReply *m_download;
+    quint64 m_downloadGeneration;
+    QList<Evaluation> m_deferred;
+
+    QElapsedTimer m_clock;
+    QHash<QString, DnsEntry> m_dnsCache;
+    quint64 m_dnsSequence;
+    QSet<QString> m_lookups;
+    // 本次执行中未命中缓存的主机名
+    QSet<QString> m_missedHosts;
+    QList<Evaluation> m_waitingForDns;
+};
+
+/**
+ * @brief PacProxyResolver 本地 PAC 解析器
+ *
+ * 从本地文件或 URL 加载 autoProxy 指定的 PAC 脚本, 并在独立线程中执行 FindProxyForURL.
+ * 结果按主机名缓存, 缓存在 cacheTtl() 后过期, 脚本变化时全部作废;
+ * 缓存已满且没有过期的条目时淘汰最早写入的一部分.
+ * 解析结果与 PAC 的返回值格式相同, 如 "PROXY 10.0.0.1:8080; DIRECT".
+ */
+class PacProxyResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    // model 不为空时跟随 autoProxyChanged 重新加载脚本
+    explicit PacProxyResolver(NetworkModel *model = nullptr, QObject *parent = nullptr);
+    ~PacProxyResolver();
+
+    const QUrl scriptUrl() const { return m_scriptUrl; }
+    bool isReady() const { return m_ready; }
+
+    int cacheTtl() const { return m_cacheTtl; }
+    void setCacheTtl(int msec);
+    int cacheSize() const { return m_cache.size(); }
+
+    // 缓存未命中或已过期时返回空字符串
+    const QString cachedProxy(const QUrl &url) const;
+    // 缓存命中时直接发出 proxyResolved, 否则在 PAC 线程中执行后发出
+    void resolve(const QUrl &url);
+
+Q_SIGNALS:
+    void scriptLoaded(bool success) const;
+    void proxyResolved(const QUrl &url, const QString &proxy) const;
+
+    void requestLoadScript(quint64 generation, const QUrl &url) const;
+    void requestLoadScriptContent(quint64 generation, const QString &script) const;
+    void requestEvaluate(quint64 generation, const QUrl &url) const;
+
+public Q_SLOTS:
+    void setScriptUrl(const QString &url);
+    void setScriptContent(const QString &script);
+    void clearCache();
+
+private Q_SLOTS:
+    void onScriptLoaded(quint64 generation, bool success);
+    void onEvaluated(quint64 generation, const QString &host, const QString &proxy);
+
+private:
+    struct CacheEntry
+    {
+        QString proxy;
+        quint64 sequence;
+        qint64 expiry;
+    };
+
+    void reset();
+
+private:
+    PacEvaluator *m_evaluator;
+    QThread *m_thread;
+
+    QUrl m_scriptUrl;
+    bool m_ready;
+    quint64 m_generation;
+
+    int m_cacheTtl;
+    QElapsedTimer m_clock;
+    QHash<QString, CacheEntry> m_cache;
+    quint64 m_cacheSequence;
+    // 正在执行中的主机名及等待其结果的 URL
+    QHash<QString, QList<QUrl>> m_pending;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // PACPROXYRESOLVER_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "payloadcodec.h"
+
+#include <QJsonDocument>
+#include <QtGlobal>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QCborMap>
+#include <QCborValue>
+#define PAYLOADCODEC_CBOR
+#endif
+
+using namespace dde::network;
+
+bool PayloadCodec::isCborSupported()
+{
+#ifdef PAYLOADCODEC_CBOR
+    return true;
+#else
+    return false;
+#endif
+}
+
+QString PayloadCodec::encodingName(Encoding encoding)
+{
+    return encoding == Cbor ? QStringLiteral("cbor") : QStringLiteral("json");
+}
+
+bool PayloadCodec::encodingFromName(const QString &name, Encoding *encoding)
+{
+    if (name == "json") {
+        *encoding = Json;
+        return true;
+    }
+    if (name == "cbor" && isCborSupported()) {
+        *encoding = Cbor;
+        return true;
+    }
+
+    return false;
+}
+
+QByteArray PayloadCodec::encode(const QJsonObject &object, Encoding encoding)
+{
+    switch (encoding) {
+    case Json:
+        return QJsonDocument(object).toJson(QJsonDocument::Compact);
+    case Cbor:
+#ifdef PAYLOADCODEC_CBOR
+        return QCborValue(QCborMap::fromJsonObject(object)).toCbor();
+#else
+        return QByteArray();
+#endif
+    }
+
+    return QByteArray();
+}
+
+QJsonObject PayloadCodec::decode(const QByteArray &data, Encoding encoding)
+{
+    switch (encoding) {
+    case Json:
+        return QJsonDocument::fromJson(data).object();
+    case Cbor:
+#ifdef PAYLOADCODEC_CBOR
+        // 数据不是 CBOR map 时与 Json 一样得到空对象
+        return QCborValue::fromCbor(data).toMap().toJsonObject();
+#else
+        return QJsonObject();
+#endif
+    }
+
+    return QJsonObject();
+}
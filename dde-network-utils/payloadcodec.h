@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PAYLOADCODEC_H
+#define PAYLOADCODEC_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief PayloadCodec 后端属性的编码
+ *
+ * 默认的 Json 文本每次变化都要重新解析; 与服务协商成功后, 服务另外把 Connections 和 WirelessAccessPoints
+ * 以 CBOR 编码的字节数组单独发给本客户端 (属性名加 "Cbor" 后缀), 解析出的 Json 对象与 Json 文本完全相同.
+ * 编码按客户端协商, 其他客户端仍然只收到 Json.
+ * CBOR 依赖 Qt 5.12 中的 QCborValue, 更早的 Qt 版本只支持 Json.
+ */
+class PayloadCodec
+{
+public:
+    enum Encoding {
+        Json,
+        Cbor
+    };
+
+    static bool isCborSupported();
+
+    // 协商时使用的名字: "json", "cbor"
+    static QString encodingName(Encoding encoding);
+    static bool encodingFromName(const QString &name, Encoding *encoding);
+
+    // 不支持的编码返回空的结果
+    static QByteArray encode(const QJsonObject &object, Encoding encoding);
+    static QJsonObject decode(const QByteArray &data, Encoding encoding);
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // PAYLOADCODEC_H
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "payloadparser.h"
+#include "networkmodel.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+
+#define CONNECTED  2
+
+using namespace dde::network;
+
+NetworkDevice::DeviceType PayloadParser::parseDeviceType(const QString &type)
+{
+    if (type == "wireless") {
+        return NetworkDevice::Wireless;
+    }
+    if (type == "wired") {
+        return NetworkDevice::Wired;
+    }
+
+    return NetworkDevice::None;
+}
+
+DevicesPayload PayloadParser::parseDevices(const QString &devices)
+{
+    return parseDevices(QJsonDocument::fromJson(devices.toUtf8()).object());
+}
+
+DevicesPayload PayloadParser::parseDevices(const QJsonObject &data)
+{
+    DevicesPayload payload;
+
+    for (auto it(data.constBegin()); it != data.constEnd(); ++it) {
+        const auto type = parseDeviceType(it.key());
+        const auto list = it.value().toArray();
+
+        if (type == NetworkDevice::None)
+            continue;
+
+        for (auto const &l : list)
+        {
+            const auto info = l.toObject();
+            const QString path = info.value("Path").toString();
+            bool managed = info.value("Managed").toBool();
+            QString interface = info.value("Interface").toString();
+
+            if (!payload.interfaces.contains(interface))
+                payload.interfaces << interface;
+
+            if (!managed) {
+                qDebug() << "device: " << path << "ignored due to unmanged";
+                continue;
+            }
+
+            // 根据标志位InterfaceFlags判断网络连接是否有效
+            if (type != NetworkDevice::Wireless) {
+                if (!info.value("InterfaceFlags").isUndefined()) {
+                    int flag = info.value("InterfaceFlags").toInt();
+                    if (!(flag & NM_DEVICE_INTERFACE_FLAG_UP)) {
+                        continue;
+                    }
+                }
+            }
+
+            payload.devices << DevicesPayload::Entry { type, path, info };
+        }
+    }
+
+    return payload;
+}
+
+ConnectionsPayload PayloadParser::parseConnections(const QString &conns)
+{
+    return parseConnections(QJsonDocument::fromJson(conns.toUtf8()).object());
+}
+
+ConnectionsPayload PayloadParser::parseConnections(const QJsonObject &connsObject)
+{
+    ConnectionsPayload payload;
+
+    for (auto it(connsObject.constBegin()); it != connsObject.constEnd(); ++it) {
+        const auto &connList = it.value().toArray();
+        const auto &connType = it.key();
+        if (connType.isEmpty())
+            continue;
+
+        QList<ConnectionRecord> &typeConnections = payload.connections[connType];
+
+        for (const auto &connObject : connList) {
+            const ConnectionRecord connection(connObject.toObject());
+
+            typeConnections.append(connection);
+
+            const auto &hwAddr = connection.hwAddress();
+            if (hwAddr.isEmpty()) {
+                payload.commonConnections[connType].append(connection);
+            } else {
+                payload.deviceConnections[hwAddr][connType].append(connection);
+            }
+
+            const auto &interface = connection.ifcName();
+            if (interface.isEmpty()) {
+                payload.wiredCommonConnections[connType].append(connection);
+            } else {
+                payload.wiredDeviceConnections[interface][connType].append(connection);
+            }
+        }
+    }
+
+    return payload;
+}
+
+ActiveConnectionsPayload PayloadParser::parseActiveConnections(const QString &conns)
+{
+    return parseActiveConnections(QJsonDocument::fromJson(conns.toUtf8()).object());
+}
+
+ActiveConnectionsPayload PayloadParser::parseActiveConnections(const QJsonObject &activeConns)
+{
+    ActiveConnectionsPayload payload;
+
+    for (auto it(activeConns.constBegin()); it != activeConns.constEnd(); ++it)
+    {
+        const QJsonObject &info = it.value().toObject();
+        if (info.isEmpty())
+            continue;
+
+        payload.activeConns << info;
+        const bool connected = info.value("State").toInt() == CONNECTED;
+
+        for (const auto &item : info.value("Devices").toArray()) {
+            const QString &devicePath = item.toString();
+            if (devicePath.isEmpty()) {
+                continue;
+            }
+            payload.deviceActiveConns[devicePath] << info;
+
+            if (connected)
+                payload.connectedDevices << devicePath;
+        }
+    }
+
+    for (auto it(payload.deviceActiveConns.constBegin()); it != payload.deviceActiveConns.constEnd(); ++it)
+        payload.deviceActiveConnsHash.insert(it.key(), NetworkDevice::contentHash(it.value()));
+
+    return payload;
+}
+
+ActiveConnInfoPayload PayloadParser::parseActiveConnInfo(const QString &activeConnInfo)
+{
+    ActiveConnInfoPayload payload;
+
+    const QJsonArray infos = QJsonDocument::fromJson(activeConnInfo.toUtf8()).array();
+    for (const auto &item : infos) {
+        const QJsonObject &info = item.toObject();
+
+        payload.activeConnInfos << info;
+        // 与原来 QMap::insertMulti 后 values() 的顺序一致, 后出现的在前
+        payload.deviceActiveConnInfos[info.value("Device").toString()].prepend(info);
+    }
+
+    for (auto it(payload.deviceActiveConnInfos.constBegin()); it != payload.deviceActiveConnInfos.constEnd(); ++it)
+        payload.deviceActiveConnInfosHash.insert(it.key(), NetworkDevice::contentHash(it.value()));
+
+    return payload;
+}
+
+AccessPointsPayload PayloadParser::parseAccessPoints(const QString &wirelessList)
+{
+    //当数据非json的时候,则这个里面的项为0
+    return parseAccessPoints(QJsonDocument::fromJson(wirelessList.toUtf8()).object());
+}
+
+AccessPointsPayload PayloadParser::parseAccessPoints(const QJsonObject &wirelessData)
+{
+    AccessPointsPayload payload;
+
+    for (auto it(wirelessData.constBegin()); it != wirelessData.constEnd(); ++it)
+        payload.deviceAccessPoints.insert(it.key(), it.value().toArray());
+
+    return payload;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAYLOADPARSER_H
+#define PAYLOADPARSER_H
+
+#include "networkdevice.h"
+#include "connectionrecord.h"
+
+#include <QMap>
+#include <QSet>
+#include <QList>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStringList>
+
+namespace dde {
+
+namespace network {
+
+// 解析后的 Devices 属性
+struct DevicesPayload
+{
+    struct Entry
+    {
+        NetworkDevice::DeviceType type;
+        QString path;
+        QJsonObject info;
+    };
+
+    // 需要由 NetworkModel 管理的设备, 已经过滤掉未托管和未启用的设备
+    QList<Entry> devices;
+    // 所有设备的网卡名, 包括被过滤掉的设备
+    QStringList interfaces;
+};
+
+// 解析后的 Connections 属性, 按连接类型以及所属设备预先分组
+// 连接保存为 ConnectionRecord, 记录与解析结果共享数据
+struct ConnectionsPayload
+{
+    // 以连接类型为键的所有连接
+    QMap<QString, QList<ConnectionRecord>> connections;
+    // "HwAddress" 为空, 所有设备都可以使用的连接
+    QMap<QString, QList<ConnectionRecord>> commonConnections;
+    // 以 "HwAddress" 为键, 只属于该设备的连接
+    QMap<QString, QMap<QString, QList<ConnectionRecord>>> deviceConnections;
+    // "IfcName" 为空, 所有有线设备都可以使用的连接
+    QMap<QString, QList<ConnectionRecord>> wiredCommonConnections;
+    // 以 "IfcName" 为键, 只属于该网卡的连接
+    QMap<QString, QMap<QString, QList<ConnectionRecord>>> wiredDeviceConnections;
+};
+
+// 解析后的 ActiveConnections 属性
+struct ActiveConnectionsPayload
+{
+    QList<QJsonObject> activeConns;
+    // 以设备路径为键的 active 连接
+    QMap<QString, QList<QJsonObject>> deviceActiveConns;
+    // deviceActiveConns 中每个列表的 NetworkDevice::contentHash, 在解析线程中算好
+    QMap<QString, quint64> deviceActiveConnsHash;
+    // 存在已连接的 active 连接的设备
+    QSet<QString> connectedDevices;
+};
+
+// 解析后的 GetActiveConnectionInfo 返回值
+struct ActiveConnInfoPayload
+{
+    QList<QJsonObject> activeConnInfos;
+    // 以设备路径 ("Device") 为键的活动连接信息
+    QMap<QString, QList<QJsonObject>> deviceActiveConnInfos;
+    // deviceActiveConnInfos 中每个列表的 NetworkDevice::contentHash, 在解析线程中算好
+    QMap<QString, quint64> deviceActiveConnInfosHash;
+};
+
+// 解析后的 WirelessAccessPoints 属性, 以设备路径为键
+struct AccessPointsPayload
+{
+    QMap<QString, QJsonArray> deviceAccessPoints;
+};
+
+/**
+ * @brief PayloadParser 把后端发来的 Json 字符串解析为 NetworkModel 可以直接应用的结构
+ *
+ * 解析过程不访问 NetworkModel 和设备对象, 可以在任意线程中执行.
+ */
+class PayloadParser
+{
+public:
+    static DevicesPayload parseDevices(const QString &devices);
+    static ConnectionsPayload parseConnections(const QString &conns);
+    static ActiveConnectionsPayload parseActiveConnections(const QString &conns);
+    static AccessPointsPayload parseAccessPoints(const QString &wirelessList);
+    static ActiveConnInfoPayload parseActiveConnInfo(const QString &activeConnInfo);
+
+    // 后端已经持有 Json 对象时直接解析, 省去序列化和反序列化
+    static DevicesPayload parseDevices(const QJsonObject &data);
+    static ConnectionsPayload parseConnections(const QJsonObject &connsObject);
+    static ActiveConnectionsPayload parseActiveConnections(const QJsonObject &activeConns);
+    static AccessPointsPayload parseAccessPoints(const QJsonObject &wirelessData);
+
+    static NetworkDevice::DeviceType parseDeviceType(const QString &type);
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+Q_DECLARE_METATYPE(dde::network::DevicesPayload)
+Q_DECLARE_METATYPE(dde::network::ConnectionsPayload)
+Q_DECLARE_METATYPE(dde::network::ActiveConnectionsPayload)
+Q_DECLARE_METATYPE(dde::network::AccessPointsPayload)
+Q_DECLARE_METATYPE(dde::network::ActiveConnInfoPayload)
+
+#endif // PAYLOADPARSER_H
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pendingcallmanager.h"
+#include "eventtracer.h"
+
+#include <QDebug>
+#include <QDBusError>
+#include <QTimer>
+
+#define MAX_CONCURRENT_CALLS 16
+#define DEFAULT_TIMEOUT (10 * 1000)
+
+using namespace dde::network;
+
+// 返回结果中字符串参数的总长度, 用于统计回调处理的数据量
+static qint64 replySize(QDBusPendingCallWatcher *w)
+{
+    qint64 size = 0;
+    for (const QVariant &arg : w->reply().arguments()) {
+        if (arg.type() == QVariant::String)
+            size += arg.toString().size();
+    }
+
+    return size;
+}
+
+PendingCallManager::PendingCallManager(QObject *parent)
+    : QObject(parent)
+    , m_maxConcurrentCalls(MAX_CONCURRENT_CALLS)
+    , m_defaultTimeout(DEFAULT_TIMEOUT)
+    , m_dedupedCalls(0)
+    , m_staleCalls(0)
+    , m_timeoutCalls(0)
+    , m_stats(nullptr)
+{
+}
+
+void PendingCallManager::setMaxConcurrentCalls(int max)
+{
+    m_maxConcurrentCalls = qMax(max, 1);
+
+    dispatchQueued();
+}
+
+void PendingCallManager::setDefaultTimeout(int msec)
+{
+    m_defaultTimeout = msec;
+}
+
+int PendingCallManager::timeout(const QString &method) const
+{
+    return m_timeouts.value(method, m_defaultTimeout);
+}
+
+void PendingCallManager::setTimeout(const QString &method, int msec)
+{
+    m_timeouts.insert(method, msec);
+}
+
+void PendingCallManager::call(const QString &method, const CallFactory &factory,
+                              const Callback &callback, const QString &key,
+                              const QVariantMap &properties)
+{
+    if (!key.isEmpty()) {
+        auto it = m_keys.find(key);
+        if (it != m_keys.end()) {
+            ++m_dedupedCalls;
+            if (callback)
+                it.value().waiters << callback;
+            return;
+        }
+
+        m_keys.insert(key, { false, false, QList<Callback>() });
+    }
+
+    enqueue({ method, key, factory, callback, properties });
+}
+
+void PendingCallManager::invalidate(const QString &key)
+{
+    ++m_generations[key];
+
+    // 还在排队的调用尚未发出, 结果不会过期, 只需处理已经发出的调用
+    auto it = m_keys.find(key);
+    if (it != m_keys.end() && it.value().running)
+        it.value().rerun = true;
+}
+
+void PendingCallManager::enqueue(const Request &request)
+{
+    if (m_running.size() >= m_maxConcurrentCalls) {
+        m_queue.enqueue(request);
+        return;
+    }
+
+    start(request);
+}
+
+void PendingCallManager::start(const Request &request)
+{
+    QDBusPendingCallWatcher *w = new QDBusPendingCallWatcher(request.factory(), this);
+
+    for (auto it(request.properties.constBegin()); it != request.properties.constEnd(); ++it)
+        w->setProperty(it.key().toUtf8().constData(), it.value());
+
+    Running &running = m_running[w];
+    running.request = request;
+    running.generation = request.key.isEmpty() ? 0 : m_generations.value(request.key);
+    running.timer.start();
+
+    if (!request.key.isEmpty())
+        m_keys[request.key].running = true;
+
+    // 以 watcher 的地址作为异步事件的 id, 同一时间不会重复
+    if (EventTracer::isEnabled())
+        EventTracer::asyncBegin("dbus", request.method.toUtf8(), reinterpret_cast<quintptr>(w), request.key.toUtf8());
+
+    connect(w, &QDBusPendingCallWatcher::finished, this, &PendingCallManager::onFinished);
+
+    const int msec = timeout(request.method);
+    if (msec > 0) {
+        // 以 watcher 作为 context, watcher 释放后定时器自动失效
+        QTimer::singleShot(msec, w, [this, w] { onTimeout(w); });
+    }
+}
+
+void PendingCallManager::onFinished(QDBusPendingCallWatcher *w)
+{
+    auto it = m_running.find(w);
+    if (it == m_running.end())
+        return;
+
+    Running running = it.value();
+    m_running.erase(it);
+
+    if (EventTracer::isEnabled())
+        EventTracer::asyncEnd("dbus", running.request.method.toUtf8(), reinterpret_cast<quintptr>(w),
+                              w->isError() ? w->error().name().toUtf8() : QByteArray());
+
+    release(w, &running, false);
+}
+
+void PendingCallManager::onTimeout(QDBusPendingCallWatcher *w)
+{
+    auto it = m_running.find(w);
+    if (it == m_running.end())
+        return;
+
+    Running running = it.value();
+    m_running.erase(it);
+
+    ++m_timeoutCalls;
+    qWarning() << "DBus call timeout:" << running.request.method << running.timer.elapsed() << "ms";
+
+    if (EventTracer::isEnabled())
+        EventTracer::asyncEnd("dbus", running.request.method.toUtf8(), reinterpret_cast<quintptr>(w), "timeout");
+
+    // 迟到的结果随原来的 watcher 一起丢弃, 回调收到的是一个 Timeout 错误,
+    // 调用方可以像处理其他 DBus 错误一样处理超时
+    w->disconnect(this);
+    w->deleteLater();
+
+    const QDBusError error(QDBusError::Timeout, QString("%1 timed out after %2 ms").arg(running.request.method).arg(running.timer.elapsed()));
+    QDBusPendingCallWatcher *timedOut = new QDBusPendingCallWatcher(QDBusPendingCall::fromError(error), this);
+    for (auto it(running.request.properties.constBegin()); it != running.request.properties.constEnd(); ++it)
+        timedOut->setProperty(it.key().toUtf8().constData(), it.value());
+
+    release(timedOut, &running, true);
+
+    Q_EMIT callTimedOut(running.request.method);
+}
+
+void PendingCallManager::release(QDBusPendingCallWatcher *w, Running *running, bool timedOut)
+{
+    const Request &request = running->request;
+
+    // 超时的耗时只是超时时间本身, 不计入直方图
+    if (!timedOut)
+        m_histograms[request.method].record(running->timer.nsecsElapsed() / 1000);
+
+    // 回调之前先释放 key, 回调中可以再次发起相同的调用
+    bool current = true;
+    KeyState state { false, false, QList<Callback>() };
+    if (!request.key.isEmpty()) {
+        state = m_keys.take(request.key);
+        current = running->generation == m_generations.value(request.key);
+    }
+
+    if (!current) {
+        ++m_staleCalls;
+    } else if (request.callback || !state.waiters.isEmpty()) {
+        NetworkStatsScope stats(m_stats, request.method, m_stats && m_stats->isEnabled() ? replySize(w) : 0);
+        TraceScope trace("dbus", "callback");
+        if (EventTracer::isEnabled())
+            trace.setDetail(request.method.toUtf8());
+        if (request.callback)
+            request.callback(w);
+        for (const Callback &waiter : state.waiters)
+            waiter(w);
+    }
+
+    w->deleteLater();
+
+    // 重新发起的调用沿用原来的回调, 被合并的调用方同样等待新的结果
+    if (state.rerun) {
+        call(request.method, request.factory, request.callback, request.key, request.properties);
+        m_keys[request.key].waiters << state.waiters;
+    }
+
+    dispatchQueued();
+}
+
+void PendingCallManager::dispatchQueued()
+{
+    while (!m_queue.isEmpty() && m_running.size() < m_maxConcurrentCalls)
+        start(m_queue.dequeue());
+}
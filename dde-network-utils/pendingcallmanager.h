@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PENDINGCALLMANAGER_H
+#define PENDINGCALLMANAGER_H
+
+#include "latencyhistogram.h"
+#include "networkstats.h"
+
+#include <QObject>
+#include <QHash>
+#include <QQueue>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QDBusPendingCall>
+#include <QDBusPendingCallWatcher>
+
+#include <functional>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief PendingCallManager 统一管理所有异步 DBus 调用
+ *
+ * - 所有 QDBusPendingCallWatcher 都由本类创建和释放
+ * - 每个方法可以设置超时时间, 超时后以 QDBusError::Timeout 错误回调, 迟到的结果被丢弃
+ * - 同时进行中的调用数有上限, 超出的调用会排队等待
+ * - 按方法名统计调用耗时直方图, 超时的调用只计入 timeoutCount
+ * - 指定 key 的调用同一时间只会有一个在进行中(single-flight), 重复的调用不再发起, 其回调挂到进行中的调用上,
+ *   与第一个调用方收到同一个结果 (包括超时错误); invalidate(key) 会使进行中的调用结果作废并在其返回后重新发起一次
+ */
+class PendingCallManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<QDBusPendingCall()> CallFactory;
+    typedef std::function<void(QDBusPendingCallWatcher *)> Callback;
+
+    explicit PendingCallManager(QObject *parent = nullptr);
+
+    int maxConcurrentCalls() const { return m_maxConcurrentCalls; }
+    void setMaxConcurrentCalls(int max);
+    int defaultTimeout() const { return m_defaultTimeout; }
+    void setDefaultTimeout(int msec);
+    int timeout(const QString &method) const;
+    void setTimeout(const QString &method, int msec);
+
+    // callback 返回后 watcher 会被自动释放, 调用方不需要也不应该再 delete
+    void call(const QString &method, const CallFactory &factory,
+              const Callback &callback = Callback(),
+              const QString &key = QString(),
+              const QVariantMap &properties = QVariantMap());
+    void invalidate(const QString &key);
+
+    int runningCount() const { return m_running.size(); }
+    int queuedCount() const { return m_queue.size(); }
+    quint64 dedupedCount() const { return m_dedupedCalls; }
+    quint64 staleCount() const { return m_staleCalls; }
+    quint64 timeoutCount() const { return m_timeoutCalls; }
+
+    const QStringList methods() const { return m_histograms.keys(); }
+    const LatencyHistogram latencyHistogram(const QString &method) const { return m_histograms.value(method); }
+
+    // 设置后按方法名统计回调的耗时和其中发出的信号
+    void setStatsCollector(NetworkStatsCollector *stats) { m_stats = stats; }
+
+Q_SIGNALS:
+    void callTimedOut(const QString &method) const;
+
+private:
+    struct Request
+    {
+        QString method;
+        QString key;
+        CallFactory factory;
+        Callback callback;
+        QVariantMap properties;
+    };
+
+    struct Running
+    {
+        Request request;
+        quint64 generation;
+        QElapsedTimer timer;
+    };
+
+    struct KeyState
+    {
+        bool running;
+        bool rerun;
+        // 被合并的重复调用的回调, 按调用顺序排在第一个调用方之后执行
+        QList<Callback> waiters;
+    };
+
+    void enqueue(const Request &request);
+    void start(const Request &request);
+    void onFinished(QDBusPendingCallWatcher *w);
+    void onTimeout(QDBusPendingCallWatcher *w);
+    void release(QDBusPendingCallWatcher *w, Running *running, bool timedOut);
+    void dispatchQueued();
+
+private:
+    int m_maxConcurrentCalls;
+    int m_defaultTimeout;
+    QHash<QString, int> m_timeouts;
+
+    QQueue<Request> m_queue;
+    QHash<QDBusPendingCallWatcher *, Running> m_running;
+    QHash<QString, KeyState> m_keys;
+    QHash<QString, quint64> m_generations;
+    QHash<QString, LatencyHistogram> m_histograms;
+
+    quint64 m_dedupedCalls;
+    quint64 m_staleCalls;
+    quint64 m_timeoutCalls;
+    NetworkStatsCollector *m_stats;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // PENDINGCALLMANAGER_H
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "proxybypassmatcher.h"
+
+#include <QHostAddress>
+#include <QRegularExpression>
+
+using namespace dde::network;
+
+static void ipv4Bytes(quint32 ip, quint8 *bytes)
+{
+    bytes[0] = quint8(ip >> 24);
+    bytes[1] = quint8(ip >> 16);
+    bytes[2] = quint8(ip >> 8);
+    bytes[3] = quint8(ip);
+}
+
+static QString normalizeHost(const QString &host)
+{
+    QString h = host.trimmed().toLower();
+    if (h.startsWith('[') && h.endsWith(']'))
+        h = h.mid(1, h.size() - 2);
+    while (h.endsWith('.'))
+        h.chop(1);
+
+    return h;
+}
+
+ProxyBypassMatcher::ProxyBypassMatcher()
+    : m_ruleCount(0)
+    , m_matchAll(false)
+    , m_matchLocal(false)
+    , m_domains(1)
+    , m_ipv4(1)
+    , m_ipv6(1)
+{
+}
+
+ProxyBypassMatcher::ProxyBypassMatcher(const QString &ignoreHosts)
+    : ProxyBypassMatcher()
+{
+    static const QRegularExpression separator("[,;\\s]+");
+    for (const QString &rule : ignoreHosts.split(separator, QString::SkipEmptyParts))
+        addRule(rule);
+
+    m_domains.squeeze();
+    m_ipv4.squeeze();
+    m_ipv6.squeeze();
+}
+
+bool ProxyBypassMatcher::matches(const QString &host) const
+{
+    if (m_matchAll)
+        return true;
+
+    const QString h = normalizeHost(host);
+    if (h.isEmpty())
+        return false;
+
+    QHostAddress address;
+    if (address.setAddress(h)) {
+        if (matchAddress(address))
+            return true;
+    } else {
+        if (m_matchLocal && !h.contains('.'))
+            return true;
+
+        if (matchDomain(h))
+            return true;
+    }
+
+    for (const QString &wildcard : m_wildcards) {
+        if (matchWildcard(wildcard, h))
+            return true;
+    }
+
+    return false;
+}
+
+void ProxyBypassMatcher::addRule(const QString &rule)
+{
+    QString r = rule.trimmed().toLower();
+    if (r.isEmpty())
+        return;
+
+    if (r == "*") {
+        m_matchAll = true;
+        ++m_ruleCount;
+        return;
+    }
+
+    if (r == "<local>") {
+        m_matchLocal = true;
+        ++m_ruleCount;
+        return;
+    }
+
+    // 网段
+    if (r.contains('/')) {
+        const QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(r);
+        if (subnet.first.isNull() || subnet.second < 0)
+            return;
+
+        if (subnet.first.protocol() == QAbstractSocket::IPv4Protocol) {
+            quint8 bytes[4];
+            ipv4Bytes(subnet.first.toIPv4Address(), bytes);
+            addPrefix(m_ipv4, bytes, subnet.second);
+        } else {
+            addPrefix(m_ipv6, subnet.first.toIPv6Address().c, subnet.second);
+        }
+        ++m_ruleCount;
+        return;
+    }
+
+    r = normalizeHost(r);
+
+    // 带端口的规则, 忽略端口部分; IPv6 地址本身含有多个 ':'
+    if (r.count(':') == 1)
+        r = r.left(r.indexOf(':'));
+
+    QHostAddress address;
+    if (address.setAddress(r)) {
+        if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+            quint8 bytes[4];
+            ipv4Bytes(address.toIPv4Address(), bytes);
+            addPrefix(m_ipv4, bytes, 32);
+        } else {
+            addPrefix(m_ipv6, address.toIPv6Address().c, 128);
+        }
+        ++m_ruleCount;
+        return;
+    }
+
+    if (r.startsWith("*.")) {
+        r = r.mid(2);
+        if (r.contains('*') || r.contains('?'))
+            m_wildcards << "*." + r;
+        else
+            addDomain(r, false, true);
+    } else if (r.startsWith('.')) {
+        addDomain(r.mid(1), false, true);
+    } else if (r.contains('*') || r.contains('?')) {
+        m_wildcards << r;
+    } else {
+        addDomain(r, true, true);
+    }
+
+    ++m_ruleCount;
+}
+
+void ProxyBypassMatcher::addDomain(const QString &domain, bool self, bool subdomains)
+{
+    int node = 0;
+    const QStringList labels = domain.split('.', QString::SkipEmptyParts);
+    for (int i = labels.size() - 1; i >= 0; --i) {
+        int next = m_domains.at(node).children.value(labels.at(i), -1);
+        if (next < 0) {
+            next = m_domains.size();
+            m_domains[node].children.insert(labels.at(i), next);
+            m_domains.append(DomainNode());
+        }
+        node = next;
+    }
+
+    m_domains[node].self |= self;
+    m_domains[node].subdomains |= subdomains;
+}
+
+void ProxyBypassMatcher::addPrefix(QVector<PrefixNode> &tree, const quint8 *address, int prefixLength)
+{
+    int node = 0;
+    for (int i = 0; i < prefixLength; ++i) {
+        // 已经有更短的网段覆盖了该网段
+        if (tree.at(node).terminal)
+            return;
+
+        const int bit = (address[i / 8] >> (7 - i % 8)) & 1;
+        int next = tree.at(node).child[bit];
+        if (next < 0) {
+            next = tree.size();
+            tree[node].child[bit] = next;
+            tree.append(PrefixNode());
+        }
+        node = next;
+    }
+
+    tree[node].terminal = true;
+}
+
+bool ProxyBypassMatcher::matchDomain(const QString &host) const
+{
+    int node = 0;
+    int end = host.size();
+    while (end > 0) {
+        const int dot = host.lastIndexOf('.', end - 1);
+        const int next = m_domains.at(node).children.value(host.mid(dot + 1, end - dot - 1), -1);
+        if (next < 0)
+            return false;
+
+        node = next;
+        end = dot;
+
+        const DomainNode &n = m_domains.at(node);
+        // 还有剩余的标签, 说明 host 是该域名的子域名
+        if (end > 0 && n.subdomains)
+            return true;
+        if (end <= 0 && n.self)
+            return true;
+    }
+
+    return false;
+}
+
+bool ProxyBypassMatcher::matchAddress(const QHostAddress &address) const
+{
+    quint8 bytes[4];
+    if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+        ipv4Bytes(address.toIPv4Address(), bytes);
+        return matchPrefix(m_ipv4, bytes, 32);
+    }
+
+    if (matchPrefix(m_ipv6, address.toIPv6Address().c, 128))
+        return true;
+
+    // ::ffff:a.b.c.d 同时按 IPv4 规则匹配
+    bool isIPv4 = false;
+    const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+    if (!isIPv4)
+        return false;
+
+    ipv4Bytes(ipv4, bytes);
+    return matchPrefix(m_ipv4, bytes, 32);
+}
+
+bool ProxyBypassMatcher::matchPrefix(const QVector<PrefixNode> &tree, const quint8 *address, int length)
+{
+    int node = 0;
+    for (int i = 0; i < length; ++i) {
+        if (tree.at(node).terminal)
+            return true;
+
+        node = tree.at(node).child[(address[i / 8] >> (7 - i % 8)) & 1];
+        if (node < 0)
+            return false;
+    }
+
+    return tree.at(node).terminal;
+}
+
+bool ProxyBypassMatcher::matchWildcard(const QString &pattern, const QString &host)
+{
+    // 逐字符匹配, 遇到不匹配时回到最近的 '*' 让它多吞一个字符; 两边都已是小写
+    int p = 0;
+    int h = 0;
+    int star = -1;
+    int starHost = 0;
+
+    while (h < host.size()) {
+        if (p < pattern.size() && (pattern.at(p) == '?' || pattern.at(p) == host.at(h))) {
+            ++p;
+            ++h;
+        } else if (p < pattern.size() && pattern.at(p) == '*') {
+            star = p++;
+            starHost = h;
+        } else if (star >= 0) {
+            p = star + 1;
+            h = ++starHost;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern.at(p) == '*')
+        ++p;
+
+    return p == pattern.size();
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROXYBYPASSMATCHER_H
+#define PROXYBYPASSMATCHER_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+class QHostAddress;
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief ProxyBypassMatcher 由 ignoreHosts 编译得到的代理例外匹配器
+ *
+ * 支持的规则(以逗号, 分号或空白分隔):
+ * - example.com        匹配 example.com 及其所有子域名
+ * - *.example.com      只匹配 example.com 的子域名, ".example.com" 与之相同
+ * - 10.0.0.1 / ::1     匹配单个地址
+ * - 10.0.0.0/8         匹配网段, 同样支持 IPv6
+ * - <local>            匹配不带点的主机名
+ * - *                  匹配所有主机
+ * 其他包含通配符的规则按通配符模式逐条匹配.
+ *
+ * 域名规则保存在按标签倒序组织的后缀树中, 网段规则保存在按位组织的前缀树中,
+ * 匹配的开销只与主机名的标签数或地址长度有关, 与规则数量无关.
+ *
+ * 构造完成后不再修改, matches() 只读取成员, 可以在多个线程中同时调用.
+ */
+class ProxyBypassMatcher
+{
+public:
+    ProxyBypassMatcher();
+    explicit ProxyBypassMatcher(const QString &ignoreHosts);
+
+    bool matches(const QString &host) const;
+
+    bool isEmpty() const { return m_ruleCount == 0; }
+    int ruleCount() const { return m_ruleCount; }
+
+private:
+    struct DomainNode
+    {
+        DomainNode() : self(false), subdomains(false) {}
+
+        QHash<QString, int> children;
+        // 匹配该域名本身
+        bool self;
+        // 匹配该域名的所有子域名
+        bool subdomains;
+    };
+
+    struct PrefixNode
+    {
+        PrefixNode() : terminal(false) { child[0] = child[1] = -1; }
+
+        int child[2];
+        bool terminal;
+    };
+
+    void addRule(const QString &rule);
+    void addDomain(const QString &domain, bool self, bool subdomains);
+    void addPrefix(QVector<PrefixNode> &tree, const quint8 *address, int prefixLength);
+    bool matchDomain(const QString &host) const;
+    bool matchAddress(const QHostAddress &address) const;
+    static bool matchPrefix(const QVector<PrefixNode> &tree, const quint8 *address, int length);
+    static bool matchWildcard(const QString &pattern, const QString &host);
+
+private:
+    int m_ruleCount;
+    bool m_matchAll;
+    bool m_matchLocal;
+    QVector<DomainNode> m_domains;
+    QVector<PrefixNode> m_ipv4;
+    QVector<PrefixNode> m_ipv6;
+    // 小写的通配符模式, 只支持 '*' 和 '?'; QRegExp 匹配时会修改自身的状态, 不能在线程间共享
+    QStringList m_wildcards;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // PROXYBYPASSMATCHER_H
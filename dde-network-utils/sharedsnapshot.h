@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDSNAPSHOT_H
+#define SHAREDSNAPSHOT_H
+
+#include <QList>
+#include <QSharedData>
+#include <QExplicitlySharedDataPointer>
+#include <QJsonObject>
+#include <QMetaType>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace dde {
+
+namespace network {
+
+// 所有快照共用的版本号, 每创建一个新快照加一
+quint64 nextSnapshotVersion();
+
+/**
+ * @brief SharedSnapshot 不可修改的共享列表快照
+ *
+ * 复制快照只增加一次引用计数, 快照创建后内容不会再变化, 可以放心地长期持有.
+ * 数据源更新时创建新的快照并替换旧的, 已经交出去的快照不受影响, 也不会触发 QList 的深拷贝.
+ * version() 在每次创建新快照时递增, 比较版本号即可判断数据是否变化.
+ * lazy() 创建的快照在第一次访问内容时才调用 loader 生成列表, 只比较版本号时不会生成.
+ */
+template <typename T>
+class SharedSnapshot
+{
+public:
+    typedef typename QList<T>::const_iterator const_iterator;
+
+    SharedSnapshot() : d(empty()) {}
+    explicit SharedSnapshot(const QList<T> &items) : d(new Data(items)) {}
+
+    // loader 可能在任意访问快照的线程中调用, 且只会调用一次
+    static SharedSnapshot lazy(const std::function<QList<T>()> &loader)
+    {
+        SharedSnapshot snapshot;
+        snapshot.d = new Data(loader);
+        return snapshot;
+    }
+
+    quint64 version() const { return d->version; }
+    const QList<T> &items() const { return d->load(); }
+    bool isLoaded() const { return !d->loader || d->loaded.load(std::memory_order_acquire); }
+
+    int size() const { return items().size(); }
+    bool isEmpty() const { return items().isEmpty(); }
+    const T &at(int i) const { return items().at(i); }
+    const T &operator[](int i) const { return items().at(i); }
+
+    const_iterator begin() const { return items().constBegin(); }
+    const_iterator end() const { return items().constEnd(); }
+    const_iterator constBegin() const { return items().constBegin(); }
+    const_iterator constEnd() const { return items().constEnd(); }
+
+    bool operator==(const SharedSnapshot &other) const { return d == other.d; }
+    bool operator!=(const SharedSnapshot &other) const { return d != other.d; }
+
+    // 内容变化时才替换为新的快照, 返回是否替换
+    bool update(const QList<T> &items)
+    {
+        if (this->items() == items)
+            return false;
+
+        d = new Data(items);
+        return true;
+    }
+
+private:
+    struct Data : public QSharedData
+    {
+        Data() : version(0), loaded(false) {}
+        explicit Data(const QList<T> &list) : items(list), version(nextSnapshotVersion()), loaded(false) {}
+        explicit Data(const std::function<QList<T>()> &source) : loader(source), version(nextSnapshotVersion()), loaded(false) {}
+
+        const QList<T> &load()
+        {
+            if (loader) {
+                std::call_once(once, [this] {
+                    items = loader();
+                    loaded.store(true, std::memory_order_release);
+                });
+            }
+            return items;
+        }
+
+        QList<T> items;
+        const std::function<QList<T>()> loader;
+        const quint64 version;
+        std::once_flag once;
+        std::atomic<bool> loaded;
+    };
+
+    static Data *empty()
+    {
+        static Data *shared = []() {
+            Data *data = new Data;
+            // 保证共享的空快照永远不会被释放
+            data->ref.ref();
+            return data;
+        }();
+        return shared;
+    }
+
+    QExplicitlySharedDataPointer<Data> d;
+};
+
+typedef SharedSnapshot<QJsonObject> ConnectionSnapshot;
+
+}   // namespace network
+
+}   // namespace dde
+
+Q_DECLARE_METATYPE(dde::network::ConnectionSnapshot)
+
+#endif // SHAREDSNAPSHOT_H
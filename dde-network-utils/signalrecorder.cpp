@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "signalrecorder.h"
+#include "networkbackend.h"
+#include "payloadcodec.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+using namespace dde::network;
+
+#define RECORDING_MAGIC     0x444e5552  // "DNUR"
+#define RECORDING_VERSION   1
+
+enum RecordFlag {
+    Full,
+    Repeat
+};
+
+SignalRecorder::SignalRecorder(QObject *parent)
+    : QObject(parent)
+    , m_recordCount(0)
+{
+}
+
+SignalRecorder::~SignalRecorder()
+{
+    stop();
+}
+
+void SignalRecorder::attach(NetworkBackend *backend)
+{
+    connect(backend, &NetworkBackend::devicesChanged, this, [this](const QString &value) { record(Devices, value); });
+    connect(backend, &NetworkBackend::connectionsChanged, this, [this](const QString &value) { record(Connections, value); });
+    connect(backend, &NetworkBackend::activeConnectionsChanged, this, [this](const QString &value) { record(ActiveConnections, value); });
+    connect(backend, &NetworkBackend::wirelessAccessPointsChanged, this, [this](const QString &value) { record(AccessPoints, value); });
+    connect(backend, &NetworkBackend::connectionsCborChanged, this, [this](const QByteArray &value) { recordCbor(Connections, value); });
+    connect(backend, &NetworkBackend::wirelessAccessPointsCborChanged, this, [this](const QByteArray &value) { recordCbor(AccessPoints, value); });
+    connect(backend, &NetworkBackend::devicesObjectChanged, this, [this](const QJsonObject &value) { recordObject(Devices, value); });
+    connect(backend, &NetworkBackend::connectionsObjectChanged, this, [this](const QJsonObject &value) { recordObject(Connections, value); });
+    connect(backend, &NetworkBackend::activeConnectionsObjectChanged, this, [this](const QJsonObject &value) { recordObject(ActiveConnections, value); });
+    connect(backend, &NetworkBackend::wirelessAccessPointsObjectChanged, this, [this](const QJsonObject &value) { recordObject(AccessPoints, value); });
+    connect(backend, &NetworkBackend::deviceEnabled, this, &SignalRecorder::recordDeviceEnabled);
+    connect(backend, &NetworkBackend::connectivityChanged, this, &SignalRecorder::recordConnectivity);
+    connect(backend, &NetworkBackend::vpnEnabledChanged, this, &SignalRecorder::recordVpnEnabled);
+}
+
+bool SignalRecorder::start(const QString &fileName)
+{
+    stop();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to open recording file" << fileName << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(QDataStream::Qt_5_6);
+    m_stream << quint32(RECORDING_MAGIC) << quint32(RECORDING_VERSION) << QDateTime::currentMSecsSinceEpoch();
+
+    m_recordCount = 0;
+    for (QString &payload : m_lastPayloads)
+        payload.clear();
+    m_timer.start();
+
+    qInfo() << "recording network signals to" << fileName;
+    return true;
+}
+
+void SignalRecorder::stop()
+{
+    if (!m_file.isOpen())
+        return;
+
+    m_stream.setDevice(nullptr);
+    m_file.close();
+
+    qInfo() << "recorded" << m_recordCount << "network signals to" << m_file.fileName();
+}
+
+void SignalRecorder::record(Kind kind, const QString &payload)
+{
+    if (!m_file.isOpen() || kind < 0 || kind >= KindCount)
+        return;
+
+    m_stream << m_timer.nsecsElapsed() / 1000 << quint8(kind);
+    if (!m_lastPayloads[kind].isNull() && m_lastPayloads[kind] == payload) {
+        m_stream << quint8(Repeat);
+    } else {
+        m_stream << quint8(Full) << qCompress(payload.toUtf8());
+        m_lastPayloads[kind] = payload;
+    }
+
+    ++m_recordCount;
+}
+
+void SignalRecorder::recordCbor(Kind kind, const QByteArray &payload)
+{
+    // 没有录制时不解码
+    if (!m_file.isOpen())
+        return;
+
+    recordObject(kind, PayloadCodec::decode(payload, PayloadCodec::Cbor));
+}
+
+void SignalRecorder::recordObject(Kind kind, const QJsonObject &payload)
+{
+    if (!m_file.isOpen())
+        return;
+
+    record(kind, QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
+}
+
+void SignalRecorder::recordDeviceEnabled(const QString &devPath, bool enabled)
+{
+    if (!m_file.isOpen())
+        return;
+
+    const QJsonObject object { { "Path", devPath }, { "Enabled", enabled } };
+    record(DeviceEnabled, QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact)));
+}
+
+void SignalRecorder::recordConnectivity(int connectivity)
+{
+    record(Connectivity, QString::number(connectivity));
+}
+
+void SignalRecorder::recordVpnEnabled(bool enabled)
+{
+    record(VpnEnabled, enabled ? "true" : "false");
+}
+
+QString SignalRecorder::kindName(int kind)
+{
+    switch (kind) {
+    case Devices:           return "Devices";
+    case Connections:       return "Connections";
+    case ActiveConnections: return "ActiveConnections";
+    case AccessPoints:      return "WirelessAccessPoints";
+    case ActiveConnInfo:    return "ActiveConnectionInfo";
+    case DeviceEnabled:     return "DeviceEnabled";
+    case Connectivity:      return "Connectivity";
+    case VpnEnabled:        return "VpnEnabled";
+    default:                return "Unknown";
+    }
+}
+
+QList<SignalRecorder::Record> SignalRecorder::load(const QString &fileName, bool *ok)
+{
+    QList<Record> records;
+    if (ok)
+        *ok = false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "failed to open recording file" << fileName << ":" << file.errorString();
+        return records;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 startTime = 0;
+    stream >> magic >> version >> startTime;
+    if (stream.status() != QDataStream::Ok || magic != RECORDING_MAGIC || version != RECORDING_VERSION) {
+        qWarning() << fileName << "is not a network signal recording";
+        return records;
+    }
+
+    QString lastPayloads[KindCount];
+    while (!stream.atEnd()) {
+        qint64 usec = 0;
+        quint8 kind = 0;
+        quint8 flag = 0;
+        stream >> usec >> kind >> flag;
+        if (stream.status() != QDataStream::Ok || kind >= KindCount)
+            return records;
+
+        if (flag == Full) {
+            QByteArray data;
+            stream >> data;
+            if (stream.status() != QDataStream::Ok)
+                return records;
+            lastPayloads[kind] = QString::fromUtf8(qUncompress(data));
+        } else if (flag != Repeat) {
+            return records;
+        }
+
+        records << Record { usec, static_cast<Kind>(kind), lastPayloads[kind] };
+    }
+
+    if (ok)
+        *ok = true;
+    return records;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIGNALRECORDER_H
+#define SIGNALRECORDER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDataStream>
+#include <QJsonObject>
+
+namespace dde {
+
+namespace network {
+
+class NetworkBackend;
+
+/**
+ * @brief SignalRecorder 把 NetworkWorker 收到的后端数据连同时间写入文件, 供 dde-network-replay 回放
+ *
+ * 设置环境变量 DDE_NETWORK_UTILS_RECORD=<文件> 后 NetworkWorker 启动时即开始录制,
+ * 也可以通过 NetworkWorker::recorder() 随时开始和停止.
+ *
+ * 文件格式 (QDataStream, Qt 5.6):
+ *   文件头: quint32 magic, quint32 version, qint64 开始录制时的 UTC 毫秒数
+ *   每条记录: qint64 距开始录制的微秒数, quint8 类型, quint8 标志, 标志为 Full 时后跟 qCompress 压缩的 UTF-8 数据
+ * 后端经常重复发送相同的数据, 与上一条同类数据相同时只记录标志 Repeat.
+ * 非字符串的数据转换为字符串保存: DeviceEnabled 为 {"Path": ..., "Enabled": ...},
+ * Connectivity 为数字, VpnEnabled 为 true 或 false.
+ */
+class SignalRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind {
+        Devices,
+        Connections,
+        ActiveConnections,
+        AccessPoints,
+        ActiveConnInfo,
+        DeviceEnabled,
+        Connectivity,
+        VpnEnabled,
+        KindCount
+    };
+
+    struct Record
+    {
+        qint64 usec;
+        Kind kind;
+        QString payload;
+    };
+
+    explicit SignalRecorder(QObject *parent = nullptr);
+    ~SignalRecorder();
+
+    // 录制 backend 发出的所有数据变化信号
+    void attach(NetworkBackend *backend);
+
+    bool start(const QString &fileName);
+    void stop();
+    bool isRecording() const { return m_file.isOpen(); }
+    QString fileName() const { return m_file.fileName(); }
+    int recordCount() const { return m_recordCount; }
+
+    void record(Kind kind, const QString &payload);
+    // 解码或序列化为 Json 后录制, 回放时与 Json 的信号没有区别
+    void recordCbor(Kind kind, const QByteArray &payload);
+    void recordObject(Kind kind, const QJsonObject &payload);
+    void recordDeviceEnabled(const QString &devPath, bool enabled);
+    void recordConnectivity(int connectivity);
+    void recordVpnEnabled(bool enabled);
+
+    static QString kindName(int kind);
+    // 读取录制的文件, 格式不正确时 ok 为 false, 返回已读取的部分
+    static QList<Record> load(const QString &fileName, bool *ok = nullptr);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+    QElapsedTimer m_timer;
+    int m_recordCount;
+    QString m_lastPayloads[KindCount];
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // SIGNALRECORDER_H
@@ -1,13 +1,58 @@
-SOURCES += $$PWD/connectivitychecker.cpp \
+SOURCES += $$PWD/accesspointinfo.cpp \
+           $$PWD/activationtracker.cpp \
+           $$PWD/connectionrecord.cpp \
+           $$PWD/connectivitychecker.cpp \
+           $$PWD/daemonnetworkbackend.cpp \
+           $$PWD/devicestatushistory.cpp \
+           $$PWD/emitcounter.cpp \
+           $$PWD/eventtracer.cpp \
+           $$PWD/ingestpipeline.cpp \
+           $$PWD/latencyhistogram.cpp \
            $$PWD/networkdevice.cpp \
            $$PWD/networkmodel.cpp \
+           $$PWD/networkstats.cpp \
            $$PWD/networkworker.cpp \
+           $$PWD/nmnetworkbackend.cpp \
+           $$PWD/payloadcodec.cpp \
+           $$PWD/payloadparser.cpp \
+           $$PWD/pendingcallmanager.cpp \
+           $$PWD/proxybypassmatcher.cpp \
+           $$PWD/sharedsnapshot.cpp \
+           $$PWD/signalrecorder.cpp \
            $$PWD/wireddevice.cpp \
-           $$PWD/wirelessdevice.cpp
+           $$PWD/wirelessdevice.cpp \
+           $$PWD/wirelessscanscheduler.cpp
 
-HEADERS += $$PWD/connectivitychecker.h \
+HEADERS += $$PWD/accesspointinfo.h \
+           $$PWD/activationtracker.h \
+           $$PWD/connectionrecord.h \
+           $$PWD/connectivitychecker.h \
+           $$PWD/daemonnetworkbackend.h \
+           $$PWD/devicestatushistory.h \
+           $$PWD/emitcounter.h \
+           $$PWD/eventtracer.h \
+           $$PWD/ingestpipeline.h \
+           $$PWD/latencyhistogram.h \
+           $$PWD/networkbackend.h \
            $$PWD/networkdevice.h \
            $$PWD/networkmodel.h \
+           $$PWD/networkstats.h \
            $$PWD/networkworker.h \
+           $$PWD/nmnetworkbackend.h \
+           $$PWD/payloadcodec.h \
+           $$PWD/payloadparser.h \
+           $$PWD/pendingcallmanager.h \
+           $$PWD/proxybypassmatcher.h \
+           $$PWD/sharedsnapshot.h \
+           $$PWD/signalrecorder.h \
            $$PWD/wireddevice.h \
-           $$PWD/wirelessdevice.h
+           $$PWD/wirelessdevice.h \
+           $$PWD/wirelessscanscheduler.h
+
+# 本地 PAC 解析依赖 QtQml, 没有该模块时不编译
+qtHaveModule(qml) {
+    QT += qml
+    DEFINES += DDENETWORKUTILS_PAC
+    SOURCES += $$PWD/pacproxyresolver.cpp
+    HEADERS += $$PWD/pacproxyresolver.h
+}
@@ -26,25 +26,42 @@
 #include "wireddevice.h"
 
 #include <QDebug>
+#include <QMetaMethod>
 
 using namespace dde::network;
 
 WiredDevice::WiredDevice(const QJsonObject &info, QObject *parent)
     : NetworkDevice(NetworkDevice::Wired, info, parent)
+    , m_activeConnectionsHash(0)
+    , m_activeConnectionsInfoHash(0)
+    , m_connectionsHash(0)
 {
-
+    countSignalsOf(&staticMetaObject);
 }
 
 const QList<QJsonObject> WiredDevice::connections() const
 {
-    return m_connections;
+    return m_connections.items();
 }
 
 void WiredDevice::setConnections(const QList<QJsonObject> &connections)
 {
-    m_connections = connections;
+    setConnections(ConnectionRecord::fromObjects(connections));
+}
+
+void WiredDevice::setConnections(const QList<ConnectionRecord> &connections)
+{
+    if (!contentChanged(m_connectionsHash, m_connectionRecords, connections)) {
+        countSuppressedSignals(1);
+        return;
+    }
 
-    Q_EMIT connectionsChanged(m_connections);
+    m_connectionRecords = connections;
+    m_connections = ConnectionRecord::snapshot(connections);
+
+    // 信号的参数需要生成所有连接的列表, 没有接收者时推迟到 connections() 被调用时
+    if (isSignalConnected(QMetaMethod::fromSignal(&WiredDevice::connectionsChanged)))
+        Q_EMIT connectionsChanged(m_connections.items());
 }
 
 const QList<QJsonObject> WiredDevice::activeConnections() const
@@ -59,6 +76,16 @@ const QList<QJsonObject> WiredDevice::activeConnectionsInfo() const
 
 void WiredDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 {
+    setActiveConnections(activeConns, contentHash(activeConns));
+}
+
+void WiredDevice::setActiveConnections(const QList<QJsonObject> &activeConns, quint64 hash)
+{
+    if (!contentChanged(m_activeConnectionsHash, m_activeConnections, activeConns, hash)) {
+        countSuppressedSignals(1);
+        return;
+    }
+
     m_activeConnections = activeConns;
 
     Q_EMIT activeConnectionsChanged(m_activeConnections);
@@ -66,53 +93,49 @@ void WiredDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 
 void WiredDevice::setActiveConnectionsInfo(const QList<QJsonObject> &activeConnInfoList)
 {
-    m_activeConnectionsInfo = activeConnInfoList;
-
-    Q_EMIT activeWiredConnectionInfoChanged(activeWiredConnectionInfo());
-    Q_EMIT activeConnectionsInfoChanged(m_activeConnectionsInfo);
+    setActiveConnectionsInfo(activeConnInfoList, contentHash(activeConnInfoList));
 }
 
-const QList<QJsonObject> WiredDevice::activeVpnConnectionsInfo() const
+void WiredDevice::setActiveConnectionsInfo(const QList<QJsonObject> &activeConnInfoList, quint64 hash)
 {
-    QList<QJsonObject> activeVpns;
-    for (const QJsonObject &activeConn : m_activeConnectionsInfo) {
-        if (activeConn.value("ConnectionType").toString().startsWith("vpn-")) {
-            activeVpns.append(activeConn);
-        }
+    if (!contentChanged(m_activeConnectionsInfoHash, m_activeConnectionsInfo, activeConnInfoList, hash)) {
+        // activeWiredConnectionInfoChanged 和 activeConnectionsInfoChanged
+        countSuppressedSignals(2);
+        return;
     }
 
-    return activeVpns;
-}
+    m_activeConnectionsInfo = activeConnInfoList;
 
-const QJsonObject WiredDevice::activeWiredConnectionInfo() const
-{
+    // 一次遍历完成分类, 之后的各个 activeWiredConnXxx 接口都只是读取缓存
     QJsonObject activeWired;
+    m_activeVpnConnectionsInfo.clear();
     for (const QJsonObject &activeConn : m_activeConnectionsInfo) {
+        const QString &type = activeConn.value("ConnectionType").toString();
         // 当开启DSL连接时，类型为 pppoe
-        if (activeConn.value("ConnectionType").toString() == "wired"
-            || activeConn.value("ConnectionType").toString() == "pppoe") {
-            activeWired = activeConn;
-            break;
+        if (type == "wired" || type == "pppoe") {
+            if (activeWired.isEmpty())
+                activeWired = activeConn;
+        } else if (type.startsWith("vpn-")) {
+            m_activeVpnConnectionsInfo.append(activeConn);
         }
     }
+    m_activeWiredConnectionInfo = activeWired;
 
-    return activeWired;
+    Q_EMIT activeWiredConnectionInfoChanged(m_activeWiredConnectionInfo);
+    Q_EMIT activeConnectionsInfoChanged(m_activeConnectionsInfo);
 }
 
 const QString WiredDevice::activeWiredConnName() const
 {
-    const QJsonObject &conn = activeWiredConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("ConnectionName").toString();
+    return m_activeWiredConnectionInfo.value("ConnectionName").toString();
 }
 
 const QString WiredDevice::activeWiredConnUuid() const
 {
-    const QJsonObject &conn = activeWiredConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("ConnectionUuid").toString();
+    return m_activeWiredConnectionInfo.value("ConnectionUuid").toString();
 }
 
 const QString WiredDevice::activeWiredConnSettingPath() const
 {
-    const QJsonObject &conn = activeWiredConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("SettingPath").toString();
+    return m_activeWiredConnectionInfo.value("SettingPath").toString();
 }
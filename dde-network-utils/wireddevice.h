@@ -27,6 +27,7 @@
 #define WIREDDEVICE_H
 
 #include "networkdevice.h"
+#include "sharedsnapshot.h"
 
 #include <QJsonObject>
 #include <QDBusObjectPath>
@@ -43,13 +44,19 @@ public:
     explicit WiredDevice(const QJsonObject &info, QObject *parent = nullptr);
 
     const QList<QJsonObject> connections() const;
+    const ConnectionSnapshot connectionsSnapshot() const { return m_connections; }
     void setConnections(const QList<QJsonObject> &connections);
+    void setConnections(const QList<ConnectionRecord> &connections);
     const QList<QJsonObject> activeConnections() const;
     const QList<QJsonObject> activeConnectionsInfo() const;
     void setActiveConnections(const QList<QJsonObject> &activeConns);
+    // hash 为 NetworkDevice::contentHash(activeConns)
+    void setActiveConnections(const QList<QJsonObject> &activeConns, quint64 hash);
     void setActiveConnectionsInfo(const QList<QJsonObject> &activeConnInfoList);
-    const QList<QJsonObject> activeVpnConnectionsInfo() const;
-    const QJsonObject activeWiredConnectionInfo() const;
+    // hash 为 NetworkDevice::contentHash(activeConnInfoList)
+    void setActiveConnectionsInfo(const QList<QJsonObject> &activeConnInfoList, quint64 hash);
+    const QList<QJsonObject> activeVpnConnectionsInfo() const { return m_activeVpnConnectionsInfo; }
+    const QJsonObject activeWiredConnectionInfo() const { return m_activeWiredConnectionInfo; }
     const QString activeWiredConnName() const;
     const QString activeWiredConnUuid() const;
     const QString activeWiredConnSettingPath() const;
@@ -63,7 +70,16 @@ Q_SIGNALS:
 private:
     QList<QJsonObject> m_activeConnections;
     QList<QJsonObject> m_activeConnectionsInfo;
-    QList<QJsonObject> m_connections;
+    // 由 setActiveConnectionsInfo 分类缓存, 避免每次访问都遍历 m_activeConnectionsInfo
+    QJsonObject m_activeWiredConnectionInfo;
+    QList<QJsonObject> m_activeVpnConnectionsInfo;
+    ConnectionSnapshot m_connections;
+    // 与 m_connections 对应的记录, 哈希相同时用于确认内容没有变化
+    QList<ConnectionRecord> m_connectionRecords;
+
+    quint64 m_activeConnectionsHash;
+    quint64 m_activeConnectionsInfoHash;
+    quint64 m_connectionsHash;
 };
 
 }
@@ -33,14 +33,20 @@ using namespace dde::network;
 #include <QJsonValue>
 #include <QJsonDocument>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QMetaMethod>
 
 #define WIRELESS_PATH  "Path"
 #define WIRELESS_STRENGTH  "Strength"
 
 WirelessDevice::WirelessDevice(const QJsonObject &info, QObject *parent)
     : NetworkDevice(NetworkDevice::Wireless, info, parent)
-    , m_networkInter("com.deepin.daemon.Network", "/com/deepin/daemon/Network", QDBusConnection::sessionBus(), this)
+    , m_activeConnectionsHash(0)
+    , m_activeConnectionsInfoHash(0)
+    , m_connectionsHash(0)
+    , m_hotspotConnectionsHash(0)
 {
+    countSignalsOf(&staticMetaObject);
 }
 
 bool WirelessDevice::supportHotspot() const
@@ -65,53 +71,24 @@ const QList<QJsonObject> WirelessDevice::activeConnectionsInfo() const
     return m_activeConnectionsInfo;
 }
 
-const QList<QJsonObject> WirelessDevice::activeVpnConnectionsInfo() const
-{
-    QList<QJsonObject> activeVpns;
-    for (const QJsonObject &activeConn : m_activeConnectionsInfo) {
-        if (activeConn.value("ConnectionType").toString().startsWith("vpn-")) {
-            activeVpns.append(activeConn);
-        }
-    }
-
-    return activeVpns;
-}
-
-const QJsonObject WirelessDevice::activeWirelessConnectionInfo() const
-{
-    QJsonObject activeWireless;
-    for (const QJsonObject &activeConn : m_activeConnectionsInfo) {
-        if (activeConn.value("ConnectionType").toString() == "wireless") {
-            activeWireless = activeConn;
-            break;
-        }
-    }
-
-    return activeWireless;
-}
-
 const QString WirelessDevice::activeWirelessConnName() const
 {
-    const QJsonObject &conn = activeWirelessConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("ConnectionName").toString();
+    return m_activeWirelessConnectionInfo.value("ConnectionName").toString();
 }
 
 const QString WirelessDevice::activeWirelessConnUuid() const
 {
-    const QJsonObject &conn = activeWirelessConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("ConnectionUuid").toString();
+    return m_activeWirelessConnectionInfo.value("ConnectionUuid").toString();
 }
 
 const QString WirelessDevice::activeWirelessConnSettingPath() const
 {
-    const QJsonObject &conn = activeWirelessConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("SettingPath").toString();
+    return m_activeWirelessConnectionInfo.value("SettingPath").toString();
 }
 
 const QString WirelessDevice::activeWirelessConnSpecificObject() const
 {
-    const QJsonObject &conn = activeWirelessConnectionInfo();
-    return conn.isEmpty() ? QString() : conn.value("SpecificObject").toString();
+    return m_activeWirelessConnectionInfo.value("SpecificObject").toString();
 }
 
 const QJsonArray WirelessDevice::apList() const
@@ -123,9 +100,20 @@ const QJsonArray WirelessDevice::apList() const
     return apArray;
 }
 
+const AccessPointInfo WirelessDevice::accessPointInfo(const QJsonObject &apInfo) const
+{
+    return accessPointInfo(AccessPointInfo::key(apInfo));
+}
+
+const AccessPointInfo WirelessDevice::accessPointInfo(const QString &key) const
+{
+    return m_apStrengthHistory.value(key);
+}
+
 void WirelessDevice::updateWirlessAp()
 {
-    m_networkInter.RequestWirelessScan();
+    // 扫描请求交给 NetworkWorker 中的扫描调度器统一处理
+    Q_EMIT scanRequested();
 }
 
 void WirelessDevice::setAPList(const QJsonValue &wirelessList)
@@ -140,18 +128,23 @@ void WirelessDevice::setAPList(const QJsonValue &wirelessList)
 
         if (!path.isEmpty()) {
             if (!apsMapOld.contains(path)) {
+                markStateChanged();
                 Q_EMIT apAdded(ap);
             } else {
                 if (apsMapOld.value(path) != ap) {
+                    markStateChanged();
                     Q_EMIT apInfoChanged(ap);
                 }
             }
             m_apsMap.insert(path, ap);
+            recordApStrength(ap);
         }
     }
 
     for (auto path : apsMapOld.keys()) {
         if (!m_apsMap.contains(path)) {
+            m_apStrengthHistory.remove(AccessPointInfo::key(apsMapOld.value(path)));
+            markStateChanged();
             Q_EMIT apRemoved(apsMapOld.value(path));
         }
     }
@@ -165,6 +158,7 @@ void WirelessDevice::updateAPInfo(const QString &apInfo)
     const auto &path = ap.value(WIRELESS_PATH).toString();
 
     if (!path.isEmpty()) {
+        markStateChanged();
         if (ap.value("Path").toString() == activeApPath()) {
             m_activeApInfo = ap;
             Q_EMIT activeApInfoChanged(m_activeApInfo);
@@ -177,6 +171,7 @@ void WirelessDevice::updateAPInfo(const QString &apInfo)
         }
         // QMap will replace existing key-value
         m_apsMap.insert(path, ap);
+        recordApStrength(ap);
     }
 }
 
@@ -187,7 +182,8 @@ void WirelessDevice::deleteAP(const QString &apInfo)
 
     if (!path.isEmpty()) {
         if (m_apsMap.contains(path)) {
-            m_apsMap.remove(path);
+            m_apStrengthHistory.remove(AccessPointInfo::key(m_apsMap.take(path)));
+            markStateChanged();
             Q_EMIT apRemoved(ap);
         }
     }
@@ -195,6 +191,16 @@ void WirelessDevice::deleteAP(const QString &apInfo)
 
 void WirelessDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 {
+    setActiveConnections(activeConns, contentHash(activeConns));
+}
+
+void WirelessDevice::setActiveConnections(const QList<QJsonObject> &activeConns, quint64 hash)
+{
+    if (!contentChanged(m_activeConnectionsHash, m_activeConnections, activeConns, hash)) {
+        countSuppressedSignals(1);
+        return;
+    }
+
     m_activeConnections = activeConns;
 
     Q_EMIT activeConnectionsChanged(m_activeConnections);
@@ -202,17 +208,51 @@ void WirelessDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 
 void WirelessDevice::setActiveConnectionsInfo(const QList<QJsonObject> &activeConnsInfo)
 {
+    setActiveConnectionsInfo(activeConnsInfo, contentHash(activeConnsInfo));
+}
+
+void WirelessDevice::setActiveConnectionsInfo(const QList<QJsonObject> &activeConnsInfo, quint64 hash)
+{
+    if (!contentChanged(m_activeConnectionsInfoHash, m_activeConnectionsInfo, activeConnsInfo, hash)) {
+        // 内容不变时热点状态不会翻转, 不会发出 hotspotEnabledChanged; 其余的是 activeWirelessConnectionInfoChanged、
+        // activeConnectionsInfoChanged, 以及没有关联 AP 或能找到该 AP 时的 activeApInfoChanged
+        const QString &apPath = activeWirelessConnSpecificObject();
+        countSuppressedSignals(apPath.isEmpty() || m_apsMap.contains(apPath) ? 3 : 2);
+        return;
+    }
+
     m_activeConnectionsInfo = activeConnsInfo;
 
-    if (activeWirelessConnectionInfo().isEmpty()) {
+    // 一次遍历完成分类, 之后的各个 activeWirelessConnXxx 接口都只是读取缓存
+    QJsonObject activeWireless;
+    QJsonObject activeHotspot;
+    m_activeVpnConnectionsInfo.clear();
+    for (const QJsonObject &activeConn : m_activeConnectionsInfo) {
+        const QString &type = activeConn.value("ConnectionType").toString();
+        if (type == "wireless") {
+            if (activeWireless.isEmpty())
+                activeWireless = activeConn;
+        } else if (type == "wireless-hotspot") {
+            activeHotspot = activeConn;
+        } else if (type.startsWith("vpn-")) {
+            m_activeVpnConnectionsInfo.append(activeConn);
+        }
+    }
+    m_activeWirelessConnectionInfo = activeWireless;
+
+    if (m_activeWirelessConnectionInfo.isEmpty()) {
         m_activeApInfo = QJsonObject();
+        markStateChanged();
         Q_EMIT activeApInfoChanged(m_activeApInfo);
     } else {
         setActiveApByPath(activeWirelessConnSpecificObject());
     }
 
-    Q_EMIT activeWirelessConnectionInfoChanged(activeWirelessConnectionInfo());
+    Q_EMIT activeWirelessConnectionInfoChanged(m_activeWirelessConnectionInfo);
     Q_EMIT activeConnectionsInfoChanged(m_activeConnectionsInfo);
+
+    // 与原先由 NetworkModel 在设置连接信息之后更新热点的顺序一致
+    setActiveHotspotInfo(activeHotspot);
 }
 
 void WirelessDevice::setActiveHotspotInfo(const QJsonObject &hotspotInfo)
@@ -221,8 +261,10 @@ void WirelessDevice::setActiveHotspotInfo(const QJsonObject &hotspotInfo)
 
     m_activeHotspotInfo = hotspotInfo;
 
-    if (changed)
+    if (changed) {
+        markStateChanged();
         Q_EMIT hotspotEnabledChanged(hotspotEnabled());
+    }
 }
 
 void WirelessDevice::setActiveApByPath(const QString &path)
@@ -236,19 +278,58 @@ void WirelessDevice::setActiveApByPath(const QString &path)
         m_activeApInfo = it.value();
     }
 
+    markStateChanged();
     Q_EMIT activeApInfoChanged(m_activeApInfo);
 }
 
-void WirelessDevice::setConnections(const QList<QJsonObject> &connections)
+void WirelessDevice::recordApStrength(const QJsonObject &apInfo)
 {
-    m_connections = connections;
+    const QString &key = AccessPointInfo::key(apInfo);
+    if (key.isEmpty())
+        return;
 
-    Q_EMIT connectionsChanged(m_connections);
+    auto it = m_apStrengthHistory.find(key);
+    if (it == m_apStrengthHistory.end())
+        it = m_apStrengthHistory.insert(key, AccessPointInfo());
+
+    it.value().addSample(apInfo.value(WIRELESS_STRENGTH).toInt(), QElapsedTimer::msecsSinceReference());
+}
+
+void WirelessDevice::setConnections(const QList<QJsonObject> &connections)
+{
+    setConnections(ConnectionRecord::fromObjects(connections));
 }
 
 void WirelessDevice::setHotspotConnections(const QList<QJsonObject> &hotspotConnections)
 {
-    m_hotspotConnections = hotspotConnections;
+    setHotspotConnections(ConnectionRecord::fromObjects(hotspotConnections));
+}
+
+void WirelessDevice::setConnections(const QList<ConnectionRecord> &connections)
+{
+    if (!contentChanged(m_connectionsHash, m_connectionRecords, connections)) {
+        countSuppressedSignals(1);
+        return;
+    }
+
+    m_connectionRecords = connections;
+    m_connections = ConnectionRecord::snapshot(connections);
+
+    // 信号的参数需要生成所有连接的列表, 没有接收者时推迟到 connections() 被调用时
+    if (isSignalConnected(QMetaMethod::fromSignal(&WirelessDevice::connectionsChanged)))
+        Q_EMIT connectionsChanged(m_connections.items());
+}
+
+void WirelessDevice::setHotspotConnections(const QList<ConnectionRecord> &hotspotConnections)
+{
+    if (!contentChanged(m_hotspotConnectionsHash, m_hotspotConnectionRecords, hotspotConnections)) {
+        countSuppressedSignals(1);
+        return;
+    }
+
+    m_hotspotConnectionRecords = hotspotConnections;
+    m_hotspotConnections = ConnectionRecord::snapshot(hotspotConnections);
 
-    Q_EMIT hostspotConnectionsChanged(m_hotspotConnections);
+    if (isSignalConnected(QMetaMethod::fromSignal(&WirelessDevice::hostspotConnectionsChanged)))
+        Q_EMIT hostspotConnectionsChanged(m_hotspotConnections.items());
 }
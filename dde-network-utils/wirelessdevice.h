@@ -27,8 +27,11 @@
 #define WIRELESSDEVICE_H
 
 #include "networkdevice.h"
+#include "accesspointinfo.h"
+#include "sharedsnapshot.h"
 
 #include <QMap>
+#include <QHash>
 #include <QJsonArray>
 
 #include <com_deepin_daemon_network.h>
@@ -53,21 +56,25 @@ public:
 
     const QList<QJsonObject> activeConnections() const;
     const QList<QJsonObject> activeConnectionsInfo() const;
-    const QList<QJsonObject> activeVpnConnectionsInfo() const;
-    const QJsonObject activeWirelessConnectionInfo() const;
+    const QList<QJsonObject> activeVpnConnectionsInfo() const { return m_activeVpnConnectionsInfo; }
+    const QJsonObject activeWirelessConnectionInfo() const { return m_activeWirelessConnectionInfo; }
     const QString activeWirelessConnName() const;
     const QString activeWirelessConnUuid() const;
     const QString activeWirelessConnSettingPath() const;
     const QString activeWirelessConnSpecificObject() const;
 
-    const QList<QJsonObject> connections() const { return m_connections; }
-    const QList<QJsonObject> hotspotConnections() const { return m_hotspotConnections; }
+    const QList<QJsonObject> connections() const { return m_connections.items(); }
+    const QList<QJsonObject> hotspotConnections() const { return m_hotspotConnections.items(); }
+    const ConnectionSnapshot connectionsSnapshot() const { return m_connections; }
+    const ConnectionSnapshot hotspotConnectionsSnapshot() const { return m_hotspotConnections; }
 
     const QJsonArray apList() const;
     inline const QJsonObject activeApInfo() const { return m_activeApInfo; }
     inline const QString activeApSsid() const { return m_activeApInfo.value("Ssid").toString(); }
     inline const QString activeApPath() const { return m_activeApInfo.value("Path").toString(); }
     inline int activeApStrength() const { return m_activeApInfo.value("Strength").toInt(); }
+    const AccessPointInfo accessPointInfo(const QJsonObject &apInfo) const;
+    const AccessPointInfo accessPointInfo(const QString &key) const;
     void updateWirlessAp();
     
 Q_SIGNALS:
@@ -84,30 +91,50 @@ Q_SIGNALS:
     void activateAccessPointFailed(const QString &apPath, const QString &uuid);
     void connectionsChanged(const QList<QJsonObject> &connections) const;
     void hostspotConnectionsChanged(const QList<QJsonObject> &connections) const;
+    void scanRequested() const;
 
 public Q_SLOTS:
     void setAPList(const QJsonValue &wirelessList);
     void updateAPInfo(const QString &apInfo);
     void deleteAP(const QString &apInfo);
     void setActiveConnections(const QList<QJsonObject> &activeConns);
+    // hash 为 NetworkDevice::contentHash(activeConns)
+    void setActiveConnections(const QList<QJsonObject> &activeConns, quint64 hash);
     void setActiveConnectionsInfo(const QList<QJsonObject> &activeConnsInfo);
+    // hash 为 NetworkDevice::contentHash(activeConnsInfo)
+    void setActiveConnectionsInfo(const QList<QJsonObject> &activeConnsInfo, quint64 hash);
     void setActiveHotspotInfo(const QJsonObject &hotspotInfo);
     void setConnections(const QList<QJsonObject> &connections);
     void setHotspotConnections(const QList<QJsonObject> &hotspotConnections);
 
+public:
+    void setConnections(const QList<ConnectionRecord> &connections);
+    void setHotspotConnections(const QList<ConnectionRecord> &hotspotConnections);
+
 private:
     void setActiveApByPath(const QString &pathyy);
+    void recordApStrength(const QJsonObject &apInfo);
 
 private:
     QList<QJsonObject> m_activeConnections;
     QList<QJsonObject> m_activeConnectionsInfo;
+    // 由 setActiveConnectionsInfo 分类缓存, 避免每次访问都遍历 m_activeConnectionsInfo
+    QJsonObject m_activeWirelessConnectionInfo;
+    QList<QJsonObject> m_activeVpnConnectionsInfo;
     QJsonObject m_activeApInfo;
     QJsonObject m_activeHotspotInfo;
     QMap<QString, QJsonObject> m_apsMap;
-    QList<QJsonObject> m_connections;
-    QList<QJsonObject> m_hotspotConnections;
-
-    NetworkInter m_networkInter;
+    QHash<QString, AccessPointInfo> m_apStrengthHistory;
+    ConnectionSnapshot m_connections;
+    ConnectionSnapshot m_hotspotConnections;
+    // 与快照对应的记录, 哈希相同时用于确认内容没有变化
+    QList<ConnectionRecord> m_connectionRecords;
+    QList<ConnectionRecord> m_hotspotConnectionRecords;
+
+    quint64 m_activeConnectionsHash;
+    quint64 m_activeConnectionsInfoHash;
+    quint64 m_connectionsHash;
+    quint64 m_hotspotConnectionsHash;
 };
 
 }
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wirelessscanscheduler.h"
+#include "networkmodel.h"
+#include "wirelessdevice.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#define IDLE_INTERVAL (20 * 1000)
+#define ACTIVE_INTERVAL (5 * 1000)
+
+// 当前 AP 平滑后的信号强度低于此值, 或每秒下降超过 WEAKENING_TREND 时认为信号在变弱
+#define WEAK_STRENGTH 40
+#define WEAKENING_TREND -2.0
+
+using namespace dde::network;
+
+WirelessScanScheduler::WirelessScanScheduler(NetworkModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_scanTimer(new QTimer(this))
+    , m_idleInterval(IDLE_INTERVAL)
+    , m_activeInterval(ACTIVE_INTERVAL)
+    , m_visibleRefs(0)
+    , m_requestCount(0)
+    , m_scanCount(0)
+    , m_mergedCount(0)
+{
+    m_scanTimer->setSingleShot(true);
+
+    connect(m_scanTimer, &QTimer::timeout, this, &WirelessScanScheduler::onScanTimeout);
+}
+
+void WirelessScanScheduler::setIntervals(int idleMsec, int activeMsec)
+{
+    m_idleInterval = qMax(idleMsec, 0);
+    m_activeInterval = qBound(0, activeMsec, m_idleInterval);
+}
+
+void WirelessScanScheduler::requestScan(const QString &devPath)
+{
+    ++m_requestCount;
+
+    QList<WirelessDevice *> devices = wirelessDevices(devPath);
+    // 设备可能还没有加入 model, 按所有无线设备的间隔处理; 一个都没有时没有间隔可以参照, 直接扫描
+    if (devices.isEmpty() && !devPath.isEmpty()) {
+        qDebug() << "no wireless device" << devPath << "in model, scheduling scan for all devices";
+        devices = wirelessDevices(QString());
+    }
+
+    // 后端的一次扫描会覆盖所有无线设备, 因此只要有一个设备允许扫描就可以发起
+    const qint64 now = QElapsedTimer::msecsSinceReference();
+    qint64 due = devices.isEmpty() ? now : -1;
+    for (const WirelessDevice *dev : devices) {
+        const auto it = m_lastScan.constFind(dev->path());
+        const qint64 allowed = it == m_lastScan.constEnd() ? now : it.value() + scanInterval(dev);
+        due = due < 0 ? allowed : qMin(due, allowed);
+    }
+
+    schedule(static_cast<int>(qMax<qint64>(0, due - now)));
+}
+
+void WirelessScanScheduler::requestScanNow()
+{
+    ++m_requestCount;
+
+    schedule(0);
+}
+
+void WirelessScanScheduler::setListVisible(const bool visible)
+{
+    if (visible) {
+        ++m_visibleRefs;
+    } else if (m_visibleRefs > 0) {
+        --m_visibleRefs;
+    }
+
+    // 列表显示后允许更频繁的扫描, 提前已经在等待中的扫描
+    if (visible && m_scanTimer->isActive() && m_scanTimer->remainingTime() > m_activeInterval)
+        m_scanTimer->start(m_activeInterval);
+}
+
+void WirelessScanScheduler::schedule(int delay)
+{
+    if (m_scanTimer->isActive()) {
+        ++m_mergedCount;
+        if (delay < m_scanTimer->remainingTime())
+            m_scanTimer->start(delay);
+        return;
+    }
+
+    // 即使可以立即扫描也放到下一次事件循环, 让同一时刻的多个请求合并为一次
+    m_scanTimer->start(delay);
+}
+
+void WirelessScanScheduler::onScanTimeout()
+{
+    const qint64 now = QElapsedTimer::msecsSinceReference();
+
+    // 顺便清理已经移除的设备
+    m_lastScan.clear();
+    for (const WirelessDevice *dev : wirelessDevices(QString()))
+        m_lastScan.insert(dev->path(), now);
+
+    ++m_scanCount;
+
+    Q_EMIT scanRequired();
+}
+
+QList<WirelessDevice *> WirelessScanScheduler::wirelessDevices(const QString &devPath) const
+{
+    QList<WirelessDevice *> devices;
+    for (NetworkDevice *dev : m_model->devices()) {
+        if (dev->type() != NetworkDevice::Wireless)
+            continue;
+        if (!devPath.isEmpty() && dev->path() != devPath)
+            continue;
+
+        devices << static_cast<WirelessDevice *>(dev);
+    }
+
+    return devices;
+}
+
+bool WirelessScanScheduler::activeApWeakening(const WirelessDevice *dev) const
+{
+    const QJsonObject &activeAp = dev->activeApInfo();
+    if (activeAp.isEmpty())
+        return false;
+
+    const AccessPointInfo &info = dev->accessPointInfo(activeAp);
+    if (info.sampleCount() < 3)
+        return false;
+
+    return info.smoothedStrength() < WEAK_STRENGTH || info.trend() < WEAKENING_TREND;
+}
+
+int WirelessScanScheduler::scanInterval(const WirelessDevice *dev) const
+{
+    if (listVisible() || activeApWeakening(dev))
+        return m_activeInterval;
+
+    return m_idleInterval;
+}
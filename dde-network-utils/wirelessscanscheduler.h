@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIRELESSSCANSCHEDULER_H
+#define WIRELESSSCANSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+
+namespace dde {
+
+namespace network {
+
+class NetworkModel;
+class WirelessDevice;
+
+/**
+ * @brief WirelessScanScheduler 统一调度无线扫描请求
+ *
+ * 所有模块的扫描请求都汇总到这里: 同一时间只会有一次待执行的扫描, 之后到达的请求会合并到其中;
+ * 每个设备两次扫描之间至少间隔 idleInterval, 只有在无线列表可见或当前连接的 AP 信号在变弱时,
+ * 才允许以更短的 activeInterval 扫描. 用户主动发起的 requestScanNow 不受间隔限制, 但同样会合并.
+ */
+class WirelessScanScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WirelessScanScheduler(NetworkModel *model, QObject *parent = nullptr);
+
+    int idleInterval() const { return m_idleInterval; }
+    int activeInterval() const { return m_activeInterval; }
+    void setIntervals(int idleMsec, int activeMsec);
+
+    bool listVisible() const { return m_visibleRefs > 0; }
+
+    quint64 requestCount() const { return m_requestCount; }
+    quint64 scanCount() const { return m_scanCount; }
+    quint64 mergedCount() const { return m_mergedCount; }
+
+Q_SIGNALS:
+    // 需要真正向后端发起一次扫描
+    void scanRequired() const;
+
+public Q_SLOTS:
+    // devPath 为空表示扫描所有无线设备
+    void requestScan(const QString &devPath = QString());
+    // 用户主动刷新时调用, 在下一次事件循环中扫描
+    void requestScanNow();
+    // 无线列表显示/隐藏时调用, 支持多个列表同时显示(引用计数)
+    void setListVisible(const bool visible);
+
+private Q_SLOTS:
+    void onScanTimeout();
+
+private:
+    void schedule(int delay);
+    QList<WirelessDevice *> wirelessDevices(const QString &devPath) const;
+    bool activeApWeakening(const WirelessDevice *dev) const;
+    int scanInterval(const WirelessDevice *dev) const;
+
+private:
+    NetworkModel *m_model;
+    QTimer *m_scanTimer;
+    QHash<QString, qint64> m_lastScan;
+
+    int m_idleInterval;
+    int m_activeInterval;
+    int m_visibleRefs;
+
+    quint64 m_requestCount;
+    quint64 m_scanCount;
+    quint64 m_mergedCount;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // WIRELESSSCANSCHEDULER_H
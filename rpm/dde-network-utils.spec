@@ -10,6 +10,7 @@ BuildRequires:  gcc-c++
 #BuildRequires:  pkgconfig(dframeworkdbus) >= 2.0
 BuildRequires:  dde-qt-dbus-factory-devel
 BuildRequires:  pkgconfig(Qt5Core)
+BuildRequires:  pkgconfig(Qt5Qml)
 BuildRequires:  qt5-linguist
 BuildRequires:  pkgconfig(gsettings-qt)
 BuildRequires:  gtest-devel
@@ -0,0 +1,20 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// 统计经由全局 operator new 的堆分配次数, 只在基准测试程序中替换 operator new
+class AllocationCounter
+{
+public:
+    AllocationCounter() : m_start(total()) {}
+
+    quint64 allocations() const { return total() - m_start; }
+
+    static quint64 total();
+
+private:
+    quint64 m_start;
+};
+
+#endif // ALLOCATIONCOUNTER_H
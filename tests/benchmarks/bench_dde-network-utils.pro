@@ -0,0 +1,35 @@
+QT       += dbus network testlib
+QT       -= gui
+
+TARGET = bench_dde-network-utils
+TEMPLATE = app
+
+# 基准测试需要在优化后的代码上运行, 不加入 make check
+CONFIG += release
+CONFIG -= debug
+
+PKGCONFIG += dframeworkdbus gsettings-qt
+CONFIG += c++11 link_pkgconfig
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../dde-network-utils/src.pri)
+include(../common/common.pri)
+
+SOURCES += \
+    main.cpp \
+    allocationcounter.cpp \
+    bench_networkmodel.cpp \
+    bench_payloadcodec.cpp \
+    bench_proxybypassmatcher.cpp \
+    bench_sharedsnapshot.cpp
+
+HEADERS += \
+    allocationcounter.h \
+    bench_networkmodel.h \
+    bench_payloadcodec.h \
+    bench_proxybypassmatcher.h \
+    bench_sharedsnapshot.h
+
+INCLUDEPATH += ../../dde-network-utils
@@ -0,0 +1,261 @@
+#include "bench_networkmodel.h"
+#include "payloadgenerator.h"
+#include "networkmodel.h"
+#include "wirelessdevice.h"
+
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace dde::network;
+
+// 数据规模可以通过环境变量修改, 例如 BENCH_SIZES=10,100,1000
+static QList<int> sizes()
+{
+    QList<int> list;
+    const QByteArray env = qgetenv("BENCH_SIZES");
+    const QString value = env.isEmpty() ? QString("10,100,1000") : QString::fromLocal8Bit(env);
+    for (const QString &size : value.split(',', QString::SkipEmptyParts)) {
+        const int n = size.trimmed().toInt();
+        if (n > 0)
+            list << n;
+    }
+    return list;
+}
+
+static void addRows()
+{
+    QTest::addColumn<int>("count");
+
+    for (int n : sizes())
+        QTest::newRow(QByteArray::number(n).constData()) << n;
+}
+
+static QStringList devicePaths(int first, int count)
+{
+    QStringList paths;
+    for (int i = 0; i < count; ++i)
+        paths << PayloadGenerator::devicePath(first + i);
+    return paths;
+}
+
+// 当前进程的常驻内存, 先把已经释放的堆内存还给系统, 避免解析时的临时分配计入结果
+static qint64 residentBytes()
+{
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.value(1).toLongLong() * sysconf(_SC_PAGESIZE);
+}
+
+// model 的数据入口都是私有槽, 与真实场景一样通过元对象系统调用
+static void invoke(NetworkModel *model, const char *slot, const QString &payload)
+{
+    QMetaObject::invokeMethod(model, slot, Qt::DirectConnection, Q_ARG(QString, payload));
+}
+
+void BenchNetworkModel::devicesChanged_data()
+{
+    addRows();
+}
+
+void BenchNetworkModel::devicesChanged()
+{
+    QFETCH(int, count);
+
+    // 后端每次都发送完整的设备列表, 大多数情况下内容与上一次相同
+    const QString devices = PayloadGenerator::devices(count / 2, count - count / 2);
+    NetworkModel model;
+    invoke(&model, "onDevicesChanged", devices);
+
+    QBENCHMARK {
+        invoke(&model, "onDevicesChanged", devices);
+    }
+    QCOMPARE(model.devices().size(), count);
+}
+
+void BenchNetworkModel::connectionListChanged_data()
+{
+    addRows();
+}
+
+void BenchNetworkModel::connectionListChanged()
+{
+    QFETCH(int, count);
+
+    const QString conns[2] = {
+        PayloadGenerator::connections(count, "wired", 0),
+        PayloadGenerator::connections(count, "wired", 1),
+    };
+    NetworkModel model;
+    invoke(&model, "onDevicesChanged", PayloadGenerator::devices(1));
+
+    int generation = 0;
+    QBENCHMARK {
+        invoke(&model, "onConnectionListChanged", conns[generation ^= 1]);
+    }
+    QCOMPARE(model.wireds().size(), count);
+}
+
+void BenchNetworkModel::activeConnInfoChanged_data()
+{
+    addRows();
+}
+
+void BenchNetworkModel::activeConnInfoChanged()
+{
+    QFETCH(int, count);
+
+    const QString infos = PayloadGenerator::activeConnectionInfo(devicePaths(0, count));
+    NetworkModel model;
+    invoke(&model, "onDevicesChanged", PayloadGenerator::devices(count));
+
+    QBENCHMARK {
+        invoke(&model, "onActiveConnInfoChanged", infos);
+    }
+    QCOMPARE(model.activeConnInfos().size(), count);
+}
+
+void BenchNetworkModel::activeConnectionsChanged_data()
+{
+    addRows();
+}
+
+void BenchNetworkModel::activeConnectionsChanged()
+{
+    QFETCH(int, count);
+
+    const QString conns = PayloadGenerator::activeConnections(devicePaths(0, count));
+    NetworkModel model;
+    invoke(&model, "onDevicesChanged", PayloadGenerator::devices(count));
+
+    QBENCHMARK {
+        invoke(&model, "onActiveConnectionsChanged", conns);
+    }
+    QCOMPARE(model.activeConns().size(), count);
+}
+
+void BenchNetworkModel::setAPList_data()
+{
+    addRows();
+}
+
+void BenchNetworkModel::setAPList()
+{
+    QFETCH(int, count);
+
+    // 扫描结果刷新时信号强度变化, 每次都有 AP 需要更新
+    const QString devPath = PayloadGenerator::devicePath(0);
+    QJsonValue apLists[2];
+    for (int i = 0; i < 2; ++i) {
+        const QJsonObject aps = QJsonDocument::fromJson(PayloadGenerator::accessPoints({ devPath }, count, i).toUtf8()).object();
+        apLists[i] = aps.value(devPath);
+    }
+    WirelessDevice device(QJsonObject { { "Path", devPath }, { "Interface", "wlan0" } });
+
+    int generation = 0;
+    QBENCHMARK {
+        device.setAPList(apLists[generation ^= 1]);
+    }
+    QCOMPARE(device.apList().size(), count);
+}
+
+void BenchNetworkModel::lookup_data()
+{
+    QTest::addColumn<QString>("helper");
+    QTest::addColumn<int>("count");
+
+    for (const QString &helper : { "connectionByUuid", "connectionUuidByPath", "connectionUuidByApInfo", "activeConnObjectByUuid" }) {
+        for (int n : sizes())
+            QTest::newRow(QString("%1/%2").arg(helper).arg(n).toLatin1().constData()) << helper << n;
+    }
+}
+
+void BenchNetworkModel::lookup()
+{
+    QFETCH(QString, helper);
+    QFETCH(int, count);
+
+    NetworkModel model;
+    invoke(&model, "onDevicesChanged", PayloadGenerator::devices(0, count));
+    invoke(&model, "onConnectionListChanged", PayloadGenerator::connections(count, "wireless"));
+    invoke(&model, "onActiveConnectionsChanged", PayloadGenerator::activeConnections(devicePaths(0, count), "wireless"));
+
+    // 查找最后一项, 即线性查找的最坏情况
+    const int last = count - 1;
+    const QString uuid = PayloadGenerator::connectionUuid("wireless", last);
+    const QString path = QString("/org/freedesktop/NetworkManager/Settings/%1").arg(last);
+    const QJsonObject apInfo { { "Ssid", QString("ssid-%1").arg(last) } };
+
+    QString result;
+    if (helper == "connectionByUuid") {
+        QBENCHMARK {
+            result = model.connectionByUuid(uuid).value("Uuid").toString();
+        }
+    } else if (helper == "connectionUuidByPath") {
+        QBENCHMARK {
+            result = model.connectionUuidByPath(path);
+        }
+    } else if (helper == "connectionUuidByApInfo") {
+        QBENCHMARK {
+            result = model.connectionUuidByApInfo(apInfo);
+        }
+    } else {
+        QBENCHMARK {
+            result = model.activeConnObjectByUuid(uuid).value("Uuid").toString();
+        }
+    }
+    QCOMPARE(result, uuid);
+}
+
+void BenchNetworkModel::connectionsMemory_data()
+{
+    QTest::addColumn<QString>("storage");
+    QTest::addColumn<int>("count");
+
+    // objects: 以前 model 持有的解析后的 Json 对象
+    // records: 与解析结果共享数据的 ConnectionRecord
+    // decoded: 访问过 wireds() 之后, 还持有生成的连接列表
+    for (const QString &storage : { "objects", "records", "decoded" }) {
+        for (int n : sizes())
+            QTest::newRow(QString("%1/%2").arg(storage).arg(n).toLatin1().constData()) << storage << n;
+    }
+}
+
+void BenchNetworkModel::connectionsMemory()
+{
+    QFETCH(QString, storage);
+    QFETCH(int, count);
+
+    const QString conns = PayloadGenerator::connections(count, "wired");
+    NetworkModel model;
+    invoke(&model, "onDevicesChanged", PayloadGenerator::devices(1));
+
+    QList<QJsonObject> objects;
+    const qint64 baseline = residentBytes();
+    if (storage == "objects") {
+        const QJsonArray list = QJsonDocument::fromJson(conns.toUtf8()).object().value("wired").toArray();
+        for (const QJsonValue &conn : list)
+            objects << conn.toObject();
+    } else {
+        invoke(&model, "onConnectionListChanged", conns);
+        if (storage == "decoded")
+            objects = model.wireds();
+    }
+    const qint64 resident = residentBytes() - baseline;
+
+    QCOMPARE(storage == "records" ? model.connectionRecords("wired").size() : objects.size(), count);
+    // 结果是持有 count 个连接增加的常驻内存, 以页为单位变化, 数据量较小时只有参考意义
+    QTest::setBenchmarkResult(resident, QTest::BytesAllocated);
+}
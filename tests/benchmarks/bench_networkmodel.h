@@ -0,0 +1,27 @@
+#ifndef BENCH_NETWORKMODEL_H
+#define BENCH_NETWORKMODEL_H
+
+#include <QObject>
+
+class BenchNetworkModel : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void devicesChanged_data();
+    void devicesChanged();
+    void connectionListChanged_data();
+    void connectionListChanged();
+    void activeConnInfoChanged_data();
+    void activeConnInfoChanged();
+    void activeConnectionsChanged_data();
+    void activeConnectionsChanged();
+    void setAPList_data();
+    void setAPList();
+    void lookup_data();
+    void lookup();
+    void connectionsMemory_data();
+    void connectionsMemory();
+};
+
+#endif // BENCH_NETWORKMODEL_H
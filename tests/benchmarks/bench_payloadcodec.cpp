@@ -0,0 +1,89 @@
+#include "bench_payloadcodec.h"
+#include "payloadgenerator.h"
+#include "payloadcodec.h"
+#include "ingestpipeline.h"
+
+#include <QJsonDocument>
+#include <QtTest>
+
+using namespace dde::network;
+
+Q_DECLARE_METATYPE(IngestPipeline::PayloadKind)
+
+// 与 e2e 测试中 stand-in 的规模相同, 另加一组较大的数据
+static void addPayloadRows(bool withEncoding)
+{
+    QTest::addColumn<IngestPipeline::PayloadKind>("kind");
+    QTest::addColumn<QString>("payload");
+    QTest::addColumn<bool>("cbor");
+
+    const QStringList devicePaths { PayloadGenerator::devicePath(1) };
+    const struct {
+        const char *name;
+        IngestPipeline::PayloadKind kind;
+        QString payload;
+    } rows[] = {
+        { "connections/20", IngestPipeline::Connections, PayloadGenerator::connections(20) },
+        { "connections/1000", IngestPipeline::Connections, PayloadGenerator::connections(1000) },
+        { "accesspoints/30", IngestPipeline::AccessPoints, PayloadGenerator::accessPoints(devicePaths, 30) },
+        { "accesspoints/1000", IngestPipeline::AccessPoints, PayloadGenerator::accessPoints(devicePaths, 1000) },
+    };
+
+    for (const auto &row : rows) {
+        if (!withEncoding) {
+            QTest::newRow(row.name) << row.kind << row.payload << false;
+            continue;
+        }
+        QTest::newRow(QByteArray(row.name) + "/json") << row.kind << row.payload << false;
+        if (PayloadCodec::isCborSupported())
+            QTest::newRow(QByteArray(row.name) + "/cbor") << row.kind << row.payload << true;
+    }
+}
+
+void BenchPayloadCodec::payloadSize_data()
+{
+    addPayloadRows(false);
+}
+
+void BenchPayloadCodec::payloadSize()
+{
+    QFETCH(QString, payload);
+
+    if (!PayloadCodec::isCborSupported())
+        QSKIP("cbor needs Qt 5.12");
+
+    // Json 属性在总线上是 UTF-8 文本
+    const QJsonObject object = QJsonDocument::fromJson(payload.toUtf8()).object();
+    const int jsonBytes = payload.toUtf8().size();
+    const int cborBytes = PayloadCodec::encode(object, PayloadCodec::Cbor).size();
+    qInfo("json %d bytes, cbor %d bytes (%.1f%%)", jsonBytes, cborBytes, 100.0 * cborBytes / jsonBytes);
+
+    QCOMPARE(PayloadCodec::decode(PayloadCodec::encode(object, PayloadCodec::Cbor), PayloadCodec::Cbor), object);
+}
+
+void BenchPayloadCodec::parse_data()
+{
+    addPayloadRows(true);
+}
+
+void BenchPayloadCodec::parse()
+{
+    QFETCH(IngestPipeline::PayloadKind, kind);
+    QFETCH(QString, payload);
+    QFETCH(bool, cbor);
+
+    // 与 IngestParser 收到的数据相同: Json 为 QString, CBOR 为字节数组
+    const QByteArray encoded = PayloadCodec::encode(QJsonDocument::fromJson(payload.toUtf8()).object(), PayloadCodec::Cbor);
+
+    QVariant parsed;
+    if (cbor) {
+        QBENCHMARK {
+            parsed = IngestParser::parseCbor(kind, encoded);
+        }
+    } else {
+        QBENCHMARK {
+            parsed = IngestParser::parse(kind, payload);
+        }
+    }
+    QVERIFY(parsed.isValid());
+}
@@ -0,0 +1,17 @@
+#ifndef BENCH_PAYLOADCODEC_H
+#define BENCH_PAYLOADCODEC_H
+
+#include <QObject>
+
+class BenchPayloadCodec : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void payloadSize_data();
+    void payloadSize();
+    void parse_data();
+    void parse();
+};
+
+#endif // BENCH_PAYLOADCODEC_H
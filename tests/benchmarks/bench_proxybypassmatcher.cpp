@@ -0,0 +1,124 @@
+#include "bench_proxybypassmatcher.h"
+#include "proxybypassmatcher.h"
+
+#include <QtTest>
+#include <QHostAddress>
+
+using namespace dde::network;
+
+static const int RuleCount = 10000;
+
+// 使用方目前的做法: 每次都重新解析 ignoreHosts 并逐条匹配
+static bool linearMatch(const QString &ignoreHosts, const QString &host)
+{
+    const QHostAddress address(host);
+    for (QString rule : ignoreHosts.split(',', QString::SkipEmptyParts)) {
+        rule = rule.trimmed();
+        if (rule.contains('/')) {
+            if (!address.isNull() && address.isInSubnet(QHostAddress::parseSubnet(rule)))
+                return true;
+            continue;
+        }
+        if (rule.startsWith("*."))
+            rule = rule.mid(1);
+        if (host == rule || host.endsWith(rule.startsWith('.') ? rule : "." + rule))
+            return true;
+    }
+
+    return false;
+}
+
+void BenchProxyBypassMatcher::initTestCase()
+{
+    QStringList rules;
+    for (int i = 0; rules.size() < RuleCount; ++i) {
+        switch (i % 4) {
+        case 0:
+            rules << QString("host%1.example%2.com").arg(i).arg(i % 100);
+            m_hits << QString("host%1.example%2.com").arg(i).arg(i % 100);
+            break;
+        case 1:
+            rules << QString("*.svc%1.corp").arg(i);
+            m_hits << QString("api.svc%1.corp").arg(i);
+            break;
+        case 2:
+            rules << QString("10.%1.%2.0/24").arg((i >> 8) & 0xff).arg(i & 0xff);
+            m_hits << QString("10.%1.%2.42").arg((i >> 8) & 0xff).arg(i & 0xff);
+            break;
+        default:
+            rules << QString("fd00:%1::/32").arg(i, 0, 16);
+            m_hits << QString("fd00:%1::1").arg(i, 0, 16);
+            break;
+        }
+    }
+    m_ignoreHosts = rules.join(", ");
+
+    for (int i = 0; i < 1000; ++i) {
+        m_misses << QString("www%1.deepin.org").arg(i)
+                 << QString("172.16.%1.%2").arg(i >> 8).arg(i & 0xff);
+    }
+}
+
+void BenchProxyBypassMatcher::compile_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << RuleCount;
+}
+
+void BenchProxyBypassMatcher::compile()
+{
+    QFETCH(int, count);
+
+    const QString hosts = m_ignoreHosts.section(", ", 0, count - 1);
+    QBENCHMARK {
+        ProxyBypassMatcher matcher(hosts);
+        Q_UNUSED(matcher);
+    }
+}
+
+void BenchProxyBypassMatcher::matchHit_data()
+{
+    QTest::addColumn<bool>("linear");
+
+    QTest::newRow("matcher") << false;
+    QTest::newRow("linear") << true;
+}
+
+void BenchProxyBypassMatcher::matchHit()
+{
+    QFETCH(bool, linear);
+
+    const ProxyBypassMatcher matcher(m_ignoreHosts);
+    // 线性匹配太慢, 只取少量样本
+    const QStringList hosts = linear ? m_hits.mid(0, 20) : m_hits;
+    int matched = 0;
+    QBENCHMARK {
+        matched = 0;
+        for (const QString &host : hosts)
+            matched += linear ? linearMatch(m_ignoreHosts, host) : matcher.matches(host);
+    }
+    QCOMPARE(matched, hosts.size());
+}
+
+void BenchProxyBypassMatcher::matchMiss_data()
+{
+    matchHit_data();
+}
+
+void BenchProxyBypassMatcher::matchMiss()
+{
+    QFETCH(bool, linear);
+
+    const ProxyBypassMatcher matcher(m_ignoreHosts);
+    const QStringList hosts = linear ? m_misses.mid(0, 20) : m_misses;
+    int matched = 0;
+    QBENCHMARK {
+        matched = 0;
+        for (const QString &host : hosts)
+            matched += linear ? linearMatch(m_ignoreHosts, host) : matcher.matches(host);
+    }
+    QCOMPARE(matched, 0);
+}
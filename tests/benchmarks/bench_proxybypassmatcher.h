@@ -0,0 +1,27 @@
+#ifndef BENCH_PROXYBYPASSMATCHER_H
+#define BENCH_PROXYBYPASSMATCHER_H
+
+#include <QObject>
+#include <QStringList>
+
+class BenchProxyBypassMatcher : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void compile_data();
+    void compile();
+    void matchHit_data();
+    void matchHit();
+    void matchMiss_data();
+    void matchMiss();
+
+private:
+    QString m_ignoreHosts;
+    QStringList m_hits;
+    QStringList m_misses;
+};
+
+#endif // BENCH_PROXYBYPASSMATCHER_H
@@ -0,0 +1,146 @@
+#include "bench_sharedsnapshot.h"
+#include "allocationcounter.h"
+#include "sharedsnapshot.h"
+
+#include <QtTest>
+#include <QMap>
+
+using namespace dde::network;
+
+static QList<QJsonObject> profiles(int count)
+{
+    QList<QJsonObject> list;
+    for (int i = 0; i < count; ++i) {
+        list << QJsonObject {
+            { "Id", QString("vpn-%1").arg(i) },
+            { "Uuid", QString("8e3c7a52-0000-4000-8000-%1").arg(i, 12, 10, QChar('0')) },
+            { "Path", QString("/org/freedesktop/NetworkManager/Settings/%1").arg(i) },
+            { "HwAddress", QString() },
+        };
+    }
+    return list;
+}
+
+// 原来的访问方式: QMap::value 按值返回, 调用方拿到可修改的副本
+struct ListModel
+{
+    explicit ListModel(const QList<QJsonObject> &list) { connections.insert("vpn", list); }
+    const QList<QJsonObject> vpns() const { return connections.value("vpn"); }
+
+    QMap<QString, QList<QJsonObject>> connections;
+};
+
+struct SnapshotModel
+{
+    explicit SnapshotModel(const QList<QJsonObject> &list) : snapshot(list) {}
+    const ConnectionSnapshot vpnsSnapshot() const { return snapshot; }
+
+    ConnectionSnapshot snapshot;
+};
+
+static void addRows()
+{
+    QTest::addColumn<bool>("useSnapshot");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("list/1k") << false << 1000;
+    QTest::newRow("snapshot/1k") << true << 1000;
+    QTest::newRow("list/10k") << false << 10000;
+    QTest::newRow("snapshot/10k") << true << 10000;
+}
+
+// 调用方常见的用法: 保存返回值后用范围 for 遍历, 非 const 的 QList 会因此深拷贝
+static int iterateList(const ListModel &model)
+{
+    int n = 0;
+    QList<QJsonObject> vpns = model.vpns();
+    for (QJsonObject &conn : vpns)
+        n += conn.size();
+    return n;
+}
+
+static int iterateSnapshot(const SnapshotModel &model)
+{
+    int n = 0;
+    ConnectionSnapshot vpns = model.vpnsSnapshot();
+    for (const QJsonObject &conn : vpns)
+        n += conn.size();
+    return n;
+}
+
+void BenchSharedSnapshot::accessor_data()
+{
+    addRows();
+}
+
+void BenchSharedSnapshot::accessor()
+{
+    QFETCH(bool, useSnapshot);
+    QFETCH(int, count);
+
+    const QList<QJsonObject> list = profiles(count);
+    const ListModel listModel(list);
+    const SnapshotModel snapshotModel(list);
+
+    int size = 0;
+    if (useSnapshot) {
+        QBENCHMARK {
+            size += snapshotModel.vpnsSnapshot().size();
+        }
+    } else {
+        QBENCHMARK {
+            size += listModel.vpns().size();
+        }
+    }
+    QVERIFY(size > 0);
+}
+
+void BenchSharedSnapshot::iterate_data()
+{
+    addRows();
+}
+
+void BenchSharedSnapshot::iterate()
+{
+    QFETCH(bool, useSnapshot);
+    QFETCH(int, count);
+
+    const QList<QJsonObject> list = profiles(count);
+    const ListModel listModel(list);
+    const SnapshotModel snapshotModel(list);
+
+    int fields = 0;
+    if (useSnapshot) {
+        QBENCHMARK {
+            fields = iterateSnapshot(snapshotModel);
+        }
+    } else {
+        QBENCHMARK {
+            fields = iterateList(listModel);
+        }
+    }
+    QCOMPARE(fields, count * 4);
+}
+
+void BenchSharedSnapshot::iterateAllocations_data()
+{
+    addRows();
+}
+
+void BenchSharedSnapshot::iterateAllocations()
+{
+    QFETCH(bool, useSnapshot);
+    QFETCH(int, count);
+
+    const QList<QJsonObject> list = profiles(count);
+    const ListModel listModel(list);
+    const SnapshotModel snapshotModel(list);
+
+    const AllocationCounter counter;
+    const int fields = useSnapshot ? iterateSnapshot(snapshotModel) : iterateList(listModel);
+    const quint64 allocations = counter.allocations();
+
+    QCOMPARE(fields, count * 4);
+    // 结果以事件数输出, 表示一次遍历中 operator new 的调用次数
+    QTest::setBenchmarkResult(allocations, QTest::Events);
+}
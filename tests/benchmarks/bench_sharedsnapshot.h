@@ -0,0 +1,19 @@
+#ifndef BENCH_SHAREDSNAPSHOT_H
+#define BENCH_SHAREDSNAPSHOT_H
+
+#include <QObject>
+
+class BenchSharedSnapshot : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void accessor_data();
+    void accessor();
+    void iterate_data();
+    void iterate();
+    void iterateAllocations_data();
+    void iterateAllocations();
+};
+
+#endif // BENCH_SHAREDSNAPSHOT_H
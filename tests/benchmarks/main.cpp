@@ -0,0 +1,48 @@
+#include "bench_networkmodel.h"
+#include "bench_payloadcodec.h"
+#include "bench_proxybypassmatcher.h"
+#include "bench_sharedsnapshot.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QtTest>
+
+// --results-dir <dir>: 每组基准测试的结果另外以 csv 格式写入 <dir>/<组名>.csv, 便于比较不同版本
+static int exec(QObject *bench, const QStringList &args, const QString &resultsDir)
+{
+    if (resultsDir.isEmpty())
+        return QTest::qExec(bench, args);
+
+    const QString file = QDir(resultsDir).filePath(QString(bench->metaObject()->className()) + ".csv");
+    return QTest::qExec(bench, QStringList(args) << "-o" << file + ",csv" << "-o" << "-,txt");
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    QString resultsDir;
+    const int index = args.indexOf("--results-dir");
+    if (index > 0 && index + 1 < args.size()) {
+        resultsDir = args.at(index + 1);
+        args.erase(args.begin() + index, args.begin() + index + 2);
+        QDir().mkpath(resultsDir);
+    }
+
+    int ret = 0;
+
+    BenchNetworkModel networkModel;
+    ret |= exec(&networkModel, args, resultsDir);
+
+    BenchPayloadCodec payloadCodec;
+    ret |= exec(&payloadCodec, args, resultsDir);
+
+    BenchProxyBypassMatcher proxyBypassMatcher;
+    ret |= exec(&proxyBypassMatcher, args, resultsDir);
+
+    BenchSharedSnapshot sharedSnapshot;
+    ret |= exec(&sharedSnapshot, args, resultsDir);
+
+    return ret;
+}
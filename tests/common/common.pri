@@ -0,0 +1,8 @@
+# 测试和基准测试共用的 FakeNetworkBackend 及数据生成器
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/fakenetworkbackend.cpp \
+           $$PWD/payloadgenerator.cpp
+
+HEADERS += $$PWD/fakenetworkbackend.h \
+           $$PWD/payloadgenerator.h
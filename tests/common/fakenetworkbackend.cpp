@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fakenetworkbackend.h"
+
+#include <QTimer>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+
+using namespace dde::network;
+
+const QString fakeService = "com.deepin.daemon.Network";
+const QString fakePath = "/com/deepin/daemon/Network";
+
+// Connectivity::Full, 避免 model 启动联网检测
+#define FULL_CONNECTIVITY   4
+
+FakeNetworkBackend::FakeNetworkBackend(QObject *parent)
+    : NetworkBackend(parent)
+    , m_vpnEnabled(false)
+    , m_connectivity(FULL_CONNECTIVITY)
+{
+    m_properties.insert(Devices, "{}");
+    m_properties.insert(Connections, "{}");
+    m_properties.insert(ActiveConnections, "{}");
+    m_properties.insert(AccessPoints, "{}");
+}
+
+void FakeNetworkBackend::updateProperty(Property property, const QString &value)
+{
+    m_properties.insert(property, value);
+
+    switch (property) {
+    case Devices:           Q_EMIT devicesChanged(value);               break;
+    case Connections:       Q_EMIT connectionsChanged(value);           break;
+    case ActiveConnections: Q_EMIT activeConnectionsChanged(value);     break;
+    case AccessPoints:      Q_EMIT wirelessAccessPointsChanged(value);  break;
+    }
+}
+
+void FakeNetworkBackend::setConnectivityState(int connectivity)
+{
+    m_connectivity = connectivity;
+
+    Q_EMIT connectivityChanged(connectivity);
+}
+
+void FakeNetworkBackend::setDeviceEnabledState(const QString &devPath, bool enabled)
+{
+    m_deviceEnabled.insert(devPath, enabled);
+
+    Q_EMIT deviceEnabled(devPath, enabled);
+}
+
+void FakeNetworkBackend::setChainsProperties(const QVariantMap &properties)
+{
+    m_chainsProperties = properties;
+}
+
+void FakeNetworkBackend::setReply(const QString &method, const QVariantList &arguments)
+{
+    m_errors.remove(method);
+    m_replies.insert(method, arguments);
+}
+
+void FakeNetworkBackend::setError(const QString &method, const QString &message)
+{
+    m_errors.insert(method, message);
+}
+
+void FakeNetworkBackend::inject(Property property, int count, int ratePerSecond, const Generator &generator)
+{
+    if (count <= 0)
+        return;
+
+    if (ratePerSecond <= 0) {
+        for (int i = 0; i < count; ++i)
+            updateProperty(property, generator(i));
+
+        if (m_streams.isEmpty())
+            Q_EMIT injectionFinished();
+        return;
+    }
+
+    // 定时器精度只有 1ms, 更高的频率在每次触发时注入多个事件
+    const int perTick = (ratePerSecond + 999) / 1000;
+
+    QTimer *timer = new QTimer(this);
+    timer->setInterval(qMax(1, 1000 * perTick / ratePerSecond));
+    connect(timer, &QTimer::timeout, this, [=] { injectNext(timer); });
+
+    m_streams.insert(timer, Stream { property, count, 0, perTick, generator });
+    timer->start();
+}
+
+void FakeNetworkBackend::stopInjection()
+{
+    const QList<QTimer *> timers = m_streams.keys();
+    m_streams.clear();
+    qDeleteAll(timers);
+}
+
+void FakeNetworkBackend::setVpnEnabled(bool enabled)
+{
+    if (m_vpnEnabled == enabled)
+        return;
+
+    m_vpnEnabled = enabled;
+
+    Q_EMIT vpnEnabledChanged(enabled);
+}
+
+QDBusPendingCall FakeNetworkBackend::activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath)
+{
+    return reply("ActivateAccessPoint", { uuid, apPath, devPath },
+                 { QVariant::fromValue(QDBusObjectPath("/org/freedesktop/NetworkManager/ActiveConnection/0")) });
+}
+
+QDBusPendingCall FakeNetworkBackend::activateConnection(const QString &uuid, const QString &devPath)
+{
+    return reply("ActivateConnection", { uuid, devPath },
+                 { QVariant::fromValue(QDBusObjectPath("/org/freedesktop/NetworkManager/ActiveConnection/0")) });
+}
+
+QDBusPendingCall FakeNetworkBackend::cancelSecret(const QString &connectionPath, const QString &settingName)
+{
+    return reply("CancelSecret", { connectionPath, settingName });
+}
+
+QDBusPendingCall FakeNetworkBackend::createConnection(const QString &type, const QString &devPath)
+{
+    return reply("CreateConnection", { type, devPath },
+                 { QVariant::fromValue(QDBusObjectPath("/com/deepin/daemon/ConnectionSession/0")) });
+}
+
+QDBusPendingCall FakeNetworkBackend::createConnectionForAccessPoint(const QString &apPath, const QString &devPath)
+{
+    return reply("CreateConnectionForAccessPoint", { apPath, devPath },
+                 { QVariant::fromValue(QDBusObjectPath("/com/deepin/daemon/ConnectionSession/0")) });
+}
+
+QDBusPendingCall FakeNetworkBackend::deactivateConnection(const QString &uuid)
+{
+    return reply("DeactivateConnection", { uuid });
+}
+
+QDBusPendingCall FakeNetworkBackend::deleteConnection(const QString &uuid)
+{
+    return reply("DeleteConnection", { uuid });
+}
+
+QDBusPendingCall FakeNetworkBackend::disconnectDevice(const QString &devPath)
+{
+    return reply("DisconnectDevice", { devPath });
+}
+
+QDBusPendingCall FakeNetworkBackend::editConnection(const QString &uuid, const QString &devPath)
+{
+    return reply("EditConnection", { uuid, devPath },
+                 { QVariant::fromValue(QDBusObjectPath("/com/deepin/daemon/ConnectionSession/0")) });
+}
+
+QDBusPendingCall FakeNetworkBackend::enableDevice(const QString &devPath, bool enabled)
+{
+    m_deviceEnabled.insert(devPath, enabled);
+
+    return reply("EnableDevice", { devPath, enabled });
+}
+
+QDBusPendingCall FakeNetworkBackend::enableWirelessHotspotMode(const QString &devPath)
+{
+    return reply("EnableWirelessHotspotMode", { devPath });
+}
+
+QDBusPendingCall FakeNetworkBackend::feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect)
+{
+    return reply("FeedSecret", { connectionPath, settingName, password, autoConnect });
+}
+
+QDBusPendingCall FakeNetworkBackend::getActiveConnectionInfo()
+{
+    return reply("GetActiveConnectionInfo", {}, { QString("[]") });
+}
+
+QDBusPendingCall FakeNetworkBackend::getAutoProxy()
+{
+    return reply("GetAutoProxy", {}, { QString() });
+}
+
+QDBusPendingCall FakeNetworkBackend::getConnectivity()
+{
+    return reply("Properties.Get", { fakeService, QString("Connectivity") },
+                 { QVariant::fromValue(QDBusVariant(m_connectivity)) });
+}
+
+QDBusPendingCall FakeNetworkBackend::getProxy(const QString &type)
+{
+    return reply("GetProxy", { type }, { QString(), QString("0") });
+}
+
+QDBusPendingCall FakeNetworkBackend::getProxyIgnoreHosts()
+{
+    return reply("GetProxyIgnoreHosts", {}, { QString() });
+}
+
+QDBusPendingCall FakeNetworkBackend::getProxyMethod()
+{
+    return reply("GetProxyMethod", {}, { QString("none") });
+}
+
+QDBusPendingCall FakeNetworkBackend::isDeviceEnabled(const QString &devPath)
+{
+    return reply("IsDeviceEnabled", { devPath }, { m_deviceEnabled.value(devPath, true) });
+}
+
+QDBusPendingCall FakeNetworkBackend::requestWirelessScan()
+{
+    return reply("RequestWirelessScan", {});
+}
+
+QDBusPendingCall FakeNetworkBackend::setAutoProxy(const QString &proxy)
+{
+    return reply("SetAutoProxy", { proxy });
+}
+
+QDBusPendingCall FakeNetworkBackend::setDeviceManaged(const QString &devPath, bool managed)
+{
+    return reply("SetDeviceManaged", { devPath, managed });
+}
+
+QDBusPendingCall FakeNetworkBackend::setProxy(const QString &type, const QString &addr, const QString &port)
+{
+    return reply("SetProxy", { type, addr, port });
+}
+
+QDBusPendingCall FakeNetworkBackend::setProxyIgnoreHosts(const QString &hosts)
+{
+    return reply("SetProxyIgnoreHosts", { hosts });
+}
+
+QDBusPendingCall FakeNetworkBackend::setProxyMethod(const QString &proxyMethod)
+{
+    return reply("SetProxyMethod", { proxyMethod });
+}
+
+QDBusPendingCall FakeNetworkBackend::getChainsProperties()
+{
+    return reply("Properties.GetAll", { QString("com.deepin.daemon.Network.ProxyChains") },
+                 { m_chainsProperties });
+}
+
+QDBusPendingCall FakeNetworkBackend::setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password)
+{
+    return reply("ProxyChains.Set", { type, ip, port, user, password });
+}
+
+QDBusPendingCall FakeNetworkBackend::reply(const QString &method, const QVariantList &arguments, const QVariantList &defaultReply)
+{
+    m_calls[method] << arguments;
+
+    // 不是回复的消息构造出的调用永远不会完成
+    if (m_hanging.contains(method))
+        return QDBusPendingCall::fromCompletedCall(QDBusMessage());
+
+    const QDBusMessage call = QDBusMessage::createMethodCall(fakeService, fakePath, fakeService, method);
+    if (m_errors.contains(method))
+        return QDBusPendingCall::fromCompletedCall(call.createErrorReply(QDBusError::Failed, m_errors.value(method)));
+
+    return QDBusPendingCall::fromCompletedCall(call.createReply(m_replies.value(method, defaultReply)));
+}
+
+void FakeNetworkBackend::injectNext(QTimer *timer)
+{
+    auto it = m_streams.find(timer);
+    if (it == m_streams.end())
+        return;
+
+    Stream &stream = it.value();
+    const Property property = stream.property;
+    const int first = stream.next;
+    const int last = qMin(stream.count, first + stream.perTick);
+    const Generator generator = stream.generator;
+    stream.next = last;
+
+    const bool finished = last >= stream.count;
+    if (finished) {
+        m_streams.erase(it);
+        timer->deleteLater();
+    }
+
+    for (int i = first; i < last; ++i)
+        updateProperty(property, generator(i));
+
+    if (finished && m_streams.isEmpty())
+        Q_EMIT injectionFinished();
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAKENETWORKBACKEND_H
+#define FAKENETWORKBACKEND_H
+
+#include "networkbackend.h"
+
+#include <QHash>
+#include <QSet>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <functional>
+
+class QTimer;
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief FakeNetworkBackend 不依赖 DBus 的进程内 backend, 供测试和基准测试使用
+ *
+ * - 属性保存在本地, 修改后立即发出对应的变化信号
+ * - 方法调用全部记录下来, 并立即返回 setReply()/setError() 设置的结果
+ * - inject() 按指定频率注入属性变化事件, 用于对 model 做压力测试
+ */
+class FakeNetworkBackend : public NetworkBackend
+{
+    Q_OBJECT
+
+public:
+    enum Property {
+        Devices,
+        Connections,
+        ActiveConnections,
+        AccessPoints
+    };
+
+    // 根据事件序号生成属性的新值
+    typedef std::function<QString(int)> Generator;
+
+    explicit FakeNetworkBackend(QObject *parent = nullptr);
+
+    // 修改属性并发出变化信号
+    void updateProperty(Property property, const QString &value);
+    void setConnectivityState(int connectivity);
+    void setDeviceEnabledState(const QString &devPath, bool enabled);
+    void setChainsProperties(const QVariantMap &properties);
+
+    // 指定方法的返回值, 未指定时返回合理的默认值
+    void setReply(const QString &method, const QVariantList &arguments);
+    void setError(const QString &method, const QString &message);
+    // 指定方法的调用永远不会返回, 用于测试超时
+    void setHanging(const QString &method) { m_hanging.insert(method); }
+
+    int callCount(const QString &method) const { return m_calls.value(method).size(); }
+    const QList<QVariantList> calls(const QString &method) const { return m_calls.value(method); }
+    void clearCalls() { m_calls.clear(); }
+
+    // 以 ratePerSecond 的频率注入 count 次事件, ratePerSecond 不大于 0 时立即全部注入
+    void inject(Property property, int count, int ratePerSecond, const Generator &generator);
+    void stopInjection();
+    bool isInjecting() const { return !m_streams.isEmpty(); }
+
+    QString devices() const override { return m_properties.value(Devices); }
+    QString connections() const override { return m_properties.value(Connections); }
+    QString activeConnections() const override { return m_properties.value(ActiveConnections); }
+    QString wirelessAccessPoints() const override { return m_properties.value(AccessPoints); }
+    bool vpnEnabled() const override { return m_vpnEnabled; }
+    int connectivity() const override { return m_connectivity; }
+    void setVpnEnabled(bool enabled) override;
+
+    QDBusPendingCall activateAccessPoint(const QString &uuid, const QString &apPath, const QString &devPath) override;
+    QDBusPendingCall activateConnection(const QString &uuid, const QString &devPath) override;
+    QDBusPendingCall cancelSecret(const QString &connectionPath, const QString &settingName) override;
+    QDBusPendingCall createConnection(const QString &type, const QString &devPath) override;
+    QDBusPendingCall createConnectionForAccessPoint(const QString &apPath, const QString &devPath) override;
+    QDBusPendingCall deactivateConnection(const QString &uuid) override;
+    QDBusPendingCall deleteConnection(const QString &uuid) override;
+    QDBusPendingCall disconnectDevice(const QString &devPath) override;
+    QDBusPendingCall editConnection(const QString &uuid, const QString &devPath) override;
+    QDBusPendingCall enableDevice(const QString &devPath, bool enabled) override;
+    QDBusPendingCall enableWirelessHotspotMode(const QString &devPath) override;
+    QDBusPendingCall feedSecret(const QString &connectionPath, const QString &settingName, const QString &password, bool autoConnect) override;
+    QDBusPendingCall getActiveConnectionInfo() override;
+    QDBusPendingCall getAutoProxy() override;
+    QDBusPendingCall getConnectivity() override;
+    QDBusPendingCall getProxy(const QString &type) override;
+    QDBusPendingCall getProxyIgnoreHosts() override;
+    QDBusPendingCall getProxyMethod() override;
+    QDBusPendingCall isDeviceEnabled(const QString &devPath) override;
+    QDBusPendingCall requestWirelessScan() override;
+    QDBusPendingCall setAutoProxy(const QString &proxy) override;
+    QDBusPendingCall setDeviceManaged(const QString &devPath, bool managed) override;
+    QDBusPendingCall setProxy(const QString &type, const QString &addr, const QString &port) override;
+    QDBusPendingCall setProxyIgnoreHosts(const QString &hosts) override;
+    QDBusPendingCall setProxyMethod(const QString &proxyMethod) override;
+
+    QDBusPendingCall getChainsProperties() override;
+    QDBusPendingCall setChainsProxy(const QString &type, const QString &ip, uint port, const QString &user, const QString &password) override;
+
+Q_SIGNALS:
+    void injectionFinished() const;
+
+private:
+    struct Stream
+    {
+        Property property;
+        int count;
+        int next;
+        int perTick;
+        Generator generator;
+    };
+
+    QDBusPendingCall reply(const QString &method, const QVariantList &arguments, const QVariantList &defaultReply = QVariantList());
+    void injectNext(QTimer *timer);
+
+private:
+    QHash<int, QString> m_properties;
+    bool m_vpnEnabled;
+    int m_connectivity;
+    QHash<QString, bool> m_deviceEnabled;
+    QVariantMap m_chainsProperties;
+
+    QHash<QString, QVariantList> m_replies;
+    QHash<QString, QString> m_errors;
+    QSet<QString> m_hanging;
+    QHash<QString, QList<QVariantList>> m_calls;
+
+    QHash<QTimer *, Stream> m_streams;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // FAKENETWORKBACKEND_H
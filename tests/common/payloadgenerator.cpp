@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "payloadgenerator.h"
+
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QHash>
+
+#define DEVICE_DISCONNECTED     30
+#define ACTIVE_CONN_ACTIVATED   2
+
+static QString hwAddress(int index)
+{
+    return QString("00:16:3E:00:%1:%2")
+            .arg((index >> 8) & 0xff, 2, 16, QChar('0'))
+            .arg(index & 0xff, 2, 16, QChar('0')).toUpper();
+}
+
+static QString toJson(const QJsonObject &object)
+{
+    return QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact));
+}
+
+static QString toJson(const QJsonArray &array)
+{
+    return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+}
+
+QString PayloadGenerator::devicePath(int index)
+{
+    return QString("/org/freedesktop/NetworkManager/Devices/%1").arg(index);
+}
+
+QString PayloadGenerator::devices(int wired, int wireless)
+{
+    QJsonArray wiredList;
+    for (int i = 0; i < wired; ++i) {
+        wiredList.append(QJsonObject {
+            { "Path", devicePath(i) },
+            { "Interface", QString("eth%1").arg(i) },
+            { "HwAddress", hwAddress(i) },
+            { "Managed", true },
+            { "InterfaceFlags", 1 },
+            { "State", DEVICE_DISCONNECTED },
+            { "Vendor", "Fake" },
+        });
+    }
+
+    QJsonArray wirelessList;
+    for (int i = 0; i < wireless; ++i) {
+        wirelessList.append(QJsonObject {
+            { "Path", devicePath(wired + i) },
+            { "Interface", QString("wlan%1").arg(i) },
+            { "HwAddress", hwAddress(wired + i) },
+            { "Managed", true },
+            { "State", DEVICE_DISCONNECTED },
+            { "Vendor", "Fake" },
+        });
+    }
+
+    QJsonObject data;
+    if (wired)
+        data.insert("wired", wiredList);
+    if (wireless)
+        data.insert("wireless", wirelessList);
+
+    return toJson(data);
+}
+
+QString PayloadGenerator::connectionUuid(const QString &type, int index)
+{
+    return QString("00000000-0000-0000-%1-%2").arg(qHash(type, 0) & 0xffff, 4, 16, QChar('0'))
+                                               .arg(index, 12, 10, QChar('0'));
+}
+
+QString PayloadGenerator::connections(int count, const QString &type, int generation)
+{
+    QJsonArray list;
+    for (int i = 0; i < count; ++i) {
+        list.append(QJsonObject {
+            { "Path", QString("/org/freedesktop/NetworkManager/Settings/%1").arg(i) },
+            { "Uuid", connectionUuid(type, i) },
+            { "Id", QString("%1 %2.%3").arg(type).arg(i).arg(generation) },
+            { "HwAddress", "" },
+            { "IfcName", "" },
+            { "Ssid", type == "wireless" ? QString("ssid-%1").arg(i) : QString() },
+        });
+    }
+
+    return toJson(QJsonObject { { type, list } });
+}
+
+QString PayloadGenerator::activeConnections(const QStringList &devicePaths, const QString &type)
+{
+    QJsonObject data;
+    for (int i = 0; i < devicePaths.size(); ++i) {
+        data.insert(QString("/org/freedesktop/NetworkManager/ActiveConnection/%1").arg(i), QJsonObject {
+            { "Devices", QJsonArray { devicePaths[i] } },
+            { "Uuid", connectionUuid(type, i) },
+            { "Id", QString("%1 %2").arg(type).arg(i) },
+            { "State", ACTIVE_CONN_ACTIVATED },
+            { "Vpn", false },
+        });
+    }
+
+    return toJson(data);
+}
+
+QString PayloadGenerator::activeConnectionInfo(const QStringList &devicePaths, const QString &type)
+{
+    QJsonArray list;
+    for (int i = 0; i < devicePaths.size(); ++i) {
+        list.append(QJsonObject {
+            { "Device", devicePaths[i] },
+            { "ConnectionType", type == "wireless" ? "wireless" : "wired" },
+            { "ConnectionName", QString("%1 %2").arg(type).arg(i) },
+            { "ConnectionUuid", connectionUuid(type, i) },
+            { "Speed", "1000" },
+        });
+    }
+
+    return toJson(list);
+}
+
+QString PayloadGenerator::accessPoints(const QStringList &devicePaths, int count, int generation)
+{
+    QJsonObject data;
+    for (const QString &devPath : devicePaths) {
+        QJsonArray list;
+        for (int i = 0; i < count; ++i) {
+            list.append(QJsonObject {
+                { "Path", QString("%1/AccessPoint/%2").arg(devPath).arg(i) },
+                { "Ssid", QString("ssid-%1").arg(i) },
+                // 信号强度随 generation 变化, 模拟扫描结果的刷新
+                { "Strength", (i * 7 + generation * 13) % 100 },
+                { "Secured", i % 2 == 0 },
+                { "SecuredInEap", false },
+                { "Frequency", i % 3 == 0 ? 5180 : 2412 },
+            });
+        }
+        data.insert(devPath, list);
+    }
+
+    return toJson(data);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAYLOADGENERATOR_H
+#define PAYLOADGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief PayloadGenerator 生成与 com.deepin.daemon.Network 属性格式相同的 Json 数据
+ *
+ * 生成的数据只由参数决定, 相同的参数总是得到相同的结果.
+ * generation 不同时内容随之变化, 用于模拟同一对象的属性更新.
+ */
+class PayloadGenerator
+{
+public:
+    // 有线设备编号为 [0, wired), 无线设备编号为 [wired, wired + wireless)
+    static QString devicePath(int index);
+    static QString devices(int wired, int wireless = 0);
+
+    static QString connectionUuid(const QString &type, int index);
+    static QString connections(int count, const QString &type = "wired", int generation = 0);
+
+    // 每个设备一个已连接的 active 连接, 使用该设备对应编号的连接
+    static QString activeConnections(const QStringList &devicePaths, const QString &type = "wired");
+    static QString activeConnectionInfo(const QStringList &devicePaths, const QString &type = "wired");
+
+    static QString accessPoints(const QStringList &devicePaths, int count, int generation = 0);
+};
+
+#endif // PAYLOADGENERATOR_H
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "accesspointinfo.h"
+
+using namespace dde::network;
+
+class TstAccessPointInfo : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new AccessPointInfo(4, 0.5);
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+public:
+    AccessPointInfo *obj = nullptr;
+};
+
+TEST_F(TstAccessPointInfo, coverageTest)
+{
+    EXPECT_TRUE(obj->isEmpty());
+    EXPECT_EQ(obj->trend(), 0);
+
+    obj->addSample(80, 1000);
+    EXPECT_EQ(obj->smoothedStrength(), 80);
+
+    obj->addSample(60, 2000);
+    EXPECT_EQ(obj->smoothedStrength(), 70);
+    EXPECT_EQ(obj->strength(), 60);
+    EXPECT_EQ(obj->lastUpdate(), 2000);
+}
+
+TEST_F(TstAccessPointInfo, ringBufferIsBounded)
+{
+    for (int i = 0; i < 10; ++i)
+        obj->addSample(i, i * 1000);
+
+    EXPECT_EQ(obj->sampleCount(), 4);
+    const auto samples = obj->samples();
+    ASSERT_EQ(samples.size(), 4);
+    EXPECT_EQ(samples.first().second, 6);
+    EXPECT_EQ(samples.last().second, 9);
+}
+
+TEST_F(TstAccessPointInfo, trendFollowsSignal)
+{
+    obj->addSample(80, 0);
+    obj->addSample(70, 1000);
+    obj->addSample(60, 2000);
+    EXPECT_DOUBLE_EQ(obj->trend(), -10);
+
+    EXPECT_EQ(AccessPointInfo::key(QJsonObject { { "Path", "/ap/1" } }), "/ap/1");
+    EXPECT_EQ(AccessPointInfo::key(QJsonObject { { "Path", "/ap/1" }, { "Bssid", "00:11" } }), "00:11");
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "activationtracker.h"
+#include "networkdevice.h"
+#include "networkmodel.h"
+#include "payloadgenerator.h"
+
+#include <QEventLoop>
+#include <QTimer>
+
+using namespace dde::network;
+
+class TstActivationTracker : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        model = new NetworkModel();
+        QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, PayloadGenerator::devices(1, 1)));
+        obj = new ActivationTracker(model);
+        QObject::connect(obj, &ActivationTracker::activationFinished, [this] (const ActivationResult &result) {
+            results << result;
+        });
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+        delete model;
+        model = nullptr;
+        results.clear();
+    }
+
+    void setStatus(NetworkDevice::DeviceStatus status)
+    {
+        QMetaObject::invokeMethod(model->devices().first(), "setDeviceStatus", Q_ARG(int, status));
+    }
+
+    void processEvents(int msec = 20)
+    {
+        QEventLoop loop;
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+public:
+    NetworkModel *model = nullptr;
+    ActivationTracker *obj = nullptr;
+    QList<ActivationResult> results;
+};
+
+TEST_F(TstActivationTracker, coverageTest)
+{
+    const QString devPath = PayloadGenerator::devicePath(0);
+    ASSERT_EQ(model->devices().first()->path(), devPath);
+
+    const quint64 id = obj->start("ActivateConnection", devPath, "uuid-0");
+    EXPECT_EQ(obj->pendingCount(), 1);
+
+    // DBus 返回后仍要等待设备激活
+    obj->callFinished(id, QString());
+    EXPECT_EQ(obj->pendingCount(), 1);
+    EXPECT_EQ(obj->requestHistogram().count(), 1u);
+
+    setStatus(NetworkDevice::Prepare);
+    setStatus(NetworkDevice::Config);
+    setStatus(NetworkDevice::IpConfig);
+    EXPECT_TRUE(results.isEmpty());
+    setStatus(NetworkDevice::Activated);
+
+    ASSERT_EQ(results.size(), 1);
+    const ActivationResult &result = results.first();
+    EXPECT_EQ(result.id, id);
+    EXPECT_EQ(result.method, QString("ActivateConnection"));
+    EXPECT_EQ(result.uuid, QString("uuid-0"));
+    EXPECT_TRUE(result.activated);
+    EXPECT_TRUE(result.error.isEmpty());
+    EXPECT_EQ(result.status, int(NetworkDevice::Activated));
+    EXPECT_GE(result.requestUsec, 0);
+    EXPECT_GE(result.totalUsec, result.requestUsec);
+    EXPECT_TRUE(result.phaseUsec.contains(NetworkDevice::Prepare));
+    EXPECT_TRUE(result.phaseUsec.contains(NetworkDevice::IpConfig));
+    EXPECT_FALSE(result.phaseUsec.contains(NetworkDevice::NeedAuth));
+
+    EXPECT_EQ(obj->pendingCount(), 0);
+    EXPECT_EQ(obj->activatedCount(), 1u);
+    EXPECT_EQ(obj->timeToActivate().count(), 1u);
+    EXPECT_EQ(obj->phaseHistogram(NetworkDevice::Config).count(), 1u);
+}
+
+TEST_F(TstActivationTracker, failures)
+{
+    const QString devPath = PayloadGenerator::devicePath(0);
+
+    // DBus 调用出错
+    obj->callFinished(obj->start("ActivateConnection", devPath, "uuid-0"), "org.freedesktop.DBus.Error.Failed");
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_FALSE(results.last().activated);
+    EXPECT_EQ(results.last().error, QString("org.freedesktop.DBus.Error.Failed"));
+
+    // 新的请求使之前的请求作废, 作废请求的返回被忽略
+    const quint64 first = obj->start("ActivateConnection", devPath, "uuid-0");
+    obj->start("ActivateConnection", devPath, "uuid-1");
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results.last().error, QString("superseded"));
+    obj->callFinished(first, "org.freedesktop.DBus.Error.Failed");
+    EXPECT_EQ(obj->pendingCount(), 1);
+
+    // 设备连接失败
+    setStatus(NetworkDevice::Prepare);
+    setStatus(NetworkDevice::NeedAuth);
+    setStatus(NetworkDevice::Failed);
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results.last().uuid, QString("uuid-1"));
+    EXPECT_EQ(results.last().error, QString("failed"));
+    EXPECT_EQ(results.last().status, int(NetworkDevice::Failed));
+    EXPECT_TRUE(results.last().phaseUsec.contains(NetworkDevice::NeedAuth));
+
+    EXPECT_EQ(obj->failedCount(), 3u);
+    EXPECT_EQ(obj->timeToActivate().count(), 0u);
+}
+
+TEST_F(TstActivationTracker, withoutDevice)
+{
+    // 没有对应设备时以 DBus 返回作为结束
+    obj->callFinished(obj->start("ActivateConnection", "/", "uuid-vpn"), QString());
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_TRUE(results.first().activated);
+    EXPECT_EQ(results.first().status, 0);
+
+    obj->setTimeout(10);
+    obj->start("ActivateConnection", "/", "uuid-vpn");
+    processEvents(50);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results.last().error, QString("timeout"));
+    EXPECT_EQ(results.last().requestUsec, -1);
+}
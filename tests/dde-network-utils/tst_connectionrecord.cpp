@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "connectionrecord.h"
+
+#include <QJsonArray>
+
+using namespace dde::network;
+
+static QJsonObject connection(int i)
+{
+    return QJsonObject {
+        { "Path", QString("/org/freedesktop/NetworkManager/Settings/%1").arg(i) },
+        { "Uuid", QString("uuid-%1").arg(i) },
+        { "Id", QString("Wired %1").arg(i) },
+        { "HwAddress", "" },
+        { "IfcName", "enp3s0" },
+        { "ClonedAddr", "00:11:22:33:44:55" },
+        { "Autoconnect", true },
+        { "Priority", i },
+        { "Dns", QJsonArray { "8.8.8.8", "1.1.1.1" } },
+    };
+}
+
+class TstConnectionRecord : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new ConnectionRecord(connection(1));
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+public:
+    ConnectionRecord *obj = nullptr;
+};
+
+TEST_F(TstConnectionRecord, hotFields)
+{
+    EXPECT_EQ(obj->id(), QString("Wired 1"));
+    EXPECT_EQ(obj->uuid(), QString("uuid-1"));
+    EXPECT_EQ(obj->path(), QString("/org/freedesktop/NetworkManager/Settings/1"));
+    EXPECT_EQ(obj->ifcName(), QString("enp3s0"));
+    EXPECT_TRUE(obj->hwAddress().isEmpty());
+    EXPECT_TRUE(obj->ssid().isEmpty());
+
+    ConnectionRecord null;
+    EXPECT_TRUE(null.isNull());
+    EXPECT_TRUE(null.uuid().isEmpty());
+    EXPECT_TRUE(null.object().isEmpty());
+}
+
+TEST_F(TstConnectionRecord, restoresObject)
+{
+    EXPECT_EQ(obj->object(), connection(1));
+    // 再次访问返回相同的结果
+    EXPECT_EQ(obj->object(), connection(1));
+
+    // 缺少的字段还原后仍然缺少, 不是字符串的常用字段原样保留
+    const QJsonObject partial { { "Uuid", "uuid-2" }, { "Ssid", 42 } };
+    const ConnectionRecord record(partial);
+    EXPECT_TRUE(record.ssid().isEmpty());
+    EXPECT_EQ(record.object(), partial);
+}
+
+TEST_F(TstConnectionRecord, compare)
+{
+    const ConnectionRecord same(connection(1));
+    EXPECT_EQ(*obj, same);
+    EXPECT_EQ(obj->hash(), same.hash());
+
+    QJsonObject changed = connection(1);
+    changed.insert("Priority", 100);
+    EXPECT_NE(*obj, ConnectionRecord(changed));
+    EXPECT_NE(*obj, ConnectionRecord(connection(2)));
+
+    // 访问过 object() 之后比较结果不变
+    obj->object();
+    EXPECT_EQ(*obj, same);
+    EXPECT_NE(*obj, ConnectionRecord(changed));
+
+    // 其余字段中嵌套的内容也会比较
+    QJsonObject dns = connection(1);
+    dns.insert("Dns", QJsonArray { "1.1.1.1", "8.8.8.8" });
+    EXPECT_NE(*obj, ConnectionRecord(dns));
+    EXPECT_EQ(ConnectionRecord(dns), ConnectionRecord(dns));
+}
+
+TEST_F(TstConnectionRecord, lazySnapshot)
+{
+    const QList<ConnectionRecord> records = ConnectionRecord::fromObjects({ connection(1), connection(2) });
+    const ConnectionSnapshot snapshot = ConnectionRecord::snapshot(records);
+    EXPECT_GT(snapshot.version(), 0u);
+    EXPECT_FALSE(snapshot.isLoaded());
+
+    EXPECT_EQ(snapshot.size(), 2);
+    EXPECT_TRUE(snapshot.isLoaded());
+    EXPECT_EQ(snapshot.items(), ConnectionRecord::toObjects(records));
+    EXPECT_EQ(snapshot.at(1), connection(2));
+}
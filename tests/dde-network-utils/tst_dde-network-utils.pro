@@ -1,4 +1,4 @@
-QT       += dbus network
+QT       += dbus network testlib
 
 TARGET = tst_dde-network-utils
 TEMPLATE = app
@@ -18,15 +18,34 @@ LIBS += -lgtest
 DEFINES += QT_DEPRECATED_WARNINGS
 
 include(../../dde-network-utils/src.pri)
+include(../common/common.pri)
 
 SOURCES += \
     main.cpp \
+    tst_accesspointinfo.cpp \
+    tst_activationtracker.cpp \
+    tst_connectionrecord.cpp \
     tst_connecttivitychecker.cpp \
+    tst_devicestatushistory.cpp \
+    tst_eventtracer.cpp \
+    tst_ingestpipeline.cpp \
+    tst_latencyhistogram.cpp \
     tst_networkdevice.cpp \
     tst_networkmodel.cpp \
+    tst_networkstats.cpp \
     tst_networkworker.cpp \
+    tst_pendingcallmanager.cpp \
+    tst_proxybypassmatcher.cpp \
+    tst_sharedsnapshot.cpp \
+    tst_signalrecorder.cpp \
     tst_wireddevice.cpp \
-    tst_wirelessdevice.cpp
+    tst_wirelessdevice.cpp \
+    tst_wirelessscanscheduler.cpp
 INCLUDEPATH += ../../dde-network-utils
 
+qtHaveModule(qml) {
+    SOURCES += tst_pacproxyresolver.cpp
+    DEFINES += PAC_DATA_DIR=\\\"$$PWD/data\\\"
+}
+
 RESOURCES +=
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "devicestatushistory.h"
+#include "wireddevice.h"
+
+using namespace dde::network;
+
+class TstDeviceStatusHistory : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new DeviceStatusHistory();
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+public:
+    DeviceStatusHistory *obj = nullptr;
+};
+
+TEST_F(TstDeviceStatusHistory, coverageTest)
+{
+    EXPECT_TRUE(obj->transitions().isEmpty());
+    EXPECT_FALSE(obj->isConnecting());
+
+    // 时间单位为微秒: Prepare 1ms, Config 2ms, NeedAuth 3s, IpConfig 4ms, IpCheck 5ms
+    obj->record(NetworkDevice::Disconnected, 0);
+    obj->record(NetworkDevice::Prepare, 1000);
+    EXPECT_TRUE(obj->isConnecting());
+    obj->record(NetworkDevice::Config, 2000);
+    obj->record(NetworkDevice::NeedAuth, 4000);
+    obj->record(NetworkDevice::IpConfig, 3004000);
+    obj->record(NetworkDevice::IpCheck, 3008000);
+    obj->record(NetworkDevice::Activated, 3013000);
+    EXPECT_FALSE(obj->isConnecting());
+
+    EXPECT_EQ(obj->transitions().size(), 7);
+    EXPECT_EQ(obj->transitions().first().status, int(NetworkDevice::Disconnected));
+    EXPECT_EQ(obj->transitions().last().usec, 3013000);
+
+    const DeviceStatusHistory::ConnectAttempt attempt = obj->lastAttempt();
+    EXPECT_EQ(attempt.result, int(NetworkDevice::Activated));
+    EXPECT_EQ(attempt.totalUsec(), 3012000);
+    EXPECT_EQ(attempt.phaseUsec.value(NetworkDevice::Prepare), 1000);
+    EXPECT_EQ(attempt.phaseUsec.value(NetworkDevice::Config), 2000);
+    EXPECT_EQ(attempt.phaseUsec.value(NetworkDevice::NeedAuth), 3000000);
+    EXPECT_EQ(attempt.phaseUsec.value(NetworkDevice::IpConfig), 4000);
+    EXPECT_EQ(attempt.phaseUsec.value(NetworkDevice::IpCheck), 5000);
+
+    EXPECT_EQ(obj->activatedCount(), 1u);
+    EXPECT_EQ(obj->failedCount(), 0u);
+    EXPECT_EQ(obj->timeToConnect().count(), 1u);
+    EXPECT_EQ(obj->timeToConnect().maxUsec(), 3012000);
+    EXPECT_EQ(obj->phaseHistogram(NetworkDevice::NeedAuth).maxUsec(), 3000000);
+    EXPECT_EQ(obj->phaseHistogram(NetworkDevice::Secondaries).count(), 0u);
+
+    obj->clear();
+    EXPECT_TRUE(obj->transitions().isEmpty());
+    EXPECT_EQ(obj->activatedCount(), 0u);
+}
+
+TEST_F(TstDeviceStatusHistory, failedAttempt)
+{
+    obj->record(NetworkDevice::Disconnected, 0);
+    obj->record(NetworkDevice::Prepare, 1000);
+    obj->record(NetworkDevice::IpConfig, 2000);
+    obj->record(NetworkDevice::Failed, 32000);
+
+    EXPECT_EQ(obj->activatedCount(), 0u);
+    EXPECT_EQ(obj->failedCount(), 1u);
+    EXPECT_EQ(obj->lastAttempt().result, int(NetworkDevice::Failed));
+    // 失败的连接不计入总耗时, 但计入各阶段耗时
+    EXPECT_EQ(obj->timeToConnect().count(), 0u);
+    EXPECT_EQ(obj->phaseHistogram(NetworkDevice::IpConfig).maxUsec(), 30000);
+
+    // 没有经过连接阶段直接激活, 不算一次连接
+    obj->record(NetworkDevice::Activated, 40000);
+    EXPECT_EQ(obj->activatedCount(), 0u);
+}
+
+TEST_F(TstDeviceStatusHistory, ringCapacity)
+{
+    for (int i = 0; i < DeviceStatusHistory::Capacity + 10; ++i)
+        obj->record(i % 2 ? NetworkDevice::Disconnected : NetworkDevice::Unavailable, i);
+
+    const QList<DeviceStatusHistory::Transition> transitions = obj->transitions();
+    ASSERT_EQ(transitions.size(), int(DeviceStatusHistory::Capacity));
+    EXPECT_EQ(transitions.first().usec, 10);
+    EXPECT_EQ(transitions.last().usec, DeviceStatusHistory::Capacity + 9);
+}
+
+TEST_F(TstDeviceStatusHistory, deviceStatus)
+{
+    WiredDevice dev(QJsonObject { { "Path", "/dev/eth0" }, { "State", NetworkDevice::Disconnected } });
+
+    QMetaObject::invokeMethod(&dev, "setDeviceStatusAt", Q_ARG(int, NetworkDevice::Prepare), Q_ARG(qint64, 1000));
+    QMetaObject::invokeMethod(&dev, "setDeviceStatusAt", Q_ARG(int, NetworkDevice::Activated), Q_ARG(qint64, 6000));
+    // 状态没有变化时不记录
+    QMetaObject::invokeMethod(&dev, "setDeviceStatusAt", Q_ARG(int, NetworkDevice::Activated), Q_ARG(qint64, 7000));
+
+    EXPECT_EQ(dev.statusHistory().transitions().size(), 3);
+    EXPECT_EQ(dev.statusHistory().activatedCount(), 1u);
+    EXPECT_EQ(dev.statusHistory().lastAttempt().totalUsec(), 5000);
+    EXPECT_EQ(dev.statusQueue().size(), 3);
+}
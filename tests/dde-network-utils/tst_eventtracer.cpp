@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include "eventtracer.h"
+#include "networkmodel.h"
+#include "payloadgenerator.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+
+using namespace dde::network;
+
+class TstEventTracer : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        fileName = dir.filePath("trace.json");
+    }
+
+    void TearDown() override
+    {
+        if (EventTracer::isEnabled())
+            EventTracer::stop();
+    }
+
+    QJsonArray readEvents()
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QJsonArray();
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+        EXPECT_EQ(error.error, QJsonParseError::NoError) << error.errorString().toStdString();
+        return doc.object().value("traceEvents").toArray();
+    }
+
+    static QList<QJsonObject> find(const QJsonArray &events, const QString &name, const QString &phase)
+    {
+        QList<QJsonObject> result;
+        for (const QJsonValue &value : events) {
+            const QJsonObject event = value.toObject();
+            if (event.value("name").toString() == name && event.value("ph").toString() == phase)
+                result << event;
+        }
+        return result;
+    }
+
+public:
+    QTemporaryDir dir;
+    QString fileName;
+};
+
+TEST_F(TstEventTracer, coverageTest)
+{
+    // 未开启时不记录
+    EXPECT_FALSE(EventTracer::isEnabled());
+    { TraceScope scope("test", "ignored"); }
+    EXPECT_FALSE(EventTracer::stop());
+
+    ASSERT_TRUE(EventTracer::start(fileName));
+    EXPECT_TRUE(EventTracer::isEnabled());
+    EXPECT_EQ(EventTracer::fileName(), fileName);
+    EXPECT_EQ(EventTracer::eventCount(), 0u);
+
+    {
+        TraceScope scope("test", "scope");
+        scope.setDetail("main");
+        EventTracer::instant("test", "instant");
+        EventTracer::asyncBegin("test", "async", 42);
+    }
+
+    QThread thread;
+    thread.setObjectName("TraceWorker");
+    QObject::connect(&thread, &QThread::started, [] {
+        TraceScope scope("test", "scope");
+        EventTracer::asyncEnd("test", "async", 42, "done");
+    });
+    thread.start();
+    thread.wait();
+
+    EXPECT_EQ(EventTracer::eventCount(), 5u);
+    EXPECT_EQ(EventTracer::droppedCount(), 0u);
+    ASSERT_TRUE(EventTracer::stop());
+    EXPECT_FALSE(EventTracer::isEnabled());
+
+    const QJsonArray events = readEvents();
+
+    const QList<QJsonObject> scopes = find(events, "scope", "X");
+    ASSERT_EQ(scopes.size(), 2);
+    EXPECT_NE(scopes.at(0).value("tid").toInt(), scopes.at(1).value("tid").toInt());
+    EXPECT_TRUE(scopes.at(0).contains("dur"));
+    EXPECT_EQ(scopes.at(0).value("cat").toString(), QString("test"));
+    EXPECT_EQ(scopes.at(0).value("args").toObject().value("detail").toString(), QString("main"));
+
+    ASSERT_EQ(find(events, "instant", "i").size(), 1);
+
+    // 跨线程的异步事件以 id 配对
+    const QList<QJsonObject> begins = find(events, "async", "b");
+    const QList<QJsonObject> ends = find(events, "async", "e");
+    ASSERT_EQ(begins.size(), 1);
+    ASSERT_EQ(ends.size(), 1);
+    EXPECT_EQ(begins.first().value("id"), ends.first().value("id"));
+    EXPECT_LE(begins.first().value("ts").toDouble(), ends.first().value("ts").toDouble());
+
+    bool workerNamed = false;
+    for (const QJsonObject &meta : find(events, "thread_name", "M")) {
+        if (meta.value("args").toObject().value("name").toString() == "TraceWorker")
+            workerNamed = meta.value("tid").toInt() == scopes.at(1).value("tid").toInt();
+    }
+    EXPECT_TRUE(workerNamed);
+
+    // 再次开始时不包含上一次的事件
+    ASSERT_TRUE(EventTracer::start(fileName));
+    EXPECT_EQ(EventTracer::eventCount(), 0u);
+    ASSERT_TRUE(EventTracer::stop());
+    EXPECT_TRUE(find(readEvents(), "scope", "X").isEmpty());
+}
+
+TEST_F(TstEventTracer, restartResetsBuffer)
+{
+    // 第一次记录写满缓冲区
+    ASSERT_TRUE(EventTracer::start(fileName));
+    for (int i = 0; i <= EventTracer::TraceBufferCapacity; ++i)
+        EventTracer::instant("test", "fill");
+    EXPECT_EQ(EventTracer::eventCount(), quint64(EventTracer::TraceBufferCapacity));
+    EXPECT_EQ(EventTracer::droppedCount(), 1u);
+    ASSERT_TRUE(EventTracer::stop());
+
+    // 再次开始时缓冲区重新可用, 不会继续丢弃
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_TRUE(EventTracer::start(fileName));
+        EXPECT_EQ(EventTracer::eventCount(), 0u);
+        EventTracer::instant("test", "again");
+        EXPECT_EQ(EventTracer::eventCount(), 1u);
+        EXPECT_EQ(EventTracer::droppedCount(), 0u);
+        ASSERT_TRUE(EventTracer::stop());
+
+        const QJsonArray events = readEvents();
+        EXPECT_EQ(find(events, "again", "i").size(), 1);
+        EXPECT_TRUE(find(events, "fill", "i").isEmpty());
+    }
+}
+
+TEST_F(TstEventTracer, modelUpdate)
+{
+    NetworkModel model;
+
+    ASSERT_TRUE(EventTracer::start(fileName));
+    QMetaObject::invokeMethod(&model, "onDevicesChanged", Q_ARG(QString, PayloadGenerator::devices(1, 1)));
+    ASSERT_TRUE(EventTracer::stop());
+
+    const QJsonArray events = readEvents();
+    EXPECT_FALSE(find(events, "update", "B").isEmpty());
+    EXPECT_EQ(find(events, "update", "B").size(), find(events, "update", "E").size());
+    EXPECT_EQ(find(events, "statusChanged", "i").size(), 2);
+}
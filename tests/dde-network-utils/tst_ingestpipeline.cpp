@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include "ingestpipeline.h"
+#include "payloadcodec.h"
+#include "networkmodel.h"
+#include "wireddevice.h"
+
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QTimer>
+
+using namespace dde::network;
+
+static QString devices(const QStringList &interfaces)
+{
+    QString list;
+    for (const QString &interface : interfaces) {
+        if (!list.isEmpty())
+            list += ",";
+        list += QString("{\"Path\":\"/org/freedesktop/NetworkManager/Devices/%1\","
+                        "\"Managed\":true,\"Interface\":\"%1\"}").arg(interface);
+    }
+    return QString("{\"wired\":[%1]}").arg(list);
+}
+
+static const QString wiredConnections("{\"wired\":[{\"Uuid\":\"uuid-1\",\"Id\":\"Wired\",\"IfcName\":\"eth0\"}]}");
+
+class TstIngestPipeline : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        model = new NetworkModel();
+        obj = new IngestPipeline(model);
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+        delete model;
+        model = nullptr;
+    }
+
+    // 等待所有已提交的数据应用或丢弃
+    void drain(int msec = 5000)
+    {
+        QEventLoop loop;
+        QTimer timer;
+        QObject::connect(&timer, &QTimer::timeout, &loop, [&] {
+            if (obj->pendingCount() == 0)
+                loop.quit();
+        });
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        timer.start(5);
+        loop.exec();
+    }
+
+public:
+    NetworkModel *model = nullptr;
+    IngestPipeline *obj = nullptr;
+};
+
+TEST_F(TstIngestPipeline, coverageTest)
+{
+    EXPECT_TRUE(obj->isEnabled());
+    EXPECT_EQ(obj->pendingCount(), 0);
+
+    obj->submitDevices(devices({ "eth0" }));
+    EXPECT_EQ(obj->submittedCount(), 1u);
+    drain();
+
+    EXPECT_EQ(obj->pendingCount(), 0);
+    EXPECT_EQ(obj->appliedCount(), 1u);
+    ASSERT_EQ(model->devices().size(), 1);
+    EXPECT_EQ(model->devices().first()->path(), QString("/org/freedesktop/NetworkManager/Devices/eth0"));
+}
+
+TEST_F(TstIngestPipeline, keepLatestPayload)
+{
+    for (int i = 1; i <= 50; ++i) {
+        QStringList interfaces;
+        for (int j = 0; j < i; ++j)
+            interfaces << QString("eth%1").arg(j);
+        obj->submitDevices(devices(interfaces));
+    }
+    drain();
+
+    // 中间的数据可能被丢弃, 但最后一份一定会被应用
+    EXPECT_EQ(obj->pendingCount(), 0);
+    EXPECT_EQ(obj->appliedCount() + obj->droppedCount(), 50u);
+    EXPECT_GE(obj->appliedCount(), 1u);
+    EXPECT_EQ(model->devices().size(), 50);
+}
+
+TEST_F(TstIngestPipeline, applySupersedesQueued)
+{
+    obj->submitDevices(devices({ "eth0", "eth1" }));
+    obj->apply(IngestPipeline::Devices, devices({ "eth2" }));
+    ASSERT_EQ(model->devices().size(), 1);
+    drain();
+
+    // 更早提交的数据不能覆盖同步应用的结果
+    EXPECT_EQ(obj->droppedCount(), 1u);
+    EXPECT_EQ(obj->appliedCount(), 1u);
+    ASSERT_EQ(model->devices().size(), 1);
+    EXPECT_EQ(model->devices().first()->interfaceName(), QString("eth2"));
+}
+
+TEST_F(TstIngestPipeline, applyAfterQueued)
+{
+    // 中间夹着其他类型的数据时旧数据不会被丢弃, 也不能在同步应用之后再覆盖它
+    obj->submitDevices(devices({ "eth0", "eth1" }));
+    obj->submitConnections(wiredConnections);
+    obj->apply(IngestPipeline::Devices, devices({ "eth2" }));
+
+    // apply() 返回时之前提交的数据都已按顺序应用
+    EXPECT_EQ(obj->pendingCount(), 0);
+    EXPECT_EQ(obj->appliedCount(), 3u);
+    ASSERT_EQ(model->devices().size(), 1);
+    EXPECT_EQ(model->devices().first()->interfaceName(), QString("eth2"));
+
+    drain();
+    ASSERT_EQ(model->devices().size(), 1);
+    EXPECT_EQ(model->devices().first()->interfaceName(), QString("eth2"));
+}
+
+TEST_F(TstIngestPipeline, preserveOrdering)
+{
+    // 中间夹着连接数据时, 之前的设备数据不能丢弃, 否则连接无法分配给设备
+    obj->submitDevices(devices({ "eth0" }));
+    obj->submitConnections(wiredConnections);
+    obj->submitDevices(devices({ "eth0", "eth1" }));
+    drain();
+
+    EXPECT_EQ(obj->droppedCount(), 0u);
+    EXPECT_EQ(obj->appliedCount(), 3u);
+    ASSERT_EQ(model->devices().size(), 2);
+
+    WiredDevice *dev = static_cast<WiredDevice *>(model->devices().first());
+    EXPECT_EQ(dev->interfaceName(), QString("eth0"));
+    ASSERT_EQ(dev->connections().size(), 1);
+    EXPECT_EQ(dev->connections().first().value("Uuid").toString(), QString("uuid-1"));
+}
+
+TEST_F(TstIngestPipeline, disabled)
+{
+    obj->setEnabled(false);
+    obj->submitDevices(devices({ "eth0" }));
+
+    // 关闭后同步应用
+    EXPECT_EQ(obj->pendingCount(), 0);
+    EXPECT_EQ(obj->appliedCount(), 1u);
+    EXPECT_EQ(model->devices().size(), 1);
+}
+
+TEST_F(TstIngestPipeline, submitParsed)
+{
+    obj->submitDevices(devices({ "eth0", "eth1" }));
+
+    const QJsonObject data = QJsonDocument::fromJson(devices({ "eth2" }).toUtf8()).object();
+    obj->submitParsed(IngestPipeline::Devices, QVariant::fromValue(PayloadParser::parseDevices(data)));
+    ASSERT_EQ(model->devices().size(), 1);
+    drain();
+
+    // 与 apply() 一样, 更早提交的数据随之作废
+    EXPECT_EQ(obj->submittedCount(), 2u);
+    EXPECT_EQ(obj->droppedCount(), 1u);
+    ASSERT_EQ(model->devices().size(), 1);
+    EXPECT_EQ(model->devices().first()->interfaceName(), QString("eth2"));
+}
+
+TEST_F(TstIngestPipeline, submitObject)
+{
+    const QJsonObject data = QJsonDocument::fromJson(devices({ "eth0", "eth1" }).toUtf8()).object();
+    obj->submitDevicesObject(data);
+    obj->submitConnectionsObject(QJsonDocument::fromJson(wiredConnections.toUtf8()).object());
+
+    // Json 对象同样在解析线程中解析, 不在提交时同步应用
+    EXPECT_EQ(obj->pendingCount(), 2);
+    EXPECT_TRUE(model->devices().isEmpty());
+    drain();
+
+    EXPECT_EQ(obj->appliedCount(), 2u);
+    ASSERT_EQ(model->devices().size(), 2);
+    WiredDevice *dev = static_cast<WiredDevice *>(model->devices().first());
+    ASSERT_EQ(dev->connections().size(), 1);
+    EXPECT_EQ(dev->connections().first().value("Uuid").toString(), QString("uuid-1"));
+}
+
+TEST_F(TstIngestPipeline, submitCbor)
+{
+    if (!PayloadCodec::isCborSupported())
+        return;
+
+    obj->submitDevices(devices({ "eth0" }));
+    const QJsonObject conns = QJsonDocument::fromJson(wiredConnections.toUtf8()).object();
+    obj->submitConnectionsCbor(PayloadCodec::encode(conns, PayloadCodec::Cbor));
+    drain();
+
+    // 与 Json 得到相同的结果
+    EXPECT_EQ(obj->appliedCount(), 2u);
+    ASSERT_EQ(model->devices().size(), 1);
+    WiredDevice *dev = static_cast<WiredDevice *>(model->devices().first());
+    ASSERT_EQ(dev->connections().size(), 1);
+    EXPECT_EQ(dev->connections().first().value("Uuid").toString(), QString("uuid-1"));
+
+    // 不是 CBOR 的数据与无效的 Json 一样得到空的结果
+    EXPECT_TRUE(PayloadCodec::decode("{}", PayloadCodec::Cbor).isEmpty());
+}
+
+TEST_F(TstIngestPipeline, applyCbor)
+{
+    if (!PayloadCodec::isCborSupported())
+        return;
+
+    obj->apply(IngestPipeline::Devices, devices({ "eth0" }));
+    const QJsonObject conns = QJsonDocument::fromJson(wiredConnections.toUtf8()).object();
+    obj->applyCbor(IngestPipeline::Connections, PayloadCodec::encode(conns, PayloadCodec::Cbor));
+
+    // 返回时已经在解析线程中解码并应用
+    EXPECT_EQ(obj->pendingCount(), 0);
+    EXPECT_EQ(obj->appliedCount(), 2u);
+    WiredDevice *dev = static_cast<WiredDevice *>(model->devices().first());
+    ASSERT_EQ(dev->connections().size(), 1);
+    EXPECT_EQ(dev->connections().first().value("Uuid").toString(), QString("uuid-1"));
+}
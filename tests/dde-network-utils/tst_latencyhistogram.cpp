@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "latencyhistogram.h"
+
+using namespace dde::network;
+
+class TstLatencyHistogram : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new LatencyHistogram();
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+public:
+    LatencyHistogram *obj = nullptr;
+};
+
+TEST_F(TstLatencyHistogram, coverageTest)
+{
+    EXPECT_EQ(obj->count(), 0u);
+    EXPECT_EQ(obj->percentileMsec(50), 0);
+
+    obj->record(500);       // < 1ms
+    obj->record(3000);      // [2ms, 4ms)
+    obj->record(3500);
+    obj->record(100000);    // [64ms, 128ms)
+
+    EXPECT_EQ(obj->count(), 4u);
+    EXPECT_EQ(obj->minUsec(), 500);
+    EXPECT_EQ(obj->maxUsec(), 100000);
+    EXPECT_EQ(obj->buckets().at(0), 1u);
+    EXPECT_EQ(obj->buckets().at(2), 2u);
+    EXPECT_EQ(obj->percentileMsec(50), 4);
+    EXPECT_EQ(obj->percentileMsec(99), 101);
+
+    LatencyHistogram other;
+    other.record(1000);
+    obj->merge(other);
+    EXPECT_EQ(obj->count(), 5u);
+}
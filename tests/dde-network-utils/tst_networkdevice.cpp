@@ -2,6 +2,7 @@
 
 #include "networkdevice.h"
 
+#include <QJsonArray>
 #include <QMimeData>
 
 using namespace dde::network;
@@ -28,3 +29,17 @@ TEST_F(TstNetworkDevice, coverageTest)
 {
 
 }
+
+TEST_F(TstNetworkDevice, contentHash)
+{
+    // 元素个数也计入哈希, 嵌套方式不同的数组不会得到相同的结果
+    const QList<QJsonObject> split { QJsonObject { { "v", QJsonArray { QJsonArray { 1 }, QJsonArray { 2 } } } } };
+    const QList<QJsonObject> nested { QJsonObject { { "v", QJsonArray { QJsonArray { 1, QJsonArray { 2 } } } } } };
+    EXPECT_NE(NetworkDevice::contentHash(split), NetworkDevice::contentHash(nested));
+
+    const QList<QJsonObject> twoKeys { QJsonObject { { "a", QJsonObject { { "b", 1 } } }, { "c", 2 } } };
+    const QList<QJsonObject> oneKey { QJsonObject { { "a", QJsonObject { { "b", 1 }, { "c", 2 } } } } };
+    EXPECT_NE(NetworkDevice::contentHash(twoKeys), NetworkDevice::contentHash(oneKey));
+
+    EXPECT_EQ(NetworkDevice::contentHash(split), NetworkDevice::contentHash(QList<QJsonObject>(split)));
+}
@@ -2,8 +2,12 @@
 
 #include "networkmodel.h"
 
+#include <QCoreApplication>
 #include <QMimeData>
 
+#include <atomic>
+#include <thread>
+
 using namespace dde::network;
 
 class TstNetworkModel : public testing::Test
@@ -28,3 +32,222 @@ TEST_F(TstNetworkModel, coverageTest)
 {
 
 }
+
+TEST_F(TstNetworkModel, proxySettingsBatch)
+{
+    NetworkModel model;
+
+    int configChanged = 0;
+    int methodChanged = 0;
+    QObject::connect(&model, &NetworkModel::proxyConfigChanged, [&] { ++configChanged; });
+    QObject::connect(&model, &NetworkModel::proxyMethodChanged, [&] { ++methodChanged; });
+
+    ProxySettings settings;
+    settings.fields = ProxySettings::Method | ProxySettings::IgnoreHosts;
+    settings.method = "manual";
+    settings.ignoreHosts = "localhost";
+    settings.proxies.insert("http", { 8080, "http", "127.0.0.1", "", "" });
+
+    QMetaObject::invokeMethod(&model, "onProxySettingsChanged", Q_ARG(ProxySettings, settings));
+    EXPECT_EQ(configChanged, 1);
+    EXPECT_EQ(methodChanged, 1);
+    EXPECT_EQ(model.proxyMethod(), "manual");
+    EXPECT_EQ(model.proxy("http").port, 8080u);
+
+    // 内容没有变化时不再发送信号
+    QMetaObject::invokeMethod(&model, "onProxySettingsChanged", Q_ARG(ProxySettings, settings));
+    EXPECT_EQ(configChanged, 1);
+}
+
+TEST_F(TstNetworkModel, proxySettingsAtomic)
+{
+    NetworkModel model;
+
+    ProxySettings settings;
+    settings.fields = ProxySettings::AutoProxy | ProxySettings::Method | ProxySettings::IgnoreHosts | ProxySettings::Chains;
+    settings.autoProxy = "http://proxy/pac";
+    settings.method = "auto";
+    settings.ignoreHosts = "*.lan";
+    settings.chains = { 1080, "socks5", "10.0.0.1", "user", "" };
+    settings.proxies.insert("http", { 8080, "http", "127.0.0.1", "", "" });
+
+    // 任何一个信号发出时, 其他字段都已经是新的值
+    int checked = 0;
+    auto checkAll = [&] {
+        EXPECT_EQ(model.proxy("http").port, 8080u);
+        EXPECT_EQ(model.autoProxy(), settings.autoProxy);
+        EXPECT_EQ(model.proxyMethod(), settings.method);
+        EXPECT_EQ(model.ignoreHosts(), settings.ignoreHosts);
+        EXPECT_EQ(model.getChainsProxy().url, settings.chains.url);
+        EXPECT_EQ(model.getChainsProxy().port, settings.chains.port);
+        ++checked;
+    };
+    QObject::connect(&model, &NetworkModel::proxyChanged, checkAll);
+    QObject::connect(&model, &NetworkModel::autoProxyChanged, checkAll);
+    QObject::connect(&model, &NetworkModel::proxyMethodChanged, checkAll);
+    QObject::connect(&model, &NetworkModel::proxyIgnoreHostsChanged, checkAll);
+    QObject::connect(&model, &NetworkModel::chainsTypeChanged, checkAll);
+    QObject::connect(&model, &NetworkModel::chainsPortChanged, checkAll);
+
+    int modelChanged = 0;
+    QObject::connect(&model, &NetworkModel::modelChanged, [&] { ++modelChanged; });
+
+    QMetaObject::invokeMethod(&model, "onProxySettingsChanged", Q_ARG(ProxySettings, settings));
+    EXPECT_EQ(checked, 6);
+    EXPECT_EQ(modelChanged, 1);
+}
+
+TEST_F(TstNetworkModel, modelTransaction)
+{
+    NetworkModel model;
+
+    QList<ChangeSet> changes;
+    QObject::connect(&model, &NetworkModel::modelChanged, [&](const ChangeSet &changeSet) {
+        changes << changeSet;
+    });
+
+    // 事务外的每次变化单独通知
+    QMetaObject::invokeMethod(&model, "onProxyMethodChanged", Q_ARG(QString, "manual"));
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes.last().entities, int(ChangeSet::ProxyChanged));
+    EXPECT_TRUE(changes.last().devices.isEmpty());
+
+    const QString devices("{\"wired\":[{\"Path\":\"/org/freedesktop/NetworkManager/Devices/1\","
+                          "\"Managed\":true,\"Interface\":\"eth0\"}]}");
+
+    // 事务中的多次变化合并为一次通知
+    model.beginUpdate();
+    model.beginUpdate();
+    QMetaObject::invokeMethod(&model, "onDevicesChanged", Q_ARG(QString, devices));
+    QMetaObject::invokeMethod(&model, "onAutoProxyChanged", Q_ARG(QString, "http://127.0.0.1/proxy.pac"));
+    QMetaObject::invokeMethod(&model, "onProxyIgnoreHostsChanged", Q_ARG(QString, "localhost"));
+    model.endUpdate();
+    EXPECT_TRUE(model.isUpdating());
+    EXPECT_EQ(changes.size(), 1);
+    model.endUpdate();
+    EXPECT_FALSE(model.isUpdating());
+
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_TRUE(changes.last().contains(ChangeSet::DevicesChanged));
+    EXPECT_TRUE(changes.last().contains(ChangeSet::ProxyChanged));
+    EXPECT_FALSE(changes.last().contains(ChangeSet::ConnectionsChanged));
+    EXPECT_EQ(changes.last().devices, QStringList() << "/org/freedesktop/NetworkManager/Devices/1");
+
+    // 设备自身的变化也会记录下来
+    QMetaObject::invokeMethod(&model, "onDeviceEnableChanged",
+                              Q_ARG(QString, "/org/freedesktop/NetworkManager/Devices/1"), Q_ARG(bool, false));
+    ASSERT_EQ(changes.size(), 3);
+    EXPECT_EQ(changes.last().entities, int(ChangeSet::DeviceStateChanged));
+    EXPECT_EQ(changes.last().devices, QStringList() << "/org/freedesktop/NetworkManager/Devices/1");
+
+    // 没有变化的事务不发送通知
+    model.beginUpdate();
+    QMetaObject::invokeMethod(&model, "onProxyMethodChanged", Q_ARG(QString, "manual"));
+    model.endUpdate();
+    EXPECT_EQ(changes.size(), 3);
+}
+
+TEST_F(TstNetworkModel, threadSafeSnapshot)
+{
+    NetworkModel model;
+
+    const std::shared_ptr<const NetworkModelSnapshot> first = model.snapshot();
+    ASSERT_TRUE(first != nullptr);
+    EXPECT_TRUE(first->devices.isEmpty());
+
+    QMetaObject::invokeMethod(&model, "onProxyMethodChanged", Q_ARG(QString, "auto"));
+    const std::shared_ptr<const NetworkModelSnapshot> second = model.snapshot();
+    EXPECT_GT(second->version, first->version);
+    EXPECT_EQ(second->proxyMethod, QString("auto"));
+    // 已经取到的快照不受后续更新影响
+    EXPECT_TRUE(first->proxyMethod.isEmpty());
+
+    // 其他线程读取快照时, 版本号只会递增
+    std::atomic<bool> stop(false);
+    std::atomic<bool> ordered(true);
+    std::thread reader([&] {
+        quint64 last = 0;
+        while (!stop) {
+            const std::shared_ptr<const NetworkModelSnapshot> s = model.snapshot();
+            if (s->version < last)
+                ordered = false;
+            last = s->version;
+        }
+    });
+
+    for (int i = 0; i < 200; ++i) {
+        QMetaObject::invokeMethod(&model, "onProxyIgnoreHostsChanged", Q_ARG(QString, QString("host%1").arg(i)));
+        QMetaObject::invokeMethod(&model, "onVPNEnabledChanged", Q_ARG(bool, i % 2));
+    }
+    stop = true;
+    reader.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(model.snapshot()->ignoreHosts, QString("host199"));
+    EXPECT_TRUE(model.snapshot()->proxyBypassMatcher.matches("host199"));
+    EXPECT_TRUE(model.snapshot()->vpnEnabled);
+    EXPECT_EQ(model.snapshot()->connectivity, NetworkModel::connectivity());
+}
+
+TEST_F(TstNetworkModel, devicesSnapshot)
+{
+    NetworkModel model;
+    const QString path("/org/freedesktop/NetworkManager/Devices/1");
+
+    QMetaObject::invokeMethod(&model, "onDevicesChanged", Q_ARG(QString, QString("{\"wired\":[{\"Path\":\"%1\","
+                                                                                  "\"Managed\":true,\"Interface\":\"eth0\"}]}").arg(path)));
+    const DeviceSnapshot added = model.devicesSnapshot();
+    ASSERT_EQ(added.size(), 1);
+    EXPECT_EQ(added.at(0).path, path);
+    EXPECT_TRUE(added.at(0).enabled);
+
+    // 设备自身的状态变化也会生成新的快照
+    QMetaObject::invokeMethod(&model, "onDeviceEnableChanged", Q_ARG(QString, path), Q_ARG(bool, false));
+    const DeviceSnapshot disabled = model.devicesSnapshot();
+    EXPECT_NE(disabled.version(), added.version());
+    ASSERT_EQ(disabled.size(), 1);
+    EXPECT_FALSE(disabled.at(0).enabled);
+
+    // 设备释放后, 旧快照中的内容仍然可以读取
+    QMetaObject::invokeMethod(&model, "onDevicesChanged", Q_ARG(QString, QString("{}")));
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    EXPECT_TRUE(model.devices().isEmpty());
+    EXPECT_TRUE(model.devicesSnapshot().isEmpty());
+    EXPECT_EQ(added.at(0).path, path);
+    EXPECT_EQ(added.at(0).interfaceName, QString("eth0"));
+    EXPECT_EQ(added.at(0).type, NetworkDevice::Wired);
+}
+
+TEST_F(TstNetworkModel, devicesSnapshotIncremental)
+{
+    NetworkModel model;
+    const QString path1("/org/freedesktop/NetworkManager/Devices/1");
+    const QString path2("/org/freedesktop/NetworkManager/Devices/2");
+
+    QMetaObject::invokeMethod(&model, "onDevicesChanged", Q_ARG(QString, QString("{\"wired\":["
+                                                                                  "{\"Path\":\"%1\",\"Managed\":true,\"Interface\":\"eth0\"},"
+                                                                                  "{\"Path\":\"%2\",\"Managed\":true,\"Interface\":\"eth1\"}]}")
+                                                                          .arg(path1).arg(path2)));
+    const std::shared_ptr<const NetworkModelSnapshot> added = model.snapshot();
+    ASSERT_EQ(added->devices.size(), 2);
+    const quint64 addedVersion = model.devicesSnapshot().version();
+
+    // 没有设备变化的事务直接共享上一份快照中的设备列表
+    QMetaObject::invokeMethod(&model, "onProxyMethodChanged", Q_ARG(QString, "manual"));
+    const std::shared_ptr<const NetworkModelSnapshot> proxy = model.snapshot();
+    EXPECT_GT(proxy->version, added->version);
+    ASSERT_EQ(proxy->devices.size(), 2);
+    EXPECT_EQ(&proxy->devices.at(0), &added->devices.at(0));
+    EXPECT_EQ(model.devicesSnapshot().version(), addedVersion);
+
+    // 只有变化的设备重新生成, 其余设备的状态保持不变
+    QMetaObject::invokeMethod(&model, "onDeviceEnableChanged", Q_ARG(QString, path2), Q_ARG(bool, false));
+    const std::shared_ptr<const NetworkModelSnapshot> disabled = model.snapshot();
+    ASSERT_EQ(disabled->devices.size(), 2);
+    EXPECT_EQ(disabled->devices.at(0), added->devices.at(0));
+    EXPECT_TRUE(disabled->devices.at(0).enabled);
+    EXPECT_EQ(disabled->devices.at(1).path, path2);
+    EXPECT_FALSE(disabled->devices.at(1).enabled);
+    EXPECT_NE(model.devicesSnapshot().version(), addedVersion);
+    EXPECT_EQ(model.devicesSnapshot().items(), disabled->devices);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include "networkstats.h"
+#include "networkmodel.h"
+#include "wireddevice.h"
+#include "pendingcallmanager.h"
+#include "payloadgenerator.h"
+
+#include <QDBusMessage>
+#include <QEventLoop>
+#include <QMetaMethod>
+#include <QSignalSpy>
+#include <QTimer>
+
+#include <memory>
+
+using namespace dde::network;
+
+// 用于检查信号是否连接了接收者, isSignalConnected 在 QObject 中是 protected 的
+class ProbeModel : public NetworkModel
+{
+public:
+    bool connected(const QMetaMethod &signal) const { return isSignalConnected(signal); }
+};
+
+class ProbeWiredDevice : public WiredDevice
+{
+public:
+    explicit ProbeWiredDevice(const QJsonObject &info) : WiredDevice(info) {}
+
+    bool connected(const QMetaMethod &signal) const { return isSignalConnected(signal); }
+    void setCounting(bool enabled) { setEmitCountingEnabled(enabled); }
+};
+
+class TstNetworkStats : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        model = new NetworkModel();
+    }
+
+    void TearDown() override
+    {
+        delete model;
+        model = nullptr;
+    }
+
+    void processEvents(int msec = 20)
+    {
+        QEventLoop loop;
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+    // 监听 object 在 QObject 之外声明的所有信号
+    void spyAll(QObject *object)
+    {
+        const QMetaObject *mo = object->metaObject();
+        for (int i = QObject::staticMetaObject.methodCount(); i < mo->methodCount(); ++i) {
+            const QMetaMethod method = mo->method(i);
+            if (method.methodType() != QMetaMethod::Signal || (method.attributes() & QMetaMethod::Cloned))
+                continue;
+
+            spies.emplace_back(new QSignalSpy(object, QByteArray("2" + method.methodSignature()).constData()));
+        }
+    }
+
+    quint64 spiedCount() const
+    {
+        quint64 count = 0;
+        for (const auto &spy : spies)
+            count += static_cast<quint64>(spy->count());
+
+        return count;
+    }
+
+public:
+    NetworkModel *model = nullptr;
+    std::vector<std::unique_ptr<QSignalSpy>> spies;
+};
+
+TEST_F(TstNetworkStats, coverageTest)
+{
+    const QString devices = PayloadGenerator::devices(1, 1);
+
+    // 默认关闭, 不做任何统计
+    QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, devices));
+    EXPECT_FALSE(model->isStatsEnabled());
+    EXPECT_FALSE(model->stats().enabled);
+    EXPECT_EQ(model->stats().entryPoints[NetworkStats::DevicesChanged].calls, 0u);
+
+    model->setStatsEnabled(true);
+    const quint64 signalsBefore = model->emittedSignalCount();
+    QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, PayloadGenerator::devices(2, 1)));
+    QMetaObject::invokeMethod(model, "onConnectionListChanged", Q_ARG(QString, PayloadGenerator::connections(3)));
+    QMetaObject::invokeMethod(model, "onWirelessAccessPointsChanged",
+                              Q_ARG(QString, PayloadGenerator::accessPoints({ PayloadGenerator::devicePath(1) }, 5)));
+
+    const NetworkStats stats = model->stats();
+    EXPECT_TRUE(stats.enabled);
+
+    const HandlerStats &dev = stats.entryPoints[NetworkStats::DevicesChanged];
+    EXPECT_EQ(dev.calls, 1u);
+    EXPECT_EQ(dev.bytes, static_cast<quint64>(PayloadGenerator::devices(2, 1).size()));
+    EXPECT_GT(dev.parseNsec, 0);
+    EXPECT_GT(dev.applyNsec, 0);
+    // 新增设备至少发出 requestDeviceStatus 和 deviceListChanged
+    EXPECT_GE(dev.signalCount, 2u);
+
+    EXPECT_EQ(stats.entryPoints[NetworkStats::ConnectionListChanged].calls, 1u);
+    EXPECT_EQ(stats.entryPoints[NetworkStats::WirelessAccessPointsChanged].calls, 1u);
+    EXPECT_EQ(stats.entryPoints[NetworkStats::SetAPList].calls, 1u);
+    EXPECT_GE(stats.entryPoints[NetworkStats::SetAPList].signalCount, 5u);
+    EXPECT_GT(model->emittedSignalCount(), signalsBefore);
+
+    model->resetStats();
+    EXPECT_EQ(model->stats().entryPoints[NetworkStats::DevicesChanged].calls, 0u);
+    EXPECT_TRUE(model->stats().enabled);
+}
+
+TEST_F(TstNetworkStats, callbacks)
+{
+    NetworkStatsCollector collector;
+    collector.setEnabled(true);
+
+    PendingCallManager manager;
+    manager.setStatsCollector(&collector);
+
+    const QDBusMessage call = QDBusMessage::createMethodCall("com.deepin.daemon.Network",
+                                                             "/com/deepin/daemon/Network",
+                                                             "com.deepin.daemon.Network",
+                                                             "GetProxyMethod");
+    manager.call("GetProxyMethod", [&] {
+        return QDBusPendingCall::fromCompletedCall(call.createReply(QString("manual")));
+    }, [](QDBusPendingCallWatcher *) {});
+    processEvents();
+
+    const NetworkStats stats = collector.snapshot();
+    ASSERT_TRUE(stats.callbacks.contains("GetProxyMethod"));
+    EXPECT_EQ(stats.callbacks.value("GetProxyMethod").calls, 1u);
+    EXPECT_EQ(stats.callbacks.value("GetProxyMethod").bytes, 6u);
+
+    EXPECT_EQ(NetworkStats::entryPointName(NetworkStats::SetAPList), QString("setAPList"));
+}
+
+TEST_F(TstNetworkStats, signalCountMatchesSpy)
+{
+    const QString wired = PayloadGenerator::devicePath(0);
+    const QString wireless = PayloadGenerator::devicePath(1);
+
+    model->setStatsEnabled(true);
+    QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, PayloadGenerator::devices(1, 1)));
+    ASSERT_EQ(model->devices().size(), 2);
+
+    spyAll(model);
+    for (NetworkDevice *dev : model->devices())
+        spyAll(dev);
+
+    const quint64 before = model->emittedSignalCount();
+
+    // 覆盖 model 和两种设备中发出信号的各条路径, 包括列表 setter 以外的信号
+    QMetaObject::invokeMethod(model, "onConnectionListChanged", Q_ARG(QString, PayloadGenerator::connections(3)));
+    QMetaObject::invokeMethod(model, "onConnectionListChanged", Q_ARG(QString, PayloadGenerator::connections(3, "wireless")));
+    QMetaObject::invokeMethod(model, "onWirelessAccessPointsChanged",
+                              Q_ARG(QString, PayloadGenerator::accessPoints({ wireless }, 4)));
+    QMetaObject::invokeMethod(model, "onWirelessAccessPointsChanged",
+                              Q_ARG(QString, PayloadGenerator::accessPoints({ wireless }, 2, 1)));
+    QMetaObject::invokeMethod(model, "onActiveConnectionsChanged", Q_ARG(QString, PayloadGenerator::activeConnections({ wired })));
+    QMetaObject::invokeMethod(model, "onActiveConnInfoChanged", Q_ARG(QString, PayloadGenerator::activeConnectionInfo({ wired })));
+    QMetaObject::invokeMethod(model, "onActiveConnectionsChanged",
+                              Q_ARG(QString, PayloadGenerator::activeConnections({ wireless }, "wireless")));
+    QMetaObject::invokeMethod(model, "onActiveConnInfoChanged",
+                              Q_ARG(QString, PayloadGenerator::activeConnectionInfo({ wireless }, "wireless")));
+    QMetaObject::invokeMethod(model, "onDeviceEnableChanged", Q_ARG(QString, wired), Q_ARG(bool, false));
+    QMetaObject::invokeMethod(model, "onConnectionSessionCreated", Q_ARG(QString, wireless), Q_ARG(QString, "/session/1"));
+    QMetaObject::invokeMethod(model, "onConnectionSessionCreated", Q_ARG(QString, "/unknown"), Q_ARG(QString, "/session/2"));
+    QMetaObject::invokeMethod(model, "onConnectivityChanged", Q_ARG(int, 4));
+
+    EXPECT_GT(spiedCount(), 0u);
+    EXPECT_EQ(model->emittedSignalCount() - before, spiedCount());
+}
+
+TEST_F(TstNetworkStats, noReceiversWhenDisabled)
+{
+    ProbeModel probe;
+    const QMetaMethod deviceListChanged = QMetaMethod::fromSignal(&NetworkModel::deviceListChanged);
+    EXPECT_FALSE(probe.connected(deviceListChanged));
+
+    probe.setStatsEnabled(true);
+    EXPECT_TRUE(probe.connected(deviceListChanged));
+    probe.setStatsEnabled(false);
+    EXPECT_FALSE(probe.connected(deviceListChanged));
+
+    // 没有接收者时 connectionsChanged 仍然推迟发出
+    ProbeWiredDevice dev(QJsonObject { { "Path", "/dev/eth0" } });
+    const QMetaMethod connectionsChanged = QMetaMethod::fromSignal(&WiredDevice::connectionsChanged);
+    EXPECT_FALSE(dev.connected(connectionsChanged));
+    dev.setConnections(QList<QJsonObject> { QJsonObject { { "Uuid", "uuid-1" } } });
+    EXPECT_FALSE(dev.connectionsSnapshot().isLoaded());
+    EXPECT_EQ(dev.emittedSignalCount(), 0u);
+
+    dev.setCounting(true);
+    EXPECT_TRUE(dev.connected(connectionsChanged));
+    dev.setCounting(false);
+    EXPECT_FALSE(dev.connected(connectionsChanged));
+
+    // model 开启统计时, 之后新增的设备也会计数
+    model->setStatsEnabled(true);
+    QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, PayloadGenerator::devices(1)));
+    ASSERT_EQ(model->devices().size(), 1);
+    const quint64 emitted = model->devices().first()->emittedSignalCount();
+    QMetaObject::invokeMethod(model, "onDeviceEnableChanged",
+                              Q_ARG(QString, PayloadGenerator::devicePath(0)), Q_ARG(bool, false));
+    EXPECT_EQ(model->devices().first()->emittedSignalCount(), emitted + 1);
+}
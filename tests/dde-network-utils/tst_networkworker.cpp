@@ -1,8 +1,15 @@
 #include <gtest/gtest.h>
 
 #include "networkworker.h"
+#include "wireddevice.h"
+#include "wirelessdevice.h"
+#include "fakenetworkbackend.h"
+#include "payloadgenerator.h"
+#include "activationtracker.h"
 
-#include <QMimeData>
+#include <QDBusError>
+#include <QEventLoop>
+#include <QTimer>
 
 using namespace dde::network;
 
@@ -11,20 +18,240 @@ class TstNetworkWorker : public testing::Test
 public:
     void SetUp() override
     {
-//        obj = new NetworkWorker();
+        model = new NetworkModel();
+        backend = new FakeNetworkBackend();
+        backend->updateProperty(FakeNetworkBackend::Devices, PayloadGenerator::devices(1, 1));
+        backend->updateProperty(FakeNetworkBackend::Connections, PayloadGenerator::connections(2));
+        obj = new NetworkWorker(backend, model);
     }
 
     void TearDown() override
     {
-//        delete obj;
-//        obj = nullptr;
+        delete obj;
+        obj = nullptr;
+        backend = nullptr;
+        delete model;
+        model = nullptr;
+    }
+
+    void processEvents(int msec = 20)
+    {
+        QEventLoop loop;
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+    // 等待注入结束且后台解析的数据全部应用
+    void waitForInjection(int msec = 5000)
+    {
+        QEventLoop loop;
+        QTimer timer;
+        QObject::connect(&timer, &QTimer::timeout, &loop, [&] {
+            if (!backend->isInjecting() && obj->ingestPipeline()->pendingCount() == 0)
+                loop.quit();
+        });
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        timer.start(5);
+        loop.exec();
     }
 
 public:
+    NetworkModel *model = nullptr;
+    FakeNetworkBackend *backend = nullptr;
     NetworkWorker *obj = nullptr;
 };
 
 TEST_F(TstNetworkWorker, coverageTest)
 {
+    EXPECT_EQ(obj->backend(), backend);
+    EXPECT_EQ(backend->parent(), obj);
+
+    // 初始化时同步读取属性
+    ASSERT_EQ(model->devices().size(), 2);
+    WiredDevice *wired = static_cast<WiredDevice *>(model->devices().first());
+    EXPECT_EQ(wired->connections().size(), 2);
+
+    processEvents();
+
+    // 新设备会查询启用状态, 初始化时会查询活动连接信息
+    EXPECT_EQ(backend->callCount("IsDeviceEnabled"), 2);
+    EXPECT_GE(backend->callCount("GetActiveConnectionInfo"), 1);
+    EXPECT_EQ(obj->callManager()->runningCount(), 0);
+}
+
+TEST_F(TstNetworkWorker, propertyEvents)
+{
+    backend->updateProperty(FakeNetworkBackend::ActiveConnections,
+                            PayloadGenerator::activeConnections({ PayloadGenerator::devicePath(0) }));
+    backend->setReply("GetActiveConnectionInfo", { PayloadGenerator::activeConnectionInfo({ PayloadGenerator::devicePath(0) }) });
+    waitForInjection();
+    processEvents();
+    // 查询的返回值同样在解析线程中解析
+    waitForInjection();
+
+    EXPECT_EQ(model->activeConns().size(), 1);
+    EXPECT_EQ(model->activeConnInfos().size(), 1);
+    EXPECT_EQ(model->devices().first()->status(), NetworkDevice::Activated);
+
+    backend->setVpnEnabled(true);
+    EXPECT_TRUE(model->vpnEnabled());
+
+    backend->setDeviceEnabledState(PayloadGenerator::devicePath(1), false);
+    EXPECT_FALSE(model->devices().last()->enabled());
+}
+
+TEST_F(TstNetworkWorker, methodCalls)
+{
+    backend->setReply("GetProxyMethod", { QString("auto") });
+    obj->setProxyMethod("auto");
+    processEvents();
+
+    // 设置后重新查询
+    ASSERT_EQ(backend->callCount("SetProxyMethod"), 1);
+    EXPECT_EQ(backend->calls("SetProxyMethod").first(), QVariantList() << "auto");
+    EXPECT_EQ(model->proxyMethod(), QString("auto"));
+
+    // 出错时不更新 model
+    backend->setError("GetAutoProxy", "failed");
+    obj->queryAutoProxy();
+    processEvents();
+    EXPECT_EQ(backend->callCount("GetAutoProxy"), 1);
+    EXPECT_TRUE(model->autoProxy().isEmpty());
+
+    obj->activateConnection(PayloadGenerator::devicePath(0), PayloadGenerator::connectionUuid("wired", 0));
+    processEvents();
+    ASSERT_EQ(backend->callCount("ActivateConnection"), 1);
+    EXPECT_EQ(backend->calls("ActivateConnection").first().value(1).toString(), PayloadGenerator::devicePath(0));
+    // 设备尚未激活, 激活请求仍在跟踪中
+    EXPECT_EQ(obj->activationTracker()->pendingCount(), 1);
+}
+
+TEST_F(TstNetworkWorker, activateTimeout)
+{
+    backend->setHanging("ActivateAccessPoint");
+    obj->callManager()->setTimeout("ActivateAccessPoint", 10);
+
+    WirelessDevice *wireless = static_cast<WirelessDevice *>(model->devices().last());
+    QStringList failed;
+    QObject::connect(wireless, &WirelessDevice::activateAccessPointFailed, [&](const QString &apPath) {
+        failed << apPath;
+    });
+
+    // 超时按失败处理, 界面可以收到 activateAccessPointFailed
+    obj->activateAccessPoint(wireless->path(), "/ap/1", PayloadGenerator::connectionUuid("wireless", 0));
+    processEvents(50);
+    EXPECT_EQ(failed, QStringList() << "/ap/1");
+}
+
+TEST_F(TstNetworkWorker, activateWithoutDeviceTimeout)
+{
+    backend->setHanging("ActivateConnection");
+    obj->callManager()->setTimeout("ActivateConnection", 10);
+
+    QList<ActivationResult> results;
+    QObject::connect(obj->activationTracker(), &ActivationTracker::activationFinished, [&](const ActivationResult &result) {
+        results << result;
+    });
+
+    // VPN 没有对应的设备, 只能以 DBus 返回作为结束, 超时后不应等到跟踪器自己的超时
+    obj->activateConnection("/", "uuid-vpn");
+    processEvents(50);
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_FALSE(results.first().activated);
+    EXPECT_EQ(results.first().error, QDBusError::errorString(QDBusError::Timeout));
+    EXPECT_GE(results.first().requestUsec, 0);
+    EXPECT_EQ(obj->activationTracker()->pendingCount(), 0);
+    EXPECT_EQ(obj->activationTracker()->requestHistogram().count(), 1u);
+}
+
+TEST_F(TstNetworkWorker, deviceListRequery)
+{
+    processEvents();
+
+    QList<ChangeSet> changes;
+    QObject::connect(model, &NetworkModel::modelChanged, [&](const ChangeSet &change) {
+        changes << change;
+    });
+
+    // deviceListChanged 后重新应用连接列表并重新查询活动连接信息
+    backend->setReply("GetActiveConnectionInfo", { PayloadGenerator::activeConnectionInfo({ PayloadGenerator::devicePath(0) }) });
+    backend->updateProperty(FakeNetworkBackend::Devices, PayloadGenerator::devices(2, 1));
+    waitForInjection();
+    processEvents();
+    waitForInjection();
+
+    ASSERT_EQ(model->devices().size(), 3);
+    EXPECT_EQ(model->activeConnInfos().size(), 1);
+
+    // 连接列表不等待查询返回, 查询到的活动连接信息在之后单独通知
+    int connectionsAt = -1;
+    int activeConnInfoAt = -1;
+    for (int i = 0; i < changes.size(); ++i) {
+        if (changes[i].contains(ChangeSet::ConnectionsChanged) && connectionsAt < 0)
+            connectionsAt = i;
+        if (changes[i].contains(ChangeSet::ActiveConnInfoChanged)) {
+            EXPECT_EQ(activeConnInfoAt, -1);
+            activeConnInfoAt = i;
+        }
+    }
+    ASSERT_GE(connectionsAt, 0);
+    EXPECT_GT(activeConnInfoAt, connectionsAt);
+    EXPECT_FALSE(model->isUpdating());
+}
+
+TEST_F(TstNetworkWorker, deviceListRequeryHanging)
+{
+    processEvents();
+    backend->setHanging("GetActiveConnectionInfo");
+
+    int connectionChanges = 0;
+    QObject::connect(model, &NetworkModel::modelChanged, [&](const ChangeSet &change) {
+        if (change.contains(ChangeSet::ConnectionsChanged))
+            ++connectionChanges;
+    });
+
+    backend->updateProperty(FakeNetworkBackend::Devices, PayloadGenerator::devices(2, 1));
+    waitForInjection();
+    processEvents(50);
+
+    // 查询没有返回时, 设备和连接列表的变化已经通知出去
+    EXPECT_EQ(model->devices().size(), 3);
+    EXPECT_GE(connectionChanges, 1);
+    EXPECT_FALSE(model->isUpdating());
+}
+
+TEST_F(TstNetworkWorker, injectEvents)
+{
+    // 设备数量逐渐增加, 最终以最后一次的数据为准
+    backend->inject(FakeNetworkBackend::Devices, 20, 0, [](int i) {
+        return PayloadGenerator::devices(i + 1, 1);
+    });
+    waitForInjection();
+    EXPECT_EQ(model->devices().size(), 21);
+
+    // 按频率注入无线列表的刷新
+    const QString wirelessPath = PayloadGenerator::devicePath(20);
+    int finished = 0;
+    QObject::connect(backend, &FakeNetworkBackend::injectionFinished, [&] { ++finished; });
+    backend->inject(FakeNetworkBackend::AccessPoints, 10, 500, [=](int i) {
+        return PayloadGenerator::accessPoints({ wirelessPath }, 30, i);
+    });
+    EXPECT_TRUE(backend->isInjecting());
+    waitForInjection();
+
+    EXPECT_EQ(finished, 1);
+    WirelessDevice *wireless = static_cast<WirelessDevice *>(model->devices().last());
+    EXPECT_EQ(wireless->path(), wirelessPath);
+    EXPECT_EQ(wireless->apList().size(), 30);
+}
+
+TEST_F(TstNetworkWorker, deactive)
+{
+    obj->deactive();
+    backend->updateProperty(FakeNetworkBackend::Devices, PayloadGenerator::devices(3));
+    waitForInjection();
+    EXPECT_EQ(model->devices().size(), 2);
 
+    obj->active();
+    EXPECT_EQ(model->devices().size(), 3);
 }
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include "pacproxyresolver.h"
+#include "networkmodel.h"
+
+#include <QEventLoop>
+#include <QTimer>
+
+using namespace dde::network;
+
+class TstPacProxyResolver : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new PacProxyResolver();
+        QObject::connect(obj, &PacProxyResolver::proxyResolved, [ = ](const QUrl &url, const QString &proxy) {
+            results.insert(url.toString(), proxy);
+        });
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+        results.clear();
+    }
+
+    const QString resolve(const QString &url)
+    {
+        results.remove(url);
+        obj->resolve(QUrl(url));
+        for (int i = 0; i < 100 && !results.contains(url); ++i)
+            processEvents();
+        return results.value(url);
+    }
+
+    void load(const QString &fixture)
+    {
+        QEventLoop loop;
+        QObject::connect(obj, &PacProxyResolver::scriptLoaded, &loop, &QEventLoop::quit);
+        QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+        obj->setScriptUrl(QString(PAC_DATA_DIR) + "/" + fixture);
+        loop.exec();
+    }
+
+    void processEvents(int msec = 20)
+    {
+        QEventLoop loop;
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+public:
+    PacProxyResolver *obj = nullptr;
+    QHash<QString, QString> results;
+};
+
+TEST_F(TstPacProxyResolver, coverageTest)
+{
+    EXPECT_FALSE(obj->isReady());
+    EXPECT_TRUE(obj->scriptUrl().isEmpty());
+    EXPECT_TRUE(obj->cachedProxy(QUrl("https://www.deepin.org/")).isEmpty());
+
+    // 没有脚本时直接连接
+    EXPECT_EQ(resolve("https://www.deepin.org/"), QString("DIRECT"));
+
+    obj->setCacheTtl(-1);
+    EXPECT_EQ(obj->cacheTtl(), 0);
+}
+
+TEST_F(TstPacProxyResolver, evaluateScript)
+{
+    load("simple.pac");
+    ASSERT_TRUE(obj->isReady());
+    EXPECT_TRUE(obj->scriptUrl().isLocalFile());
+
+    EXPECT_EQ(resolve("https://www.deepin.org/index.html"), QString("PROXY proxy.example.com:3128"));
+    EXPECT_EQ(resolve("http://nas/"), QString("DIRECT"));
+    EXPECT_EQ(resolve("http://wiki.intranet.example.com/"), QString("DIRECT"));
+    EXPECT_EQ(resolve("http://10.1.2.3/"), QString("DIRECT"));
+    EXPECT_EQ(resolve("http://192.168.1.1/"), QString("PROXY fallback.example.com:8080; DIRECT"));
+}
+
+TEST_F(TstPacProxyResolver, cacheByHost)
+{
+    load("counter.pac");
+    ASSERT_TRUE(obj->isReady());
+
+    EXPECT_EQ(resolve("https://www.deepin.org/a"), QString("PROXY counter.example.com:1"));
+    // 同一主机命中缓存, 不再执行脚本
+    EXPECT_EQ(resolve("https://www.deepin.org/b"), QString("PROXY counter.example.com:1"));
+    EXPECT_EQ(obj->cachedProxy(QUrl("http://WWW.deepin.org/")), QString("PROXY counter.example.com:1"));
+    EXPECT_EQ(resolve("https://bbs.deepin.org/"), QString("PROXY counter.example.com:2"));
+    EXPECT_EQ(obj->cacheSize(), 2);
+
+    // 缓存过期后重新执行
+    obj->setCacheTtl(1);
+    obj->clearCache();
+    EXPECT_EQ(resolve("https://www.deepin.org/"), QString("PROXY counter.example.com:3"));
+    processEvents();
+    EXPECT_TRUE(obj->cachedProxy(QUrl("https://www.deepin.org/")).isEmpty());
+    EXPECT_EQ(resolve("https://www.deepin.org/"), QString("PROXY counter.example.com:4"));
+}
+
+TEST_F(TstPacProxyResolver, invalidateOnScriptChanged)
+{
+    NetworkModel model;
+    PacProxyResolver resolver(&model);
+    QHash<QString, QString> resolved;
+    QObject::connect(&resolver, &PacProxyResolver::proxyResolved, [&](const QUrl &url, const QString &proxy) {
+        resolved.insert(url.toString(), proxy);
+    });
+
+    QMetaObject::invokeMethod(&model, "onAutoProxyChanged", Q_ARG(QString, QString(PAC_DATA_DIR) + "/counter.pac"));
+    EXPECT_TRUE(resolver.scriptUrl().isLocalFile());
+
+    resolver.resolve(QUrl("https://www.deepin.org/"));
+    for (int i = 0; i < 100 && resolved.isEmpty(); ++i)
+        processEvents();
+    EXPECT_EQ(resolved.value("https://www.deepin.org/"), QString("PROXY counter.example.com:1"));
+    EXPECT_EQ(resolver.cacheSize(), 1);
+
+    // autoProxy 变化后缓存作废, 加载失败的脚本按直接连接处理
+    QMetaObject::invokeMethod(&model, "onAutoProxyChanged", Q_ARG(QString, QString(PAC_DATA_DIR) + "/broken.pac"));
+    EXPECT_EQ(resolver.cacheSize(), 0);
+    resolved.clear();
+    resolver.resolve(QUrl("https://www.deepin.org/"));
+    for (int i = 0; i < 100 && resolved.isEmpty(); ++i)
+        processEvents();
+    EXPECT_FALSE(resolver.isReady());
+    EXPECT_EQ(resolved.value("https://www.deepin.org/"), QString("DIRECT"));
+}
+
+TEST_F(TstPacProxyResolver, asyncDnsResolve)
+{
+    load("dns.pac");
+    ASSERT_TRUE(obj->isReady());
+
+    // 第一次执行时还没有查询结果, 查询返回后重新执行
+    EXPECT_EQ(resolve("http://127.0.0.1/"), QString("PROXY 127.0.0.1:3128"));
+    EXPECT_EQ(resolve("http://localhost/"), QString("PROXY 127.0.0.1:3128"));
+}
+
+TEST_F(TstPacProxyResolver, evictOldestEntries)
+{
+    load("simple.pac");
+    ASSERT_TRUE(obj->isReady());
+
+    const int count = 1100;
+    for (int i = 0; i < count; ++i)
+        obj->resolve(QUrl(QString("http://host%1.example.com/").arg(i)));
+    for (int i = 0; i < 500 && results.size() < count; ++i)
+        processEvents();
+    ASSERT_EQ(results.size(), count);
+
+    // 缓存满时只淘汰最早的条目, 不整个清空
+    EXPECT_LE(obj->cacheSize(), 1024);
+    EXPECT_GT(obj->cacheSize(), 512);
+    EXPECT_TRUE(obj->cachedProxy(QUrl("http://host0.example.com/")).isEmpty());
+    EXPECT_FALSE(obj->cachedProxy(QUrl(QString("http://host%1.example.com/").arg(count - 1))).isEmpty());
+}
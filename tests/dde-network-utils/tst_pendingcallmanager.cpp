@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include "pendingcallmanager.h"
+
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QEventLoop>
+#include <QTimer>
+
+using namespace dde::network;
+
+static QDBusPendingCall completedCall(const QString &value)
+{
+    const QDBusMessage &call = QDBusMessage::createMethodCall("com.deepin.daemon.Network",
+                                                              "/com/deepin/daemon/Network",
+                                                              "com.deepin.daemon.Network",
+                                                              "GetProxyMethod");
+    return QDBusPendingCall::fromCompletedCall(call.createReply(value));
+}
+
+// 不是回复的消息构造出的调用永远不会完成
+static QDBusPendingCall hangingCall()
+{
+    return QDBusPendingCall::fromCompletedCall(QDBusMessage());
+}
+
+class TstPendingCallManager : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new PendingCallManager();
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+    void processEvents(int msec = 20)
+    {
+        QEventLoop loop;
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+public:
+    PendingCallManager *obj = nullptr;
+};
+
+TEST_F(TstPendingCallManager, coverageTest)
+{
+    QStringList results;
+    auto callback = [&](QDBusPendingCallWatcher *w) {
+        results << w->reply().arguments().value(0).toString();
+    };
+
+    obj->call("GetProxyMethod", [] { return completedCall("auto"); }, callback, "GetProxyMethod");
+    obj->call("GetProxyMethod", [] { return completedCall("manual"); }, callback, "GetProxyMethod");
+    processEvents();
+
+    // 重复的调用不再发起, 两次回调收到的都是第一次调用的结果
+    EXPECT_EQ(results, QStringList() << "auto" << "auto");
+    EXPECT_EQ(obj->dedupedCount(), 1u);
+    EXPECT_EQ(obj->runningCount(), 0);
+    EXPECT_EQ(obj->latencyHistogram("GetProxyMethod").count(), 1u);
+}
+
+TEST_F(TstPendingCallManager, invalidateDropsStaleReply)
+{
+    int calls = 0;
+    int callbacks = 0;
+
+    obj->call("GetProxyMethod", [&]() -> QDBusPendingCall { ++calls; return completedCall("auto"); },
+              [&](QDBusPendingCallWatcher *) { ++callbacks; }, "GetProxyMethod");
+    obj->invalidate("GetProxyMethod");
+    processEvents();
+
+    // 过期的结果被丢弃, 并自动重新发起一次
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(callbacks, 1);
+    EXPECT_EQ(obj->staleCount(), 1u);
+}
+
+TEST_F(TstPendingCallManager, boundedConcurrency)
+{
+    obj->setMaxConcurrentCalls(1);
+
+    int callbacks = 0;
+    for (int i = 0; i < 3; ++i)
+        obj->call("GetProxyMethod", [] { return completedCall("auto"); },
+                  [&](QDBusPendingCallWatcher *) { ++callbacks; });
+
+    EXPECT_EQ(obj->runningCount(), 1);
+    EXPECT_EQ(obj->queuedCount(), 2);
+
+    processEvents();
+    EXPECT_EQ(callbacks, 3);
+    EXPECT_EQ(obj->queuedCount(), 0);
+}
+
+TEST_F(TstPendingCallManager, timeoutDeliversError)
+{
+    obj->setTimeout("ActivateAccessPoint", 10);
+
+    int callbacks = 0;
+    QString error;
+    QString apPath;
+    obj->call("ActivateAccessPoint", [] { return hangingCall(); }, [&](QDBusPendingCallWatcher *w) {
+        ++callbacks;
+        error = w->isError() ? w->error().name() : QString();
+        apPath = w->property("apPath").toString();
+    }, "ActivateAccessPoint", { { "apPath", "/ap/1" } });
+    processEvents(50);
+
+    // 超时以 Timeout 错误回调, 调用时的属性仍然可以读取
+    EXPECT_EQ(callbacks, 1);
+    EXPECT_EQ(error, QDBusError::errorString(QDBusError::Timeout));
+    EXPECT_EQ(apPath, QString("/ap/1"));
+    EXPECT_EQ(obj->timeoutCount(), 1u);
+    EXPECT_EQ(obj->runningCount(), 0);
+    EXPECT_EQ(obj->latencyHistogram("ActivateAccessPoint").count(), 0u);
+
+    // key 已经释放, 可以再次发起相同的调用
+    obj->call("ActivateAccessPoint", [] { return hangingCall(); }, [&](QDBusPendingCallWatcher *) { ++callbacks; }, "ActivateAccessPoint");
+    EXPECT_EQ(obj->dedupedCount(), 0u);
+    processEvents(50);
+    EXPECT_EQ(callbacks, 2);
+}
+
+TEST_F(TstPendingCallManager, dedupedCallersShareReply)
+{
+    int calls = 0;
+    QString first;
+    QString second;
+    auto factory = [&]() -> QDBusPendingCall { ++calls; return completedCall("auto"); };
+
+    obj->call("GetProxyMethod", factory, [&](QDBusPendingCallWatcher *w) {
+        first = w->reply().arguments().value(0).toString();
+    }, "GetProxyMethod");
+    obj->call("GetProxyMethod", factory, [&](QDBusPendingCallWatcher *w) {
+        second = w->reply().arguments().value(0).toString();
+    }, "GetProxyMethod");
+    processEvents();
+
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(first, QString("auto"));
+    EXPECT_EQ(second, QString("auto"));
+
+    // 重新发起的调用和超时同样通知所有调用方
+    first.clear();
+    second.clear();
+    obj->call("GetProxyMethod", factory, [&](QDBusPendingCallWatcher *w) {
+        first = w->reply().arguments().value(0).toString();
+    }, "GetProxyMethod");
+    obj->invalidate("GetProxyMethod");
+    obj->call("GetProxyMethod", factory, [&](QDBusPendingCallWatcher *w) {
+        second = w->reply().arguments().value(0).toString();
+    }, "GetProxyMethod");
+    processEvents();
+    EXPECT_EQ(calls, 3);
+    EXPECT_EQ(first, QString("auto"));
+    EXPECT_EQ(second, QString("auto"));
+
+    obj->setTimeout("ActivateAccessPoint", 10);
+    QStringList errors;
+    auto onError = [&](QDBusPendingCallWatcher *w) { errors << w->error().name(); };
+    obj->call("ActivateAccessPoint", [] { return hangingCall(); }, onError, "ActivateAccessPoint");
+    obj->call("ActivateAccessPoint", [] { return hangingCall(); }, onError, "ActivateAccessPoint");
+    processEvents(50);
+    EXPECT_EQ(errors, QStringList() << QDBusError::errorString(QDBusError::Timeout)
+                                    << QDBusError::errorString(QDBusError::Timeout));
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "proxybypassmatcher.h"
+
+using namespace dde::network;
+
+class TstProxyBypassMatcher : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new ProxyBypassMatcher("localhost, 127.0.0.0/8 ::1;*.corp.example.com .lan\n"
+                                     "example.org 192.168.1.10 fd00::/8 intranet:8080 10.*.*.1 <local>");
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+public:
+    ProxyBypassMatcher *obj = nullptr;
+};
+
+TEST_F(TstProxyBypassMatcher, coverageTest)
+{
+    EXPECT_EQ(obj->ruleCount(), 11);
+    EXPECT_FALSE(obj->isEmpty());
+    EXPECT_TRUE(ProxyBypassMatcher().isEmpty());
+    EXPECT_FALSE(ProxyBypassMatcher().matches("localhost"));
+}
+
+TEST_F(TstProxyBypassMatcher, matchDomains)
+{
+    EXPECT_TRUE(obj->matches("localhost"));
+    EXPECT_TRUE(obj->matches("LOCALHOST."));
+
+    // 普通域名匹配自身和子域名
+    EXPECT_TRUE(obj->matches("example.org"));
+    EXPECT_TRUE(obj->matches("www.example.org"));
+    EXPECT_FALSE(obj->matches("badexample.org"));
+
+    // "*." 和 "." 开头的规则只匹配子域名
+    EXPECT_TRUE(obj->matches("git.corp.example.com"));
+    EXPECT_TRUE(obj->matches("a.b.corp.example.com"));
+    EXPECT_FALSE(obj->matches("corp.example.com"));
+    EXPECT_FALSE(obj->matches("example.com"));
+    EXPECT_TRUE(obj->matches("printer.lan"));
+    EXPECT_FALSE(obj->matches("lan.com"));
+
+    // 端口被忽略, <local> 匹配不带点的主机名
+    EXPECT_TRUE(obj->matches("intranet"));
+    EXPECT_TRUE(obj->matches("nas"));
+    EXPECT_FALSE(obj->matches("deepin.org"));
+}
+
+TEST_F(TstProxyBypassMatcher, matchAddresses)
+{
+    EXPECT_TRUE(obj->matches("127.0.0.1"));
+    EXPECT_TRUE(obj->matches("127.255.1.2"));
+    EXPECT_FALSE(obj->matches("128.0.0.1"));
+    EXPECT_TRUE(obj->matches("192.168.1.10"));
+    EXPECT_FALSE(obj->matches("192.168.1.11"));
+
+    EXPECT_TRUE(obj->matches("::1"));
+    EXPECT_TRUE(obj->matches("[::1]"));
+    EXPECT_TRUE(obj->matches("fd12:3456::1"));
+    EXPECT_FALSE(obj->matches("fe80::1"));
+    EXPECT_TRUE(obj->matches("::ffff:127.0.0.1"));
+
+    // 通配符规则
+    EXPECT_TRUE(obj->matches("10.1.2.1"));
+    EXPECT_FALSE(obj->matches("10.1.2.3"));
+}
+
+TEST_F(TstProxyBypassMatcher, matchWildcards)
+{
+    ProxyBypassMatcher wildcards("*.cdn*.example.com build-??.ci *-test*");
+    EXPECT_EQ(wildcards.ruleCount(), 3);
+
+    // '*' 可以匹配空串和多个标签, 不匹配时回退重试
+    EXPECT_TRUE(wildcards.matches("a.cdn.example.com"));
+    EXPECT_TRUE(wildcards.matches("a.b.cdn-eu.example.com"));
+    EXPECT_FALSE(wildcards.matches("cdn.example.com"));
+    EXPECT_FALSE(wildcards.matches("a.cdn.example.com.cn"));
+
+    // '?' 只匹配一个字符
+    EXPECT_TRUE(wildcards.matches("BUILD-01.ci"));
+    EXPECT_FALSE(wildcards.matches("build-1.ci"));
+    EXPECT_FALSE(wildcards.matches("build-001.ci"));
+
+    EXPECT_TRUE(wildcards.matches("web-test-test"));
+    EXPECT_FALSE(wildcards.matches("webtest"));
+}
+
+TEST_F(TstProxyBypassMatcher, matchAll)
+{
+    ProxyBypassMatcher all("*");
+    EXPECT_TRUE(all.matches("www.deepin.org"));
+    EXPECT_TRUE(all.matches("8.8.8.8"));
+
+    // 已被更短网段覆盖的规则不影响匹配结果
+    ProxyBypassMatcher nested("10.0.0.0/8, 10.1.0.0/16");
+    EXPECT_TRUE(nested.matches("10.1.2.3"));
+    EXPECT_TRUE(nested.matches("10.200.0.1"));
+    EXPECT_FALSE(nested.matches("11.0.0.1"));
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "sharedsnapshot.h"
+
+using namespace dde::network;
+
+static QList<QJsonObject> connections(int count)
+{
+    QList<QJsonObject> list;
+    for (int i = 0; i < count; ++i)
+        list << QJsonObject { { "Uuid", QString::number(i) } };
+    return list;
+}
+
+class TstSharedSnapshot : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new ConnectionSnapshot(connections(3));
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+public:
+    ConnectionSnapshot *obj = nullptr;
+};
+
+TEST_F(TstSharedSnapshot, coverageTest)
+{
+    EXPECT_EQ(obj->size(), 3);
+    EXPECT_FALSE(obj->isEmpty());
+    EXPECT_EQ(obj->at(1).value("Uuid").toString(), QString("1"));
+    EXPECT_EQ((*obj)[2].value("Uuid").toString(), QString("2"));
+
+    int count = 0;
+    for (const QJsonObject &conn : *obj)
+        count += !conn.isEmpty();
+    EXPECT_EQ(count, 3);
+
+    ConnectionSnapshot empty;
+    EXPECT_TRUE(empty.isEmpty());
+    EXPECT_EQ(empty.version(), 0u);
+    EXPECT_EQ(empty, ConnectionSnapshot());
+}
+
+TEST_F(TstSharedSnapshot, immutableAcrossUpdates)
+{
+    const ConnectionSnapshot held = *obj;
+    EXPECT_EQ(held, *obj);
+    EXPECT_EQ(held.version(), obj->version());
+
+    // 内容相同时保留原快照
+    EXPECT_FALSE(obj->update(connections(3)));
+    EXPECT_EQ(held, *obj);
+
+    // 更新后旧快照保持不变, 新快照版本号更大
+    EXPECT_TRUE(obj->update(connections(5)));
+    EXPECT_NE(held, *obj);
+    EXPECT_GT(obj->version(), held.version());
+    EXPECT_EQ(held.size(), 3);
+    EXPECT_EQ(obj->size(), 5);
+}
+
+TEST_F(TstSharedSnapshot, lazyLoadsOnce)
+{
+    int loads = 0;
+    const ConnectionSnapshot lazy = ConnectionSnapshot::lazy([&loads] {
+        ++loads;
+        return connections(4);
+    });
+
+    // 只读取版本号时不生成内容
+    EXPECT_GT(lazy.version(), obj->version());
+    EXPECT_FALSE(lazy.isLoaded());
+    EXPECT_EQ(loads, 0);
+
+    const ConnectionSnapshot held = lazy;
+    EXPECT_EQ(held.size(), 4);
+    EXPECT_EQ(lazy.at(3).value("Uuid").toString(), QString("3"));
+    EXPECT_TRUE(lazy.isLoaded());
+    EXPECT_EQ(loads, 1);
+
+    ConnectionSnapshot updated = lazy;
+    EXPECT_FALSE(updated.update(connections(4)));
+    EXPECT_EQ(updated, lazy);
+    EXPECT_TRUE(obj->isLoaded());
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include "signalrecorder.h"
+#include "fakenetworkbackend.h"
+#include "payloadgenerator.h"
+#include "payloadcodec.h"
+
+#include <QTemporaryDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+using namespace dde::network;
+
+class TstSignalRecorder : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new SignalRecorder();
+        backend = new FakeNetworkBackend();
+        obj->attach(backend);
+        fileName = dir.filePath("signals.rec");
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+        delete backend;
+        backend = nullptr;
+    }
+
+public:
+    SignalRecorder *obj = nullptr;
+    FakeNetworkBackend *backend = nullptr;
+    QTemporaryDir dir;
+    QString fileName;
+};
+
+TEST_F(TstSignalRecorder, coverageTest)
+{
+    // 未开始录制时不记录
+    backend->updateProperty(FakeNetworkBackend::Devices, PayloadGenerator::devices(1));
+    EXPECT_FALSE(obj->isRecording());
+    EXPECT_EQ(obj->recordCount(), 0);
+
+    ASSERT_TRUE(obj->start(fileName));
+    EXPECT_TRUE(obj->isRecording());
+
+    const QString devices = PayloadGenerator::devices(1, 1);
+    backend->updateProperty(FakeNetworkBackend::Devices, devices);
+    backend->updateProperty(FakeNetworkBackend::Connections, PayloadGenerator::connections(3));
+    backend->updateProperty(FakeNetworkBackend::Devices, devices);
+    backend->setDeviceEnabledState(PayloadGenerator::devicePath(0), false);
+    backend->setConnectivityState(2);
+    backend->setVpnEnabled(true);
+    obj->record(SignalRecorder::ActiveConnInfo, "[]");
+    EXPECT_EQ(obj->recordCount(), 7);
+
+    obj->stop();
+    EXPECT_FALSE(obj->isRecording());
+
+    bool ok = false;
+    const QList<SignalRecorder::Record> records = SignalRecorder::load(fileName, &ok);
+    EXPECT_TRUE(ok);
+    ASSERT_EQ(records.size(), 7);
+
+    EXPECT_EQ(records[0].kind, SignalRecorder::Devices);
+    EXPECT_EQ(records[0].payload, devices);
+    EXPECT_EQ(records[1].kind, SignalRecorder::Connections);
+    // 重复的数据只记录标志, 读取时还原
+    EXPECT_EQ(records[2].payload, devices);
+    EXPECT_EQ(records[3].kind, SignalRecorder::DeviceEnabled);
+    EXPECT_TRUE(records[3].payload.contains(PayloadGenerator::devicePath(0)));
+    EXPECT_EQ(records[4].payload, QString("2"));
+    EXPECT_EQ(records[5].payload, QString("true"));
+    EXPECT_EQ(records[6].kind, SignalRecorder::ActiveConnInfo);
+
+    for (int i = 1; i < records.size(); ++i)
+        EXPECT_GE(records[i].usec, records[i - 1].usec);
+}
+
+TEST_F(TstSignalRecorder, invalidFile)
+{
+    bool ok = true;
+    EXPECT_TRUE(SignalRecorder::load(dir.filePath("missing.rec"), &ok).isEmpty());
+    EXPECT_FALSE(ok);
+
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("not a recording");
+    file.close();
+
+    ok = true;
+    EXPECT_TRUE(SignalRecorder::load(fileName, &ok).isEmpty());
+    EXPECT_FALSE(ok);
+
+    // 截断的文件返回已读取的部分
+    ASSERT_TRUE(obj->start(fileName));
+    backend->updateProperty(FakeNetworkBackend::Connections, PayloadGenerator::connections(100));
+    backend->updateProperty(FakeNetworkBackend::Connections, PayloadGenerator::connections(200));
+    obj->stop();
+
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    file.resize(file.size() - 10);
+    file.close();
+
+    ok = true;
+    EXPECT_EQ(SignalRecorder::load(fileName, &ok).size(), 1);
+    EXPECT_FALSE(ok);
+}
+
+TEST_F(TstSignalRecorder, recordCbor)
+{
+    if (!PayloadCodec::isCborSupported())
+        return;
+
+    ASSERT_TRUE(obj->start(fileName));
+    const QJsonObject conns = QJsonDocument::fromJson(PayloadGenerator::connections(3).toUtf8()).object();
+    Q_EMIT backend->connectionsCborChanged(PayloadCodec::encode(conns, PayloadCodec::Cbor));
+    Q_EMIT backend->wirelessAccessPointsCborChanged(PayloadCodec::encode(QJsonObject(), PayloadCodec::Cbor));
+    obj->stop();
+
+    // CBOR 的变化以解码后的 Json 录制
+    const QList<SignalRecorder::Record> records = SignalRecorder::load(fileName);
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].kind, SignalRecorder::Connections);
+    EXPECT_EQ(QJsonDocument::fromJson(records[0].payload.toUtf8()).object(), conns);
+    EXPECT_EQ(records[1].kind, SignalRecorder::AccessPoints);
+    EXPECT_EQ(records[1].payload, QString("{}"));
+}
@@ -6,6 +6,13 @@
 
 using namespace dde::network;
 
+// 发出信号的计数默认关闭, 由 NetworkModel 开启统计时打开
+class CountingWiredDevice : public WiredDevice
+{
+public:
+    explicit CountingWiredDevice(const QJsonObject &info) : WiredDevice(info) { setEmitCountingEnabled(true); }
+};
+
 class TstWiredDevice : public testing::Test
 {
 public:
@@ -28,3 +35,40 @@ TEST_F(TstWiredDevice, coverageTest)
 {
 
 }
+
+TEST_F(TstWiredDevice, activeConnectionInfoCache)
+{
+    WiredDevice dev(QJsonObject { { "Path", "/dev/eth0" } });
+
+    dev.setActiveConnectionsInfo({
+        QJsonObject { { "ConnectionType", "vpn-l2tp" }, { "ConnectionName", "vpn" } },
+        QJsonObject { { "ConnectionType", "pppoe" }, { "ConnectionName", "dsl" }, { "ConnectionUuid", "uuid-dsl" } },
+    });
+
+    EXPECT_EQ(dev.activeWiredConnName(), "dsl");
+    EXPECT_EQ(dev.activeWiredConnUuid(), "uuid-dsl");
+    EXPECT_EQ(dev.activeVpnConnectionsInfo().size(), 1);
+
+    dev.setActiveConnectionsInfo({});
+    EXPECT_TRUE(dev.activeWiredConnectionInfo().isEmpty());
+    EXPECT_TRUE(dev.activeWiredConnName().isEmpty());
+}
+
+TEST_F(TstWiredDevice, suppressUnchangedLists)
+{
+    CountingWiredDevice dev(QJsonObject { { "Path", "/dev/eth0" } });
+    const QList<QJsonObject> conns { QJsonObject { { "Uuid", "uuid-1" }, { "Id", "Wired" } } };
+
+    int changed = 0;
+    QObject::connect(&dev, &WiredDevice::connectionsChanged, [&] { ++changed; });
+
+    const quint64 emitted = dev.emittedSignalCount();
+    dev.setConnections(conns);
+    dev.setConnections(conns);
+    EXPECT_EQ(changed, 1);
+    EXPECT_EQ(dev.emittedSignalCount(), emitted + 1);
+    EXPECT_EQ(dev.suppressedSignalCount(), 1u);
+
+    dev.setConnections({ QJsonObject { { "Uuid", "uuid-1" }, { "Id", "Wired 2" } } });
+    EXPECT_EQ(changed, 2);
+}
@@ -3,9 +3,16 @@
 #include "wirelessdevice.h"
 
 #include <QMimeData>
+#include <QJsonArray>
 
 using namespace dde::network;
 
+class CountingWirelessDevice : public WirelessDevice
+{
+public:
+    explicit CountingWirelessDevice(const QJsonObject &info) : WirelessDevice(info) { setEmitCountingEnabled(true); }
+};
+
 class TstWirelessDevice : public testing::Test
 {
 public:
@@ -28,3 +35,47 @@ TEST_F(TstWirelessDevice, coverageTest)
 {
 
 }
+
+TEST_F(TstWirelessDevice, suppressUnchangedActiveConnInfo)
+{
+    CountingWirelessDevice dev(QJsonObject { { "Path", "/dev/wlan0" } });
+    dev.setAPList(QJsonArray { QJsonObject { { "Path", "/ap/1" }, { "Ssid", "ap" }, { "Strength", 60 } } });
+
+    const QList<QJsonObject> infos {
+        QJsonObject { { "ConnectionType", "wireless" }, { "ConnectionName", "ap" }, { "SpecificObject", "/ap/1" } },
+    };
+
+    // 第一次设置发出 activeApInfoChanged、activeWirelessConnectionInfoChanged 和 activeConnectionsInfoChanged
+    const quint64 emitted = dev.emittedSignalCount();
+    dev.setActiveConnectionsInfo(infos);
+    EXPECT_EQ(dev.emittedSignalCount() - emitted, 3u);
+    EXPECT_EQ(dev.activeWirelessConnName(), QString("ap"));
+
+    // 内容不变时这些信号都被抑制
+    dev.setActiveConnectionsInfo(infos, NetworkDevice::contentHash(infos));
+    EXPECT_EQ(dev.emittedSignalCount() - emitted, 3u);
+    EXPECT_EQ(dev.suppressedSignalCount(), 3u);
+}
+
+TEST_F(TstWirelessDevice, hotspotChangedAfterActiveConnInfo)
+{
+    WirelessDevice dev(QJsonObject { { "Path", "/dev/wlan0" } });
+
+    QStringList order;
+    QObject::connect(&dev, &WirelessDevice::activeWirelessConnectionInfoChanged, [&] { order << "wireless"; });
+    QObject::connect(&dev, &WirelessDevice::activeConnectionsInfoChanged, [&] { order << "infos"; });
+    QObject::connect(&dev, &WirelessDevice::hotspotEnabledChanged, [&](bool enabled) {
+        // 接收者在热点信号中读取到的连接信息已经是新的
+        EXPECT_EQ(dev.activeConnectionsInfo().size(), enabled ? 1 : 0);
+        order << "hotspot";
+    });
+
+    dev.setActiveConnectionsInfo({ QJsonObject { { "ConnectionType", "wireless-hotspot" }, { "ConnectionUuid", "uuid-1" } } });
+    EXPECT_TRUE(dev.hotspotEnabled());
+    EXPECT_EQ(order, QStringList({ "wireless", "infos", "hotspot" }));
+
+    order.clear();
+    dev.setActiveConnectionsInfo(QList<QJsonObject>());
+    EXPECT_FALSE(dev.hotspotEnabled());
+    EXPECT_EQ(order, QStringList({ "wireless", "infos", "hotspot" }));
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "wirelessscanscheduler.h"
+#include "networkmodel.h"
+
+#include <QEventLoop>
+#include <QTimer>
+
+using namespace dde::network;
+
+static const char *WirelessDevices = R"({"wireless":[{"Path":"/dev/wlan0","Managed":true,"Interface":"wlan0","State":30}]})";
+
+class TstWirelessScanScheduler : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        model = new NetworkModel();
+        QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, WirelessDevices));
+        obj = new WirelessScanScheduler(model);
+        obj->setIntervals(60 * 1000, 60 * 1000);
+        QObject::connect(obj, &WirelessScanScheduler::scanRequired, [this] { ++scans; });
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+        delete model;
+        model = nullptr;
+    }
+
+    void processEvents(int msec)
+    {
+        QEventLoop loop;
+        QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+public:
+    NetworkModel *model = nullptr;
+    WirelessScanScheduler *obj = nullptr;
+    int scans = 0;
+};
+
+TEST_F(TstWirelessScanScheduler, coverageTest)
+{
+    obj->requestScan();
+    obj->requestScan("/dev/wlan0");
+    processEvents(20);
+
+    EXPECT_EQ(scans, 1);
+    EXPECT_EQ(obj->scanCount(), 1u);
+    EXPECT_EQ(obj->mergedCount(), 1u);
+}
+
+TEST_F(TstWirelessScanScheduler, minimumInterval)
+{
+    obj->requestScan();
+    processEvents(20);
+    obj->requestScan();
+    processEvents(20);
+
+    EXPECT_EQ(scans, 1);
+    EXPECT_EQ(obj->requestCount(), 2u);
+
+    obj->requestScan("/dev/unknown");
+    EXPECT_EQ(obj->requestCount(), 3u);
+}
+
+TEST_F(TstWirelessScanScheduler, explicitRequestBypassesInterval)
+{
+    obj->requestScan();
+    processEvents(20);
+    EXPECT_EQ(scans, 1);
+
+    obj->requestScan();
+    obj->requestScanNow();
+    obj->requestScanNow();
+    processEvents(20);
+
+    EXPECT_EQ(scans, 2);
+    EXPECT_EQ(obj->mergedCount(), 2u);
+}
+
+TEST_F(TstWirelessScanScheduler, listVisibleShortensInterval)
+{
+    obj->setIntervals(60 * 1000, 0);
+
+    obj->requestScan();
+    processEvents(20);
+    obj->requestScan();
+    processEvents(20);
+    EXPECT_EQ(scans, 1);
+
+    obj->setListVisible(true);
+    processEvents(20);
+    EXPECT_EQ(scans, 2);
+
+    obj->setListVisible(false);
+    obj->requestScan();
+    processEvents(20);
+    EXPECT_EQ(scans, 2);
+}
+
+TEST_F(TstWirelessScanScheduler, unknownDevice)
+{
+    // 设备还没有加入 model 时不丢弃请求
+    obj->requestScan("/dev/wlan1");
+    processEvents(20);
+    EXPECT_EQ(scans, 1);
+
+    NetworkModel empty;
+    WirelessScanScheduler scheduler(&empty);
+    int emptyScans = 0;
+    QObject::connect(&scheduler, &WirelessScanScheduler::scanRequired, [&] { ++emptyScans; });
+
+    scheduler.requestScan("/dev/wlan0");
+    processEvents(20);
+    EXPECT_EQ(emptyScans, 1);
+}
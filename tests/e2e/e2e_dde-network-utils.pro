@@ -0,0 +1,31 @@
+QT       += dbus network
+QT       -= gui
+
+TARGET = e2e_dde-network-utils
+TEMPLATE = app
+
+# 依赖 dbus-daemon, 与基准测试一样在优化后的代码上手动运行, 不加入 make check
+CONFIG += release
+CONFIG -= debug
+
+PKGCONFIG += dframeworkdbus gsettings-qt
+CONFIG += c++11 link_pkgconfig
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../dde-network-utils/src.pri)
+include(../common/common.pri)
+
+SOURCES += \
+    main.cpp \
+    e2edriver.cpp \
+    standinservice.cpp \
+    standinnmservice.cpp
+
+HEADERS += \
+    e2edriver.h \
+    standinservice.h \
+    standinnmservice.h
+
+INCLUDEPATH += ../../dde-network-utils
@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "e2edriver.h"
+#include "standinservice.h"
+#include "standinnmservice.h"
+
+#include "networkmodel.h"
+#include "networkworker.h"
+#include "wirelessdevice.h"
+#include "nmnetworkbackend.h"
+#include "daemonnetworkbackend.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QProcess>
+#include <QTextStream>
+#include <QTimer>
+#include <QDebug>
+
+#include <algorithm>
+
+using namespace dde::network;
+
+// 等待最后一次变化到达的最长时间
+#define SCENARIO_TIMEOUT    10000
+
+static qint64 processCpuUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static QString backendName(E2EDriver::Backend backend)
+{
+    switch (backend) {
+    case E2EDriver::DaemonCborBackend:  return "daemon-cbor";
+    case E2EDriver::NmBackend:          return "nm";
+    default:                            return "daemon";
+    }
+}
+
+E2EDriver::E2EDriver(QObject *parent)
+    : QObject(parent)
+    , m_busProcess(new QProcess(this))
+    , m_standinProcess(new QProcess(this))
+    , m_model(nullptr)
+    , m_worker(nullptr)
+    , m_lastReceived(0)
+    , m_bytes(0)
+    , m_burstFinished(false)
+    , m_burstLastTimestamp(0)
+{
+    m_standinProcess->setProcessChannelMode(QProcess::ForwardedChannels);
+}
+
+E2EDriver::~E2EDriver()
+{
+    stop();
+}
+
+void E2EDriver::addBackend(Backend backend)
+{
+    m_backends << backend;
+}
+
+void E2EDriver::addScenario(const QString &property, int count, int ratePerSecond)
+{
+    m_scenarios << Scenario { property, count, ratePerSecond };
+}
+
+int E2EDriver::exec()
+{
+    if (!startBus()) {
+        stop();
+        return 1;
+    }
+
+    if (m_backends.isEmpty())
+        m_backends << DaemonBackend;
+
+    int ret = 0;
+    for (Backend backend : m_backends) {
+        if (runBackend(backend) != 0)
+            ret = 1;
+    }
+
+    stop();
+    return ret;
+}
+
+int E2EDriver::runBackend(Backend backend)
+{
+    if (!startStandin(backend)) {
+        stopStandin();
+        return 1;
+    }
+
+    m_model = new NetworkModel;
+    if (backend == NmBackend) {
+        m_worker = new NetworkWorker(new NmNetworkBackend(QDBusConnection::sessionBus()), m_model, nullptr, true);
+    } else {
+        if (backend == DaemonCborBackend)
+            qunsetenv("DDE_NETWORK_UTILS_PAYLOAD");
+        else
+            qputenv("DDE_NETWORK_UTILS_PAYLOAD", "json");
+
+        DaemonNetworkBackend *daemon = new DaemonNetworkBackend;
+        m_worker = new NetworkWorker(daemon, m_model, nullptr, true);
+
+        // 统计交给解析的数据量, 属性数据是 ASCII 的 Json 或 CBOR, 直接按长度统计
+        // 协商了 CBOR 时客户端仍会收到广播的 Json, 但不再解析, 不计入
+        auto countBytes = [this] (const QString &payload) { m_bytes += payload.size(); };
+        auto countCborBytes = [this] (const QByteArray &payload) { m_bytes += payload.size(); };
+        connect(daemon, &NetworkBackend::connectionsChanged, this, countBytes);
+        connect(daemon, &NetworkBackend::activeConnectionsChanged, this, countBytes);
+        connect(daemon, &NetworkBackend::wirelessAccessPointsChanged, this, countBytes);
+        connect(daemon, &NetworkBackend::connectionsCborChanged, this, countCborBytes);
+        connect(daemon, &NetworkBackend::wirelessAccessPointsCborChanged, this, countCborBytes);
+
+        if (backend == DaemonCborBackend
+                && !waitFor([daemon] { return daemon->payloadEncoding() == PayloadCodec::Cbor; }, SCENARIO_TIMEOUT)) {
+            qWarning() << "cbor payloads are not negotiated with the stand-in service";
+            stopStandin();
+            return 1;
+        }
+    }
+
+    if (!waitFor([this] { return m_model->devices().size() == 2; }, SCENARIO_TIMEOUT)) {
+        qWarning() << "devices of the stand-in service are not loaded";
+        stopStandin();
+        return 1;
+    }
+
+    // 模拟界面上的使用方: 在 model 的信号中读取最新的数据
+    connect(m_model, &NetworkModel::connectionListChanged, this, [this] {
+        for (const QJsonObject &conn : m_model->wireds())
+            record(conn);
+    });
+    connect(m_model, &NetworkModel::activeConnectionsChanged, this, [this] (const QList<QJsonObject> &conns) {
+        for (const QJsonObject &conn : conns)
+            record(conn);
+    });
+    for (NetworkDevice *dev : m_model->devices()) {
+        if (dev->type() != NetworkDevice::Wireless)
+            continue;
+        WirelessDevice *wireless = static_cast<WirelessDevice *>(dev);
+        connect(wireless, &WirelessDevice::apAdded, this, &E2EDriver::record);
+        connect(wireless, &WirelessDevice::apInfoChanged, this, &E2EDriver::record);
+    }
+
+    QDBusConnection::sessionBus().connect(m_controlService, m_controlPath, STANDIN_CONTROL_IFACE, "BurstFinished",
+                                          this, SLOT(onBurstFinished(QString, int, qint64)));
+
+    int ret = 0;
+    for (const Scenario &scenario : m_scenarios) {
+        // stand-in NetworkManager 没有单独的 ActiveConnections 属性可以连续修改
+        if (backend == NmBackend && scenario.property == "ActiveConnections")
+            continue;
+
+        const Result result = runScenario(backend, scenario);
+        report(result);
+        if (!result.completed)
+            ret = 1;
+    }
+
+    QDBusConnection::sessionBus().disconnect(m_controlService, m_controlPath, STANDIN_CONTROL_IFACE, "BurstFinished",
+                                             this, SLOT(onBurstFinished(QString, int, qint64)));
+    stopStandin();
+    return ret;
+}
+
+void E2EDriver::onBurstFinished(const QString &name, int count, qint64 lastTimestamp)
+{
+    Q_UNUSED(name);
+    Q_UNUSED(count);
+
+    m_burstFinished = true;
+    m_burstLastTimestamp = lastTimestamp;
+}
+
+bool E2EDriver::startBus()
+{
+    m_busProcess->start("dbus-daemon", { "--session", "--nofork", "--print-address" });
+    if (!m_busProcess->waitForStarted() || !m_busProcess->waitForReadyRead()) {
+        qWarning() << "failed to start dbus-daemon:" << m_busProcess->errorString();
+        return false;
+    }
+
+    const QByteArray address = m_busProcess->readLine().trimmed();
+    if (address.isEmpty()) {
+        qWarning() << "dbus-daemon did not print its address";
+        return false;
+    }
+
+    // 必须在第一次访问 sessionBus 之前设置, 本进程和 stand-in 进程都连接到私有总线
+    qputenv("DBUS_SESSION_BUS_ADDRESS", address);
+    return true;
+}
+
+bool E2EDriver::startStandin(Backend backend)
+{
+    m_controlService = backend == NmBackend ? NM_SERVICE : STANDIN_SERVICE;
+    m_controlPath = backend == NmBackend ? STANDIN_NM_CONTROL_PATH : STANDIN_CONTROL_PATH;
+
+    m_standinProcess->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+    m_standinProcess->start(QCoreApplication::applicationFilePath(), { backend == NmBackend ? "--standin-nm" : "--standin" });
+    if (!m_standinProcess->waitForStarted()) {
+        qWarning() << "failed to start stand-in service:" << m_standinProcess->errorString();
+        return false;
+    }
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    const QString service = m_controlService;
+    if (!waitFor([bus, service] { return bus->isServiceRegistered(service).value(); }, SCENARIO_TIMEOUT)) {
+        qWarning() << "stand-in service is not registered";
+        return false;
+    }
+
+    return true;
+}
+
+void E2EDriver::stopStandin()
+{
+    delete m_worker;
+    m_worker = nullptr;
+    delete m_model;
+    m_model = nullptr;
+
+    if (m_standinProcess->state() != QProcess::NotRunning) {
+        QDBusInterface control(m_controlService, m_controlPath, STANDIN_CONTROL_IFACE);
+        control.call("Quit");
+        if (!m_standinProcess->waitForFinished(3000))
+            m_standinProcess->kill();
+    }
+}
+
+void E2EDriver::stop()
+{
+    stopStandin();
+
+    if (m_busProcess->state() != QProcess::NotRunning) {
+        m_busProcess->terminate();
+        if (!m_busProcess->waitForFinished(3000))
+            m_busProcess->kill();
+    }
+}
+
+E2EDriver::Result E2EDriver::runScenario(Backend backend, const Scenario &scenario)
+{
+    m_seen.clear();
+    m_latencies.clear();
+    m_lastReceived = 0;
+    m_bytes = 0;
+    m_burstFinished = false;
+    m_burstLastTimestamp = 0;
+
+    const quint64 droppedBefore = m_worker->ingestPipeline()->droppedCount();
+
+    Result result;
+    result.backend = backend;
+    result.scenario = scenario;
+    result.completed = false;
+
+    const qint64 start = monotonicUsec();
+    const qint64 cpuStart = processCpuUsec();
+    QDBusInterface control(m_controlService, m_controlPath, STANDIN_CONTROL_IFACE);
+    const QDBusReply<bool> reply = control.call("Burst", scenario.property, scenario.count, scenario.ratePerSecond);
+    if (reply.isValid() && reply.value()) {
+        const int duration = scenario.ratePerSecond > 0 ? 1000 * scenario.count / scenario.ratePerSecond : 0;
+        // 最后一次变化到达后才算完成, 中间被丢弃的变化不会再到达
+        result.completed = waitFor([this] {
+            return m_burstFinished && m_seen.contains(m_burstLastTimestamp);
+        }, duration + SCENARIO_TIMEOUT);
+    } else {
+        qWarning() << "failed to start burst of" << scenario.property << ":" << reply.error().message();
+    }
+
+    result.delivered = m_latencies.size();
+    result.dropped = m_worker->ingestPipeline()->droppedCount() - droppedBefore;
+    result.elapsedUsec = m_lastReceived > start ? m_lastReceived - start : 0;
+    result.cpuUsec = processCpuUsec() - cpuStart;
+    result.bytes = m_bytes;
+    result.latencies = m_latencies;
+
+    return result;
+}
+
+void E2EDriver::record(const QJsonObject &object)
+{
+    qint64 timestamp = 0;
+    const QJsonValue value = object.value(STANDIN_TIMESTAMP_KEY);
+    if (!value.isUndefined()) {
+        timestamp = static_cast<qint64>(value.toDouble());
+    } else {
+        // stand-in NetworkManager 把时间戳写在热点的 Ssid 或连接的 Id 中
+        QString stamp = object.value("Ssid").toString();
+        if (!stamp.startsWith(STANDIN_NM_TIMESTAMP_PREFIX))
+            stamp = object.value("Id").toString();
+        if (!stamp.startsWith(STANDIN_NM_TIMESTAMP_PREFIX))
+            return;
+        timestamp = stamp.mid(QString(STANDIN_NM_TIMESTAMP_PREFIX).size()).toLongLong();
+    }
+
+    // 同一份数据可能触发多个信号, 只记录第一次
+    if (m_seen.contains(timestamp))
+        return;
+
+    const qint64 now = monotonicUsec();
+    m_seen.insert(timestamp);
+    m_latencies << now - timestamp;
+    m_lastReceived = now;
+}
+
+bool E2EDriver::waitFor(const std::function<bool()> &condition, int msec)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!condition()) {
+        if (timer.hasExpired(msec))
+            return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents | QEventLoop::WaitForMoreEvents, 5);
+    }
+
+    return true;
+}
+
+void E2EDriver::report(const Result &result)
+{
+    QVector<qint64> latencies = result.latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies] (double p) -> qint64 {
+        if (latencies.isEmpty())
+            return 0;
+        const int index = qBound(0, static_cast<int>(p / 100 * latencies.size() + 0.5) - 1, latencies.size() - 1);
+        return latencies.at(index);
+    };
+
+    const double seconds = result.elapsedUsec / 1000000.0;
+    const double throughput = seconds > 0 ? result.delivered / seconds : 0;
+
+    QTextStream out(stdout);
+    out << backendName(result.backend) << " " << result.scenario.property
+        << ": sent " << result.scenario.count
+        << " at " << (result.scenario.ratePerSecond > 0 ? QString("%1/s").arg(result.scenario.ratePerSecond) : QString("full speed"))
+        << ", delivered " << result.delivered
+        << ", dropped " << result.dropped
+        << ", p50 " << percentile(50) << " us"
+        << ", p99 " << percentile(99) << " us"
+        << ", max " << (latencies.isEmpty() ? 0 : latencies.last()) << " us"
+        << ", " << QString::number(throughput, 'f', 1) << " deliveries/s"
+        << ", cpu " << QString::number(result.cpuUsec / 1000.0, 'f', 1) << " ms"
+        << (result.bytes > 0 ? QString(", parsed %1 KiB").arg(result.bytes / 1024.0, 0, 'f', 1) : QString())
+        << (result.completed ? "" : " (incomplete)")
+        << endl;
+}
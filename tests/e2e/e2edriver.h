@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef E2EDRIVER_H
+#define E2EDRIVER_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
+
+class QProcess;
+
+namespace dde {
+namespace network {
+class NetworkModel;
+class NetworkWorker;
+}
+}
+
+/**
+ * @brief E2EDriver 端到端耗时测试
+ *
+ * 启动私有的 dbus-daemon 会话总线, 再以 --standin 参数启动自身作为 stand-in 网络服务,
+ * 然后在本进程中用默认的 NetworkWorker 连接该服务. 每个场景让 stand-in 连续发出属性变化,
+ * 统计从 stand-in 发出信号到本进程中 model 信号的回调被调用的耗时, 回调的吞吐量以及本进程的 CPU 时间.
+ *
+ * NmBackend 以 --standin-nm 启动 stand-in NetworkManager, 本进程使用 NmNetworkBackend,
+ * 用于与经过 deepin 网络服务的默认路径对比. 它只支持 Connections 和 WirelessAccessPoints 场景.
+ * DaemonCborBackend 与 DaemonBackend 相同, 但与 stand-in 协商以 CBOR 发送较大的属性.
+ *
+ * 同类数据连续到达时 IngestPipeline 会丢弃过期的数据, 因此回调次数可能少于发出的次数.
+ */
+class E2EDriver : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Backend {
+        DaemonBackend,
+        DaemonCborBackend,
+        NmBackend
+    };
+
+    struct Scenario
+    {
+        QString property;
+        int count;
+        int ratePerSecond;
+    };
+
+    struct Result
+    {
+        Backend backend;
+        Scenario scenario;
+        int delivered;
+        quint64 dropped;
+        qint64 elapsedUsec;
+        qint64 cpuUsec;
+        // 收到的属性数据的字节数, NmBackend 不发送完整的属性, 总是 0
+        qint64 bytes;
+        QVector<qint64> latencies;
+        bool completed;
+    };
+
+    explicit E2EDriver(QObject *parent = nullptr);
+    ~E2EDriver();
+
+    void addBackend(Backend backend);
+    void addScenario(const QString &property, int count, int ratePerSecond);
+
+    // 返回进程退出码
+    int exec();
+
+private Q_SLOTS:
+    void onBurstFinished(const QString &name, int count, qint64 lastTimestamp);
+
+private:
+    bool startBus();
+    bool startStandin(Backend backend);
+    void stopStandin();
+    void stop();
+
+    int runBackend(Backend backend);
+    Result runScenario(Backend backend, const Scenario &scenario);
+    void record(const QJsonObject &object);
+    bool waitFor(const std::function<bool()> &condition, int msec);
+
+    static void report(const Result &result);
+
+private:
+    QProcess *m_busProcess;
+    QProcess *m_standinProcess;
+    dde::network::NetworkModel *m_model;
+    dde::network::NetworkWorker *m_worker;
+    QList<Backend> m_backends;
+    QList<Scenario> m_scenarios;
+    // 当前 stand-in 的控制接口所在的服务
+    QString m_controlService;
+    QString m_controlPath;
+
+    // 当前场景中收到的时间戳
+    QSet<qint64> m_seen;
+    QVector<qint64> m_latencies;
+    qint64 m_lastReceived;
+    qint64 m_bytes;
+    bool m_burstFinished;
+    qint64 m_burstLastTimestamp;
+};
+
+#endif // E2EDRIVER_H
@@ -0,0 +1,64 @@
+#include "e2edriver.h"
+#include "standinservice.h"
+#include "standinnmservice.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("End-to-end latency of dde-network-utils over a private session bus");
+    parser.addHelpOption();
+    QCommandLineOption standinOption("standin", "Run as the stand-in com.deepin.daemon.Network service.");
+    QCommandLineOption standinNmOption("standin-nm", "Run as the stand-in org.freedesktop.NetworkManager service.");
+    QCommandLineOption backendOption("backend", "Comma separated backends to measure: daemon, daemon-cbor, nm. \"both\" means daemon,nm.",
+                                     "backend", "daemon,daemon-cbor,nm");
+    QCommandLineOption countOption("count", "Property changes sent in each scenario.", "count", "200");
+    QCommandLineOption rateOption("rate", "Property changes sent per second, 0 for full speed. Runs 200/s and full speed by default.", "rate");
+    parser.addOptions({ standinOption, standinNmOption, backendOption, countOption, rateOption });
+    parser.process(app);
+
+    // stand-in 服务进程, 由测试进程启动
+    if (parser.isSet(standinOption)) {
+        StandinService service;
+        if (!service.registerService())
+            return 1;
+        return app.exec();
+    }
+    if (parser.isSet(standinNmOption)) {
+        StandinNmService service;
+        if (!service.registerService())
+            return 1;
+        return app.exec();
+    }
+
+    const int count = parser.value(countOption).toInt();
+    QList<int> rates { 200, 0 };
+    if (parser.isSet(rateOption))
+        rates = { parser.value(rateOption).toInt() };
+
+    E2EDriver driver;
+    QString backends = parser.value(backendOption);
+    if (backends == "both")
+        backends = "daemon,nm";
+    for (const QString &backend : backends.split(',', QString::SkipEmptyParts)) {
+        if (backend == "daemon")
+            driver.addBackend(E2EDriver::DaemonBackend);
+        else if (backend == "daemon-cbor")
+            driver.addBackend(E2EDriver::DaemonCborBackend);
+        else if (backend == "nm")
+            driver.addBackend(E2EDriver::NmBackend);
+        else
+            qWarning() << "unknown backend" << backend;
+    }
+    for (const QString &property : { "Connections", "ActiveConnections", "WirelessAccessPoints" }) {
+        for (int rate : rates)
+            driver.addScenario(property, count, rate);
+    }
+
+    return driver.exec();
+}
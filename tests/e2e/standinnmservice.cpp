@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "standinnmservice.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QTimer>
+#include <QDebug>
+
+// 与 StandinService 的数据规模相同
+#define STANDIN_NM_CONNECTIONS      20
+#define STANDIN_NM_ACCESS_POINTS    30
+
+// NMDeviceType, NMDeviceState
+#define NM_DEVICE_TYPE_ETHERNET     1
+#define NM_DEVICE_TYPE_WIFI         2
+#define NM_DEVICE_STATE_DISCONNECTED    30
+
+static QString devicePath(int index)
+{
+    return QString(NM_DEVICE_PREFIX "%1").arg(index);
+}
+
+static QString accessPointPath(int index)
+{
+    return QString(NM_AP_PREFIX "%1").arg(index);
+}
+
+static QString connectionPath(int index)
+{
+    return QString(NM_SETTINGS_PREFIX "%1").arg(index);
+}
+
+static QString hwAddress(int prefix, int index)
+{
+    return QString("%1:00:00:00:%2:%3").arg(prefix, 2, 16, QChar('0'))
+            .arg(index / 256, 2, 16, QChar('0')).arg(index % 256, 2, 16, QChar('0')).toUpper();
+}
+
+StandinNmManager::StandinNmManager(const QList<QDBusObjectPath> &devices, QObject *parent)
+    : QObject(parent)
+    , m_devices(devices)
+{
+}
+
+QDBusObjectPath StandinNmManager::ActivateConnection(const QDBusObjectPath &connection, const QDBusObjectPath &device,
+                                                     const QDBusObjectPath &specificObject)
+{
+    Q_UNUSED(connection);
+    Q_UNUSED(device);
+    Q_UNUSED(specificObject);
+
+    return QDBusObjectPath(NM_ACTIVE_PREFIX "0");
+}
+
+void StandinNmManager::DeactivateConnection(const QDBusObjectPath &activeConnection)
+{
+    Q_UNUSED(activeConnection);
+}
+
+uint StandinNmManager::CheckConnectivity()
+{
+    return connectivity();
+}
+
+StandinNmDevice::StandinNmDevice(uint deviceType, int index, QObject *parent)
+    : QObject(parent)
+    , m_interface(QString(deviceType == NM_DEVICE_TYPE_WIFI ? "wlan%1" : "eth%1").arg(index))
+    , m_hwAddress(hwAddress(0x02, index))
+    , m_driver(deviceType == NM_DEVICE_TYPE_WIFI ? "iwlwifi" : "e1000e")
+    , m_deviceType(deviceType)
+    , m_state(NM_DEVICE_STATE_DISCONNECTED)
+    // NM_DEVICE_INTERFACE_FLAG_UP
+    , m_interfaceFlags(0x1)
+    , m_managed(true)
+{
+}
+
+void StandinNmDevice::Disconnect()
+{
+}
+
+StandinNmWireless::StandinNmWireless(const QList<QDBusObjectPath> &accessPoints, StandinNmDevice *device)
+    : QDBusAbstractAdaptor(device)
+    , m_accessPoints(accessPoints)
+{
+}
+
+void StandinNmWireless::RequestScan(const QVariantMap &options)
+{
+    Q_UNUSED(options);
+}
+
+StandinNmAccessPoint::StandinNmAccessPoint(int index, QObject *parent)
+    : QObject(parent)
+    , m_ssid(QString("ap-%1").arg(index).toUtf8())
+    , m_hwAddress(hwAddress(0x0a, index))
+    , m_strength(static_cast<uchar>((index * 7) % 100))
+    // 偶数序号的热点加密
+    , m_flags(index % 2 == 0 ? 0x1 : 0)
+    , m_wpaFlags(0)
+    , m_rsnFlags(index % 2 == 0 ? 0x188 : 0)
+    , m_frequency(index % 3 == 0 ? 5180 : 2412)
+{
+}
+
+void StandinNmAccessPoint::update(const QString &path, const QByteArray &ssid, uchar strength)
+{
+    m_ssid = ssid;
+    m_strength = strength;
+
+    QDBusMessage msg = QDBusMessage::createSignal(path, DBUS_PROPERTIES_IFACE, QStringLiteral("PropertiesChanged"));
+    msg << QString(NM_AP_IFACE)
+        << QVariantMap { { "Ssid", m_ssid }, { "Strength", QVariant::fromValue(m_strength) } }
+        << QStringList();
+    QDBusConnection::sessionBus().send(msg);
+}
+
+StandinNmConnection::StandinNmConnection(int index, QObject *parent)
+    : QObject(parent)
+{
+    m_settings.insert("connection", QVariantMap {
+        { "id", QString("wired-%1").arg(index) },
+        { "uuid", QString("00000000-0000-0000-0000-%1").arg(index, 12, 10, QChar('0')) },
+        { "type", QString("802-3-ethernet") },
+    });
+    // 不绑定网卡, 所有有线设备都可以使用
+    m_settings.insert("802-3-ethernet", QVariantMap());
+}
+
+void StandinNmConnection::setId(const QString &id)
+{
+    m_settings["connection"].insert("id", id);
+
+    Q_EMIT Updated();
+}
+
+NMVariantMapMap StandinNmConnection::GetSettings()
+{
+    return m_settings;
+}
+
+void StandinNmConnection::Delete()
+{
+}
+
+StandinNmSettings::StandinNmSettings(const QList<QDBusObjectPath> &connections, QObject *parent)
+    : QObject(parent)
+    , m_connections(connections)
+{
+}
+
+QList<QDBusObjectPath> StandinNmSettings::ListConnections()
+{
+    return m_connections;
+}
+
+StandinNmControl::StandinNmControl(const QList<StandinNmAccessPoint *> &accessPoints,
+                                   const QList<StandinNmConnection *> &connections, QObject *parent)
+    : QObject(parent)
+    , m_accessPoints(accessPoints)
+    , m_connections(connections)
+    , m_burstTimer(new QTimer(this))
+    , m_burstCount(0)
+    , m_burstNext(0)
+    , m_burstPerTick(1)
+    , m_lastTimestamp(0)
+{
+    connect(m_burstTimer, &QTimer::timeout, this, &StandinNmControl::emitNext);
+}
+
+bool StandinNmControl::Burst(const QString &name, int count, int ratePerSecond)
+{
+    if (m_burstTimer->isActive() || count <= 0)
+        return false;
+    if (name != "WirelessAccessPoints" && name != "Connections")
+        return false;
+
+    m_burstName = name;
+    m_burstCount = count;
+    m_burstNext = 0;
+
+    if (ratePerSecond <= 0) {
+        m_burstPerTick = count;
+        QTimer::singleShot(0, this, &StandinNmControl::emitNext);
+        return true;
+    }
+
+    // 定时器精度只有 1ms, 更高的频率在每次触发时发出多个变化
+    m_burstPerTick = (ratePerSecond + 999) / 1000;
+    m_burstTimer->start(qMax(1, 1000 * m_burstPerTick / ratePerSecond));
+    return true;
+}
+
+void StandinNmControl::Quit()
+{
+    QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+}
+
+void StandinNmControl::emitNext()
+{
+    const int last = qMin(m_burstCount, m_burstNext + m_burstPerTick);
+    for (; m_burstNext < last; ++m_burstNext) {
+        m_lastTimestamp = monotonicUsec();
+        const QString stamp = STANDIN_NM_TIMESTAMP_PREFIX + QString::number(m_lastTimestamp);
+
+        if (m_burstName == "WirelessAccessPoints") {
+            const int index = m_burstNext % m_accessPoints.size();
+            m_accessPoints.at(index)->update(accessPointPath(index), stamp.toUtf8(),
+                                             static_cast<uchar>((index * 7 + m_burstNext * 13) % 100));
+        } else {
+            m_connections.at(m_burstNext % m_connections.size())->setId(stamp);
+        }
+    }
+
+    if (m_burstNext < m_burstCount)
+        return;
+
+    m_burstTimer->stop();
+
+    Q_EMIT BurstFinished(m_burstName, m_burstCount, m_lastTimestamp);
+}
+
+StandinNmService::StandinNmService(QObject *parent)
+    : QObject(parent)
+{
+    qDBusRegisterMetaType<NMVariantMapMap>();
+
+    QList<QDBusObjectPath> apPaths;
+    for (int i = 0; i < STANDIN_NM_ACCESS_POINTS; ++i) {
+        m_accessPoints << new StandinNmAccessPoint(i, this);
+        apPaths << QDBusObjectPath(accessPointPath(i));
+    }
+
+    m_devices << new StandinNmDevice(NM_DEVICE_TYPE_ETHERNET, 0, this);
+    m_devices << new StandinNmDevice(NM_DEVICE_TYPE_WIFI, 1, this);
+    new StandinNmWireless(apPaths, m_devices.last());
+
+    QList<QDBusObjectPath> connPaths;
+    for (int i = 0; i < STANDIN_NM_CONNECTIONS; ++i) {
+        m_connections << new StandinNmConnection(i, this);
+        connPaths << QDBusObjectPath(connectionPath(i));
+    }
+
+    m_manager = new StandinNmManager({ QDBusObjectPath(devicePath(0)), QDBusObjectPath(devicePath(1)) }, this);
+    m_settings = new StandinNmSettings(connPaths, this);
+    m_control = new StandinNmControl(m_accessPoints, m_connections, this);
+}
+
+bool StandinNmService::registerService()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    const QDBusConnection::RegisterOptions options = QDBusConnection::ExportScriptableSlots
+            | QDBusConnection::ExportScriptableSignals
+            | QDBusConnection::ExportAllProperties
+            | QDBusConnection::ExportAdaptors;
+
+    bool ok = bus.registerObject(NM_PATH, m_manager, options)
+            && bus.registerObject(NM_SETTINGS_PATH, m_settings, options)
+            && bus.registerObject(STANDIN_NM_CONTROL_PATH, m_control, options);
+    for (int i = 0; ok && i < m_devices.size(); ++i)
+        ok = bus.registerObject(devicePath(i), m_devices.at(i), options);
+    for (int i = 0; ok && i < m_accessPoints.size(); ++i)
+        ok = bus.registerObject(accessPointPath(i), m_accessPoints.at(i), options);
+    for (int i = 0; ok && i < m_connections.size(); ++i)
+        ok = bus.registerObject(connectionPath(i), m_connections.at(i), options);
+
+    if (!ok) {
+        qWarning() << "failed to register stand-in NetworkManager objects:" << bus.lastError().message();
+        return false;
+    }
+
+    // 对象全部注册后再占用服务名, 客户端看到服务出现时即可正常访问
+    if (!bus.registerService(NM_SERVICE)) {
+        qWarning() << "failed to register" << NM_SERVICE << ":" << bus.lastError().message();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STANDINNMSERVICE_H
+#define STANDINNMSERVICE_H
+
+#include "standinservice.h"
+#include "nmnetworkbackend.h"
+
+#include <QObject>
+#include <QDBusAbstractAdaptor>
+#include <QDBusObjectPath>
+#include <QVariantMap>
+
+class QTimer;
+
+#define STANDIN_NM_CONTROL_PATH     "/org/freedesktop/NetworkManager/Standin"
+
+// NetworkManager 的属性不能附加额外的字段, 时间戳以 "standin:<微秒>" 的形式写入热点的 Ssid 或连接的 Id
+#define STANDIN_NM_TIMESTAMP_PREFIX "standin:"
+
+/**
+ * @brief StandinNmManager 模拟 org.freedesktop.NetworkManager 根对象
+ */
+class StandinNmManager : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", NM_IFACE)
+    Q_PROPERTY(QList<QDBusObjectPath> Devices READ devices)
+    Q_PROPERTY(QList<QDBusObjectPath> ActiveConnections READ activeConnections)
+    Q_PROPERTY(QDBusObjectPath PrimaryConnection READ primaryConnection)
+    Q_PROPERTY(uint Connectivity READ connectivity)
+
+public:
+    explicit StandinNmManager(const QList<QDBusObjectPath> &devices, QObject *parent = nullptr);
+
+    QList<QDBusObjectPath> devices() const { return m_devices; }
+    QList<QDBusObjectPath> activeConnections() const { return QList<QDBusObjectPath>(); }
+    QDBusObjectPath primaryConnection() const { return QDBusObjectPath("/"); }
+    // Connectivity::Full, 避免 model 启动联网检测
+    uint connectivity() const { return 4; }
+
+public Q_SLOTS:
+    Q_SCRIPTABLE QDBusObjectPath ActivateConnection(const QDBusObjectPath &connection, const QDBusObjectPath &device,
+                                                    const QDBusObjectPath &specificObject);
+    Q_SCRIPTABLE void DeactivateConnection(const QDBusObjectPath &activeConnection);
+    Q_SCRIPTABLE uint CheckConnectivity();
+
+private:
+    QList<QDBusObjectPath> m_devices;
+};
+
+/**
+ * @brief StandinNmDevice 模拟 org.freedesktop.NetworkManager.Device
+ */
+class StandinNmDevice : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", NM_DEVICE_IFACE)
+    Q_PROPERTY(QString Interface MEMBER m_interface)
+    Q_PROPERTY(QString HwAddress MEMBER m_hwAddress)
+    Q_PROPERTY(QString Driver MEMBER m_driver)
+    Q_PROPERTY(uint DeviceType MEMBER m_deviceType)
+    Q_PROPERTY(uint State MEMBER m_state)
+    Q_PROPERTY(uint InterfaceFlags MEMBER m_interfaceFlags)
+    Q_PROPERTY(bool Managed MEMBER m_managed)
+
+public:
+    StandinNmDevice(uint deviceType, int index, QObject *parent = nullptr);
+
+public Q_SLOTS:
+    Q_SCRIPTABLE void Disconnect();
+
+private:
+    QString m_interface;
+    QString m_hwAddress;
+    QString m_driver;
+    uint m_deviceType;
+    uint m_state;
+    uint m_interfaceFlags;
+    bool m_managed;
+};
+
+/**
+ * @brief StandinNmWireless 无线设备上的 org.freedesktop.NetworkManager.Device.Wireless 接口
+ */
+class StandinNmWireless : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", NM_WIRELESS_IFACE)
+    Q_PROPERTY(QList<QDBusObjectPath> AccessPoints READ accessPoints)
+
+public:
+    StandinNmWireless(const QList<QDBusObjectPath> &accessPoints, StandinNmDevice *device);
+
+    QList<QDBusObjectPath> accessPoints() const { return m_accessPoints; }
+
+public Q_SLOTS:
+    void RequestScan(const QVariantMap &options);
+
+private:
+    QList<QDBusObjectPath> m_accessPoints;
+};
+
+/**
+ * @brief StandinNmAccessPoint 模拟 org.freedesktop.NetworkManager.AccessPoint
+ */
+class StandinNmAccessPoint : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", NM_AP_IFACE)
+    Q_PROPERTY(QByteArray Ssid MEMBER m_ssid)
+    Q_PROPERTY(QString HwAddress MEMBER m_hwAddress)
+    Q_PROPERTY(uchar Strength MEMBER m_strength)
+    Q_PROPERTY(uint Flags MEMBER m_flags)
+    Q_PROPERTY(uint WpaFlags MEMBER m_wpaFlags)
+    Q_PROPERTY(uint RsnFlags MEMBER m_rsnFlags)
+    Q_PROPERTY(uint Frequency MEMBER m_frequency)
+
+public:
+    StandinNmAccessPoint(int index, QObject *parent = nullptr);
+
+    // 与 NetworkManager 一样, 只在 PropertiesChanged 中发出变化的属性
+    void update(const QString &path, const QByteArray &ssid, uchar strength);
+
+private:
+    QByteArray m_ssid;
+    QString m_hwAddress;
+    uchar m_strength;
+    uint m_flags;
+    uint m_wpaFlags;
+    uint m_rsnFlags;
+    uint m_frequency;
+};
+
+/**
+ * @brief StandinNmConnection 模拟 org.freedesktop.NetworkManager.Settings.Connection
+ */
+class StandinNmConnection : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", NM_CONNECTION_IFACE)
+
+public:
+    StandinNmConnection(int index, QObject *parent = nullptr);
+
+    void setId(const QString &id);
+
+Q_SIGNALS:
+    Q_SCRIPTABLE void Updated();
+
+public Q_SLOTS:
+    Q_SCRIPTABLE NMVariantMapMap GetSettings();
+    Q_SCRIPTABLE void Delete();
+
+private:
+    NMVariantMapMap m_settings;
+};
+
+/**
+ * @brief StandinNmSettings 模拟 org.freedesktop.NetworkManager.Settings
+ */
+class StandinNmSettings : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", NM_SETTINGS_IFACE)
+
+public:
+    explicit StandinNmSettings(const QList<QDBusObjectPath> &connections, QObject *parent = nullptr);
+
+Q_SIGNALS:
+    Q_SCRIPTABLE void NewConnection(const QDBusObjectPath &connection);
+    Q_SCRIPTABLE void ConnectionRemoved(const QDBusObjectPath &connection);
+
+public Q_SLOTS:
+    Q_SCRIPTABLE QList<QDBusObjectPath> ListConnections();
+
+private:
+    QList<QDBusObjectPath> m_connections;
+};
+
+/**
+ * @brief StandinNmControl 与 StandinControl 相同的控制接口
+ *
+ * Burst 每次只修改一个对象: WirelessAccessPoints 依次修改各热点的 Ssid 和 Strength,
+ * 通过该热点的 PropertiesChanged 发出; Connections 依次修改各连接的 Id 并发出 Updated.
+ * 这正是 NetworkManager 的粒度, 而 deepin 网络服务每次发出的都是完整的列表.
+ */
+class StandinNmControl : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", STANDIN_CONTROL_IFACE)
+
+public:
+    StandinNmControl(const QList<StandinNmAccessPoint *> &accessPoints, const QList<StandinNmConnection *> &connections,
+                     QObject *parent = nullptr);
+
+Q_SIGNALS:
+    Q_SCRIPTABLE void BurstFinished(const QString &name, int count, qint64 lastTimestamp);
+
+public Q_SLOTS:
+    Q_SCRIPTABLE bool Burst(const QString &name, int count, int ratePerSecond);
+    Q_SCRIPTABLE void Quit();
+
+private:
+    void emitNext();
+
+private:
+    QList<StandinNmAccessPoint *> m_accessPoints;
+    QList<StandinNmConnection *> m_connections;
+    QTimer *m_burstTimer;
+
+    QString m_burstName;
+    int m_burstCount;
+    int m_burstNext;
+    int m_burstPerTick;
+    qint64 m_lastTimestamp;
+};
+
+/**
+ * @brief StandinNmService 在当前会话总线上注册 stand-in NetworkManager 服务
+ *
+ * 包含一个有线设备和一个带热点的无线设备, 以及若干有线连接, 规模与 StandinService 相同.
+ */
+class StandinNmService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StandinNmService(QObject *parent = nullptr);
+
+    bool registerService();
+
+private:
+    StandinNmManager *m_manager;
+    QList<StandinNmDevice *> m_devices;
+    QList<StandinNmAccessPoint *> m_accessPoints;
+    QList<StandinNmConnection *> m_connections;
+    StandinNmSettings *m_settings;
+    StandinNmControl *m_control;
+};
+
+#endif // STANDINNMSERVICE_H
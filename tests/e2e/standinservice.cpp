@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "standinservice.h"
+#include "payloadgenerator.h"
+#include "payloadcodec.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTimer>
+#include <QDebug>
+
+// Burst 中每次变化的数据规模
+#define BURST_CONNECTIONS       20
+#define BURST_ACCESS_POINTS     30
+
+using namespace dde::network;
+
+StandinNetwork::StandinNetwork(QObject *parent)
+    : QObject(parent)
+    , m_peerWatcher(new QDBusServiceWatcher(this))
+{
+    m_peerWatcher->setConnection(QDBusConnection::sessionBus());
+    m_peerWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_peerWatcher, &QDBusServiceWatcher::serviceUnregistered, this, [this](const QString &peer) {
+        m_cborPeers.remove(peer);
+        m_peerWatcher->removeWatchedService(peer);
+    });
+
+    m_properties.insert("Devices", PayloadGenerator::devices(1, 1));
+    m_properties.insert("Connections", PayloadGenerator::connections(BURST_CONNECTIONS));
+    m_properties.insert("ActiveConnections", QString("{}"));
+    m_properties.insert("WirelessAccessPoints", PayloadGenerator::accessPoints({ PayloadGenerator::devicePath(1) }, BURST_ACCESS_POINTS));
+    m_properties.insert("VpnEnabled", false);
+    // Connectivity::Full, 避免 model 启动联网检测
+    m_properties.insert("Connectivity", 4u);
+
+    m_proxy.insert("method", QString("none"));
+}
+
+void StandinNetwork::updateProperty(const QString &name, const QVariant &value)
+{
+    m_properties.insert(name, value);
+
+    QDBusMessage msg = QDBusMessage::createSignal(STANDIN_PATH,
+                                                  QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                  QStringLiteral("PropertiesChanged"));
+    msg << QString(STANDIN_SERVICE) << QVariantMap { { name, value } } << QStringList();
+    QDBusConnection::sessionBus().send(msg);
+
+    if (m_cborPeers.isEmpty() || (name != "Connections" && name != "WirelessAccessPoints"))
+        return;
+
+    // 广播之后再单独发给协商了 CBOR 的客户端, 同一客户端收到的顺序与发出的顺序相同
+    const QJsonObject object = QJsonDocument::fromJson(value.toString().toUtf8()).object();
+    const QVariantMap cbor { { name + "Cbor", PayloadCodec::encode(object, PayloadCodec::Cbor) } };
+    for (const QString &peer : m_cborPeers) {
+        QDBusMessage targeted = QDBusMessage::createTargetedSignal(peer, STANDIN_PATH,
+                                                                   QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                                   QStringLiteral("PropertiesChanged"));
+        targeted << QString(STANDIN_SERVICE) << cbor << QStringList();
+        QDBusConnection::sessionBus().send(targeted);
+    }
+}
+
+QDBusObjectPath StandinNetwork::ActivateConnection(const QString &uuid, const QDBusObjectPath &devPath)
+{
+    Q_UNUSED(uuid);
+    Q_UNUSED(devPath);
+
+    return QDBusObjectPath("/org/freedesktop/NetworkManager/ActiveConnection/0");
+}
+
+void StandinNetwork::DeactivateConnection(const QString &uuid)
+{
+    Q_UNUSED(uuid);
+}
+
+void StandinNetwork::DisconnectDevice(const QDBusObjectPath &devPath)
+{
+    Q_UNUSED(devPath);
+}
+
+void StandinNetwork::EnableDevice(const QDBusObjectPath &devPath, bool enabled)
+{
+    m_deviceEnabled.insert(devPath.path(), enabled);
+
+    Q_EMIT DeviceEnabled(devPath, enabled);
+}
+
+QString StandinNetwork::GetActiveConnectionInfo()
+{
+    return QStringLiteral("[]");
+}
+
+QString StandinNetwork::GetAutoProxy()
+{
+    return m_proxy.value("auto").toString();
+}
+
+QString StandinNetwork::GetProxy(const QString &type, QString &port)
+{
+    port = m_proxy.value(type + "/port", QString("0")).toString();
+
+    return m_proxy.value(type + "/addr").toString();
+}
+
+QString StandinNetwork::GetProxyIgnoreHosts()
+{
+    return m_proxy.value("ignoreHosts").toString();
+}
+
+QString StandinNetwork::GetProxyMethod()
+{
+    return m_proxy.value("method").toString();
+}
+
+QStringList StandinNetwork::GetPayloadEncodings()
+{
+    QStringList encodings { PayloadCodec::encodingName(PayloadCodec::Json) };
+    if (PayloadCodec::isCborSupported())
+        encodings << PayloadCodec::encodingName(PayloadCodec::Cbor);
+
+    return encodings;
+}
+
+bool StandinNetwork::IsDeviceEnabled(const QDBusObjectPath &devPath)
+{
+    return m_deviceEnabled.value(devPath.path(), true);
+}
+
+void StandinNetwork::RequestWirelessScan()
+{
+}
+
+void StandinNetwork::SetAutoProxy(const QString &proxy)
+{
+    m_proxy.insert("auto", proxy);
+}
+
+void StandinNetwork::SetProxy(const QString &type, const QString &addr, const QString &port)
+{
+    m_proxy.insert(type + "/addr", addr);
+    m_proxy.insert(type + "/port", port);
+}
+
+void StandinNetwork::SetProxyIgnoreHosts(const QString &hosts)
+{
+    m_proxy.insert("ignoreHosts", hosts);
+}
+
+void StandinNetwork::SetProxyMethod(const QString &method)
+{
+    m_proxy.insert("method", method);
+}
+
+void StandinNetwork::SetPayloadEncoding(const QString &encoding)
+{
+    PayloadCodec::Encoding value;
+    if (!PayloadCodec::encodingFromName(encoding, &value)) {
+        sendErrorReply(QDBusError::InvalidArgs, "unsupported payload encoding " + encoding);
+        return;
+    }
+
+    // 只改变调用者自己的编码
+    const QString peer = message().service();
+    if (value == PayloadCodec::Cbor) {
+        if (!m_cborPeers.contains(peer)) {
+            m_cborPeers.insert(peer);
+            m_peerWatcher->addWatchedService(peer);
+        }
+    } else if (m_cborPeers.remove(peer)) {
+        m_peerWatcher->removeWatchedService(peer);
+    }
+}
+
+StandinProxyChains::StandinProxyChains(QObject *parent)
+    : QObject(parent)
+    , m_port(0)
+{
+}
+
+void StandinProxyChains::Set(const QString &type, const QString &ip, uint port, const QString &user, const QString &password)
+{
+    m_type = type;
+    m_ip = ip;
+    m_port = port;
+    m_user = user;
+    m_password = password;
+}
+
+StandinControl::StandinControl(StandinNetwork *network, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_burstTimer(new QTimer(this))
+    , m_burstNext(0)
+    , m_burstPerTick(1)
+    , m_lastTimestamp(0)
+{
+    connect(m_burstTimer, &QTimer::timeout, this, &StandinControl::emitNext);
+}
+
+bool StandinControl::SetProperty(const QString &name, const QDBusVariant &value)
+{
+    if (!m_network->hasProperty(name))
+        return false;
+
+    m_network->updateProperty(name, value.variant());
+    return true;
+}
+
+bool StandinControl::Burst(const QString &name, int count, int ratePerSecond)
+{
+    if (m_burstTimer->isActive() || count <= 0 || generate(name, 0).isNull())
+        return false;
+
+    // 数据提前生成好, 避免生成数据的耗时影响发出的频率
+    m_burstName = name;
+    m_burstPayloads.clear();
+    for (int i = 0; i < count; ++i)
+        m_burstPayloads << generate(name, i + 1);
+    m_burstNext = 0;
+
+    if (ratePerSecond <= 0) {
+        m_burstPerTick = count;
+        QTimer::singleShot(0, this, &StandinControl::emitNext);
+        return true;
+    }
+
+    // 定时器精度只有 1ms, 更高的频率在每次触发时发出多个变化
+    m_burstPerTick = (ratePerSecond + 999) / 1000;
+    m_burstTimer->start(qMax(1, 1000 * m_burstPerTick / ratePerSecond));
+    return true;
+}
+
+void StandinControl::Quit()
+{
+    QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+}
+
+void StandinControl::emitNext()
+{
+    const int last = qMin(m_burstPayloads.size(), m_burstNext + m_burstPerTick);
+    for (; m_burstNext < last; ++m_burstNext) {
+        QJsonDocument &doc = m_burstPayloads[m_burstNext];
+        m_lastTimestamp = monotonicUsec();
+        stamp(doc, m_lastTimestamp);
+        m_network->updateProperty(m_burstName, QString::fromUtf8(doc.toJson(QJsonDocument::Compact)));
+    }
+
+    if (m_burstNext < m_burstPayloads.size())
+        return;
+
+    m_burstTimer->stop();
+    const int count = m_burstPayloads.size();
+    m_burstPayloads.clear();
+
+    Q_EMIT BurstFinished(m_burstName, count, m_lastTimestamp);
+}
+
+QJsonDocument StandinControl::generate(const QString &name, int generation)
+{
+    QString payload;
+    if (name == "Connections")
+        payload = PayloadGenerator::connections(BURST_CONNECTIONS, "wired", generation);
+    else if (name == "ActiveConnections")
+        payload = PayloadGenerator::activeConnections({ PayloadGenerator::devicePath(0) });
+    else if (name == "WirelessAccessPoints")
+        payload = PayloadGenerator::accessPoints({ PayloadGenerator::devicePath(1) }, BURST_ACCESS_POINTS, generation);
+
+    return QJsonDocument::fromJson(payload.toUtf8());
+}
+
+void StandinControl::stamp(QJsonDocument &doc, qint64 usec)
+{
+    // 时间戳写入第一个对象: {"key": [{...}, ...]} 或 {"key": {...}}
+    QJsonObject root = doc.object();
+    if (root.isEmpty())
+        return;
+
+    const QString key = root.constBegin().key();
+    QJsonValue value = root.value(key);
+    if (value.isArray()) {
+        QJsonArray array = value.toArray();
+        if (array.isEmpty())
+            return;
+        QJsonObject first = array.first().toObject();
+        first.insert(STANDIN_TIMESTAMP_KEY, usec);
+        array.replace(0, first);
+        value = array;
+    } else {
+        QJsonObject object = value.toObject();
+        object.insert(STANDIN_TIMESTAMP_KEY, usec);
+        value = object;
+    }
+
+    root.insert(key, value);
+    doc.setObject(root);
+}
+
+StandinService::StandinService(QObject *parent)
+    : QObject(parent)
+    , m_network(new StandinNetwork(this))
+    , m_chains(new StandinProxyChains(this))
+    , m_control(new StandinControl(m_network, this))
+{
+}
+
+bool StandinService::registerService()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    const QDBusConnection::RegisterOptions options = QDBusConnection::ExportScriptableSlots
+            | QDBusConnection::ExportScriptableSignals
+            | QDBusConnection::ExportAllProperties;
+
+    if (!bus.registerObject(STANDIN_PATH, m_network, options)
+            || !bus.registerObject(STANDIN_CHAINS_PATH, m_chains, options)
+            || !bus.registerObject(STANDIN_CONTROL_PATH, m_control, options)) {
+        qWarning() << "failed to register stand-in objects:" << bus.lastError().message();
+        return false;
+    }
+
+    // 对象全部注册后再占用服务名, 客户端看到服务出现时即可正常访问
+    if (!bus.registerService(STANDIN_SERVICE)) {
+        qWarning() << "failed to register" << STANDIN_SERVICE << ":" << bus.lastError().message();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STANDINSERVICE_H
+#define STANDINSERVICE_H
+
+#include <QObject>
+#include <QDBusContext>
+#include <QDBusObjectPath>
+#include <QJsonDocument>
+#include <QVariantMap>
+#include <QSet>
+
+#include <time.h>
+
+class QTimer;
+class QDBusServiceWatcher;
+
+#define STANDIN_SERVICE         "com.deepin.daemon.Network"
+#define STANDIN_PATH            "/com/deepin/daemon/Network"
+#define STANDIN_CHAINS_PATH     "/com/deepin/daemon/Network/ProxyChains"
+#define STANDIN_CONTROL_PATH    "/com/deepin/daemon/Network/Standin"
+#define STANDIN_CONTROL_IFACE   "com.deepin.daemon.Network.Standin"
+
+// 发出信号时写入 payload 第一个对象中的时间戳 (CLOCK_MONOTONIC, 微秒), 各进程之间可以直接比较
+#define STANDIN_TIMESTAMP_KEY   "StandinTimestamp"
+
+static inline qint64 monotonicUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief StandinNetwork 模拟 com.deepin.daemon.Network 的属性和常用方法
+ *
+ * 属性变化时与真实服务一样通过 org.freedesktop.DBus.Properties.PropertiesChanged 通知.
+ * 只实现了 NetworkWorker 初始化和测试中会用到的方法.
+ *
+ * 编码按客户端分别协商: 调用过 SetPayloadEncoding("cbor") 的客户端, 在 Connections 和
+ * WirelessAccessPoints 变化时还会单独收到一个只发给它的 PropertiesChanged, 其中是 CBOR 编码的
+ * ConnectionsCbor 和 WirelessAccessPointsCbor. Json 的变化照常广播, 其他客户端不受影响.
+ */
+class StandinNetwork : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", STANDIN_SERVICE)
+    Q_PROPERTY(QString Devices READ devices)
+    Q_PROPERTY(QString Connections READ connections)
+    Q_PROPERTY(QString ActiveConnections READ activeConnections)
+    Q_PROPERTY(QString WirelessAccessPoints READ wirelessAccessPoints)
+    Q_PROPERTY(bool VpnEnabled READ vpnEnabled WRITE setVpnEnabled)
+    Q_PROPERTY(uint Connectivity READ connectivity)
+
+public:
+    explicit StandinNetwork(QObject *parent = nullptr);
+
+    QString devices() const { return m_properties.value("Devices").toString(); }
+    QString connections() const { return m_properties.value("Connections").toString(); }
+    QString activeConnections() const { return m_properties.value("ActiveConnections").toString(); }
+    QString wirelessAccessPoints() const { return m_properties.value("WirelessAccessPoints").toString(); }
+    bool vpnEnabled() const { return m_properties.value("VpnEnabled").toBool(); }
+    void setVpnEnabled(bool enabled) { updateProperty("VpnEnabled", enabled); }
+    uint connectivity() const { return m_properties.value("Connectivity").toUInt(); }
+
+    bool hasProperty(const QString &name) const { return m_properties.contains(name); }
+    void updateProperty(const QString &name, const QVariant &value);
+
+Q_SIGNALS:
+    Q_SCRIPTABLE void DeviceEnabled(const QDBusObjectPath &devPath, bool enabled);
+
+public Q_SLOTS:
+    Q_SCRIPTABLE QDBusObjectPath ActivateConnection(const QString &uuid, const QDBusObjectPath &devPath);
+    Q_SCRIPTABLE void DeactivateConnection(const QString &uuid);
+    Q_SCRIPTABLE void DisconnectDevice(const QDBusObjectPath &devPath);
+    Q_SCRIPTABLE void EnableDevice(const QDBusObjectPath &devPath, bool enabled);
+    Q_SCRIPTABLE QString GetActiveConnectionInfo();
+    Q_SCRIPTABLE QString GetAutoProxy();
+    Q_SCRIPTABLE QString GetProxy(const QString &type, QString &port);
+    Q_SCRIPTABLE QString GetProxyIgnoreHosts();
+    Q_SCRIPTABLE QString GetProxyMethod();
+    Q_SCRIPTABLE QStringList GetPayloadEncodings();
+    Q_SCRIPTABLE bool IsDeviceEnabled(const QDBusObjectPath &devPath);
+    Q_SCRIPTABLE void RequestWirelessScan();
+    Q_SCRIPTABLE void SetAutoProxy(const QString &proxy);
+    Q_SCRIPTABLE void SetProxy(const QString &type, const QString &addr, const QString &port);
+    Q_SCRIPTABLE void SetProxyIgnoreHosts(const QString &hosts);
+    Q_SCRIPTABLE void SetProxyMethod(const QString &method);
+    Q_SCRIPTABLE void SetPayloadEncoding(const QString &encoding);
+
+private:
+    QVariantMap m_properties;
+    QVariantMap m_proxy;
+    QMap<QString, bool> m_deviceEnabled;
+    // 协商了 CBOR 的客户端的 unique name, 客户端退出后移除
+    QSet<QString> m_cborPeers;
+    QDBusServiceWatcher *m_peerWatcher;
+};
+
+/**
+ * @brief StandinProxyChains 模拟 com.deepin.daemon.Network.ProxyChains
+ */
+class StandinProxyChains : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.daemon.Network.ProxyChains")
+    Q_PROPERTY(QString Type READ type)
+    Q_PROPERTY(QString IP READ ip)
+    Q_PROPERTY(uint Port READ port)
+    Q_PROPERTY(QString User READ user)
+    Q_PROPERTY(QString Password READ password)
+
+public:
+    explicit StandinProxyChains(QObject *parent = nullptr);
+
+    QString type() const { return m_type; }
+    QString ip() const { return m_ip; }
+    uint port() const { return m_port; }
+    QString user() const { return m_user; }
+    QString password() const { return m_password; }
+
+public Q_SLOTS:
+    Q_SCRIPTABLE void Set(const QString &type, const QString &ip, uint port, const QString &user, const QString &password);
+
+private:
+    QString m_type;
+    QString m_ip;
+    uint m_port;
+    QString m_user;
+    QString m_password;
+};
+
+/**
+ * @brief StandinControl 供测试进程控制 stand-in 服务的接口
+ *
+ * - SetProperty: 直接修改 StandinNetwork 的属性并发出变化通知
+ * - Burst: 以指定频率连续发出 count 次属性变化, 每次的 payload 都不同, 且带有发出时的时间戳;
+ *   ratePerSecond 不大于 0 时不做间隔, 全部发出后通过 BurstFinished 通知最后一次的时间戳
+ * - Quit: 退出 stand-in 进程
+ */
+class StandinControl : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", STANDIN_CONTROL_IFACE)
+
+public:
+    explicit StandinControl(StandinNetwork *network, QObject *parent = nullptr);
+
+Q_SIGNALS:
+    Q_SCRIPTABLE void BurstFinished(const QString &name, int count, qint64 lastTimestamp);
+
+public Q_SLOTS:
+    Q_SCRIPTABLE bool SetProperty(const QString &name, const QDBusVariant &value);
+    Q_SCRIPTABLE bool Burst(const QString &name, int count, int ratePerSecond);
+    Q_SCRIPTABLE void Quit();
+
+private:
+    void emitNext();
+    static QJsonDocument generate(const QString &name, int generation);
+    static void stamp(QJsonDocument &doc, qint64 usec);
+
+private:
+    StandinNetwork *m_network;
+    QTimer *m_burstTimer;
+
+    QString m_burstName;
+    QList<QJsonDocument> m_burstPayloads;
+    int m_burstNext;
+    int m_burstPerTick;
+    qint64 m_lastTimestamp;
+};
+
+/**
+ * @brief StandinService 在当前会话总线上注册 stand-in 服务
+ */
+class StandinService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StandinService(QObject *parent = nullptr);
+
+    bool registerService();
+
+private:
+    StandinNetwork *m_network;
+    StandinProxyChains *m_chains;
+    StandinControl *m_control;
+};
+
+#endif // STANDINSERVICE_H
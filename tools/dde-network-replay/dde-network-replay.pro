@@ -0,0 +1,22 @@
+QT       += dbus network
+QT       -= gui
+
+TARGET = dde-network-replay
+TEMPLATE = app
+
+PKGCONFIG += dframeworkdbus gsettings-qt
+CONFIG += c++11 link_pkgconfig
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../dde-network-utils/src.pri)
+
+SOURCES += \
+    main.cpp \
+    networkreplayer.cpp
+
+HEADERS += \
+    networkreplayer.h
+
+INCLUDEPATH += ../../dde-network-utils
@@ -0,0 +1,39 @@
+#include "networkreplayer.h"
+#include "signalrecorder.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+using namespace dde::network;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay network signals recorded with DDE_NETWORK_UTILS_RECORD into a NetworkModel");
+    parser.addHelpOption();
+    QCommandLineOption speedOption("speed", "Replay speed, 1 for the original timing, 0 for no delay.", "factor", "1");
+    parser.addOption(speedOption);
+    parser.addPositionalArgument("recording", "File written by the signal recorder.");
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    bool ok = false;
+    const QList<SignalRecorder::Record> records = SignalRecorder::load(parser.positionalArguments().first(), &ok);
+    if (!ok && records.isEmpty())
+        return 1;
+
+    QTextStream out(stdout);
+    if (!ok)
+        out << "recording is truncated, replaying the first " << records.size() << " records" << endl;
+
+    NetworkReplayer replayer(records, parser.value(speedOption).toDouble());
+    replayer.run();
+    replayer.report(out);
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkreplayer.h"
+#include "networkmodel.h"
+#include "networkdevice.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaMethod>
+#include <QTextStream>
+#include <QTimer>
+
+#include <time.h>
+
+using namespace dde::network;
+
+static qint64 threadCpuUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+NetworkReplayer::NetworkReplayer(const QList<SignalRecorder::Record> &records, double speed, QObject *parent)
+    : QObject(parent)
+    , m_records(records)
+    , m_speed(speed)
+    , m_model(new NetworkModel(this))
+    , m_currentKind(-1)
+    , m_elapsedUsec(0)
+{
+    watch(m_model);
+    connect(m_model, &NetworkModel::deviceListChanged, this, &NetworkReplayer::watchDevices);
+}
+
+NetworkReplayer::~NetworkReplayer()
+{
+}
+
+void NetworkReplayer::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const SignalRecorder::Record &record : m_records) {
+        if (m_speed > 0)
+            wait(static_cast<qint64>(record.usec / m_speed) - timer.nsecsElapsed() / 1000);
+
+        dispatch(record);
+    }
+
+    // model 内部排队的处理也算在回放中
+    QCoreApplication::processEvents();
+    m_elapsedUsec = timer.nsecsElapsed() / 1000;
+}
+
+void NetworkReplayer::report(QTextStream &out) const
+{
+    out << "replayed " << m_records.size() << " records in " << m_elapsedUsec / 1000 << " ms"
+        << (m_speed > 0 ? QString(" at %1x speed").arg(m_speed) : QString(" at full speed")) << endl << endl;
+
+    out << qSetFieldWidth(24) << left << "handler" << qSetFieldWidth(10) << right
+        << "calls" << "cpu ms" << "mean us" << "max us" << "signals" << qSetFieldWidth(0) << endl;
+
+    for (int kind = 0; kind < SignalRecorder::KindCount; ++kind) {
+        const HandlerStats &stats = m_handlers[kind];
+        if (!stats.calls)
+            continue;
+
+        out << qSetFieldWidth(24) << left << SignalRecorder::kindName(kind) << qSetFieldWidth(10) << right
+            << stats.calls
+            << QString::number(stats.cpuUsec / 1000.0, 'f', 2)
+            << stats.cpuUsec / static_cast<qint64>(stats.calls)
+            << stats.maxCpuUsec
+            << stats.signalCount
+            << qSetFieldWidth(0) << endl;
+    }
+
+    out << endl << qSetFieldWidth(48) << left << "signal" << qSetFieldWidth(10) << right << "count" << qSetFieldWidth(0) << endl;
+    for (auto it = m_signals.constBegin(); it != m_signals.constEnd(); ++it)
+        out << qSetFieldWidth(48) << left << it.key() << qSetFieldWidth(10) << right << it.value() << qSetFieldWidth(0) << endl;
+}
+
+void NetworkReplayer::countSignal()
+{
+    const QObject *object = sender();
+    if (!object)
+        return;
+
+    const QMetaMethod signal = object->metaObject()->method(senderSignalIndex());
+    ++m_signals[QString("%1::%2").arg(object->metaObject()->className()).arg(QString::fromLatin1(signal.name()))];
+
+    if (m_currentKind >= 0)
+        ++m_handlers[m_currentKind].signalCount;
+}
+
+void NetworkReplayer::dispatch(const SignalRecorder::Record &record)
+{
+    // model 的数据入口都是私有槽, 通过元对象系统调用
+    const char *slot = nullptr;
+    switch (record.kind) {
+    case SignalRecorder::Devices:           slot = "onDevicesChanged";              break;
+    case SignalRecorder::Connections:       slot = "onConnectionListChanged";       break;
+    case SignalRecorder::ActiveConnections: slot = "onActiveConnectionsChanged";    break;
+    case SignalRecorder::AccessPoints:      slot = "onWirelessAccessPointsChanged"; break;
+    case SignalRecorder::ActiveConnInfo:    slot = "onActiveConnInfoChanged";       break;
+    default:                                                                        break;
+    }
+
+    m_currentKind = record.kind;
+    const qint64 start = threadCpuUsec();
+
+    if (slot) {
+        QMetaObject::invokeMethod(m_model, slot, Qt::DirectConnection, Q_ARG(QString, record.payload));
+    } else if (record.kind == SignalRecorder::DeviceEnabled) {
+        const QJsonObject object = QJsonDocument::fromJson(record.payload.toUtf8()).object();
+        QMetaObject::invokeMethod(m_model, "onDeviceEnableChanged", Qt::DirectConnection,
+                                  Q_ARG(QString, object.value("Path").toString()),
+                                  Q_ARG(bool, object.value("Enabled").toBool()));
+    } else if (record.kind == SignalRecorder::Connectivity) {
+        QMetaObject::invokeMethod(m_model, "onConnectivityChanged", Qt::DirectConnection, Q_ARG(int, record.payload.toInt()));
+    } else if (record.kind == SignalRecorder::VpnEnabled) {
+        QMetaObject::invokeMethod(m_model, "onVPNEnabledChanged", Qt::DirectConnection, Q_ARG(bool, record.payload == "true"));
+    }
+
+    const qint64 cpu = threadCpuUsec() - start;
+    m_currentKind = -1;
+
+    HandlerStats &stats = m_handlers[record.kind];
+    ++stats.calls;
+    stats.cpuUsec += cpu;
+    stats.maxCpuUsec = qMax(stats.maxCpuUsec, cpu);
+}
+
+void NetworkReplayer::watch(QObject *object)
+{
+    if (m_watched.contains(object))
+        return;
+
+    m_watched.insert(object);
+    connect(object, &QObject::destroyed, this, [this, object] { m_watched.remove(object); });
+
+    const QMetaMethod counter = metaObject()->method(metaObject()->indexOfSlot("countSignal()"));
+    const QMetaObject *meta = object->metaObject();
+    for (int i = QObject::staticMetaObject.methodCount(); i < meta->methodCount(); ++i) {
+        const QMetaMethod method = meta->method(i);
+        if (method.methodType() == QMetaMethod::Signal)
+            connect(object, method, this, counter);
+    }
+}
+
+void NetworkReplayer::watchDevices()
+{
+    for (NetworkDevice *dev : m_model->devices())
+        watch(dev);
+}
+
+void NetworkReplayer::wait(qint64 usec)
+{
+    if (usec <= 0) {
+        QCoreApplication::processEvents();
+        return;
+    }
+
+    QEventLoop loop;
+    QTimer::singleShot(static_cast<int>(usec / 1000), Qt::PreciseTimer, &loop, &QEventLoop::quit);
+    loop.exec();
+}
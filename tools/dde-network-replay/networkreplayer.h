@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKREPLAYER_H
+#define NETWORKREPLAYER_H
+
+#include "signalrecorder.h"
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+
+class QTextStream;
+
+namespace dde {
+namespace network {
+class NetworkModel;
+}
+}
+
+/**
+ * @brief NetworkReplayer 把 SignalRecorder 录制的数据按原来的时间间隔送入 NetworkModel
+ *
+ * speed 为回放的倍速, 不大于 0 时不等待, 连续回放.
+ * 每条数据调用 model 对应的入口, 统计各入口占用的 CPU 时间, 以及期间 model 和设备发出的信号个数.
+ */
+class NetworkReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct HandlerStats
+    {
+        quint64 calls = 0;
+        qint64 cpuUsec = 0;
+        qint64 maxCpuUsec = 0;
+        quint64 signalCount = 0;
+    };
+
+    NetworkReplayer(const QList<dde::network::SignalRecorder::Record> &records, double speed, QObject *parent = nullptr);
+    ~NetworkReplayer();
+
+    void run();
+    void report(QTextStream &out) const;
+
+private Q_SLOTS:
+    void countSignal();
+
+private:
+    void dispatch(const dde::network::SignalRecorder::Record &record);
+    void watch(QObject *object);
+    void watchDevices();
+    void wait(qint64 usec);
+
+private:
+    QList<dde::network::SignalRecorder::Record> m_records;
+    double m_speed;
+    dde::network::NetworkModel *m_model;
+
+    int m_currentKind;
+    HandlerStats m_handlers[dde::network::SignalRecorder::KindCount];
+    QMap<QString, quint64> m_signals;
+    QSet<QObject *> m_watched;
+    qint64 m_elapsedUsec;
+};
+
+#endif // NETWORKREPLAYER_H